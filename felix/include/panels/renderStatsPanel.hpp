@@ -8,6 +8,7 @@ class RenderStatsPanel
 {
    public:
     bool m_wireFrame = false;
+    bool m_depthTest = false;
 
     RenderStatsPanel()
     {
@@ -42,10 +43,16 @@ class RenderStatsPanel
 
         ImGui::Checkbox("Wireframe Mode", &m_wireFrame);
 
-        if (ImGui::Checkbox("Depth Test", &m_depthTest))
+        // the gui runs on the render thread, felix applies both on the main thread
+        ImGui::Checkbox("Depth Test", &m_depthTest);
+
+        i32_t framesInFlight = Renderer::s_getFramesInFlight();
+        ImGui::PushItemWidth(70.0f);
+        if (ImGui::SliderInt("Frames In Flight", &framesInFlight, 1, Renderer::k_maxFramesInFlight))
         {
-            GraphicsApi::setDepthTest(m_depthTest);
+            Renderer::s_setFramesInFlight(framesInFlight);
         }
+        ImGui::PopItemWidth();
 
         // TODO Temporary
         static bool showDemoWindow = false;
@@ -98,12 +105,41 @@ class RenderStatsPanel
                 ImGui::PushItemWidth(60.0f);
                 ImGui::LabelText("Draw Calls", "%i", stats.drawCalls);
                 ImGui::LabelText("Quads", "%i", stats.quads);
+                ImGui::LabelText("Compact Quads", "%i", stats.compactQuads);
+                ImGui::LabelText("Static Quads", "%i", stats.staticQuads);
+                ImGui::LabelText("Static Quads Uploaded", "%i", stats.staticQuadsUploaded);
                 ImGui::LabelText("Characters", "%i", stats.characters);
+                ImGui::LabelText("Text Layouts", "%i", stats.textLayouts);
+                ImGui::LabelText("Text Layouts Built", "%i", stats.textLayoutsBuilt);
+                ImGui::LabelText("Glyphs Cached", "%i", stats.glyphsCached);
+                ImGui::LabelText("Glyphs Pending", "%i", stats.glyphsPending);
+                ImGui::LabelText("Glyphs Generated", "%i", stats.glyphsGenerated);
+                ImGui::LabelText("Glyphs From Cache", "%i", stats.glyphsFromCache);
+                ImGui::LabelText("Glyphs Evicted", "%i", stats.glyphsEvicted);
+                ImGui::LabelText("Opaque Draws", "%i", stats.opaqueDraws);
+                ImGui::LabelText("Translucent Draws", "%i", stats.translucentDraws);
+                ImGui::LabelText("Batch Breaks Pipeline", "%i", stats.batchBreaksPipeline);
+                ImGui::LabelText("Batch Breaks Textures", "%i", stats.batchBreaksTextures);
+                ImGui::LabelText("Batch Breaks Capacity", "%i", stats.batchBreaksCapacity);
+                ImGui::LabelText("Quads Submitted", "%i", stats.submittedQuads);
+                ImGui::LabelText("Quads Culled", "%i", stats.culledQuads);
+                ImGui::LabelText("Texts Submitted", "%i", stats.submittedTexts);
+                ImGui::LabelText("Texts Culled", "%i", stats.culledTexts);
 
                 ImGui::LabelText("Total Vertices", "%i", stats.totalVertices);
                 ImGui::LabelText("Quad Vertices Available", "%i", stats.quadVertsAvail);
                 ImGui::LabelText("Text Vertices Available", "%i", stats.textVertsAvail);
 
+                ImGui::LabelText("Cmd Queue KiB", "%.1f", stats.cmdQueueBytes / 1024.0f);
+                ImGui::LabelText("Cmd Queue High Water KiB", "%.1f", stats.cmdQueueHighWaterBytes / 1024.0f);
+                ImGui::LabelText("Cmd Queue Pool KiB", "%.1f", stats.cmdQueuePoolBytes / 1024.0f);
+                ImGui::LabelText("Cmd Lists", "%i", stats.cmdLists);
+                ImGui::LabelText("Streamed KiB", "%.1f", stats.streamedBytes / 1024.0f);
+                ImGui::LabelText("Texture Pages", "%i", stats.texturePages);
+                ImGui::LabelText("Packed Textures", "%i", stats.packedTextures);
+                ImGui::LabelText("State Changes Issued", "%i", stats.stateChangesIssued);
+                ImGui::LabelText("State Changes Skipped", "%i", stats.stateChangesSkipped);
+
                 ImGui::PopItemWidth();
 
                 ImGui::EndTabItem();
@@ -139,7 +175,6 @@ class RenderStatsPanel
    private:
     Application* mp_appRef;
     Window*      mp_appWinRef;
-    bool         m_depthTest = false;
 
     inline static const u32_t k_frameHistoryLength = 60 * 2 + 1;
     std::vector<f32_t>        m_frameTimes_ms;
@@ -146,7 +146,7 @@ class SceneHeirarchyPanel
             Entity entity       = {entityHandle, mp_sceneContext.raw()};
             auto&  name         = entity.getComponent<NameCmp>().name;
 
-            if (filter.PassFilter(name.c_str()) && !entity.getComponent<AncestryCmp>().parent)
+            if (filter.PassFilter(name.c_str()) && entity.getComponent<AncestryCmp>().parent == entt::null)
             {
                 // only draw entities that passed the filter and are
                 // top level entities
@@ -240,8 +240,8 @@ class SceneHeirarchyPanel
         auto& name = entity.getComponent<NameCmp>().name;
         auto& ac   = entity.getComponent<AncestryCmp>();
 
-        bool isChild     = ac.parent;
-        bool hasChildren = ac.children.size() > 0;
+        bool isChild     = ac.parent != entt::null;
+        bool hasChildren = ac.childCount > 0;
 
         ImGuiTreeNodeFlags flags
             = ImGuiTreeNodeFlags_OpenOnArrow | ImGuiTreeNodeFlags_OpenOnDoubleClick | ImGuiTreeNodeFlags_SpanAvailWidth;
@@ -256,13 +256,16 @@ class SceneHeirarchyPanel
 
         // if the section context is a child of this, force it to be open
 
-        for (auto child : ac.children)
+        Entity child(ac.firstChild, mp_sceneContext.raw());
+        while (child)
         {
             if (m_selectionContext == child)
             {
                 ImGui::SetNextItemOpen(true);
                 break;
             }
+
+            child = Entity(child.getComponent<AncestryCmp>().nextSibling, mp_sceneContext.raw());
         }
 
         bool open = ImGui::TreeNodeEx((void*)entity.getId(), flags, "%s %s", icon, name.c_str());
@@ -293,15 +296,21 @@ class SceneHeirarchyPanel
 
         if (open)
         {
-            // draw children
-            for (u32_t i = 0; i < ac.children.size(); i++)
+            // draw children, looked up again as adding one above can move this one's component
+            Entity child(entity.getComponent<AncestryCmp>().firstChild, mp_sceneContext.raw());
+            while (child)
             {
-                Entity selected = _drawEntity(ac.children[i]);
+                // a child can remove itself while it's drawn
+                Entity next(child.getComponent<AncestryCmp>().nextSibling, mp_sceneContext.raw());
+
+                Entity selected = _drawEntity(child);
 
                 if (selected)
                 {
                     selectedChild = selected;
                 }
+
+                child = next;
             }
 
             ImGui::TreePop();
@@ -352,46 +361,46 @@ class SceneHeirarchyPanel
     {
         auto& tc = entity.getComponent<TransformCmp>();
 
-        glm::vec3 translation = tc.local.getTranslation();
+        glm::vec3 translation = tc.getTranslation();
 
         if (_drawVec3Control("Translation", translation, 0.0f, 0.01f))
         {
-            tc.local.setTranslation(translation);
+            tc.setTranslation(translation);
         }
 
-        glm::vec3 rotation = glm::degrees(tc.local.getRotation());
+        glm::vec3 rotation = glm::degrees(tc.getRotation());
 
         if (_drawVec3Control("Rotation", rotation, 0.0f, 0.1f))
         {
-            tc.local.setRotation(glm::radians(rotation));
+            tc.setRotation(glm::radians(rotation));
         }
 
-        glm::vec3 scale = tc.local.getScale();
+        glm::vec3 scale = tc.getScale();
 
-        bool locked = tc.local.isScaleLocked();
+        bool locked = tc.isScaleLocked();
         if (_drawVec3Control("Scale", scale, 1.0f, 0.01f, true, &locked))
         {
-            tc.local.setScaleLocked(locked);
+            tc.setScaleLocked(locked);
 
-            if (tc.local.isScaleLocked())
+            if (tc.isScaleLocked())
             {
                 // check what changed
-                if (scale.x != tc.local.getScale().x)
+                if (scale.x != tc.getScale().x)
                 {
-                    tc.local.setScaleX(scale.x);
+                    tc.setScaleX(scale.x);
                 }
-                else if (scale.y != tc.local.getScale().y)
+                else if (scale.y != tc.getScale().y)
                 {
-                    tc.local.setScaleY(scale.y);
+                    tc.setScaleY(scale.y);
                 }
-                else if (scale.z != tc.local.getScale().z)
+                else if (scale.z != tc.getScale().z)
                 {
-                    tc.local.setScaleZ(scale.z);
+                    tc.setScaleZ(scale.z);
                 }
             }
             else
             {
-                tc.local.setScale(scale);
+                tc.setScale(scale);
             }
         }
 
@@ -469,10 +478,13 @@ class SceneHeirarchyPanel
 
         if (ImGui::TreeNodeEx("Color", flags))
         {
-            ImGui::ColorEdit4(
-                "Color",
-                glm::value_ptr(spriteCmp.color),
-                ImGuiColorEditFlags_Float | ImGuiColorEditFlags_AlphaBar | ImGuiColorEditFlags_AlphaPreview);
+            if (ImGui::ColorEdit4(
+                    "Color",
+                    glm::value_ptr(spriteCmp.color),
+                    ImGuiColorEditFlags_Float | ImGuiColorEditFlags_AlphaBar | ImGuiColorEditFlags_AlphaPreview))
+            {
+                entity.markChanged<SpriteCmp>();
+            }
 
             ImGui::TreePop();
         }
@@ -516,6 +528,7 @@ class SceneHeirarchyPanel
                     if (texture)
                     {
                         spriteCmp.p_texture = texture;
+                        entity.markChanged<SpriteCmp>();
                     }
                     else
                     {
@@ -543,6 +556,7 @@ class SceneHeirarchyPanel
                     if (texture)
                     {
                         spriteCmp.p_texture = texture;
+                        entity.markChanged<SpriteCmp>();
                     }
                     else
                     {
@@ -554,7 +568,10 @@ class SceneHeirarchyPanel
 
             ImGui::TableNextColumn();
             ImGui::Text("Albedo");
-            ImGui::DragFloat("Tiling Factor", &spriteCmp.tilingFactor, 0.01f, 0.0f);
+            if (ImGui::DragFloat("Tiling Factor", &spriteCmp.tilingFactor, 0.01f, 0.0f))
+            {
+                entity.markChanged<SpriteCmp>();
+            }
 
             ImGui::EndTable();
 
@@ -751,6 +768,22 @@ class SceneHeirarchyPanel
                     pc.p_emitter->setShrink(pc.parameters.shrink);
                 }
             }
+            ImGui::SameLine();
+            if (ImGui::Checkbox("Analytic", &pc.parameters.analytic))
+            {
+                if (isRuntime)
+                {
+                    pc.p_emitter->setAnalytic(pc.parameters.analytic);
+                }
+            }
+
+            // both take effect when the emitter starts, seed 0 takes the next of Random's sequence
+            ImGui::InputScalar("Seed", ImGuiDataType_U32, &pc.parameters.seed);
+            if (pc.parameters.analytic)
+            {
+                ImGui::DragFloat(
+                    "Prewarm", &pc.parameters.prewarm_s, 0.05f, 0.0f, 10000.0f, "%.02f s", ImGuiSliderFlags_AlwaysClamp);
+            }
 
             if (ImGui::DragFloatRange2("Lifetime",
                                        &pc.parameters.lifetimeMin_s,
@@ -880,6 +913,15 @@ class SceneHeirarchyPanel
                 }
             }
 
+            // who keeps their particles when the scene is over its particle budget
+            if (ImGui::DragInt("Priority", &pc.parameters.priority))
+            {
+                if (isRuntime)
+                {
+                    pc.p_emitter->setPriority(pc.parameters.priority);
+                }
+            }
+
             for (u32_t i = 0; i < pc.parameters.colors.size(); i++)
             {
                 auto& colorSpec = pc.parameters.colors[i];
@@ -237,7 +237,7 @@ class ViewportPanel
                 const glm::mat4& cameraProjection = mp_editCamera->getProjection();
 
                 auto&     tc        = selectedEntity.getComponent<TransformCmp>();
-                glm::mat4 transform = tc.world.getTransform();
+                glm::mat4 transform = tc.getWorld();
 
                 ImGuizmo::Manipulate(glm::value_ptr(cameraView),
                                      glm::value_ptr(cameraProjection),
@@ -288,20 +288,20 @@ class ViewportPanel
                 return;
             }
 
-            auto& tc = selectedEntity.getComponent<TransformCmp>();
-            auto& ac = selectedEntity.getComponent<AncestryCmp>();
+            auto&  tc = selectedEntity.getComponent<TransformCmp>();
+            Entity parent(selectedEntity.getComponent<AncestryCmp>().parent, mp_sceneContext.raw());
 
-            if (ac.parent)
+            if (parent)
             {
                 // this is a child, so we must adjust the  transform
                 // imuizmo gave us to local for this child. For
                 // base level entities (no parents) local = world so this
                 // doesn't need to be done
-                if (ac.parent.hasComponent<TransformCmp>())
+                if (parent.hasComponent<TransformCmp>())
                 {
                     // Remove parent world component by multiplying
                     // this world by inverse of parent's world
-                    localT *= glm::inverse(ac.parent.getComponent<TransformCmp>().world.getTransform());
+                    localT *= glm::inverse(parent.getComponent<TransformCmp>().getWorld());
                 }
             }
             // now that we have a modified transform, figure out what changed
@@ -321,25 +321,25 @@ class ViewportPanel
             {
                 case (ImGuizmo::OPERATION::UNIVERSAL):
                 {
-                    tc.local.setTranslation(translation);
-                    tc.local.setRotation(rotation);
-                    tc.local.setScale(scale);
+                    tc.setTranslation(translation);
+                    tc.setRotation(rotation);
+                    tc.setScale(scale);
 
                     break;
                 }
                 case (ImGuizmo::OPERATION::TRANSLATE):
                 {
-                    tc.local.setTranslation(translation);
+                    tc.setTranslation(translation);
                     break;
                 }
                 case (ImGuizmo::OPERATION::ROTATE):
                 {
-                    tc.local.setRotation(rotation);
+                    tc.setRotation(rotation);
                     break;
                 }
                 case (ImGuizmo::OPERATION::SCALE):
                 {
-                    tc.local.setScale(scale);
+                    tc.setScale(scale);
                     break;
                 }
                 default:
@@ -219,10 +219,10 @@ class FelixLayer : public Layer
         //     {
         //         auto  spriteEntity1 = mp_scene->addEntity("Test Sprite " + std::to_string((i * sz) + j));
         //         auto& transformCmp1 = spriteEntity1.addComponent<TransformCmp>();
-        //         transformCmp1.local.setScale({0.1f, 0.1f, 1.0f});
-        //         transformCmp1.local.setTranslationX(0.13 * i);
-        //         transformCmp1.local.setTranslationY(0.13 * j);
-        //         transformCmp1.local.setRotationZ(glm::radians(45.0f));
+        //         transformCmp1.setScale({0.1f, 0.1f, 1.0f});
+        //         transformCmp1.setTranslationX(0.13 * i);
+        //         transformCmp1.setTranslationY(0.13 * j);
+        //         transformCmp1.setRotationZ(glm::radians(45.0f));
         //         auto& spriteCmp1 = spriteEntity1.addComponent<SpriteCmp>();
         //         spriteCmp1.color = {0.0f, 0.02f * i, 0.02f * j, 1.0f};
         //     }
@@ -230,7 +230,7 @@ class FelixLayer : public Layer
 
         // auto  spriteEntity2 = mp_scene->addEntity("Test Sprite 2");
         // auto& transformCmp2 = spriteEntity2.addComponent<TransformCmp>();
-        // transformCmp2.local.setScale({0.75f, 0.75f, 1.0f});
+        // transformCmp2.setScale({0.75f, 0.75f, 1.0f});
         // auto& spriteCmp2 = spriteEntity2.addComponent<SpriteCmp>();
         // spriteCmp2.color = {0.1f, 0.9f, 0.2f, 1.0f};
 
@@ -248,9 +248,9 @@ class FelixLayer : public Layer
 
         // auto  textEntity    = mp_scene->addEntity("Test Text");
         // auto& transformCmp3 = textEntity.addComponent<TransformCmp>();
-        // transformCmp3.local.setScale({0.25f, 0.25f, 1.0f});
-        // transformCmp3.local.setTranslationX(-0.4f);
-        // transformCmp3.local.setTranslationY(0.30f);
+        // transformCmp3.setScale({0.25f, 0.25f, 1.0f});
+        // transformCmp3.setTranslationX(-0.4f);
+        // transformCmp3.setTranslationY(0.30f);
         // auto textCmp = textEntity.addComponent<TextCmp>("Yuge File", format);
 
         // mp_scene->sortEntities();
@@ -397,6 +397,11 @@ class FelixLayer : public Layer
             GraphicsApi::setWireframe(mp_renderStatsPanel->m_wireFrame);
         }
 
+        if (mp_renderStatsPanel->m_depthTest != GraphicsApi::getDepthTest())
+        {
+            GraphicsApi::setDepthTest(mp_renderStatsPanel->m_depthTest);
+        }
+
         Renderer2D::s_resetStats();
 
         if (m_sceneState == State::stop)
@@ -9,10 +9,12 @@
 #include "nimbus/core/application.hpp"
 #include "nimbus/core/common.hpp"
 #include "nimbus/core/event.hpp"
+#include "nimbus/core/jobSystem.hpp"
 #include "nimbus/core/keyCode.hpp"
 #include "nimbus/core/mouseButton.hpp"
 #include "nimbus/core/layer.hpp"
 #include "nimbus/core/log.hpp"
+#include "nimbus/core/random.hpp"
 #include "nimbus/core/resourceManager.hpp"
 #include "nimbus/core/utility.hpp"
 
@@ -27,13 +29,21 @@
 #include "nimbus/renderer/buffer.hpp"
 #include "nimbus/renderer/font.hpp"
 #include "nimbus/renderer/framebuffer.hpp"
+#include "nimbus/renderer/frustumCuller.hpp"
+#include "nimbus/renderer/glyphAtlas.hpp"
 #include "nimbus/renderer/mesh.hpp"
 #include "nimbus/renderer/model.hpp"
 #include "nimbus/renderer/particleEmitter.hpp"
+#include "nimbus/renderer/particleSystem.hpp"
+#include "nimbus/renderer/pipelineState.hpp"
 #include "nimbus/renderer/renderer.hpp"
 #include "nimbus/renderer/renderer2D.hpp"
 #include "nimbus/renderer/shader.hpp"
+#include "nimbus/renderer/staticQuadBatch.hpp"
+#include "nimbus/renderer/streamingBuffer.hpp"
+#include "nimbus/renderer/textLayoutCache.hpp"
 #include "nimbus/renderer/texture.hpp"
+#include "nimbus/renderer/textureArray.hpp"
 
 ///////////////////////////
 // Scene
@@ -44,6 +54,7 @@
 #include "nimbus/scene/component.hpp"
 #include "nimbus/scene/camera.hpp"
 #include "nimbus/scene/sceneSerializer.hpp"
+#include "nimbus/scene/transformPool.hpp"
 
 ///////////////////////////
 // Scripting
@@ -0,0 +1,96 @@
+#pragma once
+#include "nimbus/core/common.hpp"
+
+#include <atomic>
+#include <functional>
+#include <initializer_list>
+#include <mutex>
+#include <vector>
+
+namespace nimbus
+{
+
+struct JobSystemInternalData;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Work stealing job system. Each worker owns a queue it pushes/pops from the back of, idle workers steal from the
+// front of the other queues. Threads that are not workers (main, render, ...) share queue 0.
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+class NIMBUS_API JobSystem
+{
+   public:
+    using jobFn_t   = std::function<void()>;
+    using rangeFn_t = std::function<void(u32_t begin, u32_t end)>;
+
+    class NIMBUS_API Job : public refCounted
+    {
+       public:
+        inline bool isDone() const
+        {
+            return m_unfinished.load(std::memory_order_acquire) == 0;
+        }
+
+       private:
+        jobFn_t  m_fn;
+        ref<Job> m_parent = nullptr;
+
+        // self + outstanding children
+        std::atomic<u32_t> m_unfinished = 1;
+
+        // dependencies that have to finish before this can be queued
+        std::atomic<u32_t> m_pendingDeps = 1;
+
+        std::mutex            m_dependentsMtx;
+        std::vector<ref<Job>> m_dependents;
+        bool                  m_finished = false;
+
+        // see s_getJobLocal
+        void* mp_local = nullptr;
+
+        friend class JobSystem;
+    };
+
+    using Handle = ref<Job>;
+
+    inline static const i32_t k_detectCountIfPossible = -1;
+
+    static void s_init(i32_t workerCount = k_detectCountIfPossible);
+    static void s_destroy();
+
+    // Queue fn once every job in deps has finished.
+    static Handle s_submit(jobFn_t fn, std::initializer_list<Handle> deps = {});
+    static Handle s_submit(jobFn_t fn, const std::vector<Handle>& deps);
+
+    // Split [0, count) into chunks of grainSize and run fn over each on the pool. The returned handle finishes when
+    // every chunk has. A grainSize of 0 picks one based on the worker count.
+    static Handle s_parallelFor(u32_t count, u32_t grainSize, rangeFn_t fn, std::initializer_list<Handle> deps = {});
+
+    // Block until the job finishes, running pending jobs on the calling thread in the meantime.
+    static void s_wait(const Handle& handle);
+
+    static void s_waitAll(const std::vector<Handle>& handles);
+
+    static u32_t s_getWorkerCount();
+
+    // Whether the calling thread is running a job right now
+    static bool s_isInJob();
+
+    // A slot for state that belongs to the running job rather than its thread. A thread waiting on a job runs others
+    // in the meantime, thread_local state would leak into those. Inside jobs only.
+    static void* s_getJobLocal();
+    static void  s_setJobLocal(void* p_local);
+
+   private:
+    static JobSystemInternalData* sp_data;
+
+    static Handle _s_create(jobFn_t fn, Job* p_parent);
+    static void   _s_addDependencies(Handle& job, const Handle* p_deps, u32_t depCount);
+    static void   _s_enqueue(const Handle& job);
+    static Handle _s_fetch();
+    static bool   _s_runOne();
+    static void   _s_execute(Handle& job);
+    static void   _s_finish(Job* p_job);
+    static void   _s_workerFn(u32_t queueIdx);
+};
+
+}  // namespace nimbus
@@ -0,0 +1,58 @@
+#pragma once
+#include "nimbus/core/common.hpp"
+
+namespace nimbus
+{
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Small, fast and seedable random numbers from xoshiro128++, 16 bytes of state. Batches come from 4 more generators
+// run side by side, 4 numbers at a time with SSE2, and are the same with or without it. A Random made without a seed
+// takes the next one of a process wide sequence, s_setSeed makes that sequence and so whole runs repeat exactly. Not
+// thread safe, give each thread its own.
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+class NIMBUS_API Random
+{
+   public:
+    // seeded from the process wide sequence
+    Random();
+
+    explicit Random(u64_t seed);
+
+    void seed(u64_t seed);
+
+    u32_t nextU32();
+    u64_t nextU64();
+
+    // in [0, 1)
+    f32_t nextF32();
+
+    // in [min, max)
+    f32_t range(f32_t min, f32_t max);
+
+    // in [min, max]
+    u32_t rangeU32(u32_t min, u32_t max);
+
+    // count floats in [min, max), the batch generators' stream is separate from the one above
+    void fill(f32_t* p_dest, u32_t count, f32_t min, f32_t max);
+
+    // restarts the sequence unseeded Randoms take their seed from, do it before making them
+    static void s_setSeed(u64_t seed);
+
+    // different every call and every run, for what must never repeat even when the sequence does
+    static u64_t s_entropySeed();
+
+   private:
+    inline static const u32_t k_laneCount = 4;
+
+    u32_t m_state[4];
+
+    // the batch generators, [word][lane] so a word of every lane loads at once
+    alignas(16) u32_t m_lanes[4][k_laneCount];
+
+    // next k_laneCount numbers of the batch generators
+    void _nextLanes(u32_t* p_dest);
+
+    static u64_t _s_splitMix(u64_t& state);
+};
+
+}  // namespace nimbus
@@ -28,6 +28,8 @@ class NIMBUS_API ResourceManager
     ref<Font> loadFont(const std::string& path);
 
    private:
+    inline static const std::string k_fontCacheDir = "../resources/cache/fonts";
+
     std::unordered_map<std::string, ref<Texture>> m_loadedTextures;
     std::unordered_map<std::string, ref<Shader>>  m_loadedShaders;
     std::unordered_map<std::string, ref<Font>>    m_loadedFonts;
@@ -0,0 +1,204 @@
+#pragma once
+#include "nimbus/core/common.hpp"
+
+#if defined(__AVX__)
+#define NB_SIMD_AVX
+#include <immintrin.h>
+#elif defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define NB_SIMD_SSE
+#include <xmmintrin.h>
+#else
+#include <cmath>
+#endif
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// The widest float vector the build targets, 8 lanes with AVX, 4 with SSE and 1 without either. Kernels written
+// against these run k_width elements per step on whatever the build has, with a scalar loop for the remainder.
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+namespace nimbus::simd
+{
+
+#if defined(NB_SIMD_AVX)
+using f32v_t = __m256;
+
+inline constexpr u32_t k_width = 8;
+
+inline f32v_t load(const f32_t* p_src)
+{
+    return _mm256_loadu_ps(p_src);
+}
+
+inline void store(f32_t* p_dst, f32v_t value)
+{
+    _mm256_storeu_ps(p_dst, value);
+}
+
+inline f32v_t set(f32_t value)
+{
+    return _mm256_set1_ps(value);
+}
+
+inline f32v_t add(f32v_t lhs, f32v_t rhs)
+{
+    return _mm256_add_ps(lhs, rhs);
+}
+
+inline f32v_t sub(f32v_t lhs, f32v_t rhs)
+{
+    return _mm256_sub_ps(lhs, rhs);
+}
+
+inline f32v_t mul(f32v_t lhs, f32v_t rhs)
+{
+    return _mm256_mul_ps(lhs, rhs);
+}
+
+inline f32v_t div(f32v_t lhs, f32v_t rhs)
+{
+    return _mm256_div_ps(lhs, rhs);
+}
+
+inline f32v_t min(f32v_t lhs, f32v_t rhs)
+{
+    return _mm256_min_ps(lhs, rhs);
+}
+
+inline f32v_t max(f32v_t lhs, f32v_t rhs)
+{
+    return _mm256_max_ps(lhs, rhs);
+}
+
+inline f32v_t sqrt(f32v_t value)
+{
+    return _mm256_sqrt_ps(value);
+}
+
+// bit i is set when lane i of lhs <= rhs
+inline u32_t lessEqualMask(f32v_t lhs, f32v_t rhs)
+{
+    return static_cast<u32_t>(_mm256_movemask_ps(_mm256_cmp_ps(lhs, rhs, _CMP_LE_OQ)));
+}
+
+#elif defined(NB_SIMD_SSE)
+using f32v_t = __m128;
+
+inline constexpr u32_t k_width = 4;
+
+inline f32v_t load(const f32_t* p_src)
+{
+    return _mm_loadu_ps(p_src);
+}
+
+inline void store(f32_t* p_dst, f32v_t value)
+{
+    _mm_storeu_ps(p_dst, value);
+}
+
+inline f32v_t set(f32_t value)
+{
+    return _mm_set1_ps(value);
+}
+
+inline f32v_t add(f32v_t lhs, f32v_t rhs)
+{
+    return _mm_add_ps(lhs, rhs);
+}
+
+inline f32v_t sub(f32v_t lhs, f32v_t rhs)
+{
+    return _mm_sub_ps(lhs, rhs);
+}
+
+inline f32v_t mul(f32v_t lhs, f32v_t rhs)
+{
+    return _mm_mul_ps(lhs, rhs);
+}
+
+inline f32v_t div(f32v_t lhs, f32v_t rhs)
+{
+    return _mm_div_ps(lhs, rhs);
+}
+
+inline f32v_t min(f32v_t lhs, f32v_t rhs)
+{
+    return _mm_min_ps(lhs, rhs);
+}
+
+inline f32v_t max(f32v_t lhs, f32v_t rhs)
+{
+    return _mm_max_ps(lhs, rhs);
+}
+
+inline f32v_t sqrt(f32v_t value)
+{
+    return _mm_sqrt_ps(value);
+}
+
+// bit i is set when lane i of lhs <= rhs
+inline u32_t lessEqualMask(f32v_t lhs, f32v_t rhs)
+{
+    return static_cast<u32_t>(_mm_movemask_ps(_mm_cmple_ps(lhs, rhs)));
+}
+
+#else
+using f32v_t = f32_t;
+
+inline constexpr u32_t k_width = 1;
+
+inline f32v_t load(const f32_t* p_src)
+{
+    return *p_src;
+}
+
+inline void store(f32_t* p_dst, f32v_t value)
+{
+    *p_dst = value;
+}
+
+inline f32v_t set(f32_t value)
+{
+    return value;
+}
+
+inline f32v_t add(f32v_t lhs, f32v_t rhs)
+{
+    return lhs + rhs;
+}
+
+inline f32v_t sub(f32v_t lhs, f32v_t rhs)
+{
+    return lhs - rhs;
+}
+
+inline f32v_t mul(f32v_t lhs, f32v_t rhs)
+{
+    return lhs * rhs;
+}
+
+inline f32v_t div(f32v_t lhs, f32v_t rhs)
+{
+    return lhs / rhs;
+}
+
+inline f32v_t min(f32v_t lhs, f32v_t rhs)
+{
+    return lhs < rhs ? lhs : rhs;
+}
+
+inline f32v_t max(f32v_t lhs, f32v_t rhs)
+{
+    return lhs > rhs ? lhs : rhs;
+}
+
+inline f32v_t sqrt(f32v_t value)
+{
+    return std::sqrt(value);
+}
+
+inline u32_t lessEqualMask(f32v_t lhs, f32v_t rhs)
+{
+    return lhs <= rhs ? 1 : 0;
+}
+#endif
+
+}  // namespace nimbus::simd
@@ -67,6 +67,11 @@ class refCounted
         return --m_refCount;
     }
 
+    inline u32_t getRefCount() const
+    {
+        return m_refCount.load(std::memory_order_relaxed);
+    }
+
    private:
     mutable std::atomic<u32_t> m_refCount = 0;
 };
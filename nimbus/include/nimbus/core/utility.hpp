@@ -44,6 +44,13 @@ NIMBUS_API char* readFileAsBytes(const std::string& filepath, u32_t* outSize);
 
 NIMBUS_API std::filesystem::path getExecutablePath();
 
+// what a malformed UTF-8 sequence decodes to
+inline constexpr u32_t k_replacementCodepoint = 0xFFFD;
+
+// Decodes the UTF-8 codepoint starting at pos and moves pos past it. Malformed, overlong and surrogate sequences
+// decode to k_replacementCodepoint and only skip their first byte, so decoding always makes progress.
+NIMBUS_API u32_t decodeUtf8(std::string_view text, size_t& pos);
+
 
 //////////////////////////////////////////////////////
 // https://stackoverflow.com/questions/281818/unmangling-the-result-of-stdtype-infoname
@@ -143,4 +150,43 @@ class NIMBUS_API Transform
     glm::vec3         scale          = {1.0f, 1.0f, 1.0f};
 };
 
+// Read only view of a whole file. It's mapped rather than read, so opening it costs nothing up front and only the
+// pages that get touched are loaded. Unmapped when closed or destroyed.
+class NIMBUS_API MappedFile
+{
+   public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    MappedFile(const MappedFile&)            = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // false if the file doesn't exist, can't be mapped or is empty
+    bool open(const std::filesystem::path& path);
+
+    void close();
+
+    inline bool isOpen() const
+    {
+        return mp_data != nullptr;
+    }
+
+    inline const u8_t* getData() const
+    {
+        return mp_data;
+    }
+
+    inline u64_t getSize() const
+    {
+        return m_size;
+    }
+
+   private:
+    const u8_t* mp_data = nullptr;
+    u64_t       m_size  = 0;
+};
+
 }  // namespace nimbus::util
@@ -7,6 +7,7 @@
 
 #include "nimbus/core/common.hpp"
 
+#include <atomic>
 #include <cstdint>
 #include <vector>
 
@@ -38,8 +39,14 @@ class GlVertexBuffer : public VertexBuffer
         m_format = format;
     }
 
+    inline bool isCreated() const
+    {
+        return m_created.load(std::memory_order_acquire);
+    }
+
    private:
-    bool m_mapped = false;
+    bool              m_mapped  = false;
+    std::atomic<bool> m_created = false;
 };
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -67,6 +74,9 @@ class GlIndexBuffer : public IndexBuffer
     {
         return m_type;
     }
+
+   private:
+    std::atomic<bool> m_created = false;
 };
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -84,6 +94,13 @@ class GlVertexArray : public VertexArray
 
     virtual void addVertexBuffer(ref<VertexBuffer> p_vertexBuffer) override;
 
+    virtual u32_t addVertexFormat(const BufferFormat& format) override;
+
+    virtual void bindVertexBuffer(u32_t                    binding,
+                                  const ref<VertexBuffer>& p_vertexBuffer,
+                                  u32_t                    stride,
+                                  u32_t                    offset = 0) override;
+
     virtual void setIndexBuffer(ref<IndexBuffer> p_indexBuffer) override;
 
     inline virtual const std::vector<ref<VertexBuffer>>& getVertexBuffers() const override
@@ -100,6 +117,17 @@ class GlVertexArray : public VertexArray
     {
         return m_expectedVboVertexCount;
     }
+
+    inline bool isCreated() const
+    {
+        return m_created.load(std::memory_order_acquire);
+    }
+
+   private:
+    std::atomic<bool> m_created = false;
+
+    // render thread, points the attributes of format at binding
+    void _setupFormat(u32_t binding, const BufferFormat& format);
 };
 
 }  // namespace nimbus
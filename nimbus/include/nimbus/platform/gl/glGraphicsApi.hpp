@@ -2,6 +2,8 @@
 
 #include "nimbus/renderer/graphicsApi.hpp"
 
+#include <atomic>
+
 namespace nimbus
 {
 class GlGraphicsApi : public GraphicsApi
@@ -13,13 +15,15 @@ class GlGraphicsApi : public GraphicsApi
 
     static void clearColor(glm::vec4 color);
 
-    static void drawElements(ref<VertexArray> p_vertexArray, u32_t vertexCount = 0);
+    static void drawElements(const ref<VertexArray>& p_vertexArray, u32_t vertexCount = 0);
 
-    static void drawArrays(ref<VertexArray> p_vertexArray, u32_t vertexCount = 0);
+    static void drawArrays(const ref<VertexArray>& p_vertexArray, u32_t vertexCount = 0);
 
-    static void drawElementsInstanced(ref<VertexArray> p_vertexArray, u32_t instanceCount, u32_t vertexCount = 0);
+    static void drawElementsInstanced(const ref<VertexArray>& p_vertexArray,
+                                      u32_t                   instanceCount,
+                                      u32_t                   vertexCount = 0);
 
-    static void drawArraysInstanced(ref<VertexArray> p_vertexArray, u32_t instanceCount, u32_t vertexCount = 0);
+    static void drawArraysInstanced(const ref<VertexArray>& p_vertexArray, u32_t instanceCount, u32_t vertexCount = 0);
 
     static void setViewportSize(int x, int y, int w, int h);
 
@@ -29,7 +33,34 @@ class GlGraphicsApi : public GraphicsApi
 
     static void setBlendingMode(GraphicsApi::BlendingMode);
 
+    static StateStats getStateStats();
+
+    static void invalidateStateCache();
+
+    static u64_t fenceFrame();
+
+    static u64_t waitForGpuFrames(u64_t frames);
+
+    static void executeCmd(RenderCmdOp op, const void* p_payload);
+
    private:
+    // the GPU is rarely more than a couple of frames behind, fenceFrame waits before it would overwrite a fence
+    inline static const u32_t k_maxFrameFences = 8;
+
+    // GLsync of every fenced frame the GPU hasn't been seen to finish, by frame, render thread only
+    inline static void* sp_frameFences[k_maxFrameFences] = {};
+    inline static u64_t s_fencedFrames                   = 0;
+    inline static u64_t s_gpuFrames                      = 0;  // finished, their fences are deleted
+
+    // counted by the render thread, published once per frame
+    inline static u32_t              s_stateIssued       = 0;
+    inline static u32_t              s_stateSkipped      = 0;
+    inline static std::atomic<u32_t> s_frameStateIssued  = 0;
+    inline static std::atomic<u32_t> s_frameStateSkipped = 0;
+
     static void _enableGlErrPrint();
+
+    // moves s_gpuFrames on towards frames, each fence is waited on for up to timeoutNs
+    static u64_t _retireFences(u64_t frames, u64_t timeoutNs);
 };
 }  // namespace nimbus
\ No newline at end of file
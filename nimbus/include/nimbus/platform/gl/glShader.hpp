@@ -1,6 +1,7 @@
 #pragma once
 
 #include "nimbus/renderer/shader.hpp"
+#include "nimbus/renderer/renderCmd.hpp"
 
 #include <cstdint>
 #include <string>
@@ -92,6 +93,18 @@ class GlShader : public Shader
     /// @param fragmentPath The path to the fragment shader.
     void _compileShader(const std::string& vertexPath, const std::string& fragmentPath);
 
+    /// Records a uniform packet with a copy of the values.
+    /// @param op The uniform op matching the element type.
+    /// @param name The name of the uniform.
+    /// @param p_data The values to copy.
+    /// @param elementSize Size of one element in bytes.
+    /// @param count Number of elements.
+    void _setUniform(RenderCmdOp        op,
+                     const std::string& name,
+                     const void*        p_data,
+                     u32_t              elementSize,
+                     u32_t              count) const;
+
     /// Retrieves the location of a uniform in the shader.
     /// @param name The name of the uniform.
     /// @return The location of the uniform.
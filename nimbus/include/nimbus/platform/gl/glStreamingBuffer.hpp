@@ -0,0 +1,71 @@
+#pragma once
+#include "nimbus/renderer/streamingBuffer.hpp"
+
+#include "nimbus/core/common.hpp"
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+namespace nimbus
+{
+
+class GlStreamingBuffer : public StreamingBuffer
+{
+   public:
+    GlStreamingBuffer(u32_t regionSize);
+
+    virtual ~GlStreamingBuffer();
+
+    virtual Allocation allocate(u32_t size, u32_t alignment = 16) override;
+
+    virtual void bindVertexBuffer(const ref<VertexArray>& p_vertexArray,
+                                  u32_t                   binding,
+                                  u32_t                   stride,
+                                  const Allocation&       allocation) override;
+
+    virtual void bindUniformBuffer(u32_t binding, const Allocation& allocation) override;
+
+    virtual void bindStorageBuffer(u32_t binding, const Allocation& allocation) override;
+
+    virtual void copyToBuffer(const Allocation&        allocation,
+                              u32_t                    offset,
+                              u32_t                    size,
+                              const ref<VertexBuffer>& p_vertexBuffer,
+                              u32_t                    dstOffset) override;
+
+    // Gl buffer holding every region, replaced when the buffer grows. An allocation's p_handle points at the one it
+    // lives in, other gl objects sourcing data from an allocation hold a ref to it until their command has run.
+    struct Storage : public refCounted
+    {
+        u32_t              id       = 0;
+        u32_t              size     = 0;
+        std::atomic<u8_t*> p_mapped = nullptr;  // set once created on the render thread
+    };
+
+   private:
+    // What a frame allocates from, a region of one storage. Replaced rather than changed so allocate can bump offset
+    // without a lock, only a new frame or running out of room take m_regionMtx.
+    struct Region : public refCounted
+    {
+        ref<Storage>       p_storage = nullptr;
+        u64_t              frame     = 0;
+        u32_t              base      = 0;  // of the region in the storage
+        u32_t              size      = 0;
+        std::atomic<u32_t> offset    = 0;  // into the region, runs past size once it's full
+    };
+
+    ref<Storage>         mp_storage = nullptr;
+    std::atomic<Region*> mp_region  = nullptr;
+    std::mutex           m_regionMtx;
+
+    // every region handed out this frame and last, a thread may still be looking at one another has replaced. Keeps
+    // the storages allocations point at alive too.
+    std::vector<ref<Region>> m_regions;
+
+    // m_regionMtx held, makes a region for frame with at least minSize bytes free
+    void _replaceRegion(u64_t frame, u32_t minSize);
+    void _grow(u32_t minRegionSize);
+};
+
+}  // namespace nimbus
@@ -2,6 +2,7 @@
 #include "nimbus/renderer/texture.hpp"
 #include "nimbus/core/common.hpp"
 
+#include <atomic>
 #include <cstdint>
 #include <string>
 
@@ -28,6 +29,8 @@ class GlTexture : public Texture
         return m_id;
     }
 
+    virtual void viewLayer(const ref<TextureArray>& p_array, u32_t layer) override;
+
     virtual u32_t getWidth() const override
     {
         return m_spec.width;
@@ -68,9 +71,25 @@ class GlTexture : public Texture
 
     static u32_t s_wrapType(WrapType wrapType);
 
+    static void s_processLoads();
+
+    static void s_cancelLoads();
+
    private:
+    bool m_decoded = false;  // main thread, its pixels have been handed to an upload
+
+    // layer view made on the render thread, waiting for the main thread to swap m_id over to it
+    std::atomic<u32_t> m_viewId = 0;
+
     void _storage();
 
+    // Render thread, uploads rows of decoded pixels, creating the texture on the first and making it ready after the
+    // last. Like glTextureSubImage2D p_data is an offset into unpackBuffer when it isn't 0.
+    void _upload(u32_t unpackBuffer, const void* p_data, u32_t firstRow, u32_t rows);
+
+    // spec of a texture loaded from an image
+    static void _s_setSpec(Spec& spec, i32_t width, i32_t height, i32_t components);
+
     static void _s_gen(u32_t& id, bool multisample = false);
 };
 
@@ -0,0 +1,40 @@
+#pragma once
+#include "nimbus/renderer/textureArray.hpp"
+
+#include "nimbus/core/common.hpp"
+
+#include <atomic>
+
+namespace nimbus
+{
+
+class GlTextureArray : public TextureArray
+{
+   public:
+    GlTextureArray(u32_t width, u32_t height, Texture::FormatInternal format, u32_t layers, bool mipmapped);
+
+    virtual ~GlTextureArray();
+
+    virtual bool bind(const u32_t glTextureUnit) const override;
+
+    virtual void copyLayer(const ref<Texture>& p_texture, u32_t layer) override;
+
+    virtual void copyLayers(const ref<TextureArray>& p_src) override;
+
+    virtual void setRegion(u32_t layer, u32_t x, u32_t y, u32_t width, u32_t height, const void* p_data) override;
+
+    // render thread, once created
+    inline u32_t getId() const
+    {
+        return m_id;
+    }
+
+   private:
+    // pixel format and bytes per pixel setRegion uploads m_format with
+    void _getUploadFormat(u32_t& format, u32_t& bytesPerPixel) const;
+
+    u32_t             m_id      = 0;
+    std::atomic<bool> m_created = false;  // m_id is set, on the render thread
+};
+
+}  // namespace nimbus
@@ -17,4 +17,7 @@
 #include <unistd.h>
 #include <dlfcn.h>
 #include <limits.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #endif
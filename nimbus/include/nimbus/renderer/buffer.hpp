@@ -226,6 +226,15 @@ class NIMBUS_API VertexArray : public refCounted
 
     virtual void addVertexBuffer(ref<VertexBuffer> p_vertexBuffer) = 0;
 
+    // Adds a binding whose buffer is given at draw time (see StreamingBuffer::bindVertexBuffer), returns its index
+    virtual u32_t addVertexFormat(const BufferFormat& format) = 0;
+
+    // Source a binding added with addVertexFormat from a vertex buffer, offset bytes in, for the draws that follow
+    virtual void bindVertexBuffer(u32_t                    binding,
+                                  const ref<VertexBuffer>& p_vertexBuffer,
+                                  u32_t                    stride,
+                                  u32_t                    offset = 0) = 0;
+
     virtual void setIndexBuffer(ref<IndexBuffer> p_indexBuffer) = 0;
 
     virtual const std::vector<ref<VertexBuffer>>& getVertexBuffers() const = 0;
@@ -234,9 +243,15 @@ class NIMBUS_API VertexArray : public refCounted
 
     virtual u32_t getExpectedVertexCount() = 0;
 
+    inline virtual u32_t getId() const
+    {
+        return m_id;
+    }
+
    protected:
     u32_t                          m_id;
     u32_t                          m_vertexBufferIndex = 0;
+    u32_t                          m_bindingCount      = 0;
     std::vector<ref<VertexBuffer>> m_vertexBuffers;
     ref<IndexBuffer>               m_indexBuffer            = nullptr;
     u32_t                          m_expectedVboVertexCount = 0;
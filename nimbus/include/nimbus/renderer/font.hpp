@@ -1,9 +1,10 @@
 #pragma once
 #include "nimbus/core/common.hpp"
-#include "nimbus/renderer/texture.hpp"
+#include "nimbus/core/jobSystem.hpp"
 
-#include <thread>
 #include <atomic>
+#include <filesystem>
+#include <vector>
 
 namespace nimbus
 {
@@ -21,6 +22,27 @@ class NIMBUS_API Font : public refCounted
         f32_t     leading = 0.0f;
     };
 
+    // A single glyph's MSDF, see renderGlyph
+    struct GlyphBitmap
+    {
+        std::vector<u8_t> pixels;  // rgb8, rows bottom to top, empty for glyphs with nothing to draw
+        u32_t             width  = 0;
+        u32_t             height = 0;
+        glm::vec4         plane  = glm::vec4(0.0f);  // left, bottom, right, top in font units
+        glm::vec4         atlas  = glm::vec4(0.0f);  // left, bottom, right, top in pixels of the bitmap
+    };
+
+    // A glyph renderGlyph made before, as the font's cache keeps it. The pixels stay valid as long as the font.
+    struct GlyphView
+    {
+        const u8_t* p_pixels = nullptr;  // as in GlyphBitmap, nullptr for glyphs with nothing to draw
+        u32_t       width    = 0;
+        u32_t       height   = 0;
+        glm::vec4   plane    = glm::vec4(0.0f);
+        glm::vec4   atlas    = glm::vec4(0.0f);
+        bool        rendered = false;  // what renderGlyph returned
+    };
+
     ~Font();
 
     inline const std::string& getPath() const
@@ -28,9 +50,10 @@ class NIMBUS_API Font : public refCounted
         return m_path;
     }
 
-    inline ref<Texture> getAtlasTex() const
+    // unique for the process' lifetime, unlike the font's address
+    inline u32_t getId() const
     {
-        return m_atlasTex;
+        return m_id;
     }
 
     inline const FontData* getFontData() const
@@ -40,41 +63,57 @@ class NIMBUS_API Font : public refCounted
 
     inline bool isLoaded() const
     {
-        // short circuit atomic check if we know it's been
-        // loaded already
-        if (m_loaded)
-        {
-            return true;
-        }
-        else if (m_isDone.load())
-        {
-            const_cast<Font*>(this)->_initializeTexture();
-            return true;
-        }
-        else
-        {
-            return false;
-        }
+        return m_isDone.load(std::memory_order_acquire);
     }
 
+    // Advance from codepoint to the next one in font units, false if the font doesn't have codepoint. Kerning only
+    // applies between ASCII characters. The font has to be loaded.
+    bool getAdvance(u32_t codepoint, u32_t next, f32_t& advance) const;
+
+    // Generates the MSDF of one glyph at pixelsPerEm, scaled down if needed so it fits in maxSize pixels square.
+    // False if the font doesn't have the glyph or it can't be made to fit. Thread safe, meant for the job system.
+    bool renderGlyph(u32_t codepoint, f32_t pixelsPerEm, f32_t pixelRange, u32_t maxSize, GlyphBitmap& bitmap) const;
+
+    // A glyph renderGlyph made with the same settings, in this run or one before it if the font has a cache. False if
+    // it has to be generated. Glyphs from earlier runs are read straight from the mapped cache file. Thread safe.
+    bool findGlyph(u32_t codepoint, f32_t pixelsPerEm, f32_t pixelRange, u32_t maxSize, GlyphView& glyph) const;
+
    private:
-    std::string  m_path;
-    FontData*    m_data;
-    ref<Texture> m_atlasTex = nullptr;
+    std::string           m_path;
+    std::filesystem::path m_cachePath;  // glyph tables and generated glyphs kept between runs, none if empty
+    u64_t                 m_cacheKey = 0;
+    FontData*             m_data;
+    u32_t                 m_id;
 
     // Atomic variable to indicate if processing is done
-    std::atomic_bool m_isDone = false;
-    std::thread      m_workerThread;
+    std::atomic_bool  m_isDone  = false;
+    JobSystem::Handle m_loadJob = nullptr;
 
-    mutable bool m_loaded = false;
+    inline static std::atomic<u32_t> s_nextId = 0;
 
     // only resouce manager can generate the fonts
-    Font(const std::string& fontPath);
+    Font(const std::string& fontPath, const std::filesystem::path& cachePath);
 
-    static ref<Font> s_create(const std::string& fontPath);
+    static ref<Font> s_create(const std::string& fontPath, const std::filesystem::path& cachePath);
 
     void _loadFont();
-    void _initializeTexture();
+    bool _openFont();
+    void _buildGlyphTables();
+
+    // Key of the font file's contents and the table layout, 0 if the font can't be read
+    u64_t _getCacheKey() const;
+
+    // false if there is no cache or it was made from a different key
+    bool _loadCache(u64_t key);
+    void _writeCache(u64_t key) const;
+
+    // keeps a glyph renderGlyph made for findGlyph and the cache, unless it was made with other settings
+    void _cacheGlyph(u32_t              codepoint,
+                     f32_t              pixelsPerEm,
+                     f32_t              pixelRange,
+                     u32_t              maxSize,
+                     bool               rendered,
+                     const GlyphBitmap& bitmap) const;
 
     friend class ResourceManager;
 };
@@ -6,6 +6,13 @@
 #include "msdf-atlas-gen/msdf-atlas-gen.h"
 #pragma GCC diagnostic pop
 
+#include "nimbus/core/utility.hpp"
+#include "nimbus/renderer/font.hpp"
+
+#include "glm.hpp"
+
+#include <mutex>
+#include <unordered_map>
 #include <vector>
 
 namespace nimbus
@@ -13,19 +20,48 @@ namespace nimbus
 
 struct FontData
 {
-    void* pixels = nullptr;
-    u32_t width;
-    u32_t height;
+    // Kept open for as long as the font lives, glyphs are loaded from it when they're first drawn. FreeType faces
+    // aren't thread safe, anything touching them after loading holds handleMutex.
+    msdfgen::FreetypeHandle* p_freetype   = nullptr;
+    msdfgen::FontHandle*     p_fontHandle = nullptr;
+    std::mutex               handleMutex;
+
+    // what glyph geometry is scaled by to be in font units, em sized
+    f64_t geometryScale = 1.0;
+
+    // metrics text layout needs, in font units
+    f32_t ascenderY  = 0.0f;
+    f32_t descenderY = 0.0f;
+    f32_t lineHeight = 0.0f;
+
+    // Flat copies of what laying out text needs, ASCII ones are built when the font is loaded so layout doesn't go
+    // through FreeType for every character
+    struct Glyph
+    {
+        f32_t advance = 0.0f;
+        bool  present = false;
+    };
+
+    // ASCII, indexed by character
+    inline static const u32_t k_tableSize = 128;
+
+    std::vector<Glyph> glyphTable;
 
-    // Storage for glyph geometry and their coordinates in the atlas
-    std::vector<msdf_atlas::GlyphGeometry> glyphs;
+    // advance from a character to the next one with kerning, at [character * k_tableSize + next]
+    std::vector<f32_t> advanceTable;
 
-    // FontGeometry is a helper class that loads a set of glyphs from a
-    // single font. It can also be used to get additional font metrics,
-    // kerning information, etc.
-    msdf_atlas::FontGeometry fontGeometry;
+    // everything past ASCII, looked up the first time it's laid out. Under handleMutex.
+    std::unordered_map<u32_t, Glyph> extraGlyphs;
 
-    // the pixel range used to generate atlas
-    f32_t pixelRange;
+    // Glyphs renderGlyph made, all at the one setting the cache holds, 0 pixels per em until the first. Those of
+    // earlier runs point into the mapped cache file, the ones made in this run into newGlyphPixels, and are written to
+    // the cache when the font goes away. Under handleMutex.
+    util::MappedFile                           cacheFile;
+    std::unordered_map<u32_t, Font::GlyphView> cachedGlyphs;
+    std::vector<std::vector<u8_t>>             newGlyphPixels;
+    u32_t                                      newGlyphCount    = 0;
+    f32_t                                      glyphPixelsPerEm = 0.0f;
+    f32_t                                      glyphPixelRange  = 0.0f;
+    u32_t                                      glyphMaxSize     = 0;
 };
-}  // namespace nimbus
\ No newline at end of file
+}  // namespace nimbus
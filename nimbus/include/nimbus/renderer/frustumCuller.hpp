@@ -0,0 +1,61 @@
+#pragma once
+#include "nimbus/core/common.hpp"
+
+#include <vector>
+
+namespace nimbus
+{
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Tests world space boxes against the frustum of a view projection matrix. Boxes are added one by one, kept as
+// separate arrays of centers and extents, and tested all at once so the compiler can vectorize the plane tests.
+// The arrays are kept between frames, so once they have grown to the object count culling doesn't allocate.
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+class NIMBUS_API FrustumCuller
+{
+   public:
+    // extracts the frustum planes and clears the boxes from last time
+    void begin(const glm::mat4& viewProjection);
+
+    // box of a quad of local bounds min to max under transform, returns the index to check visibility with
+    u32_t add(const glm::mat4& transform,
+              const glm::vec2& localMin = glm::vec2(-0.5f),
+              const glm::vec2& localMax = glm::vec2(0.5f));
+
+    // box already in world space
+    u32_t addBox(const glm::vec3& min, const glm::vec3& max);
+
+    // test every box added since begin
+    void cull();
+
+    inline bool isVisible(u32_t index) const
+    {
+        return m_visible[index] != 0;
+    }
+
+    inline u32_t getCount() const
+    {
+        return static_cast<u32_t>(m_centerX.size());
+    }
+
+    inline u32_t getVisibleCount() const
+    {
+        return m_visibleCount;
+    }
+
+   private:
+    // xyz is the plane normal, w the distance, points inside the frustum are on the positive side of every plane
+    glm::vec4 m_planes[6];
+
+    std::vector<f32_t> m_centerX;
+    std::vector<f32_t> m_centerY;
+    std::vector<f32_t> m_centerZ;
+    std::vector<f32_t> m_extentX;
+    std::vector<f32_t> m_extentY;
+    std::vector<f32_t> m_extentZ;
+    std::vector<u8_t>  m_visible;
+
+    u32_t m_visibleCount = 0;
+};
+
+}  // namespace nimbus
@@ -0,0 +1,163 @@
+#pragma once
+#include "nimbus/core/common.hpp"
+#include "nimbus/core/jobSystem.hpp"
+#include "nimbus/renderer/font.hpp"
+#include "nimbus/renderer/textureArray.hpp"
+
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace nimbus
+{
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Glyphs of every font, generated the first time they're drawn and kept in fixed size cells of a few pages of one
+// texture array. Generating a glyph is a job, it isn't drawn until its bitmap is in. Glyphs the font has generated
+// before, in this run or in one before it that left them in the font's cache, fill their cell straight away instead.
+// Once every cell is taken the glyph drawn least recently gives its cell up, so text in any script only costs the
+// glyphs that are on screen.
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+class NIMBUS_API GlyphAtlas
+{
+   public:
+    using Handle = u32_t;
+
+    inline static const Handle k_noHandle = 0xFFFFFFFF;
+
+    inline static const u32_t k_pageSize  = 1024;
+    inline static const u32_t k_cellSize  = 64;
+    inline static const u32_t k_pageCount = 4;
+
+    // glyphs are generated at this size, small enough that most fit in a cell with their range around them
+    inline static const f32_t k_pixelsPerEm = 40.0f;
+    inline static const f32_t k_pixelRange  = 2.0f;
+
+    // Frames a glyph has to go undrawn before its cell can be taken. Text drawn before the frame's update counts as
+    // the last frame's, so a glyph drawn last frame is kept as well.
+    inline static const u32_t k_minUnusedFrames = 2;
+
+    struct Glyph
+    {
+        glm::vec4 plane;  // left, bottom, right, top in font units
+        glm::vec4 atlas;  // left, bottom, right, top in texture coordinates of its page
+        u32_t     page;
+    };
+
+    GlyphAtlas();
+    ~GlyphAtlas();
+
+    // Handle of a font's glyph, the same one for the atlas' lifetime whether the glyph is in a cell or not
+    Handle getHandle(const ref<Font>& p_font, u32_t codepoint);
+
+    // The glyph if it's ready to be drawn, marked as drawn this frame. Otherwise nullptr, and generating it is started
+    // if it isn't already. p_font has to be the font of the handle, it's kept alive until the glyph is generated.
+    const Glyph* use(Handle handle, const ref<Font>& p_font);
+
+    // Once per frame, before text is drawn. Uploads the glyphs that were generated since and starts a new frame.
+    void update();
+
+    inline const ref<TextureArray>& getPages() const
+    {
+        return mp_pages;
+    }
+
+    // pixel range in texture coordinates, what the text shader antialiases with
+    inline glm::vec2 getUnitRange() const
+    {
+        return glm::vec2(k_pixelRange / k_pageSize);
+    }
+
+    // glyphs in cells
+    inline u32_t getGlyphCount() const
+    {
+        return k_cellCount - static_cast<u32_t>(m_freeCells.size()) - m_pendingCount;
+    }
+
+    inline u32_t getPendingCount() const
+    {
+        return m_pendingCount;
+    }
+
+    // uploaded by the last update
+    inline u32_t getGeneratedCount() const
+    {
+        return m_generatedCount;
+    }
+
+    // filled from their font's cache since the last update
+    inline u32_t getFromCacheCount() const
+    {
+        return m_fromCacheCount;
+    }
+
+    // cells taken from other glyphs since the last update
+    inline u32_t getEvictedCount() const
+    {
+        return m_evictedCount;
+    }
+
+   private:
+    enum class State : u8_t
+    {
+        none,     // not in a cell
+        pending,  // has a cell, generating
+        ready,
+        blank,  // nothing to draw, or the font can't draw it
+    };
+
+    struct Entry
+    {
+        u32_t fontId;
+        u32_t codepoint;
+        State state         = State::none;
+        u32_t cell          = k_noCell;
+        u64_t lastUsedFrame = 0;
+        Glyph glyph;
+    };
+
+    // a finished job, handed back to update
+    struct Result
+    {
+        Handle            handle;
+        bool              rendered;
+        Font::GlyphBitmap bitmap;
+    };
+
+    inline static const u32_t k_noCell       = 0xFFFFFFFF;
+    inline static const u32_t k_cellsPerRow  = k_pageSize / k_cellSize;
+    inline static const u32_t k_cellsPerPage = k_cellsPerRow * k_cellsPerRow;
+    inline static const u32_t k_cellCount    = k_cellsPerPage * k_pageCount;
+
+    ref<TextureArray> mp_pages = nullptr;
+
+    std::vector<Entry>                m_entries;
+    std::unordered_map<u64_t, Handle> m_handles;  // font id << 32 | codepoint
+
+    std::vector<Handle> m_cellOwners;  // entry in each cell, k_noHandle if it's free
+    std::vector<u32_t>  m_freeCells;
+
+    // cells of glyphs that can be evicted, least recently used last, gathered once per frame when nothing is free
+    std::vector<u32_t> m_evictable;
+    u64_t              m_evictableFrame = 0;
+
+    std::mutex          m_resultsMutex;
+    std::vector<Result> m_results;  // under m_resultsMutex
+
+    std::vector<JobSystem::Handle> m_jobs;
+
+    // a whole cell of pixels, glyphs are uploaded padded to it
+    std::vector<u8_t> m_cellPixels;
+
+    u64_t m_frame          = k_minUnusedFrames;  // so nothing looks like it was drawn recently at first
+    u32_t m_pendingCount   = 0;
+    u32_t m_generatedCount = 0;
+    u32_t m_fromCacheCount = 0;
+    u32_t m_evictedCount   = 0;
+
+    u32_t _allocateCell();
+    void  _freeCell(Entry& entry);
+    void  _upload(Entry& entry, const Font::GlyphView& glyph);
+};
+
+}  // namespace nimbus
@@ -1,9 +1,14 @@
 #pragma once
 
 #include "nimbus/renderer/buffer.hpp"
+#include "nimbus/renderer/renderCmd.hpp"
+
+#include <atomic>
 
 namespace nimbus
 {
+struct PipelineState;
+
 class NIMBUS_API GraphicsApi
 {
    public:
@@ -19,46 +24,84 @@ class NIMBUS_API GraphicsApi
         sourceAlphaAdditive,    // GL_SRC_ALPHA, GL_ONE
     };
 
+    struct StateStats
+    {
+        u32_t issued  = 0;  // state changes that reached the driver
+        u32_t skipped = 0;  // redundant ones dropped by the backend
+    };
+
     static void init();
 
     static void clear();
 
     static void clearColor(glm::vec4 color);
 
-    static void drawElements(ref<VertexArray> p_vertexArray, u32_t vertexCount = 0);
+    static void drawElements(const ref<VertexArray>& p_vertexArray, u32_t vertexCount = 0);
 
-    static void drawArrays(ref<VertexArray> p_vertexArray, u32_t vertexCount = 0);
+    static void drawArrays(const ref<VertexArray>& p_vertexArray, u32_t vertexCount = 0);
 
-    static void drawElementsInstanced(ref<VertexArray> p_vertexArray, u32_t instanceCount, u32_t vertexCount = 0);
+    static void drawElementsInstanced(const ref<VertexArray>& p_vertexArray,
+                                      u32_t                   instanceCount,
+                                      u32_t                   vertexCount = 0);
 
-    static void drawArraysInstanced(ref<VertexArray> p_vertexArray, u32_t instanceCount, u32_t vertexCount = 0);
+    static void drawArraysInstanced(const ref<VertexArray>& p_vertexArray, u32_t instanceCount, u32_t vertexCount = 0);
 
+    // main thread only
     static void setViewportSize(int x, int y, int w, int h);
 
+    // last viewport set, x, y, width, height
+    inline static glm::ivec4 getViewport()
+    {
+        return s_viewport;
+    }
+
     static void setWireframe(bool on);
 
+    // last set, like the blending mode
     inline static bool getWireframe()
     {
-        return s_wireframe;
+        return s_wireframe.load(std::memory_order_relaxed);
     }
 
     static void setDepthTest(bool on);
 
+    // last set, like the blending mode
     inline static bool getDepthTest()
     {
-        return s_depthTest;
+        return s_depthTest.load(std::memory_order_relaxed);
     }
 
     static void setBlendingMode(GraphicsApi::BlendingMode);
 
+    // last mode set, not necessarily what the render thread is on right now
     inline static GraphicsApi::BlendingMode getBlendingMode()
     {
-        return s_currBlendingMode;
+        return s_currBlendingMode.load(std::memory_order_relaxed);
     }
 
+    // Fixed function part of a pipeline, the shader and vertex array are bound by the draw that uses it
+    static void setPipelineState(const PipelineState& state);
+
+    // state changes over the last frame the render thread finished
+    static StateStats getStateStats();
+
+    // render thread only, forget the cached bindings after something may have changed them behind the backend's back
+    static void invalidateStateCache();
+
+    // render thread only, marks the end of a frame, returns how many frames the GPU has finished without waiting
+    static u64_t fenceFrame();
+
+    // render thread only, blocks until the GPU has finished the first frames fenced frames, returns how many it has
+    static u64_t waitForGpuFrames(u64_t frames);
+
+    // render thread only, runs a packet recorded into a RenderCmdQ
+    static void executeCmd(RenderCmdOp op, const void* p_payload);
+
    protected:
-    inline static bool         s_wireframe        = false;
-    inline static bool         s_depthTest        = false;
-    inline static BlendingMode s_currBlendingMode = BlendingMode::alphaBlend;
+    // set from any thread recording a command list, so atomic, but "last set" across threads is whichever won
+    inline static std::atomic<bool>         s_wireframe        = false;
+    inline static std::atomic<bool>         s_depthTest        = false;
+    inline static std::atomic<BlendingMode> s_currBlendingMode = BlendingMode::alphaBlend;
+    inline static glm::ivec4                s_viewport         = glm::ivec4(0);  // main thread only
 };
 }  // namespace nimbus
\ No newline at end of file
@@ -5,8 +5,8 @@
 #include "nimbus/renderer/shader.hpp"
 #include "nimbus/renderer/texture.hpp"
 #include "nimbus/renderer/graphicsApi.hpp"
+#include "nimbus/core/random.hpp"
 
-#include <random>
 #include <vector>
 
 #include "glm.hpp"
@@ -67,6 +67,26 @@ class NIMBUS_API ParticleEmitter : public refCounted
         bool                      persist      = true;
         bool                      shrink       = false;
         GraphicsApi::BlendingMode blendingMode = GraphicsApi::BlendingMode::sourceAlphaAdditive;
+        bool                      analytic     = false;  // evaluated from the time rather than stepped, see seek
+        u32_t                     seed         = 0;      // 0 picks one when the emitter is made
+        f32_t                     prewarm_s    = 0.0f;   // analytic only, the time a reset starts at
+        i32_t                     priority     = 0;      // higher is drawn first when over the particle budget
+    };
+
+    ////////////////////////////////////////////////////////////////////////////
+    // GPU data unique to each particle, written straight into the stream
+    ////////////////////////////////////////////////////////////////////////////
+    inline static const BufferFormat k_instanceVboFormat = {
+        {k_shaderVec3, "position", BufferComponent::Type::perInstance, 1},
+        {k_shaderVec4, "color", BufferComponent::Type::perInstance, 1},
+        {k_shaderVec2, "size", BufferComponent::Type::perInstance, 1},
+
+    };
+    struct particleInstanceData
+    {
+        glm::vec3 position = glm::vec3(0.0f);
+        glm::vec4 color    = glm::vec4(0.0f);
+        glm::vec2 size     = glm::vec2(0.0f);
     };
 
     ParticleEmitter() = default;
@@ -83,11 +103,38 @@ class NIMBUS_API ParticleEmitter : public refCounted
                               const glm::vec3& spawnRotation,
                               const glm::vec3& spawnScale);
 
+    // Large emitters step their particles in chunks on the job system, which
+    // particles die and the order they're compacted in is the same either way.
     void update(f32_t deltaTime);
 
-    void draw();
+    bool isDone() const;
+
+    // the most instances writeInstances can write right now
+    u32_t getInstanceCount() const;
 
-    bool isDone();
+    // Instance data of up to maxCount live particles, returns how many it
+    // wrote. Drawing is up to ParticleSystem, which batches emitters.
+    u32_t writeInstances(particleInstanceData* p_dest, u32_t maxCount);
+
+    inline const ref<Texture>& getTexture() const
+    {
+        return mp_texture;
+    }
+
+    inline const ref<Shader>& getShader() const
+    {
+        return mp_shader;
+    }
+
+    inline GraphicsApi::BlendingMode getBlendMode() const
+    {
+        return m_parameters.blendingMode;
+    }
+
+    inline i32_t getPriority() const
+    {
+        return m_parameters.priority;
+    }
 
     void reset(bool updateLiving = false);
 
@@ -117,91 +164,44 @@ class NIMBUS_API ParticleEmitter : public refCounted
 
     void setBlendMode(GraphicsApi::BlendingMode mode);
 
-   private:
-    ////////////////////////////////////////////////////////////////////////////
-    // CPU data unique to each particle
-    ////////////////////////////////////////////////////////////////////////////
-    struct particleAttributes
-    {
-        glm::vec3 positionOffset = glm::vec3(0.0f);
-        glm::vec3 velocity       = glm::vec3(0.0f);
-        glm::vec3 acceleration   = glm::vec3(0.0f);
-        glm::vec2 startSize      = glm::vec2(0.0f);
-        u32_t     colorIdx       = 0;
-        f32_t     startLifetime  = 0.0f;
-        f32_t     curLifetime    = 0.0f;
-
-        void resetLifetime(f32_t newLifetime)
-        {
-            startLifetime = newLifetime;
-            curLifetime   = startLifetime;
-        }
-
-        bool isDead() const
-        {
-            return curLifetime <= 0;
-        }
-
-        void decreaseLifetime(f32_t deltaTime)
-        {
-            curLifetime -= deltaTime;
-        }
-
-        f32_t getLifePercent()
-        {
-            return curLifetime / startLifetime;
-        }
-    };
-    ////////////////////////////////////////////////////////////////////////////
-    // GPU data unique to each particle
-    ////////////////////////////////////////////////////////////////////////////
-    inline static const BufferFormat k_instanceVboFormat = {
-        {k_shaderVec3, "position", BufferComponent::Type::perInstance, 1},
-        {k_shaderVec4, "color", BufferComponent::Type::perInstance, 1},
-        {k_shaderVec2, "size", BufferComponent::Type::perInstance, 1},
+    void setPriority(i32_t priority);
 
-    };
-    struct particleInstanceData
-    {
-        glm::vec3 position = glm::vec3(0.0f);
-        glm::vec4 color    = glm::vec4(0.0f);
-        glm::vec2 size     = glm::vec2(0.0f);
+    // Analytic particles are a function of their slot, the seed, the time
+    // and the parameters. Updating only advances the time, drawing evaluates
+    // them at it, so they can be prewarmed or seeked to any time at once.
+    // They follow the emitter's current spawn transform.
+    void setAnalytic(bool analytic);
 
-        void reset(const glm::vec3& newPosition, const glm::vec2& newSize, const glm::vec4& newColor)
-        {
-            position = newPosition;
-            size     = newSize;
-            color    = newColor;
-        }
-
-        void updatePosition(const glm::vec3& velocity, f32_t deltaTime)
-        {
-            position += velocity * deltaTime;
-        }
-    };
+    // analytic only, time_s since the emitter started
+    void seek(f32_t time_s);
 
+   private:
     ////////////////////////////////////////////////////////////////////////////
-    // GPU data shared by all particles
+    // CPU data unique to each particle
     ////////////////////////////////////////////////////////////////////////////
-    inline static const BufferFormat k_vertexVboFormat3d = {
-        {k_shaderVec3, "vertexPosition"},
-        {k_shaderVec2, "texCoords"},
-    };
-
-    inline static const BufferFormat k_vertexVboFormat2d = {
-        {k_shaderVec2, "vertexPosition"},
-        {k_shaderVec2, "texCoords"},
-    };
-
-    struct vertexData3d
-    {
-        glm::vec3 vertexPosition;
-        glm::vec2 texCoords;
-    };
-    struct vertexData2d
+    // One stream per component, so the update kernel loads simd::k_width
+    // particles of each at a time. Velocity and acceleration are as spawned,
+    // the current velocity follows from them and the particle's age.
+    struct ParticleStreams
     {
-        glm::vec2 vertexPosition;
-        glm::vec2 texCoords;
+        std::vector<f32_t>     positionX;
+        std::vector<f32_t>     positionY;
+        std::vector<f32_t>     positionZ;
+        std::vector<f32_t>     velocityX;
+        std::vector<f32_t>     velocityY;
+        std::vector<f32_t>     velocityZ;
+        std::vector<f32_t>     accelerationX;
+        std::vector<f32_t>     accelerationY;
+        std::vector<f32_t>     accelerationZ;
+        std::vector<f32_t>     startSizeX;
+        std::vector<f32_t>     startSizeY;
+        std::vector<f32_t>     startLifetime;
+        std::vector<f32_t>     curLifetime;
+        std::vector<u32_t>     colorIdx;
+        std::vector<glm::vec3> positionOffset;  // cold, where in the spawn volume it started
+
+        void resize(u32_t count);
+        void swap(u32_t lhs, u32_t rhs);
     };
 
     ////////////////////////////////////////////////////////////////////////////
@@ -218,33 +218,63 @@ class NIMBUS_API ParticleEmitter : public refCounted
     ////////////////////////////////////////////////////////////////////////////
     // Cluster State
     ////////////////////////////////////////////////////////////////////////////
-    ref<Shader>                       mp_shader      = nullptr;
-    ref<VertexArray>                  mp_vao         = nullptr;
-    ref<Texture>                      mp_texture     = nullptr;
-    ref<VertexBuffer>                 mp_instanceVbo = nullptr;
-    std::vector<particleAttributes>   m_particleAttributes;    // CPU data
-    std::vector<particleInstanceData> m_particleInstanceData;  // GPU data
-
-    // distributions
-    std::mt19937                          m_randGen;
-    std::uniform_real_distribution<f32_t> m_gpRandDist;
-    std::uniform_real_distribution<f32_t> m_lifetimeDist;
-    std::uniform_real_distribution<f32_t> m_speedDist;
-    std::uniform_real_distribution<f32_t> m_accelDistX;
-    std::uniform_real_distribution<f32_t> m_accelDistY;
-    std::uniform_real_distribution<f32_t> m_accelDistZ;
-    std::uniform_real_distribution<f32_t> m_sizeDistX;
-    std::uniform_real_distribution<f32_t> m_sizeDistY;
-    std::uniform_real_distribution<f32_t> m_angleDist;
-    std::uniform_int_distribution<u32_t>  m_colorIndexDist;
+    ref<Shader>            mp_shader  = nullptr;
+    ref<Texture>           mp_texture = nullptr;
+    ParticleStreams        m_particles;      // live ones first
+    std::vector<u32_t>     m_deadParticles;  // found by the last step in order, or about to respawn
+    std::vector<glm::vec4> m_colorTable;     // end and start - end of each color, for the draw
+
+    // stepping in chunks, each finds its own dead which are merged in chunk order
+    inline static const u32_t k_chunkParticles       = 8192;  // a multiple of every simd::k_width
+    inline static const u32_t k_minParallelParticles = 2 * k_chunkParticles;
+
+    std::vector<std::vector<u32_t>> m_chunkDeadParticles;
+
+    // analytic state, the streams cache what each slot spawned with
+    inline static const u32_t k_noGeneration = 0xFFFFFFFF;
+
+    u32_t              m_seed = 0;
+    f64_t              m_time = 0.0;   // since the emitter started
+    std::vector<u32_t> m_generations;  // which spawn of each slot the streams hold
+
+    // randoms, everything but the colors is drawn from the parameters' ranges
+    inline static const u32_t k_spawnRandomCount = 9;  // per respawn
+
+    Random             m_random;
+    std::vector<f32_t> m_spawnRandoms;  // for a batch of respawns
+    u32_t              m_colorMin = 0;
+    u32_t              m_colorMax = 0;
 
     ////////////////////////////////////////////////////////////////////////////
     // Private helper functions
     ////////////////////////////////////////////////////////////////////////////
-    void _respawnParticle(particleAttributes* p_attrib, particleInstanceData* p_instDat);
+    // draws everything the batch needs at once
+    void _respawnParticles(const std::vector<u32_t>& indices);
+
+    // ages and moves [begin, end) of the live particles, those that died are appended to deadParticles in order
+    void _stepParticles(u32_t begin, u32_t end, f32_t deltaTime, std::vector<u32_t>& deadParticles);
+
+    // instance data of the first count live particles
+    void _writeInstances(particleInstanceData* p_dest, u32_t count);
+
+    // analytic, the same for every spawn of the slot so when it respawns follows from the time
+    f32_t _getAnalyticLifetime(u32_t idx) const;
 
-    u32_t _getRandomColorIdx();
+    // analytic, whether the slot has a particle alive at m_time, and if so its lifetime, age and which spawn it is
+    bool _getAnalyticAge(u32_t idx, f32_t& lifetime, f32_t& age, u32_t& generation) const;
+
+    // analytic, fills the streams with what spawn generation of the slot starts with
+    void _spawnAnalytic(u32_t idx, u32_t generation);
+
+    // analytic, instance data of up to maxCount particles alive at m_time, returns how many
+    u32_t _writeAnalyticInstances(particleInstanceData* p_dest, u32_t maxCount);
 
     glm::vec3 _getRandomPositionInVolume();
+
+    // u and v in [-1, 1]
+    glm::vec3 _getPositionInVolume(f32_t u, f32_t v) const;
+
+    // in [0, 1), the same for the same arguments
+    static f32_t _s_hashUnit(u32_t seed, u32_t idx, u32_t generation, u32_t stream);
 };
 }  // namespace nimbus
@@ -0,0 +1,128 @@
+#pragma once
+#include "nimbus/core/common.hpp"
+#include "nimbus/core/jobSystem.hpp"
+#include "nimbus/renderer/particleEmitter.hpp"
+
+#include <vector>
+
+#include "glm.hpp"
+
+namespace nimbus
+{
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Updates and draws a scene's particle emitters together. Emitters only simulate, their instances all go through one
+// quad vertex array into the renderer's streaming buffer, and emitters that share a shader, texture and blending mode
+// are merged into one instanced draw. Materials draw in the order their first emitter was added, and emitters within
+// one in the order they were added, so overlapping translucent emitters always draw the same way round. The budget
+// caps how many particles are drawn in total, emitters with a higher priority get theirs first and ties go to the one
+// added first.
+//
+// Updating runs each emitter as a job and returns, large emitters split theirs further. Drawing waits on each
+// emitter's job as it gets to it, so whatever is drawn before the particles is recorded while they simulate. Touching
+// an emitter in between is only safe after wait.
+//
+// Each material's instances are written and its draw recorded into a command list of its own, the first on the
+// calling thread and the rest as jobs meanwhile. The renderer puts the lists back in material order where draw was
+// called.
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+class NIMBUS_API ParticleSystem
+{
+   public:
+    inline static const u32_t k_defaultBudget = 65536;
+
+    ~ParticleSystem();
+
+    void add(const ref<ParticleEmitter>& p_emitter);
+
+    void remove(const ref<ParticleEmitter>& p_emitter);
+
+    void clear();
+
+    inline u32_t getEmitterCount() const
+    {
+        return static_cast<u32_t>(m_emitters.size());
+    }
+
+    inline u32_t getBudget() const
+    {
+        return m_budget;
+    }
+
+    inline void setBudget(u32_t budget)
+    {
+        m_budget = budget;
+    }
+
+    // instanced draws the last draw took
+    inline u32_t getDrawCount() const
+    {
+        return m_drawCount;
+    }
+
+    // particles the last draw left out for being over budget
+    inline u32_t getDroppedCount() const
+    {
+        return m_droppedCount;
+    }
+
+    // starts simulating every emitter, after waiting on the last update if it wasn't drawn
+    void update(f32_t deltaTime);
+
+    // blocks until the emitters are done simulating
+    void wait();
+
+    void draw();
+
+   private:
+    inline static const BufferFormat k_quadVboFormat = {
+        {k_shaderVec2, "vertexPosition"},
+        {k_shaderVec2, "texCoords"},
+    };
+
+    struct QuadVertex
+    {
+        glm::vec2 vertexPosition;
+        glm::vec2 texCoords;
+    };
+
+    struct DrawItem
+    {
+        ParticleEmitter* p_emitter;
+        u32_t            count;  // instances it has, then instances it's granted
+        u32_t            order;  // of the emitters with something to draw, as they were added
+        u32_t            group;  // order of the first of them with the same material
+    };
+
+    std::vector<ref<ParticleEmitter>> m_emitters;
+    std::vector<JobSystem::Handle>    m_jobs;  // each emitter's update, same order, none once waited on
+    std::vector<DrawItem>             m_drawItems;
+
+    struct DrawGroup
+    {
+        u32_t begin;  // of the items with the same material, m_drawItems[begin, end)
+        u32_t end;
+        bool  drawn;
+    };
+
+    std::vector<DrawGroup>         m_drawGroups;
+    std::vector<JobSystem::Handle> m_drawJobs;
+
+    // made on the first draw that has anything to draw
+    ref<VertexArray> mp_vao            = nullptr;
+    u32_t            m_instanceBinding = 0;
+
+    u32_t m_budget       = k_defaultBudget;
+    u32_t m_drawCount    = 0;
+    u32_t m_droppedCount = 0;
+
+    void _createQuad();
+
+    // records the instanced draw of one group, into whatever command list the thread or job is recording
+    void _drawGroup(DrawGroup& group);
+
+    // whether the two can be drawn together
+    static bool _s_sameMaterial(const ParticleEmitter& lhs, const ParticleEmitter& rhs);
+};
+
+}  // namespace nimbus
@@ -0,0 +1,27 @@
+#pragma once
+#include "nimbus/core/common.hpp"
+#include "nimbus/renderer/buffer.hpp"
+#include "nimbus/renderer/graphicsApi.hpp"
+#include "nimbus/renderer/shader.hpp"
+
+#include <optional>
+
+namespace nimbus
+{
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Everything a draw depends on besides its uniforms and textures. Draws set the whole state they need instead of
+// saving and restoring what was there before, the backend drops whatever turns out not to have changed.
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+struct PipelineState
+{
+    ref<Shader>               p_shader      = nullptr;
+    ref<VertexArray>          p_vertexArray = nullptr;
+    GraphicsApi::BlendingMode blendingMode  = GraphicsApi::BlendingMode::alphaBlend;
+
+    // left unset these keep the global setting (editor toggles and such)
+    std::optional<bool> depthTest;
+    std::optional<bool> wireframe;
+};
+
+}  // namespace nimbus
@@ -0,0 +1,126 @@
+#pragma once
+#include "nimbus/core/common.hpp"
+
+namespace nimbus
+{
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Typed render command packets. A packet is an opcode plus a plain data payload copied straight into the command
+// queue, so recording one doesn't touch reference counts and executing one doesn't run destructors. Payloads carry
+// raw graphics api ids, the objects behind them stay valid because their deletion is retired only once the frame
+// that recorded them has been processed (see Renderer::s_submitRetire).
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+enum class RenderCmdOp : u8_t
+{
+    callback = 0,  // arbitrary function, see Renderer::s_submit
+    useProgram,
+    bindVertexArray,
+    bindBuffer,
+    vertexArrayBuffer,
+    bindBufferRange,
+    copyBuffer,
+    bindTexture,
+    uniformInt,
+    uniformFloat,
+    uniformVec2,
+    uniformVec3,
+    uniformVec4,
+    uniformMat2,
+    uniformMat3,
+    uniformMat4,
+    drawElements,
+    drawArrays,
+    blendFunc,
+    depthTest,
+    polygonMode,
+};
+
+namespace renderCmd
+{
+
+struct UseProgram
+{
+    u32_t id;
+};
+
+struct BindVertexArray
+{
+    u32_t id;
+};
+
+struct BindBuffer
+{
+    u32_t target;
+    u32_t id;
+};
+
+// source a vertex array binding from a buffer range
+struct VertexArrayBuffer
+{
+    u32_t vertexArray;
+    u32_t binding;
+    u32_t buffer;
+    u32_t offset;
+    u32_t stride;
+};
+
+// bind a buffer range to an indexed target (uniform blocks, ...)
+struct BindBufferRange
+{
+    u32_t target;
+    u32_t index;
+    u32_t buffer;
+    u32_t offset;
+    u32_t size;
+};
+
+// copy between buffers on the GPU
+struct CopyBuffer
+{
+    u32_t src;
+    u32_t dst;
+    u32_t srcOffset;
+    u32_t dstOffset;
+    u32_t size;
+};
+
+struct BindTexture
+{
+    u32_t unit;
+    u32_t target;
+    u32_t id;
+};
+
+// followed by count elements of the type implied by the op
+struct Uniform
+{
+    i32_t location;
+    u32_t count;
+};
+
+struct Draw
+{
+    u32_t count;
+    u32_t indexType;      // drawElements only
+    u32_t instanceCount;  // 0 for a non instanced draw
+};
+
+struct BlendFunc
+{
+    u32_t srcFactor;
+    u32_t dstFactor;
+};
+
+struct DepthTest
+{
+    u32_t enabled;
+};
+
+struct PolygonMode
+{
+    u32_t mode;
+};
+
+}  // namespace renderCmd
+
+}  // namespace nimbus
@@ -1,35 +1,101 @@
 #pragma once
 #include "nimbus/core/common.hpp"
+#include "nimbus/renderer/renderCmd.hpp"
 
+#include <atomic>
+#include <cstring>
 #include <mutex>
+#include <type_traits>
 
 namespace nimbus
 {
 
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Command queue made of fixed size blocks linked together as it fills. Blocks come from and return to a pool shared
+// by every queue, so once the pool has warmed up to the high water mark recording a frame doesn't allocate.
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 class RenderCmdQ
 {
-    const u32_t k_cmdBufSize = (2 << 16);
-
    public:
+    inline static const u32_t k_blockSize = (1 << 16);
+
+    // every command and payload is aligned to this
+    inline static const u32_t k_cmdAlign = 8;
+
     typedef void (*renderCmdFn)(void*);
 
     RenderCmdQ();
     ~RenderCmdQ();
 
+    // callback command, returns where size bytes of fn's data go
     void* slot(renderCmdFn fn, u32_t size);
 
-    inline u32_t getCmdCount()
+    // packet command, returns where size bytes of payload go
+    void* packet(RenderCmdOp op, u32_t size);
+
+    template <typename T>
+    inline void packet(RenderCmdOp op, const T& payload)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "Packet payloads must be trivially copyable!");
+        memcpy(packet(op, sizeof(T)), &payload, sizeof(T));
+    }
+
+    inline u32_t getCmdCount() const
     {
         return m_cmdCount;
     }
 
+    inline u32_t getUsedBytes() const
+    {
+        return m_usedBytes;
+    }
+
+    inline u32_t getHighWaterBytes() const
+    {
+        return m_highWaterBytes;
+    }
+
     void pump();
 
+    // bytes held by the block pool, in use or not
+    static u32_t s_getPoolBytes();
+
    private:
-    u8_t* mp_cmdBuf;
-    u8_t* mp_cmdBufPtr;
-    u32_t m_cmdCount     = 0;
-    u32_t m_cmdBufUsedSz = 0;
+    struct alignas(k_cmdAlign) Block
+    {
+        Block* p_next;
+        u32_t  capacity;
+        u32_t  used;
+        u32_t  cmdCount;
+
+        inline u8_t* data()
+        {
+            return reinterpret_cast<u8_t*>(this + 1);
+        }
+    };
+
+    struct CmdHeader
+    {
+        RenderCmdOp op;
+        u32_t       size;  // aligned payload size
+    };
+
+    Block* mp_head = nullptr;
+    Block* mp_tail = nullptr;
+
+    u32_t m_cmdCount       = 0;
+    u32_t m_usedBytes      = 0;
+    u32_t m_highWaterBytes = 0;
+
+    void _grow(u32_t minSize);
+    void _recycle();
+
+    inline static std::mutex         s_poolMtx;
+    inline static Block*             sp_freeBlocks = nullptr;
+    inline static std::atomic<u32_t> s_poolBytes   = 0;
+
+    static Block* _s_acquireBlock(u32_t minSize);
+    static void   _s_releaseBlock(Block* p_block);
 };
 
-}  // namespace nimbus
\ No newline at end of file
+}  // namespace nimbus
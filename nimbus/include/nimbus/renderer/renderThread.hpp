@@ -1,45 +1,104 @@
 #pragma once
 #include "nimbus/core/common.hpp"
 
+#include <atomic>
 #include <thread>
-#include <mutex>
-#include <condition_variable>
 
 namespace nimbus
 {
 
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Hands frames from the main thread to the render thread. Both sides only ever wait on a counter owned by the other
+// (std::atomic wait/notify, a futex on linux), so there are no locks on the handoff. The render thread, the only one
+// with the context, also waits on the GPU for the other threads when they need it caught up.
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 class RenderThread
 {
    public:
-    enum class State
-    {
-        pend = 0,
-        busy,
-        ready,
-        dead
-    };
-
     RenderThread();
     ~RenderThread();
 
     void run(void (*fn)());
-    void waitForState(State state);
-    void setState(State state);
     void stop();
 
-    bool isActive() const
+    ///////////////////////////
+    // Main thread
+    ///////////////////////////
+    // hand the recorded frame to the render thread
+    void submitFrame();
+
+    // block until fewer than framesInFlight submitted frames are still to be processed
+    void waitForFramesInFlight(u32_t framesInFlight);
+
+    // block until every submitted frame has been processed
+    void waitForIdle();
+
+    // Block until the GPU has finished the first frames submitted frames, callable from any thread but the render
+    // thread. Returns straight away when it already has.
+    void waitForGpu(u64_t frames);
+
+    ///////////////////////////
+    // Render thread
+    ///////////////////////////
+    // block until there's a frame to process or someone waiting on the GPU, false once stopped
+    bool waitForWork();
+
+    void completeFrame();
+
+    // publish how many frames the GPU has finished, waking anyone in waitForGpu
+    void completeGpuFrames(u64_t frames);
+
+    // frames waitForGpu callers are blocked on, nothing to do unless it's more than getGpuCompletedFrames
+    inline u64_t getGpuFramesWanted() const
+    {
+        return m_gpuWanted.load(std::memory_order_acquire);
+    }
+
+    inline bool hasFrame() const
+    {
+        return m_submitted.load(std::memory_order_acquire) != m_completed.load(std::memory_order_relaxed);
+    }
+
+    inline bool isActive() const
     {
-        return m_active;
+        return m_active.load(std::memory_order_acquire);
+    }
+
+    inline std::thread::id getId() const
+    {
+        return m_thread.get_id();
+    }
+
+    inline u64_t getSubmittedFrames() const
+    {
+        return m_submitted.load(std::memory_order_acquire);
+    }
+
+    inline u64_t getCompletedFrames() const
+    {
+        return m_completed.load(std::memory_order_acquire);
+    }
+
+    inline u64_t getGpuCompletedFrames() const
+    {
+        return m_gpuCompleted.load(std::memory_order_acquire);
     }
 
    private:
     std::thread m_thread;
 
-    State m_state;
-    bool  m_active;
+    std::atomic<bool> m_active = false;
+
+    // written by the main and render thread respectively
+    std::atomic<u64_t> m_submitted = 0;
+    std::atomic<u64_t> m_completed = 0;
+
+    // furthest frame any waitForGpu caller is on, and how far the GPU is known to be, written by the render thread
+    std::atomic<u64_t> m_gpuWanted    = 0;
+    std::atomic<u64_t> m_gpuCompleted = 0;
 
-    std::mutex              m_pendMtx;
-    std::condition_variable m_pendCond;
+    // bumped for anything the render thread has to wake up for, it can only wait on one counter
+    std::atomic<u32_t> m_wake = 0;
 };
 
-}  // namespace nimbus
\ No newline at end of file
+}  // namespace nimbus
@@ -2,9 +2,12 @@
 
 #include "nimbus/core/common.hpp"
 #include "nimbus/renderer/buffer.hpp"
+#include "nimbus/renderer/pipelineState.hpp"
 #include "nimbus/renderer/shader.hpp"
+#include "nimbus/renderer/renderCmd.hpp"
 #include "nimbus/renderer/renderCmdQ.hpp"
 #include "nimbus/renderer/renderThread.hpp"
+#include "nimbus/renderer/streamingBuffer.hpp"
 #include "nimbus/renderer/texture.hpp"
 
 #include "glm.hpp"
@@ -26,6 +29,32 @@ class Renderer : public refCounted
    public:
     inline static const i32_t k_detectCountIfPossible = -1;
 
+    // uniform block binding of the per frame data, see FrameUniforms
+    inline static const u32_t k_frameUniformBinding = 0;
+
+    // std140 layout of the FrameData uniform block shaders declare at k_frameUniformBinding
+    struct FrameUniforms
+    {
+        glm::mat4 view           = glm::mat4(1.0f);
+        glm::mat4 projection     = glm::mat4(1.0f);
+        glm::mat4 viewProjection = glm::mat4(1.0f);
+        glm::vec4 viewport       = glm::vec4(0.0f);  // x, y, width, height
+        f32_t     time           = 0.0f;             // game time in seconds
+        f32_t     pad[3]         = {};
+    };
+
+    // how many submitted frames the render thread can be behind the main thread
+    inline static const u32_t k_maxFramesInFlight = 3;
+
+    struct CmdQStats
+    {
+        u32_t renderBytes    = 0;  // recorded by the last submitted frame
+        u32_t objectBytes    = 0;  // recorded by the last submitted frame
+        u32_t highWaterBytes = 0;  // largest any single queue has been
+        u32_t poolBytes      = 0;  // held by the block pool
+        u32_t cmdLists       = 0;  // recorded by the last submitted frame
+    };
+
     static void s_init();
     static void s_destroy();
 
@@ -39,35 +68,65 @@ class Renderer : public refCounted
     template <typename T>
     inline static void s_submit(T&& func)
     {
-        auto renderCmd = [](void* ptr)
-        {
-            auto pFunc = (T*)ptr;
-            (*pFunc)();
+        _s_submitCallback(_s_getSubmitRenderCmdQ(), std::forward<T>(func));
+    }
 
-            // destruct any captured variables
-            pFunc->~T();
-        };
+    template <typename T>
+    inline static void s_submitObject(T&& func)
+    {
+        _s_submitCallback(_s_getSubmitObjectCmdQ(), std::forward<T>(func));
+    }
 
-        auto slot = _s_getSubmitRenderCmdQ()->slot(renderCmd, sizeof(func));
-        new (slot) T(std::forward<T>(func));
+    // Runs after every render command recorded in the current frame has been processed. Graphics api objects
+    // delete themselves through this so packets holding their raw ids stay valid until the frame is done. Callable
+    // from any thread, the last ref to an object may well be dropped on a job worker. The main and render threads
+    // and threads recording a command list have queues of their own, everything else shares one behind a mutex that
+    // the frame being recorded picks up at swap.
+    template <typename T>
+    inline static void s_submitRetire(T&& func)
+    {
+        std::unique_lock<std::mutex> lock;
+        _s_submitCallback(_s_getSubmitRetireCmdQ(lock), std::forward<T>(func));
     }
 
     template <typename T>
-    inline static void s_submitObject(T&& func)
+    inline static void s_submitPacket(RenderCmdOp op, const T& payload)
     {
-        auto objectCmd = [](void* ptr)
-        {
-            auto pFunc = (T*)ptr;
-            (*pFunc)();
+        _s_getSubmitRenderCmdQ()->packet(op, payload);
+    }
 
-            // destruct any captured variables
-            pFunc->~T();
-        };
-        auto slot = _s_getSubmitObjectCmdQ()->slot(objectCmd, sizeof(func));
-        new (slot) T(std::forward<T>(func));
+    // variable sized packet, returns where size bytes of payload go
+    inline static void* s_submitPacket(RenderCmdOp op, u32_t size)
+    {
+        return _s_getSubmitRenderCmdQ()->packet(op, size);
     }
 
-    // TODO consider this
+    // Record this thread's commands (s_submit, s_submitObject, s_submitRetire and everything built on them) into a
+    // command list rather than the frame's queue, so jobs can record in parallel. Inside a job the list belongs to the
+    // job, not the thread, jobs a waiting worker runs meanwhile record into their own lists, and jobs split off by
+    // s_parallelFor need lists of their own. Lists are put in (pass, order) order at s_swapAndStart, give each list of
+    // a pass a unique order for the result to be deterministic. Every list has to be ended before the frame is
+    // swapped.
+    //
+    // While recording a list other threads may call the s_submit functions, s_render and s_renderInstanced,
+    // StreamingBuffer::allocate and its binds, GraphicsApi draws and its blending, depth test and wireframe setters,
+    // and binding shaders, textures and vertex arrays and setting uniforms on them. s_setScene, s_startFrame, s_endFrame, the
+    // swap, GraphicsApi::setViewportSize and Renderer2D stay on the main thread, they share state across the frame.
+    static void s_beginCmdList(u32_t pass, u32_t order);
+    static void s_endCmdList();
+
+    // Marks where the command lists of pass run relative to the rest of the frame. Lists of a pass that is never
+    // marked run after everything else in the frame.
+    static void s_submitCmdLists(u32_t pass);
+
+    // A pass no other list of the frame being recorded has, for callers that record lists more than once a frame
+    static u32_t s_newCmdListPass();
+
+    // Writes the frame uniforms once for the draws that follow, rather than every draw uploading its camera. Main
+    // thread only, lists recorded elsewhere see whatever scene was set last when they run.
+    static void s_setScene(const glm::mat4& view, const glm::mat4& projection);
+
+    // as above for callers that only have the combined matrix
     static void s_setScene(const glm::mat4& vpMatrix);
 
     static void s_startFrame();
@@ -76,26 +135,57 @@ class Renderer : public refCounted
 
     static void s_swapAndStart();
 
+    // blocks until the render thread is within frames in flight of the main thread
     static void s_waitForRenderThread();
 
+    // 1 is the lowest latency, more let the main thread run ahead of the render thread for throughput. Takes effect
+    // at the next swap.
+    static void  s_setFramesInFlight(u32_t framesInFlight);
+    static u32_t s_getFramesInFlight();
+
+    // Blocks until the GPU has finished the first frames swapped frames, for reusing memory they read. Callable from
+    // any thread but the render thread, only waits when the GPU is actually that far behind.
+    static void s_waitForGpu(u64_t frames);
+
     static void s_pumpCmds();
 
+    static CmdQStats s_getCmdQStats();
+
     static ref<Texture> getWhiteTexture();
 
     static ref<Texture> getBlackTexture();
 
-    static void s_render(ref<Shader>      p_shader,
-                         ref<VertexArray> p_vertexArray,
-                         i32_t            vertexCount       = k_detectCountIfPossible,
-                         bool             setViewProjection = true);
+    // shared by everything that streams per frame data
+    static ref<StreamingBuffer> s_getStreamingBuffer();
+
+    // Every draw sets the whole pipeline state it depends on, a default PipelineState is alpha blended with the depth
+    // test and wireframe left as they are
+    static void s_render(const PipelineState& state, i32_t vertexCount = k_detectCountIfPossible);
 
-    static void s_renderInstanced(const ref<Shader>&      p_shader,
-                                  const ref<VertexArray>& p_vertexArray,
-                                  i32_t                   instanceCount,
-                                  i32_t                   vertexCount       = k_detectCountIfPossible,
-                                  bool                    setViewProjection = true);
+    static void s_renderInstanced(const PipelineState& state,
+                                  i32_t                instanceCount,
+                                  i32_t                vertexCount = k_detectCountIfPossible);
 
    private:
+    template <typename T>
+    inline static void _s_submitCallback(RenderCmdQ* p_cmdQ, T&& func)
+    {
+        using fn_t = std::remove_reference_t<T>;
+        static_assert(alignof(fn_t) <= RenderCmdQ::k_cmdAlign, "Captures are over aligned for RenderCmdQ");
+
+        auto renderCmd = [](void* ptr)
+        {
+            auto pFunc = (fn_t*)ptr;
+            (*pFunc)();
+
+            // destruct any captured variables
+            pFunc->~fn_t();
+        };
+
+        auto slot = p_cmdQ->slot(renderCmd, sizeof(func));
+        new (slot) fn_t(std::forward<T>(func));
+    }
+
     static RenderCmdQ* _s_getSubmitRenderCmdQ();
 
     static RenderCmdQ* _s_getProcessRenderCmdQ();
@@ -104,27 +194,36 @@ class Renderer : public refCounted
 
     static RenderCmdQ* _s_getProcessObjectCmdQ();
 
+    // locks lock when the queue is shared with other threads
+    static RenderCmdQ* _s_getSubmitRetireCmdQ(std::unique_lock<std::mutex>& lock);
+
+    static RenderCmdQ* _s_getProcessRetireCmdQ();
+
     static void _s_qSwap();
 
+    static void _s_applyFramesInFlight();
+
     static void _s_renderThreadFn();
 
     static void _s_processObjectQueue();
 
+    static void _s_pumpCmdLists(u32_t pass);
+
+    static void _s_recycleCmdLists(u32_t frameIdx);
+
     ///////////////////////////
     // TODO port these
     ///////////////////////////
     static void _s_submit(const ref<Shader>&      p_shader,
                           const ref<VertexArray>& p_vertexArray,
                           const glm::mat4&        model,
-                          i32_t                   vertexCount       = k_detectCountIfPossible,
-                          bool                    setViewProjection = true);
+                          i32_t                   vertexCount = k_detectCountIfPossible);
 
     static void _s_submitInstanced(const ref<Shader>&      p_shader,
                                    const ref<VertexArray>& p_vertexArray,
                                    i32_t                   instanceCount,
                                    const glm::mat4&        model,
-                                   i32_t                   vertexCount       = k_detectCountIfPossible,
-                                   bool                    setViewProjection = true);
+                                   i32_t                   vertexCount = k_detectCountIfPossible);
 
     friend class RenderThread;
 };
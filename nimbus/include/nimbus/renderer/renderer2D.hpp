@@ -6,11 +6,18 @@
 #include "nimbus/renderer/font.hpp"
 #include "nimbus/renderer/shader.hpp"
 #include "nimbus/renderer/graphicsApi.hpp"
+#include "nimbus/renderer/glyphAtlas.hpp"
+#include "nimbus/renderer/textLayoutCache.hpp"
+#include "nimbus/renderer/textureArray.hpp"
 
 #include "glm.hpp"
 
+#include <unordered_map>
+
 namespace nimbus
 {
+class StaticQuadBatch;
+
 class NIMBUS_API Renderer2D : public refCounted
 {
    public:
@@ -25,16 +32,51 @@ class NIMBUS_API Renderer2D : public refCounted
 
         u32_t quadVertsAvail = 0;
         u32_t textVertsAvail = 0;
+
+        u32_t cmdQueueBytes          = 0;
+        u32_t cmdQueueHighWaterBytes = 0;
+        u32_t cmdQueuePoolBytes      = 0;
+        u32_t cmdLists               = 0;
+        u32_t streamedBytes          = 0;
+        u32_t texturePages           = 0;
+        u32_t packedTextures         = 0;
+        u32_t stateChangesIssued     = 0;
+        u32_t stateChangesSkipped    = 0;
+        u32_t submittedQuads         = 0;
+        u32_t culledQuads            = 0;
+        u32_t submittedTexts         = 0;
+        u32_t culledTexts            = 0;
+        u32_t compactQuads           = 0;
+        u32_t staticQuads            = 0;
+        u32_t staticQuadsUploaded    = 0;
+        u32_t opaqueDraws            = 0;
+        u32_t translucentDraws       = 0;
+        u32_t batchBreaksPipeline    = 0;
+        u32_t batchBreaksTextures    = 0;
+        u32_t batchBreaksCapacity    = 0;
+        u32_t textLayouts            = 0;
+        u32_t textLayoutsBuilt       = 0;
+        u32_t glyphsCached           = 0;
+        u32_t glyphsPending          = 0;
+        u32_t glyphsGenerated        = 0;
+        u32_t glyphsFromCache        = 0;
+        u32_t glyphsEvicted          = 0;
     };
 
     static void s_init();
 
     static void s_destroy();
 
+    static void s_begin(const glm::mat4& view, const glm::mat4& projection);
+
     static void s_begin(const glm::mat4& vpMatrix);
 
     static void s_end();
 
+    // Quads and text submitted after this go into the given layer, higher layers draw on top of lower ones whatever
+    // their depth. Goes back to 0 on every s_begin.
+    static void s_setLayer(u8_t layer);
+
     static void s_drawQuad(const glm::mat4&    transform,
                            const ref<Texture>& p_texture,
                            const glm::vec4&    color,
@@ -43,6 +85,16 @@ class NIMBUS_API Renderer2D : public refCounted
 
     static void s_drawQuad(const glm::mat4& transform, const glm::vec4& color, u32_t entityId = 0);
 
+    // Brings a batch's buffer and runs up to date, once a frame before drawing any of it
+    static void s_uploadStaticBatch(const ref<StaticQuadBatch>& p_batch);
+
+    // Draws count slots of a batch from first with one call. It sorts in with everything else like a translucent quad
+    // at depth, so it's meant for a run of the batch (see StaticQuadBatch::getRuns) or a part of one.
+    static void s_drawStaticBatch(const ref<StaticQuadBatch>& p_batch, u32_t first, u32_t count, f32_t depth);
+
+    // uploads the batch and draws each of its runs
+    static void s_drawStaticBatch(const ref<StaticQuadBatch>& p_batch);
+
     static void s_drawText(const std::string&  text,
                            const Font::Format& fontFormat,
                            const glm::vec3&    position,
@@ -54,14 +106,23 @@ class NIMBUS_API Renderer2D : public refCounted
                            const glm::mat4&    transform,
                            u32_t               entityId = 0);
 
+    // Local space box s_drawText fills with text, before its transform. It's from the same cached layout, with a
+    // margin for glyphs overhanging their advance. Returns false if the font can't be drawn with yet.
+    static bool s_getTextBounds(const std::string&  text,
+                                const Font::Format& fontFormat,
+                                glm::vec2&          min,
+                                glm::vec2&          max);
+
+    // objects the scene considered drawing, and how many of those it culled before submitting
+    static void s_addCullStats(u32_t quads, u32_t culledQuads, u32_t texts, u32_t culledTexts);
+
     static void s_resetStats();
 
-    static Stats s_getStats()
-    {
-        return s_stats;
-    }
+    static Stats s_getStats();
 
    private:
+    friend class StaticQuadBatch;
+
     ///////////////////////////
     // Generic Data
     ///////////////////////////
@@ -70,8 +131,8 @@ class NIMBUS_API Renderer2D : public refCounted
     ///////////////////////////
     //  Quad layout and data
     ///////////////////////////
+    // batch sizes, the batch grows geometrically up to the max before it's flushed
     inline static const u32_t k_quadInitCount = 25000;
-    inline static const u32_t k_quadGrowCount = 5000;
     inline static const u32_t k_quadMaxCount  = 100000;
 
     inline static const BufferFormat k_quadVertexFormat = {
@@ -91,27 +152,95 @@ class NIMBUS_API Renderer2D : public refCounted
         {k_shaderInt, "texIndex", BufferComponent::Type::perInstance, 1},
         {k_shaderFloat, "texTilingFactor", BufferComponent::Type::perInstance, 1},
         {k_shaderUInt, "entityId", BufferComponent::Type::perInstance, 1},
+        {k_shaderInt, "texLayer", BufferComponent::Type::perInstance, 1},
     };
 
     struct QuadInstVertex
     {
         glm::mat4 transform;
         glm::vec4 color;
-        i32_t     texIndex;
+        i32_t     texIndex;  // into u_textures, or u_pages when texLayer isn't k_noLayer
         f32_t     texTilingFactor;
         u32_t     entityId;
+        i32_t     texLayer;
+    };
+
+    inline static const i32_t k_noLayer = -1;
+
+    // Quads whose transform is a flat translate, rotate, scale go through this instead, quadCompact.v.glsl rebuilds
+    // the matrix. A batch is either all compact or all full, switching flushes it.
+    inline static const BufferFormat k_quadCompactInstVertexFormat = {
+        {k_shaderVec2, "translation", BufferComponent::Type::perInstance, 1},
+        {k_shaderUInt, "depthRotation", BufferComponent::Type::perInstance, 1},
+        {k_shaderUInt, "scale", BufferComponent::Type::perInstance, 1},
+        {k_shaderUInt, "color", BufferComponent::Type::perInstance, 1},
+        {k_shaderUInt, "texture", BufferComponent::Type::perInstance, 1},
+        {k_shaderUInt, "entityId", BufferComponent::Type::perInstance, 1},
+    };
+
+    struct QuadCompactInstVertex
+    {
+        glm::vec2 translation;
+        u32_t     depthRotation;  // half z | rotation as a 16 bit fraction of a turn
+        u32_t     scale;          // half x | half y
+        u32_t     color;          // rgba8
+        u32_t     texture;        // 4 bit texIndex | 12 bit texLayer + 1 | half texTilingFactor
+        u32_t     entityId;
+    };
+
+    // Sampler units of a batch, these match u_textures and u_pages in quad.f.glsl. Standalone textures take the
+    // first k_quadTextureSlots units, pages the ones after.
+    inline static const u32_t k_quadTextureSlots = 8;
+    inline static const u32_t k_quadPageSlots    = 8;
+
+    // Loaded sprite textures get copied into pages, arrays of textures sharing a size and format, so a batch binds a
+    // page rather than each texture. Packed textures then sample their layer rather than keeping their own copy.
+    // Pages start with one layer and double as they fill, up to what fits the budget. Bigger textures stay
+    // standalone.
+    inline static const u32_t k_pageMaxTextureSize = 1024;
+    inline static const u32_t k_pageMaxLayers      = 64;
+    inline static const u32_t k_pageBudgetBytes    = (32 << 20);
+
+    inline static const u32_t k_noSlot = 0xFFFFFFFF;
+
+    struct TexturePage
+    {
+        ref<TextureArray>  p_array = nullptr;
+        std::vector<u32_t> freeLayers;
+        u32_t              batchSlot = k_noSlot;  // unit offset in the current batch, if bound
+    };
+
+    struct PackedTexture
+    {
+        ref<Texture> p_texture = nullptr;  // evicted once this is the last reference
+        u32_t        page      = 0;
+        u32_t        layer     = 0;
     };
 
     struct QuadData
     {
         std::vector<QuadVertex>     vertices;
         std::vector<QuadInstVertex> instVertices;
-        ref<VertexBuffer>           p_vbo     = nullptr;
-        ref<VertexArray>            p_vao     = nullptr;
-        ref<Shader>                 p_shader  = nullptr;
-        u32_t                       quadCount = 0;
-        std::vector<ref<Texture>>   textures;
-        bool                        needsResize = false;
+        ref<VertexArray>            p_vao       = nullptr;
+        u32_t                       instBinding = 0;  // streamed
+        ref<Shader>                 p_shader    = nullptr;
+        u32_t                       quadCount   = 0;
+
+        std::vector<QuadCompactInstVertex> compactInstVertices;
+        ref<VertexArray>                   p_compactVao       = nullptr;
+        u32_t                              compactInstBinding = 0;  // streamed
+        ref<Shader>                        p_compactShader    = nullptr;
+        bool                               compactBatch       = false;
+
+        // standalone textures of the current batch, slot 0 is the white texture
+        std::vector<ref<Texture>>                 textures;
+        std::unordered_map<const Texture*, i32_t> textureSlots;
+
+        // pages of the current batch, in slot order
+        std::vector<u32_t> batchPages;
+
+        std::vector<TexturePage>                          pages;
+        std::unordered_map<const Texture*, PackedTexture> packedTextures;
     };
 
     static QuadData* s_quadData;
@@ -119,52 +248,147 @@ class NIMBUS_API Renderer2D : public refCounted
     ///////////////////////////
     //  Text layout and data
     ///////////////////////////
-    inline static const u32_t k_textVerticesInitCount = 500;
-    inline static const u32_t k_textVerticesGrowCount = 500;
-    inline static const u32_t k_textVerticesMaxCount  = 10000;
+    // batch sizes in glyphs, grows like the quad batch
+    inline static const u32_t k_glyphInitCount = 125;
+    inline static const u32_t k_glyphMaxCount  = 10000;
 
-    inline static const BufferFormat k_TextVertexFormat = {
-        {k_shaderVec4, "position"},
-        {k_shaderVec2, "texCoords"},
-        {k_shaderVec4, "fgColor"},
-        {k_shaderVec4, "bgColor"},
-        {k_shaderVec2, "unitRange"},
-        {k_shaderInt, "texIndex"},
-        {k_shaderUInt, "entityId"},
+    // Glyphs are instances of the shared quad stretched over their rect, what's the same for all glyphs of a
+    // s_drawText goes into a style instead. Styles of a batch are a storage buffer, see text.v.glsl. Every font
+    // samples the glyph atlas' pages, so text only breaks a batch when it runs out of room.
+    inline static const BufferFormat k_glyphInstVertexFormat = {
+        {k_shaderVec4, "plane", BufferComponent::Type::perInstance, 1},
+        {k_shaderVec4, "atlas", BufferComponent::Type::perInstance, 1},
+        {k_shaderUInt, "style", BufferComponent::Type::perInstance, 1},
+        {k_shaderUInt, "page", BufferComponent::Type::perInstance, 1},
     };
 
-    struct TextVertex
+    struct GlyphInstVertex
     {
-        glm::vec4 position;
-        glm::vec2 texCoord;
+        glm::vec4 plane;  // left, bottom, right, top in the text's local space
+        glm::vec4 atlas;  // left, bottom, right, top in texture coordinates
+        u32_t     style;  // into the batch's styles
+        u32_t     page;   // of the glyph atlas
+    };
+
+    // std430 layout of TextStyle in text.v.glsl
+    struct TextStyle
+    {
+        glm::mat4 transform;
         glm::vec4 fgColor;
         glm::vec4 bgColor;
         glm::vec2 unitRange;
-        i32_t     texIndex;
         u32_t     entityId;
+        u32_t     padding;
     };
 
+    inline static const u32_t k_textStyleBinding = 1;
+
     struct TextData
     {
-        std::vector<TextVertex>   vertices;
-        u32_t                     vertexIdx = 0;
-        ref<VertexBuffer>         p_vbo     = nullptr;
-        ref<VertexArray>          p_vao     = nullptr;
-        ref<Shader>               p_shader  = nullptr;
-        u32_t                     charCount = 0;
-        std::vector<ref<Texture>> atlases;
-        bool                      needsResize = false;
+        std::vector<GlyphInstVertex> instVertices;
+        std::vector<TextStyle>       styles;
+        ref<VertexArray>             p_vao       = nullptr;
+        u32_t                        instBinding = 0;  // streamed
+        ref<Shader>                  p_shader    = nullptr;
+        u32_t                        glyphCount  = 0;
+        GlyphAtlas                   glyphs;
+        TextLayoutCache              layouts{glyphs};
     };
 
     static TextData* s_textData;
 
+    ///////////////////////////
+    //  Draw list
+    ///////////////////////////
+    // Quads, text and static batch runs aren't batched as they're submitted. Each one is recorded with a sort key, the
+    // list is radix sorted at s_end and batched in key order. From the most significant bit down:
+    //   layer (8) | translucent (1) | opaque:      pipeline (3) | texture (20) | depth front to back (24) | 0 (8)
+    //                               | translucent: depth back to front (24) | submission order (31)
+    // Opaque draws only exist while depth testing is on, the depth buffer keeps them right in any order so they group
+    // by state. Translucent ones keep painter's order, their key never ties.
+    enum class DrawKind : u8_t
+    {
+        compactQuad = 0,
+        quad,
+        text,
+        staticBatch,
+    };
+
+    struct DrawItem
+    {
+        u64_t    key;
+        u32_t    index;  // into quads, texts or statics of the draw list, depending on kind
+        DrawKind kind;
+    };
+
+    struct QuadItem
+    {
+        glm::mat4             transform;
+        glm::vec4             color;
+        ref<Texture>          p_texture = nullptr;  // nullptr for the white texture
+        const PackedTexture*  p_packed  = nullptr;  // nullptr if p_texture is standalone
+        f32_t                 texTilingFactor;
+        u32_t                 entityId;
+        QuadCompactInstVertex compactVertex;  // without the texture bits, only for compact quads
+    };
+
+    struct TextItem
+    {
+        ref<Font>                      p_font;
+        const TextLayoutCache::Layout* p_layout;
+        glm::mat4                      transform;
+        glm::vec4                      fgColor;
+        glm::vec4                      bgColor;
+        glm::vec2                      unitRange;
+        u32_t                          entityId;
+    };
+
+    struct StaticItem
+    {
+        ref<StaticQuadBatch> p_batch;
+        u32_t                first;
+        u32_t                count;
+    };
+
+    struct DrawList
+    {
+        std::vector<DrawItem>   items;
+        std::vector<DrawItem>   sortScratch;
+        std::vector<QuadItem>   quads;
+        std::vector<TextItem>   texts;
+        std::vector<StaticItem> statics;
+        u32_t                   sequence = 0;
+        u8_t                    layer    = 0;
+    };
+
+    static DrawList* s_drawList;
+
     static Stats s_stats;
 
     ///////////////////////////
     // Private functions
     ///////////////////////////
+    static u64_t _s_makeSortKey(DrawKind kind, u32_t textureKey, f32_t depth, bool translucent);
+    static void _s_sortDrawList();
+    static void _s_flushDrawList();
+    static void _s_batchQuad(const QuadItem& item, bool compact);
+    static void _s_batchText(const TextItem& item);
+    static void _s_drawStatic(const StaticItem& item);
     static void _s_submit();
     static void _s_createTextBuffers();
     static void _s_createQuadBuffers();
+    static bool _s_encodeCompactQuad(const glm::mat4&       transform,
+                                     const glm::vec4&       color,
+                                     f32_t                  texTilingFactor,
+                                     u32_t                  entityId,
+                                     QuadCompactInstVertex& vertex);
+    static bool _s_packTexture(const ref<Texture>& p_texture);
+
+    // the page and layer of a texture, packing it if it can be, or nullptr if it stays standalone
+    static const PackedTexture* _s_findPackedTexture(const ref<Texture>& p_texture);
+
+    // moves a full page to an array with up to twice the layers
+    static void _s_growPage(u32_t pageIdx, u32_t maxLayers);
+    static void _s_evictPackedTextures();
 };
 }  // namespace nimbus
\ No newline at end of file
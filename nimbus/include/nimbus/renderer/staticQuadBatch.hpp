@@ -0,0 +1,142 @@
+#pragma once
+#include "nimbus/core/common.hpp"
+#include "nimbus/renderer/buffer.hpp"
+#include "nimbus/renderer/renderer2D.hpp"
+#include "nimbus/renderer/texture.hpp"
+
+#include <vector>
+
+namespace nimbus
+{
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Quads kept on the GPU across frames. Each quad owns a slot of a persistent instance buffer, changing one only
+// re-uploads the dirty ranges of slots, so quads that don't change cost nothing per frame. Slots draw in slot order,
+// a run of them per instanced call (see Renderer2D::s_drawStaticBatch), and the calls sort in with the frame's other
+// draws by depth and submission order like any quad. A batch samples at most Renderer2D's per batch textures and
+// pages, quads whose texture doesn't fit are refused and drawn the usual way.
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+class NIMBUS_API StaticQuadBatch : public refCounted
+{
+   public:
+    inline static const u32_t k_noSlot = 0xFFFFFFFF;
+
+    // Slots in a row that share a depth, with the world box around them. Runs never cross a multiple of
+    // k_runMaxSlots, so a change only has those slots looked at again and culling stays fine grained. Removed slots
+    // in between are part of a run, ones at either end aren't.
+    struct Run
+    {
+        u32_t     first;
+        u32_t     count;
+        f32_t     depth;
+        glm::vec3 min;
+        glm::vec3 max;
+    };
+
+    inline static const u32_t k_runMaxSlots = 256;
+
+    StaticQuadBatch();
+
+    // Adds a quad after all the others and returns its slot, or k_noSlot if its texture isn't loaded yet or can't be
+    // sampled in the same draw as the ones the batch already uses
+    u32_t add(const glm::mat4&    transform,
+              const ref<Texture>& p_texture,
+              const glm::vec4&    color,
+              f32_t               texTilingFactor = 1.0f,
+              u32_t               entityId        = 0);
+
+    // Rewrites a slot, returns false and leaves it as it was if the texture is refused like in add
+    bool set(u32_t               slot,
+             const glm::mat4&    transform,
+             const ref<Texture>& p_texture,
+             const glm::vec4&    color,
+             f32_t               texTilingFactor = 1.0f,
+             u32_t               entityId        = 0);
+
+    // Hides a slot, it stays taken until the batch is cleared
+    void remove(u32_t slot);
+
+    void clear();
+
+    // slots handed out since the last clear, removed ones included
+    inline u32_t getSlotCount() const
+    {
+        return m_slotCount;
+    }
+
+    inline u32_t getQuadCount() const
+    {
+        return m_slotCount - m_removedCount;
+    }
+
+    inline u32_t getRemovedCount() const
+    {
+        return m_removedCount;
+    }
+
+    // in slot order, as of the last upload (see Renderer2D::s_uploadStaticBatch)
+    inline const std::vector<Run>& getRuns() const
+    {
+        return m_runs;
+    }
+
+   private:
+    friend class Renderer2D;
+
+    using Instance = Renderer2D::QuadInstVertex;
+
+    // the buffer starts with room for this many, and grows geometrically
+    inline static const u32_t k_initCapacity = 1024;
+
+    // dirty slots this close together are uploaded as one range
+    inline static const u32_t k_rangeMergeGap = 8;
+
+    // past this the whole buffer is recreated instead of streaming the dirty ranges
+    inline static const u32_t k_streamedUploadMaxBytes = (4 << 20);
+
+    struct TextureSlot
+    {
+        ref<Texture> p_texture = nullptr;
+        u32_t        users     = 0;
+    };
+
+    struct PageSlot
+    {
+        u32_t page  = k_noSlot;  // into Renderer2D's pages
+        u32_t users = 0;
+    };
+
+    // CPU copy of the buffer, sized to its capacity with unused slots zeroed
+    std::vector<Instance> m_instances;
+    u32_t                 m_slotCount    = 0;
+    u32_t                 m_removedCount = 0;
+
+    // what the instances' texIndex refers to, standalone textures (0 is the white texture) and pages
+    std::vector<TextureSlot> m_textures;
+    std::vector<PageSlot>    m_pages;
+
+    // slots written since the last upload, may hold duplicates
+    std::vector<u32_t> m_dirtySlots;
+
+    ref<VertexBuffer> mp_buffer       = nullptr;
+    bool              m_bufferIsStale = true;  // recreate it with everything rather than copying ranges
+
+    // runs of each k_runMaxSlots slots, and all of them in a row
+    std::vector<std::vector<Run>> m_chunkRuns;
+    std::vector<Run>              m_runs;
+
+    bool _acquireTexture(const ref<Texture>& p_texture, i32_t& texIndex, i32_t& texLayer);
+    void _releaseTexture(const Instance& instance);
+
+    // brings the GPU buffer and the runs up to date, returns how many slots were uploaded
+    u32_t _upload();
+
+    // finds the runs again where slots are dirty, everywhere if the buffer is stale
+    void _updateRuns();
+    void _findRuns(u32_t chunk);
+
+    // what unused and removed slots hold, all corners at the origin so it rasterizes nothing
+    static Instance _s_hiddenInstance();
+};
+
+}  // namespace nimbus
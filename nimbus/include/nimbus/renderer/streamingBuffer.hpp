@@ -0,0 +1,85 @@
+#pragma once
+#include "nimbus/core/common.hpp"
+#include "nimbus/renderer/buffer.hpp"
+
+#include <atomic>
+
+namespace nimbus
+{
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Ring of per frame regions for data that is rewritten every frame (instance data, dynamic vertices, ...). Each frame
+// sub-allocates from its own region, regions are only reused once the frame that last wrote them has finished on the
+// GPU, so writing never races the render thread or GPU reading an older frame. Running out of room grows the buffer
+// geometrically in place of a flush, allocations are staged on the CPU until the new memory is mapped.
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+class NIMBUS_API StreamingBuffer : public refCounted
+{
+   public:
+    // one for each frame that can be in flight and the one being written
+    inline static const u32_t k_regionCount = 4;
+
+    // largest uniform buffer offset alignment the spec allows implementations to ask for
+    inline static const u32_t k_uniformAlign = 256;
+
+    struct Allocation
+    {
+        void* p_data   = nullptr;  // write the frame's data here
+        u32_t offset   = 0;        // in bytes from the start of the buffer
+        u32_t size     = 0;
+        void* p_handle = nullptr;  // backend memory the allocation lives in
+    };
+
+    static ref<StreamingBuffer> s_create(u32_t regionSize);
+
+    virtual ~StreamingBuffer() = default;
+
+    // Memory is valid to write until the frame is swapped. Thread safe, workers allocate while recording a command list
+    // (see Renderer::s_beginCmdList) and have to be done before the swap.
+    virtual Allocation allocate(u32_t size, u32_t alignment = 16) = 0;
+
+    // Source the vertex array's binding from an allocation for the draws that follow
+    virtual void bindVertexBuffer(const ref<VertexArray>& p_vertexArray,
+                                  u32_t                   binding,
+                                  u32_t                   stride,
+                                  const Allocation&       allocation)
+        = 0;
+
+    // Source the uniform block binding from an allocation, allocations bound here need k_uniformAlign alignment
+    virtual void bindUniformBuffer(u32_t binding, const Allocation& allocation) = 0;
+
+    // Source the storage block binding from an allocation, same alignment as for uniform buffers
+    virtual void bindStorageBuffer(u32_t binding, const Allocation& allocation) = 0;
+
+    // Copy size bytes at offset into the allocation over to a vertex buffer on the GPU, ordered with the draws around
+    // it, so a buffer that lives across frames can have parts of it rewritten without waiting on the GPU
+    virtual void copyToBuffer(const Allocation&        allocation,
+                              u32_t                    offset,
+                              u32_t                    size,
+                              const ref<VertexBuffer>& p_vertexBuffer,
+                              u32_t                    dstOffset)
+        = 0;
+
+    inline u32_t getRegionSize() const
+    {
+        return m_regionSize;
+    }
+
+    // bytes allocated across all streaming buffers by the last swapped frame
+    inline static u32_t s_getBytesStreamed()
+    {
+        return s_bytesLastFrame.load(std::memory_order_relaxed);
+    }
+
+    // Move every buffer on to its next region, called by the Renderer when it swaps frames
+    static void s_nextFrame();
+
+   protected:
+    u32_t m_regionSize = 0;
+
+    inline static std::atomic<u64_t> s_frame          = 0;
+    inline static std::atomic<u32_t> s_bytesThisFrame = 0;
+    inline static std::atomic<u32_t> s_bytesLastFrame = 0;
+};
+
+}  // namespace nimbus
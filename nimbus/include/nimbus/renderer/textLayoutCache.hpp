@@ -0,0 +1,111 @@
+#pragma once
+#include "nimbus/core/common.hpp"
+#include "nimbus/renderer/font.hpp"
+#include "nimbus/renderer/glyphAtlas.hpp"
+
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace nimbus
+{
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Glyph placement of UTF-8 strings, laid out once and kept for as long as they keep being drawn. A layout is keyed by
+// the text, font, kerning and leading, it's in the text's local space so moving or recoloring text reuses it. Looking
+// one up hashes the text without copying it, so text that doesn't change costs one hash a frame. Glyphs refer to
+// their atlas entry by handle, whether the atlas has generated them yet or not.
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+class NIMBUS_API TextLayoutCache
+{
+   public:
+    struct Glyph
+    {
+        glm::vec2          origin;  // pen position in the text's local space
+        GlyphAtlas::Handle handle;
+    };
+
+    struct Layout
+    {
+        std::vector<Glyph> glyphs;
+        f32_t              scale         = 1.0f;  // from the font's units to the text's local space
+
+        // what the glyphs' advances and the font's ascender and descender span, glyphs can overhang it a little
+        glm::vec2 min = glm::vec2(0.0f);
+        glm::vec2 max = glm::vec2(0.0f);
+
+        u64_t              lastUsedFrame = 0;
+    };
+
+    explicit TextLayoutCache(GlyphAtlas& atlas);
+
+    // layouts nobody has asked for in this many frames are dropped
+    inline static const u32_t k_maxUnusedFrames = 120;
+
+    // Layout of the text, laid out now if it isn't cached. The font has to be loaded. Stays valid until nextFrame.
+    const Layout& get(const std::string& text, const Font::Format& fontFormat);
+
+    // drops layouts that went unused for too long
+    void nextFrame();
+
+    inline u32_t getLayoutCount() const
+    {
+        return static_cast<u32_t>(m_layouts.size());
+    }
+
+    // layouts that weren't cached since the last nextFrame
+    inline u32_t getMissCount() const
+    {
+        return m_misses;
+    }
+
+   private:
+    struct Key
+    {
+        std::string text;
+        ref<Font>   p_font;  // keeps the font alive, so its address can't be reused for another while cached
+        f32_t       kerning;
+        f32_t       leading;
+    };
+
+    // what a lookup hashes and compares, without copying the text
+    struct KeyView
+    {
+        std::string_view text;
+        const Font*      p_font;
+        f32_t            kerning;
+        f32_t            leading;
+    };
+
+    struct KeyHash
+    {
+        using is_transparent = void;
+
+        size_t operator()(const KeyView& key) const;
+        size_t operator()(const Key& key) const;
+    };
+
+    struct KeyEqual
+    {
+        using is_transparent = void;
+
+        bool operator()(const KeyView& lhs, const KeyView& rhs) const;
+        bool operator()(const Key& lhs, const KeyView& rhs) const;
+        bool operator()(const KeyView& lhs, const Key& rhs) const;
+        bool operator()(const Key& lhs, const Key& rhs) const;
+    };
+
+    GlyphAtlas* mp_atlas;
+
+    std::unordered_map<Key, Layout, KeyHash, KeyEqual> m_layouts;
+
+    u64_t m_frame  = 0;
+    u32_t m_misses = 0;
+
+    void _layOut(const std::string& text, const Font::Format& fontFormat, Layout& layout);
+
+    static KeyView _s_view(const Key& key);
+};
+
+}  // namespace nimbus
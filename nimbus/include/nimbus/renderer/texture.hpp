@@ -1,6 +1,7 @@
 #pragma once
 #include "nimbus/core/common.hpp"
 
+#include <atomic>
 #include <cstdint>
 #include <string>
 #include <variant>
@@ -9,6 +10,8 @@
 namespace nimbus
 {
 
+class TextureArray;
+
 class NIMBUS_API Texture : public refCounted
 {
    public:
@@ -84,6 +87,13 @@ class NIMBUS_API Texture : public refCounted
         repeat
     };
 
+    enum class State
+    {
+        loading,  // decoding or waiting on its upload, bind() returns false
+        ready,
+        failed
+    };
+
     struct Spec
     {
         u32_t          width          = 1;
@@ -113,6 +123,17 @@ class NIMBUS_API Texture : public refCounted
 
     virtual u32_t getId() const = 0;
 
+    // Unique for the process' lifetime and known from construction, unlike the id which the render thread sets
+    // once the texture is created. What to key sorting and grouping on.
+    inline u32_t getUid() const
+    {
+        return m_uid;
+    }
+
+    // Main thread, for a loaded texture copied into a layer of p_array. The texture gives up its own storage and
+    // samples that layer from then on, so it isn't kept twice. Swaps over at a later s_processLoads.
+    virtual void viewLayer(const ref<TextureArray>& p_array, u32_t layer) = 0;
+
     virtual u32_t getWidth() const = 0;
 
     virtual u32_t getHeight() const = 0;
@@ -126,15 +147,27 @@ class NIMBUS_API Texture : public refCounted
 
     virtual bool operator==(const Texture& other) const = 0;
 
-    bool isLoaded() const
+    inline State getState() const
+    {
+        return m_state.load(std::memory_order_acquire);
+    }
+
+    inline bool isLoaded() const
     {
-        return m_loaded;
+        return getState() == State::ready;
     }
 
     static void s_setMaxTextures(u32_t maxTextures);
 
     static u32_t s_getMaxTextures();
 
+    // Main thread, once per frame. Starts the uploads of textures that have finished decoding and swaps textures over
+    // to their layer views.
+    static void s_processLoads();
+
+    // Waits for outstanding decodes and drops the uploads that haven't started, for shutdown
+    static void s_cancelLoads();
+
     static u32_t s_format(Format format);
 
     static u32_t s_formatInternal(FormatInternal format);
@@ -149,10 +182,13 @@ class NIMBUS_API Texture : public refCounted
     Type m_type;
     Spec m_spec;
 
-    u32_t       m_id;
-    std::string m_path;
-    bool        m_flipOnLoad;
-    bool        m_loaded = false;
+    u32_t              m_id = 0;
+    std::string        m_path;
+    bool               m_flipOnLoad;
+    std::atomic<State> m_state = State::loading;
+    u32_t              m_uid   = s_nextUid++;
+
+    inline static std::atomic<u32_t> s_nextUid = 0;
 
     static const u32_t  k_maxTexturesUninit = 0;
     inline static u32_t s_maxTextures       = k_maxTexturesUninit;
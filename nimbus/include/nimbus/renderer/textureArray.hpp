@@ -0,0 +1,71 @@
+#pragma once
+#include "nimbus/core/common.hpp"
+#include "nimbus/renderer/texture.hpp"
+
+namespace nimbus
+{
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Fixed size stack of same sized, same format layers sampled through one binding. Layers are filled by copying
+// textures in on the GPU, so a batch can draw many textures while only binding the array, or by uploading regions of
+// pixels into arrays made without mips.
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+class NIMBUS_API TextureArray : public refCounted
+{
+   public:
+    // Arrays without mips are sampled linearly and clamped to their edges, the others sample like loaded textures
+    static ref<TextureArray> s_create(
+        u32_t width, u32_t height, Texture::FormatInternal format, u32_t layers, bool mipmapped = true);
+
+    virtual ~TextureArray() = default;
+
+    virtual bool bind(const u32_t glTextureUnit) const = 0;
+
+    // Copy every mip level of p_texture into layer. The texture has to be loaded and match the array's size and format.
+    virtual void copyLayer(const ref<Texture>& p_texture, u32_t layer) = 0;
+
+    // Copy every layer and mip level of p_src into the first layers, to grow an array. It has to match the array's
+    // size, format and levels and have no more layers.
+    virtual void copyLayers(const ref<TextureArray>& p_src) = 0;
+
+    // Upload unsigned byte pixels into a rectangle of a layer, in the array's format with rows bottom to top. The
+    // data is copied, only arrays without mips can be written this way.
+    virtual void setRegion(u32_t layer, u32_t x, u32_t y, u32_t width, u32_t height, const void* p_data) = 0;
+
+    inline u32_t getWidth() const
+    {
+        return m_width;
+    }
+
+    inline u32_t getHeight() const
+    {
+        return m_height;
+    }
+
+    inline Texture::FormatInternal getFormat() const
+    {
+        return m_format;
+    }
+
+    inline u32_t getLayerCount() const
+    {
+        return m_layers;
+    }
+
+    inline u32_t getLevelCount() const
+    {
+        return m_levels;
+    }
+
+    // mip levels of a full chain for a size, what loaded textures are created with
+    static u32_t s_levelCount(u32_t width, u32_t height);
+
+   protected:
+    u32_t                   m_width  = 0;
+    u32_t                   m_height = 0;
+    Texture::FormatInternal m_format = Texture::FormatInternal::rgba8;
+    u32_t                   m_layers = 0;
+    u32_t                   m_levels = 1;
+};
+
+}  // namespace nimbus
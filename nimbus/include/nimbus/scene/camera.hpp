@@ -152,6 +152,7 @@ class NIMBUS_API Camera : public refCounted
     volatile bool m_staleProjection  = true;
     volatile bool m_staleView        = true;
     volatile bool m_staleWorldBounds = true;
+    volatile bool m_staleViewProj    = true;  // view or projection was rebuilt since the product was
 
     // location
     glm::vec3 m_position = {0.0f, 0.0f, 0.0f};
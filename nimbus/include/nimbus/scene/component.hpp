@@ -7,6 +7,7 @@
 #include "nimbus/core/guid.hpp"
 #include "nimbus/renderer/particleEmitter.hpp"
 #include "nimbus/scene/entity.hpp"
+#include "nimbus/scene/transformPool.hpp"
 #include "nimbus/core/utility.hpp"
 #include "nimbus/physics/physics2D.hpp"
 #include "nimbus/script/scriptEngine.hpp"
@@ -47,15 +48,17 @@ struct NameCmp
     }
 };
 
+// Place in the scene's hierarchy, as links to the other entities in it. A parent's children are a list through their
+// sibling links, where the first child's prevSibling is the last child, so adding one to the end doesn't walk the
+// list. Change it through Scene::setParent, which keeps both ends of every link in step. The scene's TransformPool
+// mirrors it between transform slots, and keeps the depths world transforms are propagated by.
 struct AncestryCmp
 {
-    Entity              parent;
-    std::vector<Entity> children;
-
-    AncestryCmp() = default;
-    AncestryCmp(Entity iparent) : parent(iparent)
-    {
-    }
+    entt::entity parent      = entt::null;
+    entt::entity firstChild  = entt::null;
+    entt::entity nextSibling = entt::null;
+    entt::entity prevSibling = entt::null;
+    u32_t        childCount  = 0;
 };
 
 struct ScriptCmp
@@ -87,22 +90,151 @@ struct NativeLogicCmp
     }
 };
 
+// Handle to the entity's transform in its scene's TransformPool, which the scene fills in when the component is
+// added and keeps up to date as slots move. Only valid while the entity has the component.
 struct TransformCmp
 {
-    util::Transform local;
-    util::Transform world;
+    TransformPool* p_pool = nullptr;
+    u32_t          slot   = TransformPool::k_noSlot;
+
+    inline glm::vec3 getTranslation() const
+    {
+        return p_pool->getTranslation(slot);
+    }
+
+    inline void setTranslation(const glm::vec3& translation)
+    {
+        p_pool->setTranslation(slot, translation);
+    }
+
+    inline void setTranslationX(f32_t translationX)
+    {
+        _setTranslationAxis(0, translationX);
+    }
+
+    inline void setTranslationY(f32_t translationY)
+    {
+        _setTranslationAxis(1, translationY);
+    }
+
+    inline void setTranslationZ(f32_t translationZ)
+    {
+        _setTranslationAxis(2, translationZ);
+    }
+
+    // euler angles in radians
+    inline const glm::vec3& getRotation() const
+    {
+        return p_pool->getRotation(slot);
+    }
+
+    inline void setRotation(const glm::vec3& rotation)
+    {
+        p_pool->setRotation(slot, rotation);
+    }
+
+    inline void setRotationX(f32_t rotationX)
+    {
+        _setRotationAxis(0, rotationX);
+    }
+
+    inline void setRotationY(f32_t rotationY)
+    {
+        _setRotationAxis(1, rotationY);
+    }
+
+    inline void setRotationZ(f32_t rotationZ)
+    {
+        _setRotationAxis(2, rotationZ);
+    }
+
+    inline glm::vec3 getScale() const
+    {
+        return p_pool->getScale(slot);
+    }
 
-    TransformCmp() = default;
+    inline void setScale(const glm::vec3& scale)
+    {
+        p_pool->setScale(slot, scale);
+    }
+
+    inline void setScaleX(f32_t scaleX)
+    {
+        p_pool->setScaleAxis(slot, 0, scaleX);
+    }
+
+    inline void setScaleY(f32_t scaleY)
+    {
+        p_pool->setScaleAxis(slot, 1, scaleY);
+    }
+
+    inline void setScaleZ(f32_t scaleZ)
+    {
+        p_pool->setScaleAxis(slot, 2, scaleZ);
+    }
+
+    inline bool isScaleLocked() const
+    {
+        return p_pool->isScaleLocked(slot);
+    }
+
+    inline void setScaleLocked(bool locked)
+    {
+        p_pool->setScaleLocked(slot, locked);
+    }
+
+    inline const glm::mat4& getLocal() const
+    {
+        return p_pool->getLocal(slot);
+    }
+
+    inline void setLocal(const glm::mat4& local)
+    {
+        p_pool->setLocal(slot, local);
+    }
+
+    // as of the last world transform update
+    inline const glm::mat4& getWorld() const
+    {
+        return p_pool->getWorld(slot);
+    }
+
+    // copies for what still takes a util::Transform, the world one is decomposed from its matrix
+    inline util::Transform getLocalTransform() const
+    {
+        util::Transform transform(getTranslation(), getRotation(), getScale());
+        transform.setScaleLocked(isScaleLocked());
+        return transform;
+    }
+
+    inline void setLocalTransform(const util::Transform& transform)
+    {
+        setTranslation(transform.getTranslation());
+        setRotation(transform.getRotation());
+        setScale(transform.getScale());
+        setScaleLocked(transform.isScaleLocked());
+    }
 
-    TransformCmp(const glm::vec3& itranslation)
+    inline util::Transform getWorldTransform() const
     {
-        local.setTranslation(itranslation);
+        util::Transform transform;
+        transform.setTransform(getWorld());
+        return transform;
     }
-    TransformCmp(const glm::vec3& itranslation, const glm::vec3& irotation, const glm::vec3& iscale)
+
+   private:
+    inline void _setTranslationAxis(u32_t axis, f32_t value)
+    {
+        glm::vec3 translation = getTranslation();
+        translation[axis]     = value;
+        setTranslation(translation);
+    }
+
+    inline void _setRotationAxis(u32_t axis, f32_t value)
     {
-        local.setTranslation(itranslation);
-        local.setRotation(irotation);
-        local.setScale(iscale);
+        glm::vec3 rotation = getRotation();
+        rotation[axis]     = value;
+        setRotation(rotation);
     }
 };
 
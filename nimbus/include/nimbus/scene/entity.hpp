@@ -45,6 +45,15 @@ class Entity
         return component;
     }
 
+    // Components changed in place through getComponent have to say so for anything that keeps a copy of them up to
+    // date, like the scene's static sprite batch
+    template <typename T>
+    inline void markChanged()
+    {
+        NB_ASSERT(hasComponent<T>(), "Entity does not have component!");
+        mp_sceneParent->m_registry.patch<T>(mh_entity);
+    }
+
     template <typename T, typename... Args>
     inline void removeComponent()
     {
@@ -52,7 +61,7 @@ class Entity
         mp_sceneParent->m_registry.remove<T>(mh_entity);
     }
 
-    inline entt::entity getId()
+    inline entt::entity getId() const
     {
         return mh_entity;
     }
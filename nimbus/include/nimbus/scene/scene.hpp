@@ -3,10 +3,16 @@
 
 #include "nimbus/scene/camera.hpp"
 #include "nimbus/physics/physics2D.hpp"
+#include "nimbus/renderer/frustumCuller.hpp"
+#include "nimbus/renderer/particleSystem.hpp"
+#include "nimbus/renderer/staticQuadBatch.hpp"
+#include "nimbus/scene/transformPool.hpp"
 
 #define ENTT_NOEXCEPTION
 #include "entt/entity/registry.hpp"
 
+#include <mutex>
+#include <unordered_map>
 #include <unordered_set>
 
 namespace nimbus
@@ -25,6 +31,9 @@ class NIMBUS_API Scene : public refCounted
     Entity addChildEntity(Entity parentEntity, const std::string& name = std::string());
 
     void removeEntity(Entity entity, bool removeChildren = false);
+
+    // Moves entity, along with everything below it, to the end of parent's children. No parent makes it top level.
+    void setParent(Entity entity, Entity parent = Entity());
     
     void sortEntities();
 
@@ -46,7 +55,17 @@ class NIMBUS_API Scene : public refCounted
         m_postUpdateWorkQueue.emplace_back(func);
     }
 
+    // runtime emitters, for setting the particle budget and such
+    inline ParticleSystem& getParticleSystem()
+    {
+        return m_particleSystem;
+    }
+
    private:
+    // before the registry, so these are still around while the registry lets go of their components
+    TransformPool                   m_transforms;
+    ParticleSystem                  m_particleSystem;
+    std::vector<entt::entity>       m_movedTransforms;
     entt::registry                  m_registry;
     f32_t                           m_aspectRatio;
     std::string                     m_name;
@@ -60,6 +79,28 @@ class NIMBUS_API Scene : public refCounted
     ///////////////////////////
     ref<Physics2D> mp_world2D;
 
+    ///////////////////////////
+    // Rendering
+    ///////////////////////////
+    FrustumCuller m_culler;
+
+    // Sprites live in a batch kept on the GPU, registry change notifications say which ones need rewriting. Slots are
+    // in creation order, the batch's runs and the sprites drawn every frame instead are merged by sequence index when
+    // drawing, so they layer as if all were drawn one by one. Sprites whose texture doesn't fit in with the batch's
+    // are unbatched, so are those that can't go on the end of the batch in order (their texture just loaded, or a
+    // changed one no longer fits) until enough of them have the batch rebuilt.
+    ref<StaticQuadBatch>                    mp_spriteBatch = nullptr;
+    std::unordered_map<entt::entity, u32_t> m_spriteSlots;
+    std::vector<u32_t>                      m_slotSequences;     // sequence index of each slot's sprite, ascending
+    std::vector<entt::entity>               m_unbatchedSprites;  // by sequence index
+    std::vector<entt::entity>               m_loadingSprites;
+    u32_t                                   m_misplacedSprites   = 0;  // unbatched only for being out of order
+    bool                                    m_rebuildSpriteBatch = true;
+
+    // the editor marks changes from the gui, which doesn't run on the thread the scene updates on
+    std::mutex                m_changedSpritesMtx;
+    std::vector<entt::entity> m_changedSprites;
+
     std::vector<std::function<void()>> m_postUpdateWorkQueue;
 
     friend class Entity;
@@ -73,6 +114,30 @@ class NIMBUS_API Scene : public refCounted
 
     void _render(Camera* p_camera);
 
+    void _updateWorldTransforms();
+
+    void _onTransformAdded(entt::registry& registry, entt::entity entity);
+
+    void _onTransformRemoved(entt::registry& registry, entt::entity entity);
+
+    void _onAncestryChanged(entt::registry& registry, entt::entity entity);
+
+    void _onAncestryRemoved(entt::registry& registry, entt::entity entity);
+
+    // points the entity's transform in the pool at its parent's
+    void _linkTransform(entt::entity entity);
+
+    void _onSpriteChanged(entt::registry& registry, entt::entity entity);
+
+    void _onParticleEmitterRemoved(entt::registry& registry, entt::entity entity);
+
+    void _updateSpriteBatch();
+
+    void _rebuildSpriteBatch();
+
+    // keeps m_unbatchedSprites in sequence order
+    void _addUnbatchedSprite(entt::entity entity);
+
     void _renderSceneSpecific(Camera* p_camera);
 
     void _onUpdateEditor(f32_t deltaTime);
@@ -25,6 +25,9 @@ class NIMBUS_API SceneSerializer
     void _assembleFamilyTree(void* p_entityTbl, const std::string guidStr);
 
     std::unordered_map<std::string, Entity> m_entityMap;
+
+    // child, parent
+    std::vector<std::pair<Entity, Entity>> m_parentLinks;
 };
 
 }  // namespace nimbus
\ No newline at end of file
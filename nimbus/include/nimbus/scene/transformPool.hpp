@@ -0,0 +1,175 @@
+#pragma once
+#include "nimbus/core/common.hpp"
+
+#define ENTT_NOEXCEPTION
+#include "entt/entity/entity.hpp"
+
+#include "glm.hpp"
+
+#include <vector>
+
+namespace nimbus
+{
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Transforms of a scene's entities, kept out of the registry in dense pools. What local matrices are built from is
+// kept as one array per component (rotations as quaternions), so the stale ones are rebuilt simd::k_width at a time.
+// Local and world matrices are contiguous arrays of their own. Euler angles are only kept for editing and scripts.
+// Slots stay dense, removing one moves the last transform into it, see TransformCmp for who keeps track.
+//
+// The hierarchy is mirrored here as links between slots, children appended in the order AncestryCmp has them. Only
+// the depths world matrices are propagated by are kept here. Transforms whose local matrix or parent changed are
+// listed as dirty, and world matrices are propagated down from those alone, into a child only when its parent's world
+// matrix actually changed. Nothing else is looked at, so one moved transform costs its subtree rather than the pool.
+// Dirty transforms are taken shallowest first, the ones at one depth have subtrees of their own and many of them are
+// split over the job system.
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+class NIMBUS_API TransformPool
+{
+   public:
+    inline static const u32_t k_noSlot = 0xFFFFFFFF;
+
+    // identity transform for entity, returns its slot
+    u32_t add(entt::entity entity);
+
+    // Frees a slot by moving the last transform into it. Returns the entity that moved, entt::null if none did.
+    entt::entity remove(u32_t slot);
+
+    void clear();
+
+    inline u32_t getCount() const
+    {
+        return m_count;
+    }
+
+    inline entt::entity getEntity(u32_t slot) const
+    {
+        return m_entities[slot];
+    }
+
+    glm::vec3 getTranslation(u32_t slot) const;
+    void      setTranslation(u32_t slot, const glm::vec3& translation);
+
+    // euler angles in radians
+    inline const glm::vec3& getRotation(u32_t slot) const
+    {
+        return m_rotations[slot];
+    }
+
+    void setRotation(u32_t slot, const glm::vec3& rotation);
+
+    glm::vec3 getScale(u32_t slot) const;
+
+    // unlocks the scale, like util::Transform
+    void setScale(u32_t slot, const glm::vec3& scale);
+
+    // one axis, scaling the others along with it if the scale is locked
+    void setScaleAxis(u32_t slot, u32_t axis, f32_t value);
+
+    inline bool isScaleLocked(u32_t slot) const
+    {
+        return m_scaleLocked[slot] != 0;
+    }
+
+    inline void setScaleLocked(u32_t slot, bool locked)
+    {
+        m_scaleLocked[slot] = locked;
+    }
+
+    // local matrix, rebuilt now if it's stale
+    const glm::mat4& getLocal(u32_t slot) const;
+
+    // kept as given, translation, rotation and scale are decomposed from it
+    void setLocal(u32_t slot, const glm::mat4& local);
+
+    // as of the last updateWorlds
+    inline const glm::mat4& getWorld(u32_t slot) const
+    {
+        return m_worlds[slot];
+    }
+
+    inline u32_t getParent(u32_t slot) const
+    {
+        return m_parents[slot];
+    }
+
+    // k_noSlot makes it a root, a parent from its own subtree is refused
+    void setParent(u32_t slot, u32_t parentSlot);
+
+    // one that doesn't has its local matrix as its world matrix, like physics bodies at runtime
+    void setFollowsParent(u32_t slot, bool follows);
+
+    // rebuilds every stale local matrix, updateWorlds starts with this
+    void updateLocals();
+
+    // Brings world matrices up to date, once per frame. Entities whose world matrix changed are appended to moved.
+    void updateWorlds(std::vector<entt::entity>& moved);
+
+   private:
+    // arrays are padded to this, so the last transforms can be loaded as a whole group too, whatever simd::k_width is
+    inline static const u32_t k_laneCount = 8;
+
+    // fewer dirty transforms at one depth than this aren't worth handing to the job system
+    inline static const u32_t k_minParallelRoots = 256;
+
+    u32_t m_count = 0;
+
+    // hot, what local matrices are built from
+    std::vector<f32_t> m_translationX;
+    std::vector<f32_t> m_translationY;
+    std::vector<f32_t> m_translationZ;
+    std::vector<f32_t> m_quatX;
+    std::vector<f32_t> m_quatY;
+    std::vector<f32_t> m_quatZ;
+    std::vector<f32_t> m_quatW;
+    std::vector<f32_t> m_scaleX;
+    std::vector<f32_t> m_scaleY;
+    std::vector<f32_t> m_scaleZ;
+
+    // set when a part of a local matrix changed, always 0 for padding
+    mutable std::vector<u8_t> m_stale;
+    mutable bool              m_anyStale = false;
+
+    mutable std::vector<glm::mat4> m_locals;
+    std::vector<glm::mat4>         m_worlds;
+
+    // Set when a world matrix has to be recomputed, the slot is listed in m_dirty when it's set. The list can still
+    // hold slots removed since, those are dropped when it's walked.
+    std::vector<u8_t>  m_worldStale;
+    std::vector<u32_t> m_dirty;
+
+    // hierarchy, links are slots or k_noSlot and like AncestryCmp's the first child's previous sibling is the last
+    std::vector<u32_t> m_parents;
+    std::vector<u32_t> m_firstChildren;
+    std::vector<u32_t> m_nextSiblings;
+    std::vector<u32_t> m_prevSiblings;
+    std::vector<u32_t> m_depths;  // roots are 0
+    std::vector<u8_t>  m_followsParent;
+
+    // cold
+    std::vector<glm::vec3>    m_rotations;
+    std::vector<u8_t>         m_scaleLocked;
+    std::vector<entt::entity> m_entities;
+
+    void _resize(u32_t count);
+    void _markStale(u32_t slot);
+    void _markWorldStale(u32_t slot);
+    void _setScale(u32_t slot, const glm::vec3& scale);
+
+    // one local matrix, for when there's no point in a group
+    void _composeLocal(u32_t slot) const;
+
+    void _link(u32_t slot, u32_t parentSlot);
+    void _unlink(u32_t slot);
+
+    // of the slot and its subtree
+    void _setDepth(u32_t slot, u32_t depth);
+
+    // the transform in from moves to the free slot to, along with everything that refers to it
+    void _relocate(u32_t from, u32_t to);
+
+    // world matrices of the subtrees of m_dirty[begin, end) that changed, appending their entities to moved
+    void _propagate(u32_t begin, u32_t end, std::vector<entt::entity>& moved);
+};
+
+}  // namespace nimbus
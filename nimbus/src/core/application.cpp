@@ -3,6 +3,7 @@
 
 #include "nimbus/core/application.hpp"
 #include "nimbus/core/event.hpp"
+#include "nimbus/core/jobSystem.hpp"
 
 #include "nimbus/script/scriptEngine.hpp"
 
@@ -47,6 +48,8 @@ Application::Application(const std::string& name, u32_t windowWidth, u32_t windo
 
     insertLayer(mp_guiSubsystemLayer);
 
+    JobSystem::s_init();
+
     Renderer::s_init();
 
     Renderer2D::s_init();
@@ -76,6 +79,9 @@ Application::~Application()
     // this will blow away our window and context
     mp_window.reset();
 
+    // after the resource manager as outstanding loads are waited on there
+    JobSystem::s_destroy();
+
     Log::s_destroy();
 }
 
@@ -97,7 +103,8 @@ void Application::execute()
 
     auto mainThreadProcessSw = m_swBank.newSw("MainThread Process");
 
-    auto mainThreadPendRenderThreadSw = m_swBank.newSw("MainThread Pend on RenderThread");
+    // time spent waiting on the render thread to get within frames in flight
+    auto mainThreadBubbleSw = m_swBank.newSw("MainThread Bubble");
 
     f64_t currentTime = core::getTime_s();
     bool  didDraw     = false;
@@ -152,9 +159,9 @@ void Application::execute()
         // Render thread
         ///////////////////////////
         f32_t prePendCpuProcessTime_s = mainThreadProcessSw->split();
-        mainThreadPendRenderThreadSw->split();
+        mainThreadBubbleSw->split();
         Renderer::s_waitForRenderThread();
-        mainThreadPendRenderThreadSw->splitAndSave();
+        mainThreadBubbleSw->splitAndSave();
         mainThreadProcessSw->split();  // post pend
 
         ///////////////////////////
@@ -2,42 +2,26 @@
 #include "nimbus/core/core.hpp"
 
 #include "nimbus/core/guid.hpp"
-
-#if defined(_WIN32) || defined(_WIN64)
-#include <objbase.h>
-#elif defined(__linux__)
-#include <uuid/uuid.h>
-#else
-#error Platform not supported
-#endif
+#include "nimbus/core/random.hpp"
 
 namespace nimbus
 {
 
 Guid::Guid()
 {
-#if defined(_WIN32) || defined(_WIN64)
-    GUID guid;
-    CoCreateGuid(&guid);
-
-    i128_t high = static_cast<i128_t>(guid.Data1) << 96 | static_cast<i128_t>(guid.Data2) << 80
-                  | static_cast<i128_t>(guid.Data3) << 64;
-
-    i128_t low = *reinterpret_cast<i128_t*>(guid.Data4);
+    // GUIDs are saved with scenes, so they're never seeded from the repeatable sequence
+    thread_local Random t_random(Random::s_entropySeed());
 
-    m_guid = high | low;
+    u64_t high = t_random.nextU64();
+    u64_t low  = t_random.nextU64();
 
-    _toString();
-
-#elif defined(__linux__)
-    uuid_t uuid;
-    uuid_generate_random(uuid);
+    // mark it a version 4 (random) UUID, variant 1
+    high = (high & ~u64_t(0xF000)) | 0x4000;
+    low  = (low & ~(u64_t(0xC000) << 48)) | (u64_t(0x8000) << 48);
 
-    m_guid = *reinterpret_cast<i128_t*>(uuid);
+    m_guid = static_cast<i128_t>(high) << 64 | static_cast<i128_t>(low);
 
     _toString();
-
-#endif
 }
 
 Guid::Guid(i128_t guid)
@@ -0,0 +1,385 @@
+#include "nimbus/core/nmpch.hpp"
+#include "nimbus/core/core.hpp"
+
+#include "nimbus/core/jobSystem.hpp"
+
+#include <thread>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+
+namespace nimbus
+{
+
+struct alignas(64) JobQueue
+{
+    std::mutex                    mtx;
+    std::deque<JobSystem::Handle> jobs;
+};
+
+struct JobSystemInternalData
+{
+    ///////////////////////////
+    // Threads
+    ///////////////////////////
+    std::vector<std::thread> workers;
+    std::atomic<bool>        running = true;
+
+    ///////////////////////////
+    // Queues
+    ///////////////////////////
+    // index 0 is shared by every thread that isn't a worker
+    JobQueue*          queues     = nullptr;
+    u32_t              queueCount = 0;
+    std::atomic<u32_t> queuedJobs = 0;
+
+    ///////////////////////////
+    // Sleeping
+    ///////////////////////////
+    std::mutex              sleepMtx;
+    std::condition_variable sleepCond;
+};
+
+JobSystemInternalData* JobSystem::sp_data = nullptr;
+
+static thread_local u32_t           t_queueIdx    = 0;
+static thread_local JobSystem::Job* tp_currentJob = nullptr;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Public Functions
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+void JobSystem::s_init(i32_t workerCount)
+{
+    // clang-format off
+    static std::once_flag initFlag;
+    std::call_once(initFlag,
+    [workerCount]()
+    {
+        sp_data = new JobSystemInternalData();
+
+        u32_t numWorkers = workerCount;
+        if(workerCount == k_detectCountIfPossible)
+        {
+            // leave room for the main and render threads
+            i32_t hwThreads = std::thread::hardware_concurrency();
+            numWorkers      = std::max(1, hwThreads - 2);
+        }
+
+        sp_data->queueCount = numWorkers + 1;
+        sp_data->queues     = new JobQueue[sp_data->queueCount];
+
+        for(u32_t i = 1; i < sp_data->queueCount; i++)
+        {
+            sp_data->workers.emplace_back(&JobSystem::_s_workerFn, i);
+        }
+
+        Log::coreInfo("Job system started with %i workers", numWorkers);
+    });
+    // clang-format on
+}
+
+void JobSystem::s_destroy()
+{
+    {
+        std::lock_guard<std::mutex> lock(sp_data->sleepMtx);
+        sp_data->running = false;
+    }
+    sp_data->sleepCond.notify_all();
+
+    for (auto& worker : sp_data->workers)
+    {
+        worker.join();
+    }
+
+    if (sp_data->queuedJobs.load() != 0)
+    {
+        Log::coreWarn("Unprocessed jobs (%i) left on job queues", sp_data->queuedJobs.load());
+    }
+
+    delete[] sp_data->queues;
+    delete sp_data;
+}
+
+JobSystem::Handle JobSystem::s_submit(jobFn_t fn, std::initializer_list<Handle> deps)
+{
+    Handle job = _s_create(std::move(fn), nullptr);
+    _s_addDependencies(job, deps.begin(), deps.size());
+    return job;
+}
+
+JobSystem::Handle JobSystem::s_submit(jobFn_t fn, const std::vector<Handle>& deps)
+{
+    Handle job = _s_create(std::move(fn), nullptr);
+    _s_addDependencies(job, deps.data(), deps.size());
+    return job;
+}
+
+JobSystem::Handle JobSystem::s_parallelFor(u32_t                         count,
+                                           u32_t                         grainSize,
+                                           rangeFn_t                     fn,
+                                           std::initializer_list<Handle> deps)
+{
+    NB_PROFILE_DETAIL();
+
+    if (grainSize == 0)
+    {
+        // a few chunks per thread gives stealing something to balance with
+        u32_t targetChunks = sp_data->queueCount * 4;
+        grainSize          = std::max(1u, (count + targetChunks - 1) / targetChunks);
+    }
+
+    // The outer job spawns the chunks as its children once its dependencies are met, so its handle only finishes
+    // once every chunk has. The chunks reference fn through the outer job which they keep alive via m_parent.
+    auto spawnFn = [count, grainSize, fn = std::move(fn)]()
+    {
+        Job* p_parent = tp_currentJob;
+
+        u32_t begin = 0;
+        while (count - begin > grainSize)
+        {
+            u32_t end = begin + grainSize;
+
+            _s_enqueue(_s_create([&fn, begin, end]() { fn(begin, end); }, p_parent));
+
+            begin = end;
+        }
+
+        // last chunk runs inline
+        if (begin < count)
+        {
+            fn(begin, count);
+        }
+    };
+
+    Handle job = _s_create(std::move(spawnFn), nullptr);
+    _s_addDependencies(job, deps.begin(), deps.size());
+    return job;
+}
+
+void JobSystem::s_wait(const Handle& handle)
+{
+    NB_PROFILE_DETAIL();
+
+    if (!handle)
+    {
+        return;
+    }
+
+    while (!handle->isDone())
+    {
+        if (!_s_runOne())
+        {
+            std::this_thread::yield();
+        }
+    }
+}
+
+void JobSystem::s_waitAll(const std::vector<Handle>& handles)
+{
+    for (const auto& handle : handles)
+    {
+        s_wait(handle);
+    }
+}
+
+u32_t JobSystem::s_getWorkerCount()
+{
+    return sp_data->queueCount - 1;
+}
+
+bool JobSystem::s_isInJob()
+{
+    return tp_currentJob != nullptr;
+}
+
+void* JobSystem::s_getJobLocal()
+{
+    NB_CORE_ASSERT_STATIC(tp_currentJob, "Job local state used outside of a job!");
+    return tp_currentJob->mp_local;
+}
+
+void JobSystem::s_setJobLocal(void* p_local)
+{
+    NB_CORE_ASSERT_STATIC(tp_currentJob, "Job local state used outside of a job!");
+    tp_currentJob->mp_local = p_local;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Private Functions
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+JobSystem::Handle JobSystem::_s_create(jobFn_t fn, Job* p_parent)
+{
+    NB_CORE_ASSERT_STATIC(sp_data, "Job system used before JobSystem::s_init");
+
+    Handle job = ref<Job>::gen();
+    job->m_fn  = std::move(fn);
+
+    if (p_parent)
+    {
+        p_parent->m_unfinished.fetch_add(1, std::memory_order_relaxed);
+        job->m_parent = p_parent;
+        job->m_pendingDeps.store(0, std::memory_order_relaxed);
+    }
+
+    return job;
+}
+
+void JobSystem::_s_addDependencies(Handle& job, const Handle* p_deps, u32_t depCount)
+{
+    // m_pendingDeps starts at 1 so that dependencies finishing while we are still registering can't queue the job
+    for (u32_t i = 0; i < depCount; i++)
+    {
+        const Handle& dep = p_deps[i];
+        if (!dep)
+        {
+            continue;
+        }
+
+        Job*                        p_dep = const_cast<Job*>(dep.raw());
+        std::lock_guard<std::mutex> lock(p_dep->m_dependentsMtx);
+        if (!p_dep->m_finished)
+        {
+            job->m_pendingDeps.fetch_add(1, std::memory_order_relaxed);
+            p_dep->m_dependents.push_back(job);
+        }
+    }
+
+    if (job->m_pendingDeps.fetch_sub(1, std::memory_order_acq_rel) == 1)
+    {
+        _s_enqueue(job);
+    }
+}
+
+void JobSystem::_s_enqueue(const Handle& job)
+{
+    // counted before it is visible so a fetch can never take the count below zero
+    sp_data->queuedJobs.fetch_add(1, std::memory_order_release);
+
+    JobQueue& queue = sp_data->queues[t_queueIdx];
+    {
+        std::lock_guard<std::mutex> lock(queue.mtx);
+        queue.jobs.push_back(job);
+    }
+
+    // take the lock so a worker between its predicate check and wait can't miss this
+    {
+        std::lock_guard<std::mutex> lock(sp_data->sleepMtx);
+    }
+    sp_data->sleepCond.notify_one();
+}
+
+JobSystem::Handle JobSystem::_s_fetch()
+{
+    if (sp_data->queuedJobs.load(std::memory_order_acquire) == 0)
+    {
+        return nullptr;
+    }
+
+    // newest from our own queue first as its data is likely still in cache
+    {
+        JobQueue&                   queue = sp_data->queues[t_queueIdx];
+        std::lock_guard<std::mutex> lock(queue.mtx);
+        if (!queue.jobs.empty())
+        {
+            Handle job = std::move(queue.jobs.back());
+            queue.jobs.pop_back();
+            sp_data->queuedJobs.fetch_sub(1, std::memory_order_relaxed);
+            return job;
+        }
+    }
+
+    // then steal the oldest from everyone else
+    for (u32_t i = 1; i < sp_data->queueCount; i++)
+    {
+        JobQueue&                   queue = sp_data->queues[(t_queueIdx + i) % sp_data->queueCount];
+        std::lock_guard<std::mutex> lock(queue.mtx);
+        if (!queue.jobs.empty())
+        {
+            Handle job = std::move(queue.jobs.front());
+            queue.jobs.pop_front();
+            sp_data->queuedJobs.fetch_sub(1, std::memory_order_relaxed);
+            return job;
+        }
+    }
+
+    return nullptr;
+}
+
+bool JobSystem::_s_runOne()
+{
+    Handle job = _s_fetch();
+    if (!job)
+    {
+        return false;
+    }
+
+    _s_execute(job);
+    return true;
+}
+
+void JobSystem::_s_execute(Handle& job)
+{
+    NB_PROFILE_TRACE();
+
+    Job* p_prevJob = tp_currentJob;
+    tp_currentJob  = job.raw();
+
+    job->m_fn();
+
+    tp_currentJob = p_prevJob;
+
+    _s_finish(job.raw());
+}
+
+void JobSystem::_s_finish(Job* p_job)
+{
+    if (p_job->m_unfinished.fetch_sub(1, std::memory_order_acq_rel) != 1)
+    {
+        return;
+    }
+
+    std::vector<Handle> dependents;
+    {
+        std::lock_guard<std::mutex> lock(p_job->m_dependentsMtx);
+        p_job->m_finished = true;
+        dependents.swap(p_job->m_dependents);
+    }
+
+    for (auto& dependent : dependents)
+    {
+        if (dependent->m_pendingDeps.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        {
+            _s_enqueue(dependent);
+        }
+    }
+
+    if (p_job->m_parent)
+    {
+        // the parent can't be released before we are done with it
+        Handle parent = p_job->m_parent;
+        _s_finish(parent.raw());
+    }
+}
+
+void JobSystem::_s_workerFn(u32_t queueIdx)
+{
+    t_queueIdx = queueIdx;
+
+    while (sp_data->running.load(std::memory_order_acquire))
+    {
+        if (_s_runOne())
+        {
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(sp_data->sleepMtx);
+        sp_data->sleepCond.wait(lock,
+                                []()
+                                {
+                                    return sp_data->queuedJobs.load(std::memory_order_acquire) != 0
+                                           || !sp_data->running.load(std::memory_order_acquire);
+                                });
+    }
+}
+
+}  // namespace nimbus
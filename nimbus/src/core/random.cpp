@@ -0,0 +1,192 @@
+#include "nimbus/core/nmpch.hpp"
+#include "nimbus/core/core.hpp"
+
+#include "nimbus/core/random.hpp"
+
+#include <atomic>
+#include <bit>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define NB_RANDOM_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace nimbus
+{
+
+// where unseeded Randoms get their seeds, advanced by the golden ratio like splitmix64
+static std::atomic<u64_t> s_seedSequence = Random::s_entropySeed();
+
+Random::Random() : Random(s_seedSequence.fetch_add(0x9E3779B97F4A7C15))
+{
+}
+
+Random::Random(u64_t seed)
+{
+    this->seed(seed);
+}
+
+void Random::seed(u64_t seed)
+{
+    // splitmix64 spreads the seed over the state, so similar seeds don't start out alike
+    for (u32_t i = 0; i < 4; i += 2)
+    {
+        u64_t value    = _s_splitMix(seed);
+        m_state[i]     = static_cast<u32_t>(value);
+        m_state[i + 1] = static_cast<u32_t>(value >> 32);
+    }
+
+    for (u32_t lane = 0; lane < k_laneCount; lane++)
+    {
+        for (u32_t word = 0; word < 4; word += 2)
+        {
+            u64_t value             = _s_splitMix(seed);
+            m_lanes[word][lane]     = static_cast<u32_t>(value);
+            m_lanes[word + 1][lane] = static_cast<u32_t>(value >> 32);
+        }
+    }
+}
+
+u32_t Random::nextU32()
+{
+    u32_t result = std::rotl(m_state[0] + m_state[3], 7) + m_state[0];
+    u32_t t      = m_state[1] << 9;
+
+    m_state[2] ^= m_state[0];
+    m_state[3] ^= m_state[1];
+    m_state[1] ^= m_state[2];
+    m_state[0] ^= m_state[3];
+    m_state[2] ^= t;
+    m_state[3] = std::rotl(m_state[3], 11);
+
+    return result;
+}
+
+u64_t Random::nextU64()
+{
+    u64_t high = nextU32();
+    return high << 32 | nextU32();
+}
+
+f32_t Random::nextF32()
+{
+    // the top 24 bits, as many as a float holds exactly
+    return static_cast<f32_t>(nextU32() >> 8) * (1.0f / 16777216.0f);
+}
+
+f32_t Random::range(f32_t min, f32_t max)
+{
+    return min + (max - min) * nextF32();
+}
+
+u32_t Random::rangeU32(u32_t min, u32_t max)
+{
+    NB_CORE_ASSERT(min <= max, "Random range min must be <= max");
+
+    // scaled rather than taken modulo, the bias is at most span / 2^32
+    u64_t span = static_cast<u64_t>(max) - min + 1;
+    return min + static_cast<u32_t>((nextU32() * span) >> 32);
+}
+
+void Random::fill(f32_t* p_dest, u32_t count, f32_t min, f32_t max)
+{
+    NB_PROFILE_DETAIL();
+
+    f32_t scale = (max - min) * (1.0f / 16777216.0f);
+
+    u32_t i = 0;
+
+#if defined(NB_RANDOM_SSE2)
+    __m128i s0 = _mm_load_si128(reinterpret_cast<const __m128i*>(m_lanes[0]));
+    __m128i s1 = _mm_load_si128(reinterpret_cast<const __m128i*>(m_lanes[1]));
+    __m128i s2 = _mm_load_si128(reinterpret_cast<const __m128i*>(m_lanes[2]));
+    __m128i s3 = _mm_load_si128(reinterpret_cast<const __m128i*>(m_lanes[3]));
+
+    const __m128 scales = _mm_set1_ps(scale);
+    const __m128 mins   = _mm_set1_ps(min);
+
+    for (; i + k_laneCount <= count; i += k_laneCount)
+    {
+        // nextU32 on every lane
+        __m128i sum    = _mm_add_epi32(s0, s3);
+        __m128i result = _mm_add_epi32(_mm_or_si128(_mm_slli_epi32(sum, 7), _mm_srli_epi32(sum, 25)), s0);
+        __m128i t      = _mm_slli_epi32(s1, 9);
+
+        s2 = _mm_xor_si128(s2, s0);
+        s3 = _mm_xor_si128(s3, s1);
+        s1 = _mm_xor_si128(s1, s2);
+        s0 = _mm_xor_si128(s0, s3);
+        s2 = _mm_xor_si128(s2, t);
+        s3 = _mm_or_si128(_mm_slli_epi32(s3, 11), _mm_srli_epi32(s3, 21));
+
+        // top 24 bits fit a signed conversion
+        __m128 unit = _mm_cvtepi32_ps(_mm_srli_epi32(result, 8));
+        _mm_storeu_ps(p_dest + i, _mm_add_ps(mins, _mm_mul_ps(unit, scales)));
+    }
+
+    _mm_store_si128(reinterpret_cast<__m128i*>(m_lanes[0]), s0);
+    _mm_store_si128(reinterpret_cast<__m128i*>(m_lanes[1]), s1);
+    _mm_store_si128(reinterpret_cast<__m128i*>(m_lanes[2]), s2);
+    _mm_store_si128(reinterpret_cast<__m128i*>(m_lanes[3]), s3);
+#endif
+
+    // without SSE2 all of it, the remainder of a group otherwise, from a whole group so the lanes stay in step
+    u32_t group[k_laneCount];
+    for (; i < count; i += k_laneCount)
+    {
+        _nextLanes(group);
+
+        u32_t groupCount = std::min(count - i, k_laneCount);
+        for (u32_t lane = 0; lane < groupCount; lane++)
+        {
+            p_dest[i + lane] = min + static_cast<f32_t>(group[lane] >> 8) * scale;
+        }
+    }
+}
+
+void Random::s_setSeed(u64_t seed)
+{
+    s_seedSequence = seed;
+}
+
+u64_t Random::s_entropySeed()
+{
+    std::random_device device;
+
+    u64_t high = device();
+    return high << 32 | device();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Private Functions
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+void Random::_nextLanes(u32_t* p_dest)
+{
+    for (u32_t lane = 0; lane < k_laneCount; lane++)
+    {
+        u32_t& s0 = m_lanes[0][lane];
+        u32_t& s1 = m_lanes[1][lane];
+        u32_t& s2 = m_lanes[2][lane];
+        u32_t& s3 = m_lanes[3][lane];
+
+        p_dest[lane] = std::rotl(s0 + s3, 7) + s0;
+        u32_t t      = s1 << 9;
+
+        s2 ^= s0;
+        s3 ^= s1;
+        s1 ^= s2;
+        s0 ^= s3;
+        s2 ^= t;
+        s3 = std::rotl(s3, 11);
+    }
+}
+
+u64_t Random::_s_splitMix(u64_t& state)
+{
+    u64_t z = (state += 0x9E3779B97F4A7C15);
+    z       = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9;
+    z       = (z ^ (z >> 27)) * 0x94D049BB133111EB;
+    return z ^ (z >> 31);
+}
+
+}  // namespace nimbus
@@ -16,6 +16,9 @@ ResourceManager::ResourceManager()
 
 ResourceManager::~ResourceManager()
 {
+    // decode jobs hold on to their textures
+    Texture::s_cancelLoads();
+
     m_loadedFonts.clear();
     m_loadedShaders.clear();
     m_loadedTextures.clear();
@@ -157,7 +160,15 @@ ref<Font> ResourceManager::loadFont(const std::string& path)
     {
         std::filesystem::path filePath(path);
 
-        ref<Font> font = Font::s_create(filePath.generic_string());
+        // Glyph tables are kept between runs, one file per font path. The font's load job maps it and only rebuilds
+        // them when the font file changed since it was written.
+        std::string cacheName = filePath.lexically_normal().generic_string();
+        std::replace_if(
+            cacheName.begin(), cacheName.end(), [](char c) { return c == '/' || c == ':' || c == '.'; }, '_');
+
+        std::filesystem::path cachePath = std::filesystem::path(k_fontCacheDir) / (cacheName + ".nbfont");
+
+        ref<Font> font = Font::s_create(filePath.generic_string(), cachePath);
 
         auto fontPair = m_loadedFonts.emplace(path, font);
 
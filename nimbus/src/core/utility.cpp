@@ -9,7 +9,7 @@
 
 #include <fstream>
 
-#include "nimbus/platform/os/os.h"
+#include "nimbus/platform/os/headers.h"
 
 
 namespace nimbus::util
@@ -132,10 +132,172 @@ std::filesystem::path getExecutablePath()
     return "";
 }
 
+u32_t decodeUtf8(std::string_view text, size_t& pos)
+{
+    u8_t lead = static_cast<u8_t>(text[pos++]);
+    if (lead < 0x80)
+    {
+        return lead;
+    }
+
+    u32_t length;
+    u32_t codepoint;
+    u32_t minimum;  // anything below is an overlong encoding
+    if ((lead & 0xE0) == 0xC0)
+    {
+        length    = 2;
+        codepoint = lead & 0x1F;
+        minimum   = 0x80;
+    }
+    else if ((lead & 0xF0) == 0xE0)
+    {
+        length    = 3;
+        codepoint = lead & 0x0F;
+        minimum   = 0x800;
+    }
+    else if ((lead & 0xF8) == 0xF0)
+    {
+        length    = 4;
+        codepoint = lead & 0x07;
+        minimum   = 0x10000;
+    }
+    else
+    {
+        return k_replacementCodepoint;
+    }
+
+    if (pos + length - 1 > text.size())
+    {
+        return k_replacementCodepoint;
+    }
+
+    for (u32_t i = 0; i < length - 1; i++)
+    {
+        u8_t continuation = static_cast<u8_t>(text[pos + i]);
+        if ((continuation & 0xC0) != 0x80)
+        {
+            return k_replacementCodepoint;
+        }
+        codepoint = (codepoint << 6) | (continuation & 0x3F);
+    }
+
+    if (codepoint < minimum || codepoint > 0x10FFFF || (codepoint >= 0xD800 && codepoint <= 0xDFFF))
+    {
+        return k_replacementCodepoint;
+    }
+
+    pos += length - 1;
+    return codepoint;
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Util classes
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
+MappedFile::~MappedFile()
+{
+    close();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept : mp_data(other.mp_data), m_size(other.m_size)
+{
+    other.mp_data = nullptr;
+    other.m_size  = 0;
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+{
+    if (this != &other)
+    {
+        close();
+        std::swap(mp_data, other.mp_data);
+        std::swap(m_size, other.m_size);
+    }
+    return *this;
+}
+
+bool MappedFile::open(const std::filesystem::path& path)
+{
+    close();
+
+#if defined(NB_WINDOWS)
+    HANDLE file = CreateFileW(
+        path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart == 0)
+    {
+        CloseHandle(file);
+        return false;
+    }
+
+    HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);
+    if (mapping == nullptr)
+    {
+        return false;
+    }
+
+    // the view keeps the mapping alive
+    void* p_view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping);
+    if (p_view == nullptr)
+    {
+        return false;
+    }
+
+    mp_data = static_cast<const u8_t*>(p_view);
+    m_size  = static_cast<u64_t>(size.QuadPart);
+#elif defined(NB_LINUX)
+    int file = ::open(path.c_str(), O_RDONLY);
+    if (file == -1)
+    {
+        return false;
+    }
+
+    struct stat info;
+    if (fstat(file, &info) != 0 || info.st_size == 0)
+    {
+        ::close(file);
+        return false;
+    }
+
+    // the mapping keeps the file open
+    void* p_view = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+    ::close(file);
+    if (p_view == MAP_FAILED)
+    {
+        return false;
+    }
+
+    mp_data = static_cast<const u8_t*>(p_view);
+    m_size  = static_cast<u64_t>(info.st_size);
+#endif
+
+    return mp_data != nullptr;
+}
+
+void MappedFile::close()
+{
+    if (mp_data == nullptr)
+    {
+        return;
+    }
+
+#if defined(NB_WINDOWS)
+    UnmapViewOfFile(mp_data);
+#elif defined(NB_LINUX)
+    munmap(const_cast<u8_t*>(mp_data), m_size);
+#endif
+
+    mp_data = nullptr;
+    m_size  = 0;
+}
+
 Transform::Transform(const glm::vec3& itranslation) : translation(itranslation)
 {
 }
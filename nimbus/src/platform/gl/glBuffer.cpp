@@ -30,6 +30,7 @@ GlVertexBuffer::GlVertexBuffer(const void* vertices, u32_t size, VertexBuffer::T
                 {
                     glCreateBuffers(1, &p_this->m_id);
                     glNamedBufferStorage(p_this->m_id, p_this->m_size, localCpy, 0);
+                    p_this->m_created.store(true, std::memory_order_release);
 
                     free(localCpy);
                 });
@@ -49,6 +50,7 @@ GlVertexBuffer::GlVertexBuffer(const void* vertices, u32_t size, VertexBuffer::T
                     p_this->mp_memory = glMapNamedBufferRange(p_this->m_id, 0, p_this->m_size, flags);
 
                     p_this->m_mapped = true;
+                    p_this->m_created.store(true, std::memory_order_release);
 
                     free(localCpy);
                 });
@@ -65,7 +67,7 @@ GlVertexBuffer::~GlVertexBuffer()
 {
     u32_t id     = m_id;
     bool  mapped = m_mapped;
-    Renderer::s_submitObject(
+    Renderer::s_submitRetire(
         [id, mapped]()
         {
             if (mapped)
@@ -80,6 +82,13 @@ GlVertexBuffer::~GlVertexBuffer()
 
 void GlVertexBuffer::bind() const
 {
+    if (m_created.load(std::memory_order_acquire))
+    {
+        Renderer::s_submitPacket(RenderCmdOp::bindBuffer, renderCmd::BindBuffer{GL_ARRAY_BUFFER, m_id});
+        return;
+    }
+
+    // id isn't known until the object queue has run, resolve it on the render thread
     ref<GlVertexBuffer> p_this = const_cast<GlVertexBuffer*>(this);
 
     Renderer::s_submit([p_this]() { glBindBuffer(GL_ARRAY_BUFFER, p_this->m_id); });
@@ -120,6 +129,7 @@ GlIndexBuffer::GlIndexBuffer(u32_t* indices, u32_t count)
         {
             glCreateBuffers(1, &p_this->m_id);
             glNamedBufferStorage(p_this->m_id, p_this->m_count * sizeof(u32_t), localCpy, 0);
+            p_this->m_created.store(true, std::memory_order_release);
 
             free(localCpy);
         });
@@ -140,6 +150,7 @@ GlIndexBuffer::GlIndexBuffer(u16_t* indices, u32_t count)
         {
             glCreateBuffers(1, &p_this->m_id);
             glNamedBufferStorage(p_this->m_id, p_this->m_count * sizeof(u16_t), localCpy, 0);
+            p_this->m_created.store(true, std::memory_order_release);
 
             free(localCpy);
         });
@@ -160,6 +171,7 @@ GlIndexBuffer::GlIndexBuffer(u8_t* indices, u32_t count)
         {
             glCreateBuffers(1, &p_this->m_id);
             glNamedBufferStorage(p_this->m_id, p_this->m_count * sizeof(u8_t), localCpy, 0);
+            p_this->m_created.store(true, std::memory_order_release);
 
             free(localCpy);
         });
@@ -168,11 +180,18 @@ GlIndexBuffer::GlIndexBuffer(u8_t* indices, u32_t count)
 GlIndexBuffer::~GlIndexBuffer()
 {
     u32_t id = m_id;
-    Renderer::s_submitObject([id]() { glDeleteBuffers(1, &id); });
+    Renderer::s_submitRetire([id]() { glDeleteBuffers(1, &id); });
 }
 
 void GlIndexBuffer::bind() const
 {
+    if (m_created.load(std::memory_order_acquire))
+    {
+        Renderer::s_submitPacket(RenderCmdOp::bindBuffer, renderCmd::BindBuffer{GL_ELEMENT_ARRAY_BUFFER, m_id});
+        return;
+    }
+
+    // id isn't known until the object queue has run, resolve it on the render thread
     ref<GlIndexBuffer> p_this = const_cast<GlIndexBuffer*>(this);
 
     Renderer::s_submit([p_this]() { glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, p_this->m_id); });
@@ -190,17 +209,29 @@ GlVertexArray::GlVertexArray()
 {
     ref<GlVertexArray> p_this = this;
 
-    Renderer::s_submitObject([p_this]() mutable { glCreateVertexArrays(1, &p_this->m_id); });
+    Renderer::s_submitObject(
+        [p_this]() mutable
+        {
+            glCreateVertexArrays(1, &p_this->m_id);
+            p_this->m_created.store(true, std::memory_order_release);
+        });
 }
 
 GlVertexArray::~GlVertexArray()
 {
     u32_t id = m_id;
-    Renderer::s_submitObject([id]() { glDeleteVertexArrays(1, &id); });
+    Renderer::s_submitRetire([id]() { glDeleteVertexArrays(1, &id); });
 }
 
 void GlVertexArray::bind() const
 {
+    if (m_created.load(std::memory_order_acquire))
+    {
+        Renderer::s_submitPacket(RenderCmdOp::bindVertexArray, renderCmd::BindVertexArray{m_id});
+        return;
+    }
+
+    // id isn't known until the object queue has run, resolve it on the render thread
     ref<GlVertexArray> p_this = const_cast<GlVertexArray*>(this);
 
     Renderer::s_submit([p_this]() { glBindVertexArray(p_this->m_id); });
@@ -215,79 +246,16 @@ void GlVertexArray::addVertexBuffer(ref<VertexBuffer> p_vertexBuffer)
 {
     NB_CORE_ASSERT(p_vertexBuffer->getFormat().getComponents().size(), "VBO format is required to create VBA");
 
-    ref<GlVertexArray> p_this = this;
+    ref<GlVertexArray> p_this  = this;
+    u32_t              binding = m_bindingCount++;
 
     Renderer::s_submitObject(
-        [p_this, p_vertexBuffer]() mutable
+        [p_this, p_vertexBuffer, binding]() mutable
         {
-            u32_t vboId = p_vertexBuffer->getId();
-            glBindVertexArray(p_this->m_id);
-            glBindBuffer(GL_ARRAY_BUFFER, vboId);
-
             const auto& format = p_vertexBuffer->getFormat();
-            for (const auto& component : format)
-            {
-                u32_t glType = Shader::s_getShaderType(std::get<0>(component.dataType));
-
-                if (glType == GL_INT || glType == GL_UNSIGNED_INT || glType == GL_BOOL)
-                {
-                    glEnableVertexAttribArray(p_this->m_vertexBufferIndex);
-
-                    u32_t numOfComponent = std::get<2>(component.dataType);
-
-                    glVertexAttribIPointer(p_this->m_vertexBufferIndex,
-                                           numOfComponent,
-                                           glType,
-                                           format.getStride(),
-                                           (const void*)component.offset);
-
-                    if (component.type == BufferComponent::Type::perInstance)
-                    {
-                        glVertexAttribDivisor(p_this->m_vertexBufferIndex, component.perInstance);
-                    }
-                    p_this->m_vertexBufferIndex++;
-                }
-                else if (glType == GL_FLOAT)
-                {
-                    u32_t numOfComponent = std::get<2>(component.dataType);
-                    u32_t columns        = 1;
-
-                    u32_t numOfComponentsPerColumn = numOfComponent;
-                    if (numOfComponent > 4)
-                    {
-                        // This is a matrix we must add a pointer for each
-                        // column of the matrix
-                        columns                  = static_cast<u32_t>(std::sqrt(numOfComponent));
-                        numOfComponentsPerColumn = columns;  // matrix will always be square
-                    }
-
-                    for (u32_t i = 0; i < columns; i++)
-                    {
-                        u64_t offset = component.offset + (sizeof(f32_t) * numOfComponentsPerColumn * i);
-
-                        glEnableVertexAttribArray(p_this->m_vertexBufferIndex);
-                        glVertexAttribPointer(p_this->m_vertexBufferIndex,
-                                              numOfComponentsPerColumn,
-                                              glType,
-                                              component.normalized ? GL_TRUE : GL_FALSE,
-                                              format.getStride(),
-                                              (const void*)offset);
-
-                        if (component.type == BufferComponent::Type::perInstance)
-                        {
-                            glVertexAttribDivisor(p_this->m_vertexBufferIndex, component.perInstance);
-                        }
-                        p_this->m_vertexBufferIndex++;
-                    }
-                }
-                else
-                {
-                    NB_CORE_ASSERT_STATIC(0, "Unknown ShaderDataType!");
-                }
-            }
 
-            glBindVertexArray(0);
-            glBindBuffer(GL_ARRAY_BUFFER, 0);
+            p_this->_setupFormat(binding, format);
+            glVertexArrayVertexBuffer(p_this->m_id, binding, p_vertexBuffer->getId(), 0, format.getStride());
 
             u32_t thisVboVertexCount = p_vertexBuffer->getSize() / format.getStride();
 
@@ -306,6 +274,41 @@ void GlVertexArray::addVertexBuffer(ref<VertexBuffer> p_vertexBuffer)
         });
 }
 
+u32_t GlVertexArray::addVertexFormat(const BufferFormat& format)
+{
+    NB_CORE_ASSERT(format.getComponents().size(), "Format is required to add a binding to a VBA");
+
+    ref<GlVertexArray> p_this  = this;
+    u32_t              binding = m_bindingCount++;
+
+    Renderer::s_submitObject([p_this, format, binding]() { p_this->_setupFormat(binding, format); });
+
+    return binding;
+}
+
+void GlVertexArray::bindVertexBuffer(u32_t                    binding,
+                                     const ref<VertexBuffer>& p_vertexBuffer,
+                                     u32_t                    stride,
+                                     u32_t                    offset)
+{
+    const GlVertexBuffer* p_glVertexBuffer = static_cast<const GlVertexBuffer*>(p_vertexBuffer.raw());
+
+    if (isCreated() && p_glVertexBuffer->isCreated())
+    {
+        Renderer::s_submitPacket(
+            RenderCmdOp::vertexArrayBuffer,
+            renderCmd::VertexArrayBuffer{m_id, binding, p_glVertexBuffer->getId(), offset, stride});
+        return;
+    }
+
+    // ids aren't known until the object queue has run, resolve them on the render thread
+    ref<GlVertexArray> p_this   = this;
+    ref<VertexBuffer>  p_buffer = p_vertexBuffer;
+
+    Renderer::s_submit([p_this, p_buffer, binding, stride, offset]()
+                       { glVertexArrayVertexBuffer(p_this->m_id, binding, p_buffer->getId(), offset, stride); });
+}
+
 void GlVertexArray::setIndexBuffer(ref<IndexBuffer> p_indexBuffer)
 {
     ref<GlVertexArray> p_this = this;
@@ -321,4 +324,66 @@ void GlVertexArray::setIndexBuffer(ref<IndexBuffer> p_indexBuffer)
     m_indexBuffer = p_indexBuffer;
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Private Functions
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+void GlVertexArray::_setupFormat(u32_t binding, const BufferFormat& format)
+{
+    for (const auto& component : format)
+    {
+        u32_t glType = Shader::s_getShaderType(std::get<0>(component.dataType));
+
+        if (component.type == BufferComponent::Type::perInstance)
+        {
+            // divisors belong to the binding, not the attribute
+            glVertexArrayBindingDivisor(m_id, binding, component.perInstance);
+        }
+
+        if (glType == GL_INT || glType == GL_UNSIGNED_INT || glType == GL_BOOL)
+        {
+            u32_t numOfComponent = std::get<2>(component.dataType);
+
+            glEnableVertexArrayAttrib(m_id, m_vertexBufferIndex);
+            glVertexArrayAttribIFormat(m_id, m_vertexBufferIndex, numOfComponent, glType, component.offset);
+            glVertexArrayAttribBinding(m_id, m_vertexBufferIndex, binding);
+
+            m_vertexBufferIndex++;
+        }
+        else if (glType == GL_FLOAT)
+        {
+            u32_t numOfComponent = std::get<2>(component.dataType);
+            u32_t columns        = 1;
+
+            u32_t numOfComponentsPerColumn = numOfComponent;
+            if (numOfComponent > 4)
+            {
+                // This is a matrix we must add a pointer for each
+                // column of the matrix
+                columns                  = static_cast<u32_t>(std::sqrt(numOfComponent));
+                numOfComponentsPerColumn = columns;  // matrix will always be square
+            }
+
+            for (u32_t i = 0; i < columns; i++)
+            {
+                u32_t offset = component.offset + (sizeof(f32_t) * numOfComponentsPerColumn * i);
+
+                glEnableVertexArrayAttrib(m_id, m_vertexBufferIndex);
+                glVertexArrayAttribFormat(m_id,
+                                          m_vertexBufferIndex,
+                                          numOfComponentsPerColumn,
+                                          glType,
+                                          component.normalized ? GL_TRUE : GL_FALSE,
+                                          offset);
+                glVertexArrayAttribBinding(m_id, m_vertexBufferIndex, binding);
+
+                m_vertexBufferIndex++;
+            }
+        }
+        else
+        {
+            NB_CORE_ASSERT(0, "Unknown ShaderDataType!");
+        }
+    }
+}
+
 };  // namespace nimbus
\ No newline at end of file
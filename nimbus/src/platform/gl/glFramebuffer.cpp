@@ -43,7 +43,7 @@ GlFramebuffer::~GlFramebuffer()
     u32_t id    = m_fbo;
     u32_t rboId = m_rbo;
 
-    Renderer::s_submitObject(
+    Renderer::s_submitRetire(
         [id, rboId]()
         {
             glDeleteFramebuffers(1, &id);
@@ -135,7 +135,7 @@ void GlFramebuffer::bind(Mode mode) const
     u32_t height = m_spec.height;
 
     Renderer::s_submit(
-        [id, mode, width, height]()
+        [id, mode]()
         {
             switch (mode)
             {
@@ -155,9 +155,9 @@ void GlFramebuffer::bind(Mode mode) const
                     break;
                 }
             }
-
-            glViewport(0, 0, width, height);
         });
+
+    GraphicsApi::setViewportSize(0, 0, width, height);
 }
 
 void GlFramebuffer::unbind(Mode mode) const
@@ -11,6 +11,35 @@
 namespace nimbus
 {
 
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Render thread's view of the bindings the packets change, used to drop the ones that wouldn't change anything.
+// Callbacks can touch any GL state so the command queue invalidates this after running one (see RenderCmdQ::pump).
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+struct GlStateCache
+{
+    inline static const u32_t k_unknown      = 0xFFFFFFFF;
+    inline static const u32_t k_textureUnits = 32;  // units past this are never cached
+
+    u32_t program     = k_unknown;
+    u32_t vertexArray = k_unknown;
+    u32_t activeUnit  = k_unknown;
+    u32_t blendSrc    = k_unknown;
+    u32_t blendDst    = k_unknown;
+    u32_t depthTest   = k_unknown;
+    u32_t polygonMode = k_unknown;
+
+    u32_t textureTargets[k_textureUnits];
+    u32_t textures[k_textureUnits];
+
+    GlStateCache()
+    {
+        std::fill_n(textureTargets, k_textureUnits, k_unknown);
+        std::fill_n(textures, k_textureUnits, k_unknown);
+    }
+};
+
+static GlStateCache s_stateCache;
+
 void GlGraphicsApi::init()
 {
     NB_PROFILE_DETAIL();
@@ -24,7 +53,7 @@ void GlGraphicsApi::init()
     Log::coreInfo("Renderer: %s", glGetString(GL_RENDERER));
     Log::coreInfo("Version:  %s", glGetString(GL_VERSION));
 
-    if (s_depthTest)
+    if (s_depthTest.load(std::memory_order_relaxed))
     {
         glEnable(GL_DEPTH_TEST);
     }
@@ -58,7 +87,7 @@ void GlGraphicsApi::init()
     Log::coreInfo("Max number of Texture Units: supported: %i", Texture::s_getMaxTextures());
 }
 
-void GlGraphicsApi::drawElements(ref<VertexArray> p_vertexArray, u32_t vertexCount)
+void GlGraphicsApi::drawElements(const ref<VertexArray>& p_vertexArray, u32_t vertexCount)
 {
     NB_PROFILE_DETAIL();
     u32_t count = vertexCount ? vertexCount : p_vertexArray->getIndexBuffer()->getCount();
@@ -66,19 +95,22 @@ void GlGraphicsApi::drawElements(ref<VertexArray> p_vertexArray, u32_t vertexCou
     p_vertexArray->bind();
     u32_t type = p_vertexArray->getIndexBuffer()->getType();
 
-    Renderer::s_submit([count, type]() { glDrawElements(GL_TRIANGLES, count, type, nullptr); });
+    Renderer::s_submitPacket(RenderCmdOp::drawElements, renderCmd::Draw{count, type, 0});
 }
 
-void GlGraphicsApi::drawArrays(ref<VertexArray> p_vertexArray, u32_t vertexCount)
+void GlGraphicsApi::drawArrays(const ref<VertexArray>& p_vertexArray, u32_t vertexCount)
 {
     NB_PROFILE_DETAIL();
     u32_t count = vertexCount ? vertexCount : p_vertexArray->getExpectedVertexCount();
 
     p_vertexArray->bind();
-    Renderer::s_submit([count]() { glDrawArrays(GL_TRIANGLES, 0, count); });
+
+    Renderer::s_submitPacket(RenderCmdOp::drawArrays, renderCmd::Draw{count, 0, 0});
 }
 
-void GlGraphicsApi::drawElementsInstanced(ref<VertexArray> p_vertexArray, u32_t instanceCount, u32_t vertexCount)
+void GlGraphicsApi::drawElementsInstanced(const ref<VertexArray>& p_vertexArray,
+                                          u32_t                   instanceCount,
+                                          u32_t                   vertexCount)
 {
     NB_PROFILE_DETAIL();
     u32_t count = vertexCount ? vertexCount : p_vertexArray->getIndexBuffer()->getCount();
@@ -86,18 +118,19 @@ void GlGraphicsApi::drawElementsInstanced(ref<VertexArray> p_vertexArray, u32_t
     p_vertexArray->bind();
     u32_t type = p_vertexArray->getIndexBuffer()->getType();
 
-    Renderer::s_submit([count, instanceCount, type]()
-                       { glDrawElementsInstanced(GL_TRIANGLES, count, type, nullptr, instanceCount); });
+    Renderer::s_submitPacket(RenderCmdOp::drawElements, renderCmd::Draw{count, type, instanceCount});
 }
 
-void GlGraphicsApi::drawArraysInstanced(ref<VertexArray> p_vertexArray, u32_t instanceCount, u32_t vertexCount)
+void GlGraphicsApi::drawArraysInstanced(const ref<VertexArray>& p_vertexArray,
+                                        u32_t                   instanceCount,
+                                        u32_t                   vertexCount)
 {
     NB_PROFILE_DETAIL();
     u32_t count = vertexCount ? vertexCount : p_vertexArray->getExpectedVertexCount();
 
     p_vertexArray->bind();
 
-    Renderer::s_submit([count, instanceCount]() { glDrawArraysInstanced(GL_TRIANGLES, 0, count, instanceCount); });
+    Renderer::s_submitPacket(RenderCmdOp::drawArrays, renderCmd::Draw{count, 0, instanceCount});
 }
 
 void GlGraphicsApi::clear()
@@ -116,6 +149,8 @@ void GlGraphicsApi::clearColor(glm::vec4 color)
 
 void GlGraphicsApi::setViewportSize(int x, int y, int w, int h)
 {
+    s_viewport = glm::ivec4(x, y, w, h);
+
     Renderer::s_submit([x, y, w, h]() { glViewport(x, y, w, h); });
 }
 
@@ -123,68 +158,25 @@ void GlGraphicsApi::setWireframe(bool on)
 {
     NB_PROFILE_TRACE();
 
-    if (on == s_wireframe)
-    {
-        return;
-    }
+    // always recorded, the render thread drops the redundant ones like it does blending modes
+    s_wireframe.store(on, std::memory_order_relaxed);
 
-    if (!on)
-    {
-        Renderer::s_submit(
-            []()
-            {
-                glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
-                s_wireframe = false;
-            });
-    }
-    else
-    {
-        Renderer::s_submit(
-            []()
-            {
-                glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
-                s_wireframe = true;
-            });
-    }
+    Renderer::s_submitPacket(RenderCmdOp::polygonMode, renderCmd::PolygonMode{on ? GL_LINE : GL_FILL});
 }
 
 void GlGraphicsApi::setDepthTest(bool on)
 {
     NB_PROFILE_TRACE();
 
-    if (on == s_depthTest)
-    {
-        return;
-    }
+    s_depthTest.store(on, std::memory_order_relaxed);
 
-    if (!on)
-    {
-        Renderer::s_submit(
-            []()
-            {
-                glDisable(GL_DEPTH_TEST);
-                s_depthTest = false;
-            });
-    }
-    else
-    {
-        Renderer::s_submit(
-            []()
-            {
-                glEnable(GL_DEPTH_TEST);
-                s_depthTest = true;
-            });
-    }
+    Renderer::s_submitPacket(RenderCmdOp::depthTest, renderCmd::DepthTest{on ? 1u : 0u});
 }
 
 void GlGraphicsApi::setBlendingMode(GraphicsApi::BlendingMode mode)
 {
-    if (mode == s_currBlendingMode)
-    {
-        // no reason to switch to same value
-        return;
-    }
-
+    // Always recorded, command lists can be recorded on any thread and run in a different order than they were
+    // recorded in so only the render thread knows what the current mode is. It drops the redundant ones.
     u32_t sFactor = GL_NONE;
     u32_t dFactor = GL_NONE;
     switch (mode)
@@ -225,9 +217,270 @@ void GlGraphicsApi::setBlendingMode(GraphicsApi::BlendingMode mode)
             NB_CORE_ASSERT_STATIC(0, "Invalid blending mode %i", mode);
     }
 
-    s_currBlendingMode = mode;
+    s_currBlendingMode.store(mode, std::memory_order_relaxed);
+
+    Renderer::s_submitPacket(RenderCmdOp::blendFunc, renderCmd::BlendFunc{sFactor, dFactor});
+}
+
+GraphicsApi::StateStats GlGraphicsApi::getStateStats()
+{
+    StateStats stats;
+    stats.issued  = s_frameStateIssued.load(std::memory_order_relaxed);
+    stats.skipped = s_frameStateSkipped.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void GlGraphicsApi::invalidateStateCache()
+{
+    s_stateCache = GlStateCache();
+}
+
+u64_t GlGraphicsApi::fenceFrame()
+{
+    NB_PROFILE_DETAIL();
+
+    s_frameStateIssued.store(s_stateIssued, std::memory_order_relaxed);
+    s_frameStateSkipped.store(s_stateSkipped, std::memory_order_relaxed);
+    s_stateIssued  = 0;
+    s_stateSkipped = 0;
+
+    // Nothing waits on the GPU here, per frame resources (streaming buffer regions) wait on their frame's fence when
+    // they are about to be reused, which with a few regions is long done.
+    if (s_fencedFrames - s_gpuFrames == k_maxFrameFences)
+    {
+        _retireFences(s_gpuFrames + 1, UINT64_MAX);
+    }
+
+    sp_frameFences[s_fencedFrames % k_maxFrameFences] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    s_fencedFrames++;
 
-    Renderer::s_submit([sFactor, dFactor]() { glBlendFunc(sFactor, dFactor); });
+    return _retireFences(s_fencedFrames, 0);
+}
+
+u64_t GlGraphicsApi::waitForGpuFrames(u64_t frames)
+{
+    NB_PROFILE_DETAIL();
+
+    return _retireFences(frames, UINT64_MAX);
+}
+
+void GlGraphicsApi::executeCmd(RenderCmdOp op, const void* p_payload)
+{
+    switch (op)
+    {
+        case (RenderCmdOp::useProgram):
+        {
+            auto p_cmd = static_cast<const renderCmd::UseProgram*>(p_payload);
+            if (p_cmd->id == s_stateCache.program)
+            {
+                s_stateSkipped++;
+                break;
+            }
+
+            glUseProgram(p_cmd->id);
+            s_stateCache.program = p_cmd->id;
+            s_stateIssued++;
+            break;
+        }
+        case (RenderCmdOp::bindVertexArray):
+        {
+            auto p_cmd = static_cast<const renderCmd::BindVertexArray*>(p_payload);
+            if (p_cmd->id == s_stateCache.vertexArray)
+            {
+                s_stateSkipped++;
+                break;
+            }
+
+            glBindVertexArray(p_cmd->id);
+            s_stateCache.vertexArray = p_cmd->id;
+            s_stateIssued++;
+            break;
+        }
+        case (RenderCmdOp::bindBuffer):
+        {
+            auto p_cmd = static_cast<const renderCmd::BindBuffer*>(p_payload);
+            glBindBuffer(p_cmd->target, p_cmd->id);
+            break;
+        }
+        case (RenderCmdOp::vertexArrayBuffer):
+        {
+            auto p_cmd = static_cast<const renderCmd::VertexArrayBuffer*>(p_payload);
+            glVertexArrayVertexBuffer(p_cmd->vertexArray, p_cmd->binding, p_cmd->buffer, p_cmd->offset, p_cmd->stride);
+            break;
+        }
+        case (RenderCmdOp::bindBufferRange):
+        {
+            auto p_cmd = static_cast<const renderCmd::BindBufferRange*>(p_payload);
+            glBindBufferRange(p_cmd->target, p_cmd->index, p_cmd->buffer, p_cmd->offset, p_cmd->size);
+            break;
+        }
+        case (RenderCmdOp::copyBuffer):
+        {
+            auto p_cmd = static_cast<const renderCmd::CopyBuffer*>(p_payload);
+            glCopyNamedBufferSubData(p_cmd->src, p_cmd->dst, p_cmd->srcOffset, p_cmd->dstOffset, p_cmd->size);
+            break;
+        }
+        case (RenderCmdOp::bindTexture):
+        {
+            auto p_cmd  = static_cast<const renderCmd::BindTexture*>(p_payload);
+            bool cached = p_cmd->unit < GlStateCache::k_textureUnits;
+            if (cached && s_stateCache.textures[p_cmd->unit] == p_cmd->id
+                && s_stateCache.textureTargets[p_cmd->unit] == p_cmd->target)
+            {
+                s_stateSkipped++;
+                break;
+            }
+
+            if (p_cmd->unit != s_stateCache.activeUnit)
+            {
+                glActiveTexture(GL_TEXTURE0 + p_cmd->unit);
+                s_stateCache.activeUnit = p_cmd->unit;
+            }
+            glBindTexture(p_cmd->target, p_cmd->id);
+
+            if (cached)
+            {
+                s_stateCache.textures[p_cmd->unit]       = p_cmd->id;
+                s_stateCache.textureTargets[p_cmd->unit] = p_cmd->target;
+            }
+            s_stateIssued++;
+            break;
+        }
+        case (RenderCmdOp::uniformInt):
+        {
+            auto p_cmd  = static_cast<const renderCmd::Uniform*>(p_payload);
+            auto p_data = reinterpret_cast<const GLint*>(p_cmd + 1);
+            glUniform1iv(p_cmd->location, p_cmd->count, p_data);
+            break;
+        }
+        case (RenderCmdOp::uniformFloat):
+        {
+            auto p_cmd  = static_cast<const renderCmd::Uniform*>(p_payload);
+            auto p_data = reinterpret_cast<const GLfloat*>(p_cmd + 1);
+            glUniform1fv(p_cmd->location, p_cmd->count, p_data);
+            break;
+        }
+        case (RenderCmdOp::uniformVec2):
+        {
+            auto p_cmd  = static_cast<const renderCmd::Uniform*>(p_payload);
+            auto p_data = reinterpret_cast<const GLfloat*>(p_cmd + 1);
+            glUniform2fv(p_cmd->location, p_cmd->count, p_data);
+            break;
+        }
+        case (RenderCmdOp::uniformVec3):
+        {
+            auto p_cmd  = static_cast<const renderCmd::Uniform*>(p_payload);
+            auto p_data = reinterpret_cast<const GLfloat*>(p_cmd + 1);
+            glUniform3fv(p_cmd->location, p_cmd->count, p_data);
+            break;
+        }
+        case (RenderCmdOp::uniformVec4):
+        {
+            auto p_cmd  = static_cast<const renderCmd::Uniform*>(p_payload);
+            auto p_data = reinterpret_cast<const GLfloat*>(p_cmd + 1);
+            glUniform4fv(p_cmd->location, p_cmd->count, p_data);
+            break;
+        }
+        case (RenderCmdOp::uniformMat2):
+        {
+            auto p_cmd  = static_cast<const renderCmd::Uniform*>(p_payload);
+            auto p_data = reinterpret_cast<const GLfloat*>(p_cmd + 1);
+            glUniformMatrix2fv(p_cmd->location, p_cmd->count, GL_FALSE, p_data);
+            break;
+        }
+        case (RenderCmdOp::uniformMat3):
+        {
+            auto p_cmd  = static_cast<const renderCmd::Uniform*>(p_payload);
+            auto p_data = reinterpret_cast<const GLfloat*>(p_cmd + 1);
+            glUniformMatrix3fv(p_cmd->location, p_cmd->count, GL_FALSE, p_data);
+            break;
+        }
+        case (RenderCmdOp::uniformMat4):
+        {
+            auto p_cmd  = static_cast<const renderCmd::Uniform*>(p_payload);
+            auto p_data = reinterpret_cast<const GLfloat*>(p_cmd + 1);
+            glUniformMatrix4fv(p_cmd->location, p_cmd->count, GL_FALSE, p_data);
+            break;
+        }
+        case (RenderCmdOp::drawElements):
+        {
+            auto p_cmd = static_cast<const renderCmd::Draw*>(p_payload);
+            if (p_cmd->instanceCount)
+            {
+                glDrawElementsInstanced(GL_TRIANGLES, p_cmd->count, p_cmd->indexType, nullptr, p_cmd->instanceCount);
+            }
+            else
+            {
+                glDrawElements(GL_TRIANGLES, p_cmd->count, p_cmd->indexType, nullptr);
+            }
+            break;
+        }
+        case (RenderCmdOp::drawArrays):
+        {
+            auto p_cmd = static_cast<const renderCmd::Draw*>(p_payload);
+            if (p_cmd->instanceCount)
+            {
+                glDrawArraysInstanced(GL_TRIANGLES, 0, p_cmd->count, p_cmd->instanceCount);
+            }
+            else
+            {
+                glDrawArrays(GL_TRIANGLES, 0, p_cmd->count);
+            }
+            break;
+        }
+        case (RenderCmdOp::blendFunc):
+        {
+            auto p_cmd = static_cast<const renderCmd::BlendFunc*>(p_payload);
+            if (p_cmd->srcFactor == s_stateCache.blendSrc && p_cmd->dstFactor == s_stateCache.blendDst)
+            {
+                s_stateSkipped++;
+                break;
+            }
+
+            glBlendFunc(p_cmd->srcFactor, p_cmd->dstFactor);
+            s_stateCache.blendSrc = p_cmd->srcFactor;
+            s_stateCache.blendDst = p_cmd->dstFactor;
+            s_stateIssued++;
+            break;
+        }
+        case (RenderCmdOp::depthTest):
+        {
+            auto p_cmd = static_cast<const renderCmd::DepthTest*>(p_payload);
+            if (p_cmd->enabled == s_stateCache.depthTest)
+            {
+                s_stateSkipped++;
+                break;
+            }
+
+            if (p_cmd->enabled)
+            {
+                glEnable(GL_DEPTH_TEST);
+            }
+            else
+            {
+                glDisable(GL_DEPTH_TEST);
+            }
+            s_stateCache.depthTest = p_cmd->enabled;
+            s_stateIssued++;
+            break;
+        }
+        case (RenderCmdOp::polygonMode):
+        {
+            auto p_cmd = static_cast<const renderCmd::PolygonMode*>(p_payload);
+            if (p_cmd->mode == s_stateCache.polygonMode)
+            {
+                s_stateSkipped++;
+                break;
+            }
+
+            glPolygonMode(GL_FRONT_AND_BACK, p_cmd->mode);
+            s_stateCache.polygonMode = p_cmd->mode;
+            s_stateIssued++;
+            break;
+        }
+        default:
+            NB_CORE_ASSERT_STATIC(false, "Unknown render command op %i", op);
+    }
 }
 
 static void APIENTRY _glDebugOutput(GLenum       source,
@@ -317,6 +570,28 @@ static void APIENTRY _glDebugOutput(GLenum       source,
     }
 }
 
+u64_t GlGraphicsApi::_retireFences(u64_t frames, u64_t timeoutNs)
+{
+    // fences signal in order, the first one that hasn't stops the rest being checked
+    while (s_gpuFrames < frames && s_gpuFrames < s_fencedFrames)
+    {
+        GLsync fence = static_cast<GLsync>(sp_frameFences[s_gpuFrames % k_maxFrameFences]);
+
+        GLenum result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, timeoutNs);
+        if (result == GL_TIMEOUT_EXPIRED)
+        {
+            break;
+        }
+
+        NB_CORE_ASSERT_STATIC(result != GL_WAIT_FAILED, "Failed waiting on frame fence!");
+
+        glDeleteSync(fence);
+        s_gpuFrames++;
+    }
+
+    return s_gpuFrames;
+}
+
 void GlGraphicsApi::_enableGlErrPrint()
 {
     Log::coreInfo("GL Debug Enabled");
@@ -68,7 +68,8 @@ GlShader::~GlShader()
 {
     NB_PROFILE_DETAIL();
 
-    glDeleteProgram(m_id);
+    u32_t id = m_id;
+    Renderer::s_submitRetire([id]() { glDeleteProgram(id); });
 }
 
 const std::string& GlShader::getVertexPath() const
@@ -91,9 +92,7 @@ bool GlShader::bind() const
         return false;
     }
 
-    ref<GlShader> p_this = const_cast<GlShader*>(this);
-
-    Renderer::s_submit([p_this]() { glUseProgram(p_this->m_id); });
+    Renderer::s_submitPacket(RenderCmdOp::useProgram, renderCmd::UseProgram{m_id});
 
     return true;
 }
@@ -101,131 +100,103 @@ bool GlShader::bind() const
 // utility uniform functions
 void GlShader::setBool(const std::string& name, bool value) const
 {
-    u32_t id = _getUniformLocation(name);
-
-    Renderer::s_submit([id, value]() { glUniform1i(id, (GLuint)value); });
+    i32_t intValue = value;
+    _setUniform(RenderCmdOp::uniformInt, name, &intValue, sizeof(intValue), 1);
 }
 
 void GlShader::setInt(const std::string& name, const std::vector<i32_t>& value, u32_t count) const
 {
-    u32_t id = _getUniformLocation(name);
-    Renderer::s_submit([id, value, count]() { glUniform1iv(id, count, reinterpret_cast<const GLint*>(value.data())); });
+    _setUniform(RenderCmdOp::uniformInt, name, value.data(), sizeof(i32_t), count);
 }
 
 void GlShader::setInt(const std::string& name, i32_t value) const
 {
-    u32_t id = _getUniformLocation(name);
-    Renderer::s_submit([id, value]() { glUniform1i(id, value); });
+    _setUniform(RenderCmdOp::uniformInt, name, &value, sizeof(value), 1);
 }
 
 void GlShader::setFloat(const std::string& name, const std::vector<f32_t>& value, u32_t count) const
 {
-    u32_t id = _getUniformLocation(name);
-    Renderer::s_submit([id, value, count]()
-                       { glUniform1fv(id, count, reinterpret_cast<const GLfloat*>(value.data())); });
+    _setUniform(RenderCmdOp::uniformFloat, name, value.data(), sizeof(f32_t), count);
 }
 
 void GlShader::setFloat(const std::string& name, f32_t value) const
 {
-    u32_t id = _getUniformLocation(name);
-    Renderer::s_submit([id, value]() { glUniform1f(id, value); });
+    _setUniform(RenderCmdOp::uniformFloat, name, &value, sizeof(value), 1);
 }
 
 void GlShader::setVec2(const std::string& name, const std::vector<glm::vec2>& value, u32_t count) const
 {
-    u32_t id = _getUniformLocation(name);
-    Renderer::s_submit([id, value, count]()
-                       { glUniform2fv(id, count, reinterpret_cast<const GLfloat*>(value.data())); });
+    _setUniform(RenderCmdOp::uniformVec2, name, value.data(), sizeof(glm::vec2), count);
 }
 
 void GlShader::setVec2(const std::string& name, const glm::vec2& value) const
 {
-    u32_t id = _getUniformLocation(name);
-    Renderer::s_submit([id, value]() { glUniform2fv(id, 1, glm::value_ptr(value)); });
+    _setUniform(RenderCmdOp::uniformVec2, name, glm::value_ptr(value), sizeof(value), 1);
 }
 
 void GlShader::setVec2(const std::string& name, f32_t x, f32_t y) const
 {
-    u32_t id = _getUniformLocation(name);
-    Renderer::s_submit([id, x, y]() { glUniform2f(id, x, y); });
+    setVec2(name, glm::vec2(x, y));
 }
 
 void GlShader::setVec3(const std::string& name, const std::vector<glm::vec3>& value, u32_t count) const
 {
-    u32_t id = _getUniformLocation(name);
-    Renderer::s_submit([id, value, count]()
-                       { glUniform3fv(id, count, reinterpret_cast<const GLfloat*>(value.data())); });
+    _setUniform(RenderCmdOp::uniformVec3, name, value.data(), sizeof(glm::vec3), count);
 }
 
 void GlShader::setVec3(const std::string& name, const glm::vec3& value) const
 {
-    u32_t id = _getUniformLocation(name);
-    Renderer::s_submit([id, value]() { glUniform3fv(id, 1, glm::value_ptr(value)); });
+    _setUniform(RenderCmdOp::uniformVec3, name, glm::value_ptr(value), sizeof(value), 1);
 }
 
 void GlShader::setVec3(const std::string& name, f32_t x, f32_t y, f32_t z) const
 {
-    u32_t id = _getUniformLocation(name);
-    Renderer::s_submit([id, x, y, z]() { glUniform3f(id, x, y, z); });
+    setVec3(name, glm::vec3(x, y, z));
 }
 
 void GlShader::setVec4(const std::string& name, const std::vector<glm::vec4>& value, u32_t count) const
 {
-    u32_t id = _getUniformLocation(name);
-    Renderer::s_submit([id, value, count]()
-                       { glUniform4fv(id, count, reinterpret_cast<const GLfloat*>(value.data())); });
+    _setUniform(RenderCmdOp::uniformVec4, name, value.data(), sizeof(glm::vec4), count);
 }
 
 void GlShader::setVec4(const std::string& name, const glm::vec4& value) const
 {
-    u32_t id = _getUniformLocation(name);
-    Renderer::s_submit([id, value]() { glUniform4fv(id, 1, glm::value_ptr(value)); });
+    _setUniform(RenderCmdOp::uniformVec4, name, glm::value_ptr(value), sizeof(value), 1);
 }
 
 void GlShader::setVec4(const std::string& name, f32_t x, f32_t y, f32_t z, f32_t w) const
 {
-    u32_t id = _getUniformLocation(name);
-    Renderer::s_submit([id, x, y, z, w]() { glUniform4f(id, x, y, z, w); });
+    setVec4(name, glm::vec4(x, y, z, w));
 }
 
 void GlShader::setMat2(const std::string& name, const std::vector<glm::mat2>& value, u32_t count) const
 {
-    u32_t id = _getUniformLocation(name);
-    Renderer::s_submit([id, value, count]()
-                       { glUniformMatrix2fv(id, count, GL_FALSE, reinterpret_cast<const GLfloat*>(value.data())); });
+    _setUniform(RenderCmdOp::uniformMat2, name, value.data(), sizeof(glm::mat2), count);
 }
 
 void GlShader::setMat2(const std::string& name, const glm::mat2& mat) const
 {
-    u32_t id = _getUniformLocation(name);
-    Renderer::s_submit([id, mat]() { glUniformMatrix2fv(id, 1, GL_FALSE, glm::value_ptr(mat)); });
+    _setUniform(RenderCmdOp::uniformMat2, name, glm::value_ptr(mat), sizeof(mat), 1);
 }
 
 void GlShader::setMat3(const std::string& name, const std::vector<glm::mat3>& value, u32_t count) const
 {
-    u32_t id = _getUniformLocation(name);
-    Renderer::s_submit([id, value, count]()
-                       { glUniformMatrix3fv(id, count, GL_FALSE, reinterpret_cast<const GLfloat*>(value.data())); });
+    _setUniform(RenderCmdOp::uniformMat3, name, value.data(), sizeof(glm::mat3), count);
 }
 
 void GlShader::setMat3(const std::string& name, const glm::mat3& mat) const
 {
-    u32_t id = _getUniformLocation(name);
-    Renderer::s_submit([id, mat]() { glUniformMatrix3fv(id, 1, GL_FALSE, glm::value_ptr(mat)); });
+    _setUniform(RenderCmdOp::uniformMat3, name, glm::value_ptr(mat), sizeof(mat), 1);
 }
 
 void GlShader::setMat4(const std::string& name, const std::vector<glm::mat4>& value, u32_t count) const
 {
-    u32_t id = _getUniformLocation(name);
-    Renderer::s_submit([id, value, count]()
-                       { glUniformMatrix4fv(id, count, GL_FALSE, reinterpret_cast<const GLfloat*>(value.data())); });
+    _setUniform(RenderCmdOp::uniformMat4, name, value.data(), sizeof(glm::mat4), count);
 }
 
 void GlShader::setMat4(const std::string& name, const glm::mat4& mat) const
 {
-    u32_t id = _getUniformLocation(name);
-
-    Renderer::s_submit([id, mat]() { glUniformMatrix4fv(id, 1, GL_FALSE, glm::value_ptr(mat)); });
+    _setUniform(RenderCmdOp::uniformMat4, name, glm::value_ptr(mat), sizeof(mat), 1);
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -347,6 +318,24 @@ void GlShader::_compileShader(const std::string& vertexSource, const std::string
         });
 }
 
+void GlShader::_setUniform(RenderCmdOp        op,
+                           const std::string& name,
+                           const void*        p_data,
+                           u32_t              elementSize,
+                           u32_t              count) const
+{
+    NB_PROFILE_TRACE();
+
+    u32_t dataSize = elementSize * count;
+
+    // the values are copied in behind the packet so nothing has to be kept alive for the render thread
+    void* p_slot    = Renderer::s_submitPacket(op, sizeof(renderCmd::Uniform) + dataSize);
+    auto  p_cmd     = static_cast<renderCmd::Uniform*>(p_slot);
+    p_cmd->location = _getUniformLocation(name);
+    p_cmd->count    = count;
+    memcpy(p_cmd + 1, p_data, dataSize);
+}
+
 i32_t GlShader::_getUniformLocation(const std::string& name) const
 {
     NB_PROFILE_TRACE();
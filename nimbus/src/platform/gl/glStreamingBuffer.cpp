@@ -0,0 +1,265 @@
+#include "nimbus/core/nmpch.hpp"
+#include "nimbus/core/core.hpp"
+
+#include "nimbus/platform/gl/glStreamingBuffer.hpp"
+#include "nimbus/platform/gl/glBuffer.hpp"
+#include "nimbus/renderer/renderer.hpp"
+
+#include "glad.h"
+
+namespace nimbus
+{
+
+// keeps every region start aligned for any allocation alignment up to this
+inline static const u32_t k_regionAlign = 256;
+
+GlStreamingBuffer::GlStreamingBuffer(u32_t regionSize)
+{
+    std::lock_guard<std::mutex> lock(m_regionMtx);
+
+    _grow(regionSize);
+    _replaceRegion(s_frame.load(std::memory_order_acquire), 0);
+}
+
+GlStreamingBuffer::~GlStreamingBuffer()
+{
+    ref<Storage> p_storage = mp_storage;
+    Renderer::s_submitRetire([p_storage]() { glDeleteBuffers(1, &p_storage->id); });
+}
+
+StreamingBuffer::Allocation GlStreamingBuffer::allocate(u32_t size, u32_t alignment)
+{
+    NB_CORE_ASSERT(alignment && (alignment & (alignment - 1)) == 0 && alignment <= k_regionAlign,
+                   "Alignment (%i) must be a power of 2 <= %i",
+                   alignment,
+                   k_regionAlign);
+
+    u64_t frame = s_frame.load(std::memory_order_acquire);
+
+    // room for the worst case padding, so the bump doesn't depend on where the last allocation ended
+    u32_t padded = size + alignment - 1;
+
+    Region* p_region = mp_region.load(std::memory_order_acquire);
+    u32_t   offset   = 0;
+    while (true)
+    {
+        if (p_region->frame == frame)
+        {
+            u32_t start = p_region->offset.fetch_add(padded, std::memory_order_relaxed);
+            offset      = (start + alignment - 1) & ~(alignment - 1);
+            if (start + padded <= p_region->size)
+            {
+                break;
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(m_regionMtx);
+
+        // another thread may have replaced it while this one waited
+        if (mp_region.load(std::memory_order_relaxed) == p_region)
+        {
+            _replaceRegion(frame, padded);
+        }
+
+        p_region = mp_region.load(std::memory_order_relaxed);
+    }
+
+    Allocation allocation;
+    allocation.offset   = p_region->base + offset;
+    allocation.size     = size;
+    allocation.p_handle = p_region->p_storage.raw();
+
+    u8_t* p_mapped = p_region->p_storage->p_mapped.load(std::memory_order_acquire);
+    if (p_mapped)
+    {
+        allocation.p_data = p_mapped + allocation.offset;
+    }
+    else
+    {
+        // Not mapped until the render thread has created it, stage on the CPU and upload before the draws recorded
+        // after this. The storage may be created by another thread's command list, so this goes after every object
+        // queue of the frame rather than into one of them.
+        void* p_staging   = malloc(size);
+        allocation.p_data = p_staging;
+
+        ref<Storage> p_storage = p_region->p_storage;
+        u32_t        dstOffset = allocation.offset;
+        Renderer::s_submit(
+            [p_storage, p_staging, dstOffset, size]()
+            {
+                glNamedBufferSubData(p_storage->id, dstOffset, size, p_staging);
+                free(p_staging);
+            });
+    }
+
+    s_bytesThisFrame.fetch_add(size, std::memory_order_relaxed);
+
+    return allocation;
+}
+
+void GlStreamingBuffer::bindVertexBuffer(const ref<VertexArray>& p_vertexArray,
+                                         u32_t                   binding,
+                                         u32_t                   stride,
+                                         const Allocation&       allocation)
+{
+    NB_CORE_ASSERT(allocation.p_handle, "Binding an empty allocation!");
+
+    ref<Storage> p_storage = static_cast<Storage*>(allocation.p_handle);
+    u32_t        offset    = allocation.offset;
+
+    const GlVertexArray* p_glVertexArray = static_cast<const GlVertexArray*>(p_vertexArray.raw());
+
+    if (p_glVertexArray->isCreated() && p_storage->p_mapped.load(std::memory_order_acquire))
+    {
+        Renderer::s_submitPacket(
+            RenderCmdOp::vertexArrayBuffer,
+            renderCmd::VertexArrayBuffer{p_glVertexArray->getId(), binding, p_storage->id, offset, stride});
+        return;
+    }
+
+    // ids aren't known until the object queue has run, resolve them on the render thread
+    ref<VertexArray> p_vao = p_vertexArray;
+
+    Renderer::s_submit([p_vao, p_storage, binding, offset, stride]()
+                       { glVertexArrayVertexBuffer(p_vao->getId(), binding, p_storage->id, offset, stride); });
+}
+
+void GlStreamingBuffer::bindUniformBuffer(u32_t binding, const Allocation& allocation)
+{
+    NB_CORE_ASSERT(allocation.p_handle, "Binding an empty allocation!");
+    NB_CORE_ASSERT((allocation.offset % k_uniformAlign) == 0, "Uniform buffer allocations need k_uniformAlign!");
+
+    ref<Storage> p_storage = static_cast<Storage*>(allocation.p_handle);
+    u32_t        offset    = allocation.offset;
+    u32_t        size      = allocation.size;
+
+    if (p_storage->p_mapped.load(std::memory_order_acquire))
+    {
+        Renderer::s_submitPacket(RenderCmdOp::bindBufferRange,
+                                 renderCmd::BindBufferRange{GL_UNIFORM_BUFFER, binding, p_storage->id, offset, size});
+        return;
+    }
+
+    Renderer::s_submit([p_storage, binding, offset, size]()
+                       { glBindBufferRange(GL_UNIFORM_BUFFER, binding, p_storage->id, offset, size); });
+}
+
+void GlStreamingBuffer::bindStorageBuffer(u32_t binding, const Allocation& allocation)
+{
+    NB_CORE_ASSERT(allocation.p_handle, "Binding an empty allocation!");
+    NB_CORE_ASSERT((allocation.offset % k_uniformAlign) == 0, "Storage buffer allocations need k_uniformAlign!");
+
+    ref<Storage> p_storage = static_cast<Storage*>(allocation.p_handle);
+    u32_t        offset    = allocation.offset;
+    u32_t        size      = allocation.size;
+
+    if (p_storage->p_mapped.load(std::memory_order_acquire))
+    {
+        Renderer::s_submitPacket(
+            RenderCmdOp::bindBufferRange,
+            renderCmd::BindBufferRange{GL_SHADER_STORAGE_BUFFER, binding, p_storage->id, offset, size});
+        return;
+    }
+
+    Renderer::s_submit([p_storage, binding, offset, size]()
+                       { glBindBufferRange(GL_SHADER_STORAGE_BUFFER, binding, p_storage->id, offset, size); });
+}
+
+void GlStreamingBuffer::copyToBuffer(const Allocation&        allocation,
+                                     u32_t                    offset,
+                                     u32_t                    size,
+                                     const ref<VertexBuffer>& p_vertexBuffer,
+                                     u32_t                    dstOffset)
+{
+    NB_CORE_ASSERT(allocation.p_handle, "Copying from an empty allocation!");
+    NB_CORE_ASSERT(offset + size <= allocation.size, "Copy of %i bytes at %i is outside the allocation", size, offset);
+
+    ref<Storage> p_storage = static_cast<Storage*>(allocation.p_handle);
+    u32_t        srcOffset = allocation.offset + offset;
+
+    const GlVertexBuffer* p_glVertexBuffer = static_cast<const GlVertexBuffer*>(p_vertexBuffer.raw());
+
+    if (p_glVertexBuffer->isCreated() && p_storage->p_mapped.load(std::memory_order_acquire))
+    {
+        Renderer::s_submitPacket(
+            RenderCmdOp::copyBuffer,
+            renderCmd::CopyBuffer{p_storage->id, p_glVertexBuffer->getId(), srcOffset, dstOffset, size});
+        return;
+    }
+
+    // ids aren't known until the object queue has run, resolve them on the render thread
+    ref<VertexBuffer> p_dst = p_vertexBuffer;
+
+    Renderer::s_submit([p_storage, p_dst, srcOffset, dstOffset, size]()
+                       { glCopyNamedBufferSubData(p_storage->id, p_dst->getId(), srcOffset, dstOffset, size); });
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Private Functions
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+void GlStreamingBuffer::_replaceRegion(u64_t frame, u32_t minSize)
+{
+    Region* p_current = mp_region.load(std::memory_order_relaxed);
+    if (p_current && p_current->frame == frame)
+    {
+        // full, the new storage has nothing from this frame in it yet
+        _grow(minSize);
+    }
+    else if (minSize > m_regionSize)
+    {
+        _grow(minSize);
+    }
+    else if (frame >= k_regionCount)
+    {
+        // the region was last written k_regionCount frames ago, usually long done on the GPU
+        Renderer::s_waitForGpu(frame + 1 - k_regionCount);
+    }
+
+    // nothing from two frames back is looked at any more, every allocating thread finished before the swap
+    std::erase_if(m_regions, [frame](const ref<Region>& p_region) { return p_region->frame + 1 < frame; });
+
+    ref<Region> p_region = ref<Region>::gen();
+    p_region->p_storage  = mp_storage;
+    p_region->frame      = frame;
+    p_region->base       = static_cast<u32_t>(frame % k_regionCount) * m_regionSize;
+    p_region->size       = m_regionSize;
+
+    m_regions.push_back(p_region);
+    mp_region.store(p_region.raw(), std::memory_order_release);
+}
+
+void GlStreamingBuffer::_grow(u32_t minRegionSize)
+{
+    u32_t regionSize = std::max(m_regionSize * 2, minRegionSize);
+    regionSize       = (regionSize + k_regionAlign - 1) & ~(k_regionAlign - 1);
+
+    if (mp_storage)
+    {
+        // allocations already made this frame still point at it through their region
+        ref<Storage> p_oldStorage = mp_storage;
+        Renderer::s_submitRetire([p_oldStorage]() { glDeleteBuffers(1, &p_oldStorage->id); });
+
+        Log::coreInfo("Streaming buffer region grown from %i to %i bytes", m_regionSize, regionSize);
+    }
+
+    m_regionSize     = regionSize;
+    mp_storage       = ref<Storage>::gen();
+    mp_storage->size = regionSize * k_regionCount;
+
+    ref<Storage> p_storage = mp_storage;
+    Renderer::s_submitObject(
+        [p_storage]()
+        {
+            GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+            glCreateBuffers(1, &p_storage->id);
+
+            // dynamic storage so staged allocations can be uploaded
+            glNamedBufferStorage(p_storage->id, p_storage->size, nullptr, flags | GL_DYNAMIC_STORAGE_BIT);
+
+            void* p_mapped = glMapNamedBufferRange(p_storage->id, 0, p_storage->size, flags);
+            p_storage->p_mapped.store(static_cast<u8_t*>(p_mapped), std::memory_order_release);
+        });
+}
+
+}  // namespace nimbus
@@ -2,6 +2,9 @@
 #include "nimbus/core/core.hpp"
 
 #include "nimbus/platform/gl/glTexture.hpp"
+#include "nimbus/platform/gl/glStreamingBuffer.hpp"
+#include "nimbus/platform/gl/glTextureArray.hpp"
+#include "nimbus/core/jobSystem.hpp"
 #include "nimbus/renderer/renderer.hpp"
 
 #include "stb_image.h"
@@ -10,6 +13,42 @@
 namespace nimbus
 {
 
+// Pixels uploaded through the streaming buffer per frame, at least a row goes each frame. Images bigger than this go
+// in slices of rows over several frames, so the streaming buffer never has to grow to fit a whole image.
+inline static const u32_t k_uploadBudgetBytes = (2 << 20);
+
+// decoded on the job system, waiting for the main thread to start their upload
+struct DecodedImage
+{
+    GlTexture* p_texture  = nullptr;  // kept alive by s_loadingTextures
+    u8_t*      p_pixels   = nullptr;
+    i32_t      width      = 0;
+    i32_t      height     = 0;
+    i32_t      components = 0;
+};
+
+// main thread, an image part way through being uploaded
+struct PendingUpload
+{
+    ref<GlTexture> p_texture = nullptr;
+    u8_t*          p_pixels  = nullptr;
+    u32_t          rowBytes  = 0;
+    u32_t          nextRow   = 0;
+};
+
+static std::mutex                     s_decodedMtx;
+static std::vector<DecodedImage>      s_decodedImages;
+static std::vector<JobSystem::Handle> s_decodeJobs;
+
+// Textures being decoded. The jobs only see raw pointers so the last ref is never dropped on a worker, these are
+// released on the main thread once the upload has a ref of its own or the decode failed.
+static std::vector<ref<GlTexture>> s_loadingTextures;
+
+static std::vector<PendingUpload> s_pendingUploads;
+
+// main thread, textures whose layer view is being made
+static std::vector<ref<GlTexture>> s_viewingTextures;
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Public Functions
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -25,86 +64,45 @@ GlTexture::GlTexture(const Type type, const std::string& path, const bool flipOn
                    "s_maxTextures not initialized. Did you call "
                    "Texture::s_setMaxTextures?");
 
-    stbi_set_flip_vertically_on_load(m_flipOnLoad);
+    // decode off the main thread, s_processLoads picks it up from there
+    GlTexture* p_this = this;
+    {
+        std::lock_guard<std::mutex> lock(s_decodedMtx);
+        s_loadingTextures.push_back(this);
+    }
 
-    i32_t numComponents;
+    JobSystem::Handle job = JobSystem::s_submit(
+        [p_this, path, flipOnLoad]()
+        {
+            NB_PROFILE_DETAIL();
 
-    u8_t* data = stbi_load(m_path.c_str(), (int*)&m_spec.width, (int*)&m_spec.height, &numComponents, 0);
+            DecodedImage image;
+            image.p_texture = p_this;
 
-    if (data)
-    {
-        if (numComponents == 1)
-        {
-            m_spec.format         = Format::red;
-            m_spec.formatInternal = FormatInternal::r8;
-        }
-        else if (numComponents == 3)
-        {
-            m_spec.format         = Format::rgb;
-            m_spec.formatInternal = FormatInternal::rgb8;
-        }
-        else if (numComponents == 4)
-        {
-            m_spec.format         = Format::rgba;
-            m_spec.formatInternal = FormatInternal::rgba8;
-        }
-        else
-        {
-            NB_CORE_ASSERT(0, "Unknown image format has %i components", numComponents);
-        }
+            stbi_set_flip_vertically_on_load_thread(flipOnLoad);
+            image.p_pixels = stbi_load(path.c_str(), &image.width, &image.height, &image.components, 0);
 
-        ref<GlTexture> p_this = this;
+            if (!image.p_pixels)
+            {
+                Log::coreError("Texture failed to load at path: %s", path.c_str());
+                p_this->m_state.store(State::failed, std::memory_order_release);
+                return;
+            }
 
-        Renderer::s_submitObject(
-            [p_this, data]() mutable
+            if (image.components != 1 && image.components != 3 && image.components != 4)
             {
-                _s_gen(p_this->m_id);
-                glBindTexture(GL_TEXTURE_2D, p_this->m_id);
-
-                // TODO, determine how to set this
-                p_this->m_spec.dataType      = DataType::unsignedByte_;
-                p_this->m_spec.filterTypeMin = FilterType::mipmapLinear;
-                p_this->m_spec.filterTypeMag = FilterType::linear;
-                p_this->m_spec.wrapTypeS     = WrapType::repeat;
-                p_this->m_spec.wrapTypeT     = WrapType::repeat;
-                p_this->m_spec.wrapTypeR     = WrapType::repeat;
-
-                // safety check for:
-                // If a non-zero named buffer object is bound to the
-                // GL_PIXEL_UNPACK_BUFFER target (see glBindBuffer) while a
-                // texture image is specified, data is treated as a byte offset
-                // into the buffer object's data store.
-                glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
-                glTexImage2D(GL_TEXTURE_2D,
-                             0,
-                             s_formatInternal(p_this->m_spec.formatInternal),
-                             p_this->m_spec.width,
-                             p_this->m_spec.height,
-                             0,
-                             s_format(p_this->m_spec.format),
-                             s_dataType(p_this->m_spec.dataType),
-                             data);
-                glGenerateMipmap(GL_TEXTURE_2D);
-
-                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, s_filterType(p_this->m_spec.filterTypeMin));
-                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, s_filterType(p_this->m_spec.filterTypeMag));
-                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, s_wrapType(p_this->m_spec.wrapTypeS));
-                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, s_wrapType(p_this->m_spec.wrapTypeT));
-                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_R, s_wrapType(p_this->m_spec.wrapTypeR));
-
-                stbi_image_free(data);
-
-                p_this->m_loaded = true;
-            });
+                Log::coreError("Unknown image format has %i components: %s", image.components, path.c_str());
+                stbi_image_free(image.p_pixels);
+                p_this->m_state.store(State::failed, std::memory_order_release);
+                return;
+            }
+
+            std::lock_guard<std::mutex> lock(s_decodedMtx);
+            s_decodedImages.push_back(std::move(image));
+        });
 
-        // renderDoneFuture.wait();
-    }
-    else
-    {
-        Log::coreError("Texture failed to load at path: %s", m_path.c_str());
-        stbi_image_free(data);
-        m_loaded = false;
-    }
+    std::lock_guard<std::mutex> lock(s_decodedMtx);
+    s_decodeJobs.push_back(job);
 }
 
 GlTexture::GlTexture(const Type type, Spec& spec, bool submitForMe)
@@ -128,7 +126,7 @@ GlTexture::GlTexture(const Type type, Spec& spec, bool submitForMe)
 GlTexture::~GlTexture()
 {
     u32_t id = m_id;
-    Renderer::s_submitObject([id]() { glDeleteTextures(1, &id); });
+    Renderer::s_submitRetire([id]() { glDeleteTextures(1, &id); });
 }
 
 bool GlTexture::bind(const u32_t glTextureUnit) const
@@ -137,21 +135,56 @@ bool GlTexture::bind(const u32_t glTextureUnit) const
                           "glTextureUnit > s_setMaxTextures. Did you call "
                           "Texture::s_setMaxTextures?");
 
-    if (!m_loaded)
+    if (!isLoaded())
     {
         return false;
     }
 
-    ref<GlTexture> p_this = const_cast<GlTexture*>(this);
+    u32_t target = m_spec.samples > 1 ? GL_TEXTURE_2D_MULTISAMPLE : GL_TEXTURE_2D;
+    Renderer::s_submitPacket(RenderCmdOp::bindTexture, renderCmd::BindTexture{glTextureUnit, target, m_id});
 
-    Renderer::s_submit(
-        [p_this, glTextureUnit]()
-        {
-            glActiveTexture(GL_TEXTURE0 + glTextureUnit);
+    return true;
+}
+
+void GlTexture::viewLayer(const ref<TextureArray>& p_array, u32_t layer)
+{
+    NB_CORE_ASSERT(isLoaded(), "Only loaded textures can view a layer!");
+
+    ref<GlTexture>      p_this    = this;
+    ref<GlTextureArray> p_glArray = static_cast<GlTextureArray*>(p_array.raw());
 
-            glBindTexture(p_this->m_spec.samples > 1 ? GL_TEXTURE_2D_MULTISAMPLE : GL_TEXTURE_2D, p_this->m_id);
+    Renderer::s_submitObject(
+        [p_this, p_glArray, layer]()
+        {
+            // a view needs a name that has never been bound, so not glCreateTextures
+            u32_t viewId = 0;
+            glGenTextures(1, &viewId);
+            glTextureView(viewId,
+                          GL_TEXTURE_2D,
+                          p_glArray->getId(),
+                          s_formatInternal(p_this->m_spec.formatInternal),
+                          0,
+                          p_glArray->getLevelCount(),
+                          layer,
+                          1);
+
+            glTextureParameteri(viewId, GL_TEXTURE_MIN_FILTER, s_filterType(p_this->m_spec.filterTypeMin));
+            glTextureParameteri(viewId, GL_TEXTURE_MAG_FILTER, s_filterType(p_this->m_spec.filterTypeMag));
+            glTextureParameteri(viewId, GL_TEXTURE_WRAP_S, s_wrapType(p_this->m_spec.wrapTypeS));
+            glTextureParameteri(viewId, GL_TEXTURE_WRAP_T, s_wrapType(p_this->m_spec.wrapTypeT));
+
+            // an earlier view the main thread never swapped to is superseded
+            u32_t prevViewId = p_this->m_viewId.exchange(viewId, std::memory_order_acq_rel);
+            if (prevViewId != 0)
+            {
+                glDeleteTextures(1, &prevViewId);
+            }
         });
-    return true;
+
+    if (std::find(s_viewingTextures.begin(), s_viewingTextures.end(), p_this) == s_viewingTextures.end())
+    {
+        s_viewingTextures.push_back(p_this);
+    }
 }
 
 void GlTexture::unbind() const
@@ -397,6 +430,130 @@ u32_t GlTexture::s_wrapType(WrapType wrapType)
     }
 }
 
+void GlTexture::s_processLoads()
+{
+    NB_PROFILE_DETAIL();
+
+    std::vector<DecodedImage> images;
+    {
+        std::lock_guard<std::mutex> lock(s_decodedMtx);
+
+        std::erase_if(s_decodeJobs, [](const JobSystem::Handle& job) { return job->isDone(); });
+
+        images.swap(s_decodedImages);
+
+        for (DecodedImage& image : images)
+        {
+            image.p_texture->m_decoded = true;
+
+            PendingUpload upload;
+            upload.p_texture = image.p_texture;
+            upload.p_pixels  = image.p_pixels;
+            upload.rowBytes  = image.width * image.components;
+
+            _s_setSpec(upload.p_texture->m_spec, image.width, image.height, image.components);
+
+            s_pendingUploads.push_back(std::move(upload));
+        }
+
+        // decoded ones are held by their upload now, failed ones by nothing the loader cares about
+        std::erase_if(s_loadingTextures,
+                      [](const ref<GlTexture>& p_texture)
+                      {
+                          State state = p_texture->m_state.load(std::memory_order_acquire);
+                          return state == State::failed || p_texture->m_decoded;
+                      });
+    }
+
+    // Packets already recorded hold the old id, so it's retired from here rather than deleted when the view is made.
+    // Everything recorded from now on binds the view.
+    std::erase_if(s_viewingTextures,
+                  [](const ref<GlTexture>& p_texture)
+                  {
+                      u32_t viewId = p_texture->m_viewId.exchange(0, std::memory_order_acq_rel);
+                      if (viewId == 0)
+                      {
+                          return false;
+                      }
+
+                      u32_t oldId     = p_texture->m_id;
+                      p_texture->m_id = viewId;
+                      Renderer::s_submitRetire([oldId]() { glDeleteTextures(1, &oldId); });
+                      return true;
+                  });
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Upload slices of rows until the budget is spent, oldest image first
+    ////////////////////////////////////////////////////////////////////////////
+    ref<StreamingBuffer> p_stream = Renderer::s_getStreamingBuffer();
+
+    u32_t budget = k_uploadBudgetBytes;
+    while (!s_pendingUploads.empty() && budget != 0)
+    {
+        PendingUpload& upload = s_pendingUploads.front();
+
+        u32_t height = upload.p_texture->m_spec.height;
+        u32_t rows   = std::min(height - upload.nextRow, std::max(1u, budget / upload.rowBytes));
+        u32_t size   = rows * upload.rowBytes;
+
+        // copy into the streaming buffer and let the driver pull it from there, so the upload is a GPU side copy
+        StreamingBuffer::Allocation allocation = p_stream->allocate(size);
+        memcpy(allocation.p_data, upload.p_pixels + upload.nextRow * upload.rowBytes, size);
+
+        ref<GlTexture>                  p_texture = upload.p_texture;
+        ref<GlStreamingBuffer::Storage> p_storage = static_cast<GlStreamingBuffer::Storage*>(allocation.p_handle);
+        u32_t                           offset    = allocation.offset;
+        u32_t                           firstRow  = upload.nextRow;
+
+        // the render queue rather than the object queue, a staged allocation is only copied in from there
+        Renderer::s_submit(
+            [p_texture, p_storage, offset, firstRow, rows]()
+            {
+                p_texture->_upload(
+                    p_storage->id, reinterpret_cast<const void*>(static_cast<uintptr_t>(offset)), firstRow, rows);
+            });
+
+        upload.nextRow += rows;
+        budget -= std::min(budget, size);
+
+        if (upload.nextRow == height)
+        {
+            stbi_image_free(upload.p_pixels);
+            s_pendingUploads.erase(s_pendingUploads.begin());
+        }
+    }
+}
+
+void GlTexture::s_cancelLoads()
+{
+    std::vector<JobSystem::Handle> jobs;
+    {
+        std::lock_guard<std::mutex> lock(s_decodedMtx);
+        jobs.swap(s_decodeJobs);
+    }
+
+    JobSystem::s_waitAll(jobs);
+
+    std::lock_guard<std::mutex> lock(s_decodedMtx);
+    for (DecodedImage& image : s_decodedImages)
+    {
+        stbi_image_free(image.p_pixels);
+        image.p_texture->m_state.store(State::failed, std::memory_order_release);
+    }
+    s_decodedImages.clear();
+    s_loadingTextures.clear();
+
+    // whatever was already uploaded stays, the texture never becomes ready
+    for (PendingUpload& upload : s_pendingUploads)
+    {
+        stbi_image_free(upload.p_pixels);
+        upload.p_texture->m_state.store(State::failed, std::memory_order_release);
+    }
+    s_pendingUploads.clear();
+
+    s_viewingTextures.clear();
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Private functions
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -405,6 +562,78 @@ void GlTexture::_s_gen(u32_t& id, bool multisample)
     glCreateTextures(multisample ? GL_TEXTURE_2D_MULTISAMPLE : GL_TEXTURE_2D, 1, &id);
 }
 
+void GlTexture::_upload(u32_t unpackBuffer, const void* p_data, u32_t firstRow, u32_t rows)
+{
+    NB_PROFILE_DETAIL();
+
+    if (firstRow == 0)
+    {
+        u32_t levels = 1 + static_cast<u32_t>(std::floor(std::log2(std::max(m_spec.width, m_spec.height))));
+
+        _s_gen(m_id);
+        glTextureStorage2D(m_id, levels, s_formatInternal(m_spec.formatInternal), m_spec.width, m_spec.height);
+    }
+
+    // rows of rgb and red images aren't 4 byte aligned
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, unpackBuffer);
+    glTextureSubImage2D(m_id,
+                        0,
+                        0,
+                        firstRow,
+                        m_spec.width,
+                        rows,
+                        s_format(m_spec.format),
+                        s_dataType(m_spec.dataType),
+                        p_data);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+    if (firstRow + rows < m_spec.height)
+    {
+        return;
+    }
+
+    glGenerateTextureMipmap(m_id);
+
+    glTextureParameteri(m_id, GL_TEXTURE_MIN_FILTER, s_filterType(m_spec.filterTypeMin));
+    glTextureParameteri(m_id, GL_TEXTURE_MAG_FILTER, s_filterType(m_spec.filterTypeMag));
+    glTextureParameteri(m_id, GL_TEXTURE_WRAP_S, s_wrapType(m_spec.wrapTypeS));
+    glTextureParameteri(m_id, GL_TEXTURE_WRAP_T, s_wrapType(m_spec.wrapTypeT));
+    glTextureParameteri(m_id, GL_TEXTURE_WRAP_R, s_wrapType(m_spec.wrapTypeR));
+
+    m_state.store(State::ready, std::memory_order_release);
+}
+
+void GlTexture::_s_setSpec(Spec& spec, i32_t width, i32_t height, i32_t components)
+{
+    spec.width  = width;
+    spec.height = height;
+    switch (components)
+    {
+        case (1):
+            spec.format         = Format::red;
+            spec.formatInternal = FormatInternal::r8;
+            break;
+        case (3):
+            spec.format         = Format::rgb;
+            spec.formatInternal = FormatInternal::rgb8;
+            break;
+        default:
+            spec.format         = Format::rgba;
+            spec.formatInternal = FormatInternal::rgba8;
+            break;
+    }
+
+    // TODO, determine how to set this
+    spec.dataType      = DataType::unsignedByte_;
+    spec.filterTypeMin = FilterType::mipmapLinear;
+    spec.filterTypeMag = FilterType::linear;
+    spec.wrapTypeS     = WrapType::repeat;
+    spec.wrapTypeT     = WrapType::repeat;
+    spec.wrapTypeR     = WrapType::repeat;
+}
+
 void GlTexture::_storage()
 {
     if (m_spec.samples == 1)
@@ -423,7 +652,7 @@ void GlTexture::_storage()
         glTextureParameteri(m_id, GL_TEXTURE_WRAP_S, Texture::s_wrapType(m_spec.wrapTypeS));
         glTextureParameteri(m_id, GL_TEXTURE_WRAP_T, Texture::s_wrapType(m_spec.wrapTypeT));
 
-        m_loaded = true;
+        m_state.store(State::ready, std::memory_order_release);
 
         glBindTexture(GL_TEXTURE_2D, 0);
     }
@@ -437,7 +666,7 @@ void GlTexture::_storage()
                                       m_spec.height,
                                       GL_TRUE);
 
-        m_loaded = true;
+        m_state.store(State::ready, std::memory_order_release);
     }
 }
 
@@ -0,0 +1,223 @@
+#include "nimbus/core/nmpch.hpp"
+#include "nimbus/core/core.hpp"
+
+#include "nimbus/platform/gl/glTextureArray.hpp"
+#include "nimbus/renderer/renderer.hpp"
+
+#include "glad.h"
+
+namespace nimbus
+{
+
+GlTextureArray::GlTextureArray(
+    u32_t width, u32_t height, Texture::FormatInternal format, u32_t layers, bool mipmapped)
+{
+    m_width  = width;
+    m_height = height;
+    m_format = format;
+    m_layers = layers;
+    m_levels = mipmapped ? s_levelCount(width, height) : 1;
+
+    ref<GlTextureArray> p_this = this;
+
+    Renderer::s_submitObject(
+        [p_this]()
+        {
+            glCreateTextures(GL_TEXTURE_2D_ARRAY, 1, &p_this->m_id);
+
+            glTextureStorage3D(p_this->m_id,
+                               p_this->m_levels,
+                               Texture::s_formatInternal(p_this->m_format),
+                               p_this->m_width,
+                               p_this->m_height,
+                               p_this->m_layers);
+
+            if (p_this->m_levels > 1)
+            {
+                // same sampling as textures loaded from files
+                glTextureParameteri(p_this->m_id, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+                glTextureParameteri(p_this->m_id, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+                glTextureParameteri(p_this->m_id, GL_TEXTURE_WRAP_S, GL_REPEAT);
+                glTextureParameteri(p_this->m_id, GL_TEXTURE_WRAP_T, GL_REPEAT);
+            }
+            else
+            {
+                glTextureParameteri(p_this->m_id, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+                glTextureParameteri(p_this->m_id, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+                glTextureParameteri(p_this->m_id, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+                glTextureParameteri(p_this->m_id, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+            }
+
+            p_this->m_created.store(true, std::memory_order_release);
+        });
+}
+
+GlTextureArray::~GlTextureArray()
+{
+    u32_t id = m_id;
+    Renderer::s_submitRetire([id]() { glDeleteTextures(1, &id); });
+}
+
+bool GlTextureArray::bind(const u32_t glTextureUnit) const
+{
+    if (m_created.load(std::memory_order_acquire))
+    {
+        Renderer::s_submitPacket(RenderCmdOp::bindTexture,
+                                 renderCmd::BindTexture{glTextureUnit, GL_TEXTURE_2D_ARRAY, m_id});
+        return true;
+    }
+
+    // created by the object queue at the start of the frame this runs in, so the id is known by then
+    ref<GlTextureArray> p_this = const_cast<GlTextureArray*>(this);
+
+    Renderer::s_submit([p_this, glTextureUnit]() { glBindTextureUnit(glTextureUnit, p_this->m_id); });
+    return true;
+}
+
+void GlTextureArray::copyLayer(const ref<Texture>& p_texture, u32_t layer)
+{
+    NB_CORE_ASSERT(p_texture->getWidth() == m_width && p_texture->getHeight() == m_height,
+                   "Texture is %ix%i, the array is %ix%i",
+                   p_texture->getWidth(),
+                   p_texture->getHeight(),
+                   m_width,
+                   m_height);
+    NB_CORE_ASSERT(layer < m_layers, "Layer %i out of range (%i layers)", layer, m_layers);
+
+    ref<GlTextureArray> p_this = this;
+    ref<Texture>        p_src  = p_texture;
+
+    Renderer::s_submitObject(
+        [p_this, p_src, layer]()
+        {
+            for (u32_t level = 0; level < p_this->m_levels; level++)
+            {
+                glCopyImageSubData(p_src->getId(),
+                                   GL_TEXTURE_2D,
+                                   level,
+                                   0,
+                                   0,
+                                   0,
+                                   p_this->m_id,
+                                   GL_TEXTURE_2D_ARRAY,
+                                   level,
+                                   0,
+                                   0,
+                                   layer,
+                                   std::max(1u, p_this->m_width >> level),
+                                   std::max(1u, p_this->m_height >> level),
+                                   1);
+            }
+        });
+}
+
+void GlTextureArray::copyLayers(const ref<TextureArray>& p_src)
+{
+    NB_CORE_ASSERT(p_src->getWidth() == m_width && p_src->getHeight() == m_height && p_src->getFormat() == m_format
+                       && p_src->getLevelCount() == m_levels,
+                   "Arrays don't match");
+    NB_CORE_ASSERT(p_src->getLayerCount() <= m_layers,
+                   "Copying %i layers into an array of %i",
+                   p_src->getLayerCount(),
+                   m_layers);
+
+    ref<GlTextureArray> p_this  = this;
+    ref<GlTextureArray> p_glSrc = static_cast<GlTextureArray*>(p_src.raw());
+
+    Renderer::s_submitObject(
+        [p_this, p_glSrc]()
+        {
+            for (u32_t level = 0; level < p_this->m_levels; level++)
+            {
+                glCopyImageSubData(p_glSrc->m_id,
+                                   GL_TEXTURE_2D_ARRAY,
+                                   level,
+                                   0,
+                                   0,
+                                   0,
+                                   p_this->m_id,
+                                   GL_TEXTURE_2D_ARRAY,
+                                   level,
+                                   0,
+                                   0,
+                                   0,
+                                   std::max(1u, p_this->m_width >> level),
+                                   std::max(1u, p_this->m_height >> level),
+                                   p_glSrc->m_layers);
+            }
+        });
+}
+
+void GlTextureArray::setRegion(u32_t layer, u32_t x, u32_t y, u32_t width, u32_t height, const void* p_data)
+{
+    NB_CORE_ASSERT(m_levels == 1, "Regions can't be set on an array with mips");
+    NB_CORE_ASSERT(layer < m_layers, "Layer %i out of range (%i layers)", layer, m_layers);
+    NB_CORE_ASSERT(x + width <= m_width && y + height <= m_height,
+                   "Region %i,%i %ix%i is outside of the %ix%i array",
+                   x,
+                   y,
+                   width,
+                   height,
+                   m_width,
+                   m_height);
+
+    u32_t format        = 0;
+    u32_t bytesPerPixel = 0;
+    _getUploadFormat(format, bytesPerPixel);
+
+    u32_t size     = width * height * bytesPerPixel;
+    void* localCpy = malloc(size);
+    memcpy(localCpy, p_data, size);
+
+    ref<GlTextureArray> p_this = this;
+
+    Renderer::s_submitObject(
+        [p_this, layer, x, y, width, height, format, localCpy]()
+        {
+            // rows of 3 byte pixels aren't always 4 byte aligned
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+            glTextureSubImage3D(
+                p_this->m_id, 0, x, y, layer, width, height, 1, format, GL_UNSIGNED_BYTE, localCpy);
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+            free(localCpy);
+        });
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Private Functions
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+void GlTextureArray::_getUploadFormat(u32_t& format, u32_t& bytesPerPixel) const
+{
+    switch (m_format)
+    {
+        case (Texture::FormatInternal::rgba8):
+        {
+            format        = GL_RGBA;
+            bytesPerPixel = 4;
+            break;
+        }
+        case (Texture::FormatInternal::rgb8):
+        {
+            format        = GL_RGB;
+            bytesPerPixel = 3;
+            break;
+        }
+        case (Texture::FormatInternal::rg8):
+        {
+            format        = GL_RG;
+            bytesPerPixel = 2;
+            break;
+        }
+        case (Texture::FormatInternal::r8):
+        {
+            format        = GL_RED;
+            bytesPerPixel = 1;
+            break;
+        }
+        default:
+            NB_CORE_ASSERT(false, "Texture array format %i can't be uploaded to\n", m_format);
+    }
+}
+
+}  // namespace nimbus
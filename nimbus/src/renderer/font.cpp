@@ -2,9 +2,9 @@
 #include "nimbus/core/core.hpp"
 
 #include "nimbus/renderer/font.hpp"
-#include "nimbus/renderer/texture.hpp"
 #include "nimbus/renderer/fontData.hpp"
 #include "nimbus/core/resourceManager.hpp"
+#include "nimbus/core/utility.hpp"
 
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wunused-function"
@@ -12,148 +12,577 @@
 #include "msdf-atlas-gen/msdf-atlas-gen.h"
 #pragma GCC diagnostic pop
 
-#include <thread>
 #include <atomic>
+#include <fstream>
 
 namespace nimbus
 {
 
-Font::Font(const std::string& fontPath) : m_path(fontPath), m_data(new FontData())
+// What glyphs are generated with
+static const f64_t k_miterLimit     = 1.0;
+static const f64_t k_maxCornerAngle = 3.0;
+
+// attempts at shrinking a glyph that doesn't fit in the size it's rendered for
+static const u32_t k_maxFitAttempts = 3;
+
+// bump when the cache layout or the way the tables or glyphs are made changes
+static const u32_t k_cacheVersion = 3;
+
+// Start of a cache file, followed by the glyph table, the advance table, a GlyphRecord for each generated glyph and
+// the pixels of those glyphs
+struct FontCacheHeader
+{
+    char  magic[4];
+    u32_t version;
+    u64_t key;
+    u32_t tableSize;
+    u32_t glyphCount;
+    f32_t glyphPixelsPerEm;  // what every glyph in the cache was generated with
+    f32_t glyphPixelRange;
+    u32_t glyphMaxSize;
+};
+
+struct GlyphRecord
+{
+    u32_t     codepoint;
+    u32_t     rendered;
+    u32_t     width;
+    u32_t     height;
+    glm::vec4 plane;
+    glm::vec4 atlas;
+    u64_t     pixelOffset;  // from the start of the pixels
+};
+
+static const char k_cacheMagic[4] = {'N', 'B', 'F', 'A'};
+
+// FNV-1a, stable across runs and platforms unlike std::hash
+static u64_t s_hashBytes(const void* p_data, u64_t size, u64_t hash = 14695981039346656037ull)
+{
+    const u8_t* p_bytes = static_cast<const u8_t*>(p_data);
+    for (u64_t i = 0; i < size; i++)
+    {
+        hash ^= p_bytes[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+Font::Font(const std::string& fontPath, const std::filesystem::path& cachePath)
+    : m_path(fontPath), m_cachePath(cachePath), m_data(new FontData()), m_id(s_nextId++)
 {
-    m_workerThread = std::thread(&Font::_loadFont, this);
+    m_loadJob = JobSystem::s_submit([this]() { _loadFont(); });
 }
 
-ref<Font> Font::s_create(const std::string& fontPath)
+ref<Font> Font::s_create(const std::string& fontPath, const std::filesystem::path& cachePath)
 {
-    return ref(new Font(fontPath));
+    return ref(new Font(fontPath, cachePath));
 }
 
 Font::~Font()
 {
-    m_workerThread.join();
-    if (m_data->pixels != nullptr)
+    JobSystem::s_wait(m_loadJob);
+
+    // glyphs generated this run go in with the ones the cache already had
+    if (m_cacheKey != 0 && m_data->newGlyphCount > 0)
+    {
+        _writeCache(m_cacheKey);
+    }
+
+    if (m_data->p_fontHandle != nullptr)
+    {
+        msdfgen::destroyFont(m_data->p_fontHandle);
+    }
+    if (m_data->p_freetype != nullptr)
     {
-        free(m_data->pixels);
+        msdfgen::deinitializeFreetype(m_data->p_freetype);
     }
 
     delete m_data;
 }
 
+bool Font::getAdvance(u32_t codepoint, u32_t next, f32_t& advance) const
+{
+    const u32_t k_tableSize = FontData::k_tableSize;
+
+    if (codepoint < k_tableSize)
+    {
+        const FontData::Glyph& glyph = m_data->glyphTable[codepoint];
+
+        advance = next < k_tableSize ? m_data->advanceTable[codepoint * k_tableSize + next] : glyph.advance;
+        return glyph.present;
+    }
+
+    std::lock_guard<std::mutex> lock(m_data->handleMutex);
+
+    auto p_glyph = m_data->extraGlyphs.find(codepoint);
+    if (p_glyph == m_data->extraGlyphs.end())
+    {
+        FontData::Glyph glyph;
+
+        msdf_atlas::GlyphGeometry geometry;
+        if (m_data->p_fontHandle != nullptr
+            && geometry.load(m_data->p_fontHandle, m_data->geometryScale, msdfgen::unicode_t(codepoint)))
+        {
+            glyph.advance = static_cast<f32_t>(geometry.getAdvance());
+            glyph.present = true;
+        }
+
+        p_glyph = m_data->extraGlyphs.emplace(codepoint, glyph).first;
+    }
+
+    advance = p_glyph->second.advance;
+    return p_glyph->second.present;
+}
+
+bool Font::renderGlyph(u32_t codepoint, f32_t pixelsPerEm, f32_t pixelRange, u32_t maxSize, GlyphBitmap& bitmap) const
+{
+    NB_PROFILE_DETAIL();
+
+    msdf_atlas::GlyphGeometry glyph;
+    {
+        std::lock_guard<std::mutex> lock(m_data->handleMutex);
+
+        if (m_data->p_fontHandle == nullptr
+            || !glyph.load(m_data->p_fontHandle, m_data->geometryScale, msdfgen::unicode_t(codepoint)))
+        {
+            return false;
+        }
+    }
+
+    bitmap = GlyphBitmap();
+    if (glyph.isWhitespace())
+    {
+        _cacheGlyph(codepoint, pixelsPerEm, pixelRange, maxSize, true, bitmap);
+        return true;
+    }
+
+    glyph.edgeColoring(&msdfgen::edgeColoringInkTrap, k_maxCornerAngle, 0);
+
+    // The box is the glyph at the scale plus the range on both sides, shrink the glyph part until it fits. The
+    // packer places the one glyph in an atlas of its own, its box says where.
+    f64_t scale  = pixelsPerEm;
+    i32_t boxX   = 0;
+    i32_t boxY   = 0;
+    i32_t width  = 0;
+    i32_t height = 0;
+    i32_t boxW   = 0;
+    i32_t boxH   = 0;
+    for (u32_t attempt = 0; attempt < k_maxFitAttempts; attempt++)
+    {
+        msdf_atlas::TightAtlasPacker packer;
+        packer.setScale(scale);
+        packer.setPixelRange(pixelRange);
+        packer.setMiterLimit(k_miterLimit);
+        packer.pack(&glyph, 1);
+        packer.getDimensions(width, height);
+
+        glyph.getBoxRect(boxX, boxY, boxW, boxH);
+        if (boxW <= static_cast<i32_t>(maxSize) && boxH <= static_cast<i32_t>(maxSize))
+        {
+            break;
+        }
+
+        f64_t margin = 2.0 * pixelRange + 1.0;
+        scale *= (maxSize - margin) / std::max(static_cast<f64_t>(std::max(boxW, boxH)) - margin, 1.0);
+    }
+
+    if (boxW > static_cast<i32_t>(maxSize) || boxH > static_cast<i32_t>(maxSize))
+    {
+        Log::coreWarn("Glyph %i of %s doesn't fit in %i pixels", codepoint, m_path.c_str(), maxSize);
+        _cacheGlyph(codepoint, pixelsPerEm, pixelRange, maxSize, false, GlyphBitmap());
+        return false;
+    }
+
+    msdf_atlas::ImmediateAtlasGenerator<f32_t,
+                                        3,
+                                        &msdf_atlas::msdfGenerator,
+                                        msdf_atlas::BitmapAtlasStorage<msdf_atlas::byte, 3>>
+        generator(width, height);
+
+    msdf_atlas::GeneratorAttributes attributes;
+    attributes.config.overlapSupport = true;
+    attributes.scanlinePass          = true;
+    generator.setAttributes(attributes);
+
+    // one glyph is already one job, it doesn't split any further
+    generator.setThreadCount(1);
+    generator.generate(&glyph, 1);
+
+    msdfgen::BitmapConstRef<msdfgen::byte, 3> atlasBitmap
+        = (msdfgen::BitmapConstRef<msdfgen::byte, 3>)generator.atlasStorage();
+
+    bitmap.width  = boxW;
+    bitmap.height = boxH;
+    bitmap.pixels.resize(bitmap.width * bitmap.height * 3);
+
+    for (u32_t row = 0; row < bitmap.height; row++)
+    {
+        memcpy(&bitmap.pixels[row * bitmap.width * 3], atlasBitmap(boxX, boxY + row), bitmap.width * 3);
+    }
+
+    f64_t left;
+    f64_t bottom;
+    f64_t right;
+    f64_t top;
+    glyph.getQuadPlaneBounds(left, bottom, right, top);
+    bitmap.plane = glm::vec4(left, bottom, right, top);
+
+    glyph.getQuadAtlasBounds(left, bottom, right, top);
+    bitmap.atlas = glm::vec4(left - boxX, bottom - boxY, right - boxX, top - boxY);
+
+    _cacheGlyph(codepoint, pixelsPerEm, pixelRange, maxSize, true, bitmap);
+    return true;
+}
+
+bool Font::findGlyph(u32_t codepoint, f32_t pixelsPerEm, f32_t pixelRange, u32_t maxSize, GlyphView& glyph) const
+{
+    std::lock_guard<std::mutex> lock(m_data->handleMutex);
+
+    if (pixelsPerEm != m_data->glyphPixelsPerEm || pixelRange != m_data->glyphPixelRange
+        || maxSize != m_data->glyphMaxSize)
+    {
+        return false;
+    }
+
+    auto p_glyph = m_data->cachedGlyphs.find(codepoint);
+    if (p_glyph == m_data->cachedGlyphs.end())
+    {
+        return false;
+    }
+
+    glyph = p_glyph->second;
+    return true;
+}
+
 void Font::_loadFont()
 {
-    // Initialize instance of FreeType library
-    if (msdfgen::FreetypeHandle* ft = msdfgen::initializeFreetype())
+    if (_openFont())
+    {
+        u64_t key = m_cachePath.empty() ? 0 : _getCacheKey();
+
+        if (key != 0 && _loadCache(key))
+        {
+            Log::coreInfo("Loaded glyph tables and %i glyphs of %s from %s",
+                          static_cast<i32_t>(m_data->cachedGlyphs.size()),
+                          m_path.c_str(),
+                          m_cachePath.generic_string().c_str());
+        }
+        else
+        {
+            _buildGlyphTables();
+
+            if (key != 0)
+            {
+                _writeCache(key);
+            }
+        }
+
+        m_cacheKey = key;
+    }
+    else
+    {
+        Log::coreError("Couldn't load font %s", m_path.c_str());
+
+        // nothing is present, so drawing with it trips the same checks as a font without '?'
+        m_data->glyphTable.assign(FontData::k_tableSize, FontData::Glyph());
+        m_data->advanceTable.assign(FontData::k_tableSize * FontData::k_tableSize, 0.0f);
+    }
+
+    m_isDone.store(true, std::memory_order_release);  // Set the flag when done
+}
+
+bool Font::_openFont()
+{
+    NB_PROFILE_DETAIL();
+
+    m_data->p_freetype = msdfgen::initializeFreetype();
+    if (m_data->p_freetype == nullptr)
+    {
+        return false;
+    }
+
+    m_data->p_fontHandle = msdfgen::loadFont(m_data->p_freetype, m_path.c_str());
+    if (m_data->p_fontHandle == nullptr)
+    {
+        return false;
+    }
+
+    // only the metrics, glyphs are loaded as they're needed
+    msdf_atlas::FontGeometry fontGeometry;
+    fontGeometry.loadMetrics(m_data->p_fontHandle, 1.0);
+
+    const msdfgen::FontMetrics& metrics = fontGeometry.getMetrics();
+    m_data->geometryScale               = fontGeometry.getGeometryScale();
+    m_data->ascenderY                   = static_cast<f32_t>(metrics.ascenderY);
+    m_data->descenderY                  = static_cast<f32_t>(metrics.descenderY);
+    m_data->lineHeight                  = static_cast<f32_t>(metrics.lineHeight);
+
+    return true;
+}
+
+void Font::_buildGlyphTables()
+{
+    NB_PROFILE_DETAIL();
+
+    const u32_t k_tableSize = FontData::k_tableSize;
+
+    // FontGeometry is a helper class that loads a set of glyphs from a single font, with their kerning
+    std::vector<msdf_atlas::GlyphGeometry> glyphs;
+    msdf_atlas::FontGeometry               fontGeometry(&glyphs);
+
+    int glyphsLoaded = fontGeometry.loadCharset(m_data->p_fontHandle, 1.0, msdf_atlas::Charset::ASCII);
+
+    Log::coreInfo(
+        "Loaded %i glyphs out of %i from %s", glyphsLoaded, msdf_atlas::Charset::ASCII.size(), m_path.c_str());
+
+    m_data->glyphTable.assign(k_tableSize, FontData::Glyph());
+    m_data->advanceTable.assign(k_tableSize * k_tableSize, 0.0f);
+
+    for (u32_t character = 0; character < k_tableSize; character++)
+    {
+        const msdf_atlas::GlyphGeometry* p_geometry = fontGeometry.getGlyph(msdfgen::unicode_t(character));
+        if (p_geometry == nullptr)
+        {
+            continue;
+        }
+
+        FontData::Glyph& glyph = m_data->glyphTable[character];
+
+        glyph.advance = static_cast<f32_t>(p_geometry->getAdvance());
+        glyph.present = true;
+
+        for (u32_t next = 0; next < k_tableSize; next++)
+        {
+            f64_t advance;
+            if (!fontGeometry.getAdvance(advance, character, next))
+            {
+                // no specific advance for this pair, so just use the one for this character
+                advance = glyph.advance;
+            }
+
+            m_data->advanceTable[character * k_tableSize + next] = static_cast<f32_t>(advance);
+        }
+    }
+}
+
+u64_t Font::_getCacheKey() const
+{
+    NB_PROFILE_DETAIL();
+
+    util::MappedFile fontFile;
+    if (!fontFile.open(m_path))
+    {
+        return 0;
+    }
+
+    u64_t key = s_hashBytes(fontFile.getData(), fontFile.getSize());
+
+    key = s_hashBytes(&k_cacheVersion, sizeof(k_cacheVersion), key);
+
+    // 0 means no key
+    return key != 0 ? key : 1;
+}
+
+bool Font::_loadCache(u64_t key)
+{
+    NB_PROFILE_DETAIL();
+
+    util::MappedFile cacheFile;
+    if (!cacheFile.open(m_cachePath) || cacheFile.getSize() < sizeof(FontCacheHeader))
+    {
+        return false;
+    }
+
+    FontCacheHeader header;
+    memcpy(&header, cacheFile.getData(), sizeof(header));
+
+    if (memcmp(header.magic, k_cacheMagic, sizeof(k_cacheMagic)) != 0 || header.version != k_cacheVersion
+        || header.key != key || header.tableSize != FontData::k_tableSize)
+    {
+        return false;
+    }
+
+    u64_t glyphBytes   = sizeof(FontData::Glyph) * header.tableSize;
+    u64_t advanceBytes = sizeof(f32_t) * header.tableSize * header.tableSize;
+    u64_t recordBytes  = sizeof(GlyphRecord) * header.glyphCount;
+    u64_t pixelsStart  = sizeof(header) + glyphBytes + advanceBytes + recordBytes;
+
+    // cut short by a crash mid write or whatever else, rebuild it
+    if (cacheFile.getSize() < pixelsStart)
+    {
+        return false;
+    }
+
+    const u8_t* p_read     = cacheFile.getData() + sizeof(header);
+    const u8_t* p_pixels   = cacheFile.getData() + pixelsStart;
+    u64_t       pixelsSize = cacheFile.getSize() - pixelsStart;
+
+    std::unordered_map<u32_t, GlyphView> cachedGlyphs;
+    for (u32_t i = 0; i < header.glyphCount; i++)
+    {
+        GlyphRecord record;
+        memcpy(&record, p_read + glyphBytes + advanceBytes + i * sizeof(GlyphRecord), sizeof(record));
+
+        u64_t size = static_cast<u64_t>(record.width) * record.height * 3;
+        if (record.pixelOffset + size > pixelsSize)
+        {
+            return false;
+        }
+
+        GlyphView glyph;
+        glyph.p_pixels = size > 0 ? p_pixels + record.pixelOffset : nullptr;
+        glyph.width    = record.width;
+        glyph.height   = record.height;
+        glyph.plane    = record.plane;
+        glyph.atlas    = record.atlas;
+        glyph.rendered = record.rendered != 0;
+        cachedGlyphs.emplace(record.codepoint, glyph);
+    }
+
+    m_data->glyphTable.resize(header.tableSize);
+    memcpy(m_data->glyphTable.data(), p_read, glyphBytes);
+    p_read += glyphBytes;
+
+    m_data->advanceTable.resize(header.tableSize * header.tableSize);
+    memcpy(m_data->advanceTable.data(), p_read, advanceBytes);
+
+    // the glyphs are read from the mapping as they're drawn, so it stays open
+    std::lock_guard<std::mutex> lock(m_data->handleMutex);
+    m_data->cachedGlyphs     = std::move(cachedGlyphs);
+    m_data->glyphPixelsPerEm = header.glyphPixelsPerEm;
+    m_data->glyphPixelRange  = header.glyphPixelRange;
+    m_data->glyphMaxSize     = header.glyphMaxSize;
+    m_data->cacheFile        = std::move(cacheFile);
+
+    return true;
+}
+
+void Font::_writeCache(u64_t key) const
+{
+    NB_PROFILE_DETAIL();
+
+    std::error_code error;
+    std::filesystem::create_directories(m_cachePath.parent_path(), error);
+
+    std::lock_guard<std::mutex> lock(m_data->handleMutex);
+
+    // in codepoint order, so the same glyphs always make the same file
+    std::vector<u32_t> codepoints;
+    codepoints.reserve(m_data->cachedGlyphs.size());
+    for (const auto& [codepoint, glyph] : m_data->cachedGlyphs)
     {
-        // Load font file
-        if (msdfgen::FontHandle* font = msdfgen::loadFont(ft, m_path.c_str()))
+        codepoints.push_back(codepoint);
+    }
+    std::sort(codepoints.begin(), codepoints.end());
+
+    FontCacheHeader header;
+    memcpy(header.magic, k_cacheMagic, sizeof(k_cacheMagic));
+    header.version          = k_cacheVersion;
+    header.key              = key;
+    header.tableSize        = FontData::k_tableSize;
+    header.glyphCount       = static_cast<u32_t>(codepoints.size());
+    header.glyphPixelsPerEm = m_data->glyphPixelsPerEm;
+    header.glyphPixelRange  = m_data->glyphPixelRange;
+    header.glyphMaxSize     = m_data->glyphMaxSize;
+
+    // written next to it and moved over, so a reader never sees half a file
+    std::filesystem::path tmpPath = m_cachePath;
+    tmpPath += ".tmp";
+
+    std::ofstream stream(tmpPath, std::ios::binary | std::ios::trunc);
+    stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    stream.write(reinterpret_cast<const char*>(m_data->glyphTable.data()),
+                 sizeof(FontData::Glyph) * m_data->glyphTable.size());
+    stream.write(reinterpret_cast<const char*>(m_data->advanceTable.data()),
+                 sizeof(f32_t) * m_data->advanceTable.size());
+
+    u64_t pixelOffset = 0;
+    for (u32_t codepoint : codepoints)
+    {
+        const GlyphView& glyph = m_data->cachedGlyphs.at(codepoint);
+
+        GlyphRecord record;
+        record.codepoint   = codepoint;
+        record.rendered    = glyph.rendered ? 1 : 0;
+        record.width       = glyph.width;
+        record.height      = glyph.height;
+        record.plane       = glyph.plane;
+        record.atlas       = glyph.atlas;
+        record.pixelOffset = pixelOffset;
+        stream.write(reinterpret_cast<const char*>(&record), sizeof(record));
+
+        pixelOffset += static_cast<u64_t>(glyph.width) * glyph.height * 3;
+    }
+
+    for (u32_t codepoint : codepoints)
+    {
+        const GlyphView& glyph = m_data->cachedGlyphs.at(codepoint);
+        if (glyph.p_pixels != nullptr)
         {
-            m_data->fontGeometry = msdf_atlas::FontGeometry(&m_data->glyphs);
-            // FontGeometry is a helper class that loads a set of glyphs from a
-            // single font. It can also be used to get additional font metrics,
-            // kerning information, etc.
-            // Load a set of character glyphs:
-            // The second argument can be ignored unless you mix different font
-            // sizes in one atlas. In the last argument, you can specify a
-            // charset other than ASCII. To load specific glyph indices, use
-            // loadGlyphs instead.
-            int glyphsLoaded = m_data->fontGeometry.loadCharset(font, 1.0, msdf_atlas::Charset::ASCII);
-
-            Log::coreInfo("Loaded %i glyphs out of %i from %s",
-                          glyphsLoaded,
-                          msdf_atlas::Charset::ASCII.size(),
-                          m_path.c_str());
-
-            // Apply MSDF edge coloring. See edge-coloring.h for other coloring
-            // strategies.
-            const f64_t maxCornerAngle = 3.0;
-            for (msdf_atlas::GlyphGeometry& glyph : m_data->glyphs)
-                glyph.edgeColoring(&msdfgen::edgeColoringInkTrap, maxCornerAngle, 0);
-            // TightAtlasPacker class computes the layout of the atlas.
-            msdf_atlas::TightAtlasPacker packer;
-            // Set atlas parameters:
-            // setDimensions or setDimensionsConstraint to find the best value
-            // RRR - makes it tilted, is that okay?
-            // packer.setDimensionsConstraint(
-            //     msdf_atlas::TightAtlasPacker::DimensionsConstraint::SQUARE);
-            // setScale for a fixed size or setMinimumScale to use the largest
-            // that fits
-            // TODO: determine parameters
-            packer.setMinimumScale(50.0);  // thin fonts require this to be
-                                           // large
-            // packer.setScale(80.0f);
-            // setPixelRange or setUnitRange
-            m_data->pixelRange = 2.0;
-            packer.setPixelRange(m_data->pixelRange);
-            packer.setMiterLimit(1.0);
-            // Compute atlas layout - pack glyphs
-            packer.pack(m_data->glyphs.data(), m_data->glyphs.size());
-            // Get final atlas dimensions
-            int width = 0, height = 0;
-            packer.getDimensions(width, height);
-            // The ImmediateAtlasGenerator class facilitates the generation of
-            // the atlas bitmap.
-            msdf_atlas::ImmediateAtlasGenerator<f32_t,  // pixel type of buffer for individual glyphs depends on
-                                                        // generator function
-                                                3,      // number of atlas color channels
-                                                &msdf_atlas::msdfGenerator,  // function to generate bitmaps for
-                                                                             // individual glyphs
-                                                msdf_atlas::BitmapAtlasStorage<msdf_atlas::byte,
-                                                                               3>  // class that stores the
-                                                                                   // atlas bitmap
-                                                // For example, a custom atlas storage class that stores it in
-                                                // VRAM can be used.
-                                                >
-                generator(width, height);
-            // GeneratorAttributes can be modified to change the generator's
-            // default settings.
-            msdf_atlas::GeneratorAttributes attributes;
-
-            attributes.config.overlapSupport = true;
-            attributes.scanlinePass          = true;
-            generator.setAttributes(attributes);
-            generator.setThreadCount(4);
-            // Generate atlas bitmap
-            generator.generate(m_data->glyphs.data(), m_data->glyphs.size());
-            // The atlas bitmap can now be retrieved via atlasStorage as a
-            // BitmapConstRef. The glyphs array (or fontGeometry) contains
-            // positioning data for typesetting text.
-
-            msdfgen::BitmapConstRef<msdfgen::byte, 3> bitmap
-                = (msdfgen::BitmapConstRef<msdfgen::byte, 3>)generator.atlasStorage();
-
-            m_data->width  = bitmap.width;
-            m_data->height = bitmap.height;
-            m_data->pixels = malloc(m_data->width * m_data->height * 3);
-
-            memcpy(m_data->pixels, bitmap.pixels, m_data->width * m_data->height * 3);
-
-            msdfgen::destroyFont(font);
+            stream.write(reinterpret_cast<const char*>(glyph.p_pixels), glyph.width * glyph.height * 3);
         }
-        msdfgen::deinitializeFreetype(ft);
     }
+    stream.close();
 
-    m_isDone.store(true);  // Set the flag when done
+    // the old glyphs were read from the mapping, it has to go before the file can be replaced
+    if (stream)
+    {
+        m_data->cachedGlyphs.clear();
+        m_data->cacheFile.close();
+        std::filesystem::rename(tmpPath, m_cachePath, error);
+    }
+
+    if (!stream || error)
+    {
+        Log::coreWarn("Couldn't write the font cache %s", m_cachePath.generic_string().c_str());
+        std::filesystem::remove(tmpPath, error);
+    }
 }
 
-void Font::_initializeTexture()
+void Font::_cacheGlyph(u32_t              codepoint,
+                       f32_t              pixelsPerEm,
+                       f32_t              pixelRange,
+                       u32_t              maxSize,
+                       bool               rendered,
+                       const GlyphBitmap& bitmap) const
 {
-    Texture::Spec texSpec;
+    std::lock_guard<std::mutex> lock(m_data->handleMutex);
 
-    texSpec.format         = Texture::Format::rgb;
-    texSpec.formatInternal = Texture::FormatInternal::rgb8;
-    texSpec.width          = m_data->width;
-    texSpec.height         = m_data->height;
+    // the cache holds glyphs of one setting, whatever it was first asked for
+    if (m_data->glyphPixelsPerEm == 0.0f)
+    {
+        m_data->glyphPixelsPerEm = pixelsPerEm;
+        m_data->glyphPixelRange  = pixelRange;
+        m_data->glyphMaxSize     = maxSize;
+    }
+    else if (pixelsPerEm != m_data->glyphPixelsPerEm || pixelRange != m_data->glyphPixelRange
+             || maxSize != m_data->glyphMaxSize)
+    {
+        return;
+    }
 
-    m_atlasTex = Texture::s_create(Texture::Type::diffuse, texSpec);
+    // two jobs can generate the same glyph, the first one in keeps it
+    if (m_data->cachedGlyphs.contains(codepoint))
+    {
+        return;
+    }
 
-    // todo configure size
-    m_atlasTex->setData((void*)m_data->pixels, m_data->width * m_data->height * 3);
+    GlyphView glyph;
+    glyph.width    = bitmap.width;
+    glyph.height   = bitmap.height;
+    glyph.plane    = bitmap.plane;
+    glyph.atlas    = bitmap.atlas;
+    glyph.rendered = rendered;
 
-    // Cleanup
-    free(m_data->pixels);
-    m_data->pixels = nullptr;
+    // moving a vector keeps its buffer, so the pointer stays good as more are added
+    if (!bitmap.pixels.empty())
+    {
+        m_data->newGlyphPixels.push_back(bitmap.pixels);
+        glyph.p_pixels = m_data->newGlyphPixels.back().data();
+    }
 
-    m_loaded = true;
+    m_data->cachedGlyphs.emplace(codepoint, glyph);
+    m_data->newGlyphCount++;
 }
 
 };  // namespace nimbus
\ No newline at end of file
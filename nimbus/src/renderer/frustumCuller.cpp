@@ -0,0 +1,110 @@
+#include "nimbus/core/nmpch.hpp"
+#include "nimbus/core/core.hpp"
+
+#include "nimbus/renderer/frustumCuller.hpp"
+
+namespace nimbus
+{
+
+void FrustumCuller::begin(const glm::mat4& viewProjection)
+{
+    // Gribb/Hartmann, a clip space point is inside when -w <= x,y,z <= w, which as a row combination of the matrix is
+    // a plane in world space. glm is column major so row i is m[0][i], m[1][i], m[2][i], m[3][i].
+    const glm::mat4& m = viewProjection;
+
+    glm::vec4 row0(m[0][0], m[1][0], m[2][0], m[3][0]);
+    glm::vec4 row1(m[0][1], m[1][1], m[2][1], m[3][1]);
+    glm::vec4 row2(m[0][2], m[1][2], m[2][2], m[3][2]);
+    glm::vec4 row3(m[0][3], m[1][3], m[2][3], m[3][3]);
+
+    m_planes[0] = row3 + row0;  // left
+    m_planes[1] = row3 - row0;  // right
+    m_planes[2] = row3 + row1;  // bottom
+    m_planes[3] = row3 - row1;  // top
+    m_planes[4] = row3 + row2;  // near
+    m_planes[5] = row3 - row2;  // far
+
+    m_centerX.clear();
+    m_centerY.clear();
+    m_centerZ.clear();
+    m_extentX.clear();
+    m_extentY.clear();
+    m_extentZ.clear();
+
+    m_visibleCount = 0;
+}
+
+u32_t FrustumCuller::add(const glm::mat4& transform, const glm::vec2& localMin, const glm::vec2& localMax)
+{
+    glm::vec2 localCenter = (localMin + localMax) * 0.5f;
+    glm::vec2 localExtent = (localMax - localMin) * 0.5f;
+
+    glm::vec3 center(transform * glm::vec4(localCenter, 0.0f, 1.0f));
+
+    // the world box enclosing the transformed local one, each axis gets the absolute contribution of the local axes
+    glm::vec3 extent = glm::abs(glm::vec3(transform[0])) * localExtent.x
+                       + glm::abs(glm::vec3(transform[1])) * localExtent.y;
+
+    m_centerX.push_back(center.x);
+    m_centerY.push_back(center.y);
+    m_centerZ.push_back(center.z);
+    m_extentX.push_back(extent.x);
+    m_extentY.push_back(extent.y);
+    m_extentZ.push_back(extent.z);
+
+    return static_cast<u32_t>(m_centerX.size() - 1);
+}
+
+u32_t FrustumCuller::addBox(const glm::vec3& min, const glm::vec3& max)
+{
+    glm::vec3 center = (min + max) * 0.5f;
+    glm::vec3 extent = (max - min) * 0.5f;
+
+    m_centerX.push_back(center.x);
+    m_centerY.push_back(center.y);
+    m_centerZ.push_back(center.z);
+    m_extentX.push_back(extent.x);
+    m_extentY.push_back(extent.y);
+    m_extentZ.push_back(extent.z);
+
+    return static_cast<u32_t>(m_centerX.size() - 1);
+}
+
+void FrustumCuller::cull()
+{
+    NB_PROFILE_DETAIL();
+
+    u32_t count = getCount();
+    m_visible.assign(count, 1);
+
+    const f32_t* p_centerX = m_centerX.data();
+    const f32_t* p_centerY = m_centerY.data();
+    const f32_t* p_centerZ = m_centerZ.data();
+    const f32_t* p_extentX = m_extentX.data();
+    const f32_t* p_extentY = m_extentY.data();
+    const f32_t* p_extentZ = m_extentZ.data();
+    u8_t*        p_visible = m_visible.data();
+
+    // One plane at a time over every box, the inner loop has no branches and only streams through the arrays. A box
+    // is outside a plane when even its corner furthest along the normal is behind it.
+    for (const glm::vec4& plane : m_planes)
+    {
+        glm::vec3 absNormal = glm::abs(glm::vec3(plane));
+
+        for (u32_t i = 0; i < count; i++)
+        {
+            f32_t distance = plane.x * p_centerX[i] + plane.y * p_centerY[i] + plane.z * p_centerZ[i] + plane.w;
+            f32_t radius   = absNormal.x * p_extentX[i] + absNormal.y * p_extentY[i] + absNormal.z * p_extentZ[i];
+
+            p_visible[i] &= static_cast<u8_t>(distance + radius >= 0.0f);
+        }
+    }
+
+    m_visibleCount = 0;
+    for (u32_t i = 0; i < count; i++)
+    {
+        m_visibleCount += p_visible[i];
+    }
+}
+
+}  // namespace nimbus
@@ -0,0 +1,254 @@
+#include "nimbus/core/nmpch.hpp"
+#include "nimbus/core/core.hpp"
+
+#include "nimbus/renderer/glyphAtlas.hpp"
+
+#include <algorithm>
+
+namespace nimbus
+{
+
+GlyphAtlas::GlyphAtlas()
+{
+    mp_pages = TextureArray::s_create(k_pageSize, k_pageSize, Texture::FormatInternal::rgb8, k_pageCount, false);
+
+    m_cellOwners.assign(k_cellCount, k_noHandle);
+
+    // handed out from the back, so the first page fills up first
+    m_freeCells.reserve(k_cellCount);
+    for (u32_t cell = k_cellCount; cell > 0; cell--)
+    {
+        m_freeCells.push_back(cell - 1);
+    }
+
+    m_cellPixels.resize(k_cellSize * k_cellSize * 3);
+}
+
+GlyphAtlas::~GlyphAtlas()
+{
+    // jobs write their results back into the atlas
+    JobSystem::s_waitAll(m_jobs);
+}
+
+GlyphAtlas::Handle GlyphAtlas::getHandle(const ref<Font>& p_font, u32_t codepoint)
+{
+    u64_t key = (static_cast<u64_t>(p_font->getId()) << 32) | codepoint;
+
+    auto p_handle = m_handles.find(key);
+    if (p_handle != m_handles.end())
+    {
+        return p_handle->second;
+    }
+
+    Handle handle = static_cast<Handle>(m_entries.size());
+
+    Entry entry;
+    entry.fontId    = p_font->getId();
+    entry.codepoint = codepoint;
+    m_entries.push_back(entry);
+
+    m_handles.emplace(key, handle);
+    return handle;
+}
+
+const GlyphAtlas::Glyph* GlyphAtlas::use(Handle handle, const ref<Font>& p_font)
+{
+    NB_CORE_ASSERT(handle < m_entries.size(), "Glyph handle %i out of range", handle);
+
+    Entry& entry = m_entries[handle];
+    NB_CORE_ASSERT(entry.fontId == p_font->getId(), "Glyph handle %i used with another font", handle);
+
+    entry.lastUsedFrame = m_frame;
+
+    if (entry.state == State::ready)
+    {
+        return &entry.glyph;
+    }
+    else if (entry.state != State::none)
+    {
+        return nullptr;
+    }
+
+    Font::GlyphView cached;
+    bool            isCached = p_font->findGlyph(entry.codepoint, k_pixelsPerEm, k_pixelRange, k_cellSize, cached);
+    if (isCached && cached.p_pixels == nullptr)
+    {
+        entry.state = State::blank;
+        return nullptr;
+    }
+
+    // every cell holds something drawn this frame or the last, it gets another try next frame
+    u32_t cell = _allocateCell();
+    if (cell == k_noCell)
+    {
+        return nullptr;
+    }
+
+    if (isCached)
+    {
+        entry.cell         = cell;
+        m_cellOwners[cell] = handle;
+
+        _upload(entry, cached);
+        entry.state = State::ready;
+        m_fromCacheCount++;
+        return &entry.glyph;
+    }
+
+    entry.state        = State::pending;
+    entry.cell         = cell;
+    m_cellOwners[cell] = handle;
+    m_pendingCount++;
+
+    u32_t     codepoint = entry.codepoint;
+    ref<Font> p_keep    = p_font;
+
+    m_jobs.push_back(JobSystem::s_submit(
+        [this, handle, codepoint, p_keep]()
+        {
+            Result result;
+            result.handle = handle;
+            result.rendered
+                = p_keep->renderGlyph(codepoint, k_pixelsPerEm, k_pixelRange, k_cellSize, result.bitmap);
+
+            std::lock_guard<std::mutex> lock(m_resultsMutex);
+            m_results.push_back(std::move(result));
+        }));
+
+    return nullptr;
+}
+
+void GlyphAtlas::update()
+{
+    NB_PROFILE_DETAIL();
+
+    std::vector<Result> results;
+    {
+        std::lock_guard<std::mutex> lock(m_resultsMutex);
+        results.swap(m_results);
+    }
+
+    m_generatedCount = 0;
+    m_fromCacheCount = 0;
+    m_evictedCount   = 0;
+
+    for (const Result& result : results)
+    {
+        Entry& entry = m_entries[result.handle];
+        m_pendingCount--;
+
+        if (result.rendered && !result.bitmap.pixels.empty())
+        {
+            Font::GlyphView glyph;
+            glyph.p_pixels = result.bitmap.pixels.data();
+            glyph.width    = result.bitmap.width;
+            glyph.height   = result.bitmap.height;
+            glyph.plane    = result.bitmap.plane;
+            glyph.atlas    = result.bitmap.atlas;
+
+            _upload(entry, glyph);
+            entry.state = State::ready;
+            m_generatedCount++;
+        }
+        else
+        {
+            // spaces and the like, or a glyph the font doesn't have. Its cell goes to something that can be drawn.
+            _freeCell(entry);
+            entry.state = State::blank;
+        }
+    }
+
+    std::erase_if(m_jobs, [](const JobSystem::Handle& job) { return job->isDone(); });
+
+    m_frame++;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Private Functions
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+u32_t GlyphAtlas::_allocateCell()
+{
+    if (!m_freeCells.empty())
+    {
+        u32_t cell = m_freeCells.back();
+        m_freeCells.pop_back();
+        return cell;
+    }
+
+    if (m_evictableFrame != m_frame)
+    {
+        NB_PROFILE_DETAIL();
+
+        m_evictable.clear();
+        for (u32_t cell = 0; cell < k_cellCount; cell++)
+        {
+            const Entry& owner = m_entries[m_cellOwners[cell]];
+            if (owner.state == State::ready && owner.lastUsedFrame + k_minUnusedFrames <= m_frame)
+            {
+                m_evictable.push_back(cell);
+            }
+        }
+
+        std::sort(m_evictable.begin(),
+                  m_evictable.end(),
+                  [this](u32_t lhs, u32_t rhs)
+                  {
+                      return m_entries[m_cellOwners[lhs]].lastUsedFrame > m_entries[m_cellOwners[rhs]].lastUsedFrame;
+                  });
+
+        m_evictableFrame = m_frame;
+    }
+
+    while (!m_evictable.empty())
+    {
+        u32_t cell = m_evictable.back();
+        m_evictable.pop_back();
+
+        // drawn again since it was gathered
+        Entry& owner = m_entries[m_cellOwners[cell]];
+        if (owner.lastUsedFrame + k_minUnusedFrames > m_frame)
+        {
+            continue;
+        }
+
+        owner.state = State::none;
+        owner.cell  = k_noCell;
+        m_evictedCount++;
+        return cell;
+    }
+
+    return k_noCell;
+}
+
+void GlyphAtlas::_freeCell(Entry& entry)
+{
+    m_cellOwners[entry.cell] = k_noHandle;
+    m_freeCells.push_back(entry.cell);
+    entry.cell = k_noCell;
+}
+
+void GlyphAtlas::_upload(Entry& entry, const Font::GlyphView& glyph)
+{
+    u32_t page  = entry.cell / k_cellsPerPage;
+    u32_t index = entry.cell % k_cellsPerPage;
+    u32_t x     = (index % k_cellsPerRow) * k_cellSize;
+    u32_t y     = (index / k_cellsPerRow) * k_cellSize;
+
+    // The whole cell goes up, so nothing of the glyph that had it before is left for filtering to pick up at this
+    // one's edges. Zero is as far outside the glyph as the range goes.
+    std::fill(m_cellPixels.begin(), m_cellPixels.end(), 0);
+    for (u32_t row = 0; row < glyph.height; row++)
+    {
+        memcpy(&m_cellPixels[row * k_cellSize * 3], &glyph.p_pixels[row * glyph.width * 3], glyph.width * 3);
+    }
+
+    mp_pages->setRegion(page, x, y, k_cellSize, k_cellSize, m_cellPixels.data());
+
+    glm::vec4 offset(x, y, x, y);
+
+    entry.glyph.plane = glyph.plane;
+    entry.glyph.atlas = (glyph.atlas + offset) / static_cast<f32_t>(k_pageSize);
+    entry.glyph.page  = page;
+}
+
+}  // namespace nimbus
@@ -2,6 +2,7 @@
 #include "nimbus/core/core.hpp"
 
 #include "nimbus/renderer/graphicsApi.hpp"
+#include "nimbus/renderer/pipelineState.hpp"
 
 #include "nimbus/renderer/texture.hpp"
 
@@ -16,22 +17,22 @@ void GraphicsApi::init()
     std::call_once(initFlag, []() { GlGraphicsApi::init(); });
 }
 
-void GraphicsApi::drawElements(ref<VertexArray> p_vertexArray, u32_t vertexCount)
+void GraphicsApi::drawElements(const ref<VertexArray>& p_vertexArray, u32_t vertexCount)
 {
     GlGraphicsApi::drawElements(p_vertexArray, vertexCount);
 }
 
-void GraphicsApi::drawArrays(ref<VertexArray> p_vertexArray, u32_t vertexCount)
+void GraphicsApi::drawArrays(const ref<VertexArray>& p_vertexArray, u32_t vertexCount)
 {
     GlGraphicsApi::drawArrays(p_vertexArray, vertexCount);
 }
 
-void GraphicsApi::drawElementsInstanced(ref<VertexArray> p_vertexArray, u32_t instanceCount, u32_t vertexCount)
+void GraphicsApi::drawElementsInstanced(const ref<VertexArray>& p_vertexArray, u32_t instanceCount, u32_t vertexCount)
 {
     GlGraphicsApi::drawElementsInstanced(p_vertexArray, instanceCount, vertexCount);
 }
 
-void GraphicsApi::drawArraysInstanced(ref<VertexArray> p_vertexArray, u32_t instanceCount, u32_t vertexCount)
+void GraphicsApi::drawArraysInstanced(const ref<VertexArray>& p_vertexArray, u32_t instanceCount, u32_t vertexCount)
 {
     GlGraphicsApi::drawArraysInstanced(p_vertexArray, instanceCount, vertexCount);
 }
@@ -66,4 +67,44 @@ void GraphicsApi::setBlendingMode(GraphicsApi::BlendingMode mode)
     GlGraphicsApi::setBlendingMode(mode);
 }
 
+void GraphicsApi::setPipelineState(const PipelineState& state)
+{
+    setBlendingMode(state.blendingMode);
+
+    if (state.depthTest.has_value())
+    {
+        setDepthTest(state.depthTest.value());
+    }
+
+    if (state.wireframe.has_value())
+    {
+        setWireframe(state.wireframe.value());
+    }
+}
+
+GraphicsApi::StateStats GraphicsApi::getStateStats()
+{
+    return GlGraphicsApi::getStateStats();
+}
+
+void GraphicsApi::invalidateStateCache()
+{
+    GlGraphicsApi::invalidateStateCache();
+}
+
+u64_t GraphicsApi::fenceFrame()
+{
+    return GlGraphicsApi::fenceFrame();
+}
+
+u64_t GraphicsApi::waitForGpuFrames(u64_t frames)
+{
+    return GlGraphicsApi::waitForGpuFrames(frames);
+}
+
+void GraphicsApi::executeCmd(RenderCmdOp op, const void* p_payload)
+{
+    GlGraphicsApi::executeCmd(op, p_payload);
+}
+
 }  // namespace nimbus
\ No newline at end of file
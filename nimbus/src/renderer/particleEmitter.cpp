@@ -6,9 +6,15 @@
 #include "nimbus/core/application.hpp"
 #include "nimbus/core/resourceManager.hpp"
 #include "nimbus/renderer/graphicsApi.hpp"
+#include "nimbus/core/simd.hpp"
+#include "nimbus/core/random.hpp"
+#include "nimbus/core/jobSystem.hpp"
 
 #include "glm.hpp"
 
+#include <bit>
+#include <numeric>
+
 namespace nimbus
 {
 
@@ -25,7 +31,14 @@ const std::string k_particleVertexShader = R"(
     layout (location = 0) out vec2 TexCoords;
     layout (location = 1) out vec4 Color;
 
-    uniform mat4 u_viewProjection;
+    layout(std140, binding = 0) uniform FrameData
+    {
+        mat4  u_view;
+        mat4  u_projection;
+        mat4  u_viewProjection;
+        vec4  u_viewport;
+        float u_time;
+    };
 
     void main()
     {
@@ -53,6 +66,19 @@ const std::string k_particleVertexShader = R"(
     }
 )";
 
+// what each random number of an analytic particle's spawn is hashed with
+const u32_t k_streamLifetime = 0;
+const u32_t k_streamAngle    = 1;
+const u32_t k_streamSpeed    = 2;
+const u32_t k_streamColor    = 3;
+const u32_t k_streamSizeX    = 4;
+const u32_t k_streamSizeY    = 5;
+const u32_t k_streamAccelX   = 6;
+const u32_t k_streamAccelY   = 7;
+const u32_t k_streamAccelZ   = 8;
+const u32_t k_streamVolumeU  = 9;
+const u32_t k_streamVolumeV  = 10;
+
 const std::string k_particleFragmentShader = R"(
     #version 460 core
 
@@ -86,7 +112,7 @@ ParticleEmitter::ParticleEmitter(u32_t               particleCount,
       m_parameters(particleParameters),
       m_is3d(is3d),
       mp_texture(p_texture),
-      m_randGen(std::random_device{}())
+      m_random(particleParameters.seed != 0 ? Random(particleParameters.seed) : Random())
 {
     NB_CORE_ASSERT(!m_is3d, "3D spaces particles are not supported!");
     NB_CORE_ASSERT(m_numParticles, "Particle Emitter needs at least 1 particle!");
@@ -111,84 +137,37 @@ ParticleEmitter::ParticleEmitter(u32_t               particleCount,
 
     if (!m_is3d)
     {
-        // clang-format off
-        const std::vector<vertexData2d> vData = 
-        {
-            // centered around (0, 0)
-            // pos               // tex
-            {glm::vec2(-0.5f, -0.5f), glm::vec2(0.0f, 1.0f)},  // bottom left
-            {glm::vec2( 0.5f, -0.5f), glm::vec2(1.0f, 1.0f)},  // bottom right
-            {glm::vec2( 0.5f,  0.5f), glm::vec2(1.0f, 0.0f)},  // top right
-            {glm::vec2(-0.5f,  0.5f), glm::vec2(0.0f, 0.0f)}   // top left
-        };
-
-        std::vector<u8_t> perVertexIdx = {
-            0, 1, 2,  // first triangle
-            2, 3, 0  // second triangle
-        };
-        // clang-format on
-
         ////////////////////////////////////////////////////////////////////////
-        // Random generator setup
+        // Random setup
         ////////////////////////////////////////////////////////////////////////
-        // general purpose distribution
-        m_gpRandDist = std::uniform_real_distribution<f32_t>(0.0f, 1.0f);
-
-        // lifetime distribution
-        setLifeTime(m_parameters.lifetimeMin_s, m_parameters.lifetimeMax_s);
-
-        // speed ditribution
-        setInitSpeed(m_parameters.initSpeedMin, m_parameters.initSpeedMax);
-
-        // accel distribution
-        setAcceleration(m_parameters.accelerationMin, m_parameters.accelerationMax);
-
-        // size distribution
-        setInitSize(m_parameters.initSizeMin, m_parameters.initSizeMax);
-
-        setEjectionAngle(m_parameters.ejectionBaseAngle_rad, m_parameters.ejectionSpreadAngle_rad);
-
+        // everything else is drawn straight from the parameters' ranges
         chooseColors(0, m_parameters.colors.size() - 1);
 
         ////////////////////////////////////////////////////////////////////////
-        // GPU Buffers
+        // CPU data, GPU buffers are shared by every emitter in ParticleSystem
         ////////////////////////////////////////////////////////////////////////
-        mp_vao = VertexArray::s_create();
-
-        ref<VertexBuffer> vertexVbo = VertexBuffer::s_create(&vData[0], vData.size() * sizeof(vertexData2d));
-
-        vertexVbo->setFormat(ParticleEmitter::k_vertexVboFormat2d);
-
-        mp_vao->addVertexBuffer(vertexVbo);
-
-        mp_vao->setIndexBuffer(IndexBuffer::s_create(&perVertexIdx[0], perVertexIdx.size()));
-
-        // we know how many particles we have, so reserve the memory
-        m_particleInstanceData.reserve(m_numParticles);
-        m_particleAttributes.reserve(m_numParticles);
+        // we know how many particles we have, so size the streams once
+        m_particles.resize(m_numParticles);
+        m_deadParticles.reserve(m_numParticles);
         for (u32_t i = 0; i < m_numParticles; i++)
         {
             glm::vec3 positionOffset = _getRandomPositionInVolume();
+            glm::vec3 position       = m_parameters.centerPosition + positionOffset;
 
-            particleAttributes partAtt
-                = {positionOffset, {0.0f, 0.0f, 0.0f}, {0.0f, 0.0f, 0.0f}, {0.0f, 0.0f}, 0, 1.0, 0.0};
-
-            m_particleAttributes.push_back(partAtt);
-
-            // set GPU data
-            particleInstanceData partInst
-                = {m_parameters.centerPosition + positionOffset, {0.0f, 0.0f, 0.0f, 0.0f}, {0.0f, 0.0f}};
-
-            m_particleInstanceData.push_back(partInst);
+            m_particles.positionOffset[i] = positionOffset;
+            m_particles.positionX[i]      = position.x;
+            m_particles.positionY[i]      = position.y;
+            m_particles.positionZ[i]      = position.z;
+            m_particles.startLifetime[i]  = 1.0f;
         }
 
-        mp_instanceVbo = VertexBuffer::s_create(&m_particleInstanceData[0],
-                                                m_particleInstanceData.size() * sizeof(particleInstanceData),
-                                                VertexBuffer::Type::streamDraw);
-
-        mp_instanceVbo->setFormat(k_instanceVboFormat);
-
-        mp_vao->addVertexBuffer(mp_instanceVbo);
+        // analytic emitters without a seed get one of their own
+        m_seed = m_parameters.seed != 0 ? m_parameters.seed : m_random.nextU32();
+        if (m_parameters.analytic)
+        {
+            m_generations.assign(m_numParticles, k_noGeneration);
+            m_time = m_parameters.prewarm_s;
+        }
     }
 }
 
@@ -205,115 +184,151 @@ void ParticleEmitter::update(f32_t deltaTime)
 {
     NB_PROFILE_DETAIL();
 
-    for (u32_t i = 0; i < m_numLiveParticles; ++i)
+    if (m_parameters.analytic)
     {
-        particleInstanceData* p_instDat = &m_particleInstanceData[i];
-        particleAttributes*   p_attrib  = &m_particleAttributes[i];
+        // nothing to step, particles are evaluated at the time when drawn
+        m_time += deltaTime;
+        return;
+    }
 
-        p_attrib->decreaseLifetime(deltaTime);
+    m_deadParticles.clear();
+    if (m_numLiveParticles < k_minParallelParticles)
+    {
+        _stepParticles(0, m_numLiveParticles, deltaTime, m_deadParticles);
+    }
+    else
+    {
+        u32_t chunkCount = (m_numLiveParticles + k_chunkParticles - 1) / k_chunkParticles;
+        if (m_chunkDeadParticles.size() < chunkCount)
+        {
+            m_chunkDeadParticles.resize(chunkCount);
+        }
 
-        if (p_attrib->isDead())
+        auto stepChunks = [this, deltaTime](u32_t begin, u32_t end)
         {
-            if (!m_parameters.persist)
-            {
-                ////////////////////////////////////////////////////////////////
-                //  Move dead particles to end
-                ////////////////////////////////////////////////////////////////
-                if (i != m_numLiveParticles - 1)  // prevent swap with itself
-                {
-                    std::swap(m_particleAttributes[i], m_particleAttributes[m_numLiveParticles - 1]);
-                    std::swap(m_particleInstanceData[i], m_particleInstanceData[m_numLiveParticles - 1]);
-                }
-
-                // this is important, we don't want to visit dead particles
-                // during this current loop, so indeed modify the loop
-                // condition
-                m_numLiveParticles--;
-
-                continue;
-            }
-            else
+            for (u32_t chunk = begin; chunk < end; chunk++)
             {
-                // don't adjust m_numLiveParticles, just respawn this particle
-                _respawnParticle(p_attrib, p_instDat);
+                u32_t first = chunk * k_chunkParticles;
+                u32_t last  = std::min(first + k_chunkParticles, m_numLiveParticles);
+
+                m_chunkDeadParticles[chunk].clear();
+                _stepParticles(first, last, deltaTime, m_chunkDeadParticles[chunk]);
             }
-        }
+        };
 
-        ////////////////////////////////////////////////////////////////////
-        //  Step living particles
-        ////////////////////////////////////////////////////////////////////
-        f32_t currentLifeLeft = p_attrib->getLifePercent();
-        // calculate velocity based on acceleration and lifetime
-        glm::vec3 velocity
-            = p_attrib->velocity + (p_attrib->acceleration * (p_attrib->startLifetime - p_attrib->curLifetime));
+        JobSystem::s_wait(JobSystem::s_parallelFor(chunkCount, 1, stepChunks));
 
-        // position update
-        p_instDat->updatePosition(velocity, deltaTime);
+        // merged in chunk order they're in index order, as if stepped in one go
+        for (u32_t chunk = 0; chunk < chunkCount; chunk++)
+        {
+            const std::vector<u32_t>& chunkDead = m_chunkDeadParticles[chunk];
+            m_deadParticles.insert(m_deadParticles.end(), chunkDead.begin(), chunkDead.end());
+        }
+    }
 
-        // update color
-        p_instDat->color = glm::mix(m_parameters.colors[p_attrib->colorIdx].colorEnd,
-                                    m_parameters.colors[p_attrib->colorIdx].colorStart,
-                                    currentLifeLeft);
+    if (m_parameters.persist)
+    {
+        // don't adjust m_numLiveParticles, just respawn them
+        _respawnParticles(m_deadParticles);
+        return;
+    }
 
-        //  shrink particles as they age if desired
-        if (m_parameters.shrink)
+    ////////////////////////////////////////////////////////////////////////////
+    //  Move dead particles to end
+    ////////////////////////////////////////////////////////////////////////////
+    // highest first, so the last live particle swapped in is never one that
+    // died this step too
+    for (auto it = m_deadParticles.rbegin(); it != m_deadParticles.rend(); ++it)
+    {
+        m_numLiveParticles--;
+        if (*it != m_numLiveParticles)  // prevent swap with itself
         {
-            // shrink at a slower rate initially then speed up as
-            // particle ages
-            f32_t sizeScalar = std::sqrt(currentLifeLeft);
-
-            p_instDat->size.x = sizeScalar * p_attrib->startSize.x;
-            p_instDat->size.y = sizeScalar * p_attrib->startSize.y;
+            m_particles.swap(*it, m_numLiveParticles);
         }
     }
 }
 
-void ParticleEmitter::draw()
+bool ParticleEmitter::isDone() const
 {
-    NB_PROFILE();
+    if (m_parameters.analytic)
+    {
+        // without persisting every slot spawns once, the longest lived is gone by now
+        return !m_parameters.persist && m_time >= m_parameters.lifetimeMax_s;
+    }
+
+    return m_numLiveParticles == 0;
+}
 
-    if (m_numLiveParticles == 0)
+u32_t ParticleEmitter::getInstanceCount() const
+{
+    if (isDone())
     {
-        // if this guy is done emitting don't do anything
-        return;
+        return 0;
     }
 
-    // if these aren't loaded, don't proceed
-    if(!mp_texture->bind(0))
+    if (!m_parameters.analytic)
     {
-        return;
+        return m_numLiveParticles;
     }
-    
-    if(!mp_shader->bind())
+
+    // the ones alive at the time they'd be evaluated at, without spawning them
+    u32_t count = 0;
+    for (u32_t i = 0; i < m_numParticles; i++)
     {
-        return;
+        f32_t lifetime;
+        f32_t age;
+        u32_t generation;
+        count += _getAnalyticAge(i, lifetime, age, generation);
     }
 
-    mp_shader->setInt("particleTexture", 0);
+    return count;
+}
 
-    mp_instanceVbo->bind();
-    mp_instanceVbo->setData(&m_particleInstanceData[0], m_numLiveParticles * sizeof(particleInstanceData));
+u32_t ParticleEmitter::writeInstances(particleInstanceData* p_dest, u32_t maxCount)
+{
+    NB_PROFILE_DETAIL();
 
-    GraphicsApi::BlendingMode currBlendMode = GraphicsApi::getBlendingMode();
-    GraphicsApi::setBlendingMode(m_parameters.blendingMode);
+    // color goes from start to end over a particle's life, the table has the
+    // end and the difference to the start of each color, taken at draw time
+    // so color edits apply to the living too
+    u32_t colorCount = static_cast<u32_t>(m_parameters.colors.size());
+    m_colorTable.resize(colorCount * 2);
+    for (u32_t c = 0; c < colorCount; c++)
+    {
+        m_colorTable[c * 2]     = m_parameters.colors[c].colorEnd;
+        m_colorTable[c * 2 + 1] = m_parameters.colors[c].colorStart - m_parameters.colors[c].colorEnd;
+    }
 
-    Renderer::s_renderInstanced(mp_shader, mp_vao, m_numLiveParticles);
+    if (m_parameters.analytic)
+    {
+        return _writeAnalyticInstances(p_dest, maxCount);
+    }
 
-    GraphicsApi::setBlendingMode(currBlendMode);
-}
+    u32_t count = std::min(m_numLiveParticles, maxCount);
+    _writeInstances(p_dest, count);
 
-bool ParticleEmitter::isDone()
-{
-    return m_numLiveParticles == 0;
+    return count;
 }
 
 void ParticleEmitter::reset(bool updateLiving)
 {
     NB_PROFILE_DETAIL();
 
+    if (m_parameters.analytic)
+    {
+        // dead or alive, particles follow from the time, only restarting it changes them
+        if (updateLiving)
+        {
+            m_time = m_parameters.prewarm_s;
+        }
+        return;
+    }
+
+    // gathered first so they respawn in one batch
+    m_deadParticles.clear();
     for (u32_t i = 0; i < m_numParticles; ++i)
     {
-        bool isDead = m_particleAttributes[i].isDead();
+        bool isDead = m_particles.curLifetime[i] <= 0.0f;
         if (updateLiving || isDead)
         {
             if (isDead)
@@ -321,9 +336,11 @@ void ParticleEmitter::reset(bool updateLiving)
                 // only increment for particles we respawn that are dead
                 m_numLiveParticles++;
             }
-            _respawnParticle(&m_particleAttributes[i], &m_particleInstanceData[i]);
+            m_deadParticles.push_back(i);
         }
     }
+
+    _respawnParticles(m_deadParticles);
 }
 
 void ParticleEmitter::chooseColors(size_t min, size_t max)
@@ -344,7 +361,8 @@ void ParticleEmitter::chooseColors(size_t min, size_t max)
             m_parameters.colors.size() - 1);
     }
 
-    m_colorIndexDist = std::uniform_int_distribution<u32_t>(minC, maxC);
+    m_colorMin = static_cast<u32_t>(minC);
+    m_colorMax = static_cast<u32_t>(maxC);
 }
 
 void ParticleEmitter::setColor(u32_t idx, const colorSpec& color)
@@ -382,7 +400,11 @@ void ParticleEmitter::setPosition(const glm::vec3& centerPosition, bool updateLi
     {
         for (u32_t i = 0; i < m_numParticles; ++i)
         {
-            m_particleInstanceData[i].position = m_parameters.centerPosition + m_particleAttributes[i].positionOffset;
+            glm::vec3 position = m_parameters.centerPosition + m_particles.positionOffset[i];
+
+            m_particles.positionX[i] = position.x;
+            m_particles.positionY[i] = position.y;
+            m_particles.positionZ[i] = position.z;
         }
     }
 }
@@ -391,10 +413,6 @@ void ParticleEmitter::setEjectionAngle(f32_t ejectionBaseAngle_rad, f32_t ejecti
 {
     m_parameters.ejectionBaseAngle_rad   = ejectionBaseAngle_rad;
     m_parameters.ejectionSpreadAngle_rad = ejectionSpreadAngle_rad;
-
-    m_angleDist = std::uniform_real_distribution<f32_t>(
-        (m_parameters.ejectionBaseAngle_rad - m_parameters.ejectionSpreadAngle_rad / 2),
-        (m_parameters.ejectionBaseAngle_rad + m_parameters.ejectionSpreadAngle_rad / 2));
 }
 
 void ParticleEmitter::setPersist(bool persist)
@@ -418,7 +436,6 @@ void ParticleEmitter::setLifeTime(f32_t min, f32_t max)
 
     m_parameters.lifetimeMin_s = min;
     m_parameters.lifetimeMax_s = max;
-    m_lifetimeDist = std::uniform_real_distribution<f32_t>(m_parameters.lifetimeMin_s, m_parameters.lifetimeMax_s);
 }
 
 void ParticleEmitter::setInitSpeed(f32_t min, f32_t max)
@@ -427,7 +444,6 @@ void ParticleEmitter::setInitSpeed(f32_t min, f32_t max)
 
     m_parameters.initSpeedMin = min;
     m_parameters.initSpeedMax = max;
-    m_speedDist = std::uniform_real_distribution<f32_t>(m_parameters.initSpeedMin, m_parameters.initSpeedMax);
 }
 
 void ParticleEmitter::setInitSize(glm::vec2 min, glm::vec2 max)
@@ -437,9 +453,6 @@ void ParticleEmitter::setInitSize(glm::vec2 min, glm::vec2 max)
 
     m_parameters.initSizeMin = min;
     m_parameters.initSizeMax = max;
-    m_sizeDistX = std::uniform_real_distribution<f32_t>(m_parameters.initSizeMin.x, m_parameters.initSizeMax.x);
-
-    m_sizeDistY = std::uniform_real_distribution<f32_t>(m_parameters.initSizeMin.y, m_parameters.initSizeMax.y);
 }
 
 void ParticleEmitter::setAcceleration(glm::vec3 min, glm::vec3 max)
@@ -450,15 +463,6 @@ void ParticleEmitter::setAcceleration(glm::vec3 min, glm::vec3 max)
 
     m_parameters.accelerationMin = min;
     m_parameters.accelerationMax = max;
-
-    m_accelDistX
-        = std::uniform_real_distribution<f32_t>(m_parameters.accelerationMin.x, m_parameters.accelerationMax.x);
-
-    m_accelDistY
-        = std::uniform_real_distribution<f32_t>(m_parameters.accelerationMin.y, m_parameters.accelerationMax.y);
-
-    m_accelDistZ
-        = std::uniform_real_distribution<f32_t>(m_parameters.accelerationMin.z, m_parameters.accelerationMax.z);
 }
 
 void ParticleEmitter::setBlendMode(GraphicsApi::BlendingMode mode)
@@ -466,42 +470,381 @@ void ParticleEmitter::setBlendMode(GraphicsApi::BlendingMode mode)
     m_parameters.blendingMode = mode;
 };
 
+void ParticleEmitter::setPriority(i32_t priority)
+{
+    m_parameters.priority = priority;
+}
+
+void ParticleEmitter::setAnalytic(bool analytic)
+{
+    if (analytic == m_parameters.analytic)
+    {
+        return;
+    }
+
+    m_parameters.analytic = analytic;
+
+    if (analytic)
+    {
+        m_generations.assign(m_numParticles, k_noGeneration);
+        m_time = m_parameters.prewarm_s;
+    }
+    else
+    {
+        // stepping carries on from a fresh spawn of every particle
+        m_numLiveParticles = m_numParticles;
+        m_deadParticles.resize(m_numParticles);
+        std::iota(m_deadParticles.begin(), m_deadParticles.end(), 0);
+        _respawnParticles(m_deadParticles);
+    }
+}
+
+void ParticleEmitter::seek(f32_t time_s)
+{
+    if (!m_parameters.analytic)
+    {
+        Log::coreWarn("Only analytic particle emitters can seek");
+        return;
+    }
+
+    m_time = std::max(time_s, 0.0f);
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Private Functions
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-void ParticleEmitter::_respawnParticle(particleAttributes* p_attrib, particleInstanceData* p_instDat)
+void ParticleEmitter::ParticleStreams::resize(u32_t count)
+{
+    positionX.resize(count, 0.0f);
+    positionY.resize(count, 0.0f);
+    positionZ.resize(count, 0.0f);
+    velocityX.resize(count, 0.0f);
+    velocityY.resize(count, 0.0f);
+    velocityZ.resize(count, 0.0f);
+    accelerationX.resize(count, 0.0f);
+    accelerationY.resize(count, 0.0f);
+    accelerationZ.resize(count, 0.0f);
+    startSizeX.resize(count, 0.0f);
+    startSizeY.resize(count, 0.0f);
+    startLifetime.resize(count, 0.0f);
+    curLifetime.resize(count, 0.0f);
+    colorIdx.resize(count, 0);
+    positionOffset.resize(count, glm::vec3(0.0f));
+}
+
+void ParticleEmitter::ParticleStreams::swap(u32_t lhs, u32_t rhs)
+{
+    std::swap(positionX[lhs], positionX[rhs]);
+    std::swap(positionY[lhs], positionY[rhs]);
+    std::swap(positionZ[lhs], positionZ[rhs]);
+    std::swap(velocityX[lhs], velocityX[rhs]);
+    std::swap(velocityY[lhs], velocityY[rhs]);
+    std::swap(velocityZ[lhs], velocityZ[rhs]);
+    std::swap(accelerationX[lhs], accelerationX[rhs]);
+    std::swap(accelerationY[lhs], accelerationY[rhs]);
+    std::swap(accelerationZ[lhs], accelerationZ[rhs]);
+    std::swap(startSizeX[lhs], startSizeX[rhs]);
+    std::swap(startSizeY[lhs], startSizeY[rhs]);
+    std::swap(startLifetime[lhs], startLifetime[rhs]);
+    std::swap(curLifetime[lhs], curLifetime[rhs]);
+    std::swap(colorIdx[lhs], colorIdx[rhs]);
+    std::swap(positionOffset[lhs], positionOffset[rhs]);
+}
+
+void ParticleEmitter::_respawnParticles(const std::vector<u32_t>& indices)
+{
+    NB_PROFILE_DETAIL();
+
+    ParticleStreams& particles = m_particles;
+    u32_t            count     = static_cast<u32_t>(indices.size());
+
+    // every random a respawn takes, for the whole batch in one fill, a run of count per attribute
+    m_spawnRandoms.resize(count * k_spawnRandomCount);
+    m_random.fill(m_spawnRandoms.data(), count * k_spawnRandomCount, 0.0f, 1.0f);
+
+    const f32_t* p_lifetimes = &m_spawnRandoms[0];
+    const f32_t* p_angles    = p_lifetimes + count;
+    const f32_t* p_speeds    = p_angles + count;
+    const f32_t* p_colors    = p_speeds + count;
+    const f32_t* p_sizesX    = p_colors + count;
+    const f32_t* p_sizesY    = p_sizesX + count;
+    const f32_t* p_accelsX   = p_sizesY + count;
+    const f32_t* p_accelsY   = p_accelsX + count;
+    const f32_t* p_accelsZ   = p_accelsY + count;
+
+    auto lerp = [](f32_t min, f32_t max, f32_t unit) { return min + (max - min) * unit; };
+
+    const Parameters& params     = m_parameters;
+    f32_t             angleMin   = params.ejectionBaseAngle_rad - params.ejectionSpreadAngle_rad / 2;
+    f32_t             angleMax   = params.ejectionBaseAngle_rad + params.ejectionSpreadAngle_rad / 2;
+    u32_t             colorCount = m_colorMax - m_colorMin + 1;
+
+    for (u32_t i = 0; i < count; i++)
+    {
+        u32_t idx = indices[i];
+
+        f32_t lifetime               = lerp(params.lifetimeMin_s, params.lifetimeMax_s, p_lifetimes[i]);
+        particles.startLifetime[idx] = lifetime;
+        particles.curLifetime[idx]   = lifetime;
+
+        f32_t angle = -lerp(angleMin, angleMax, p_angles[i]) - m_spawnRotation.z;
+        f32_t speed = lerp(params.initSpeedMin, params.initSpeedMax, p_speeds[i]);
+
+        particles.velocityX[idx] = std::sin(angle) * speed;
+        particles.velocityY[idx] = std::cos(angle) * speed;
+        particles.velocityZ[idx] = 0.0f;
+
+        u32_t color             = static_cast<u32_t>(p_colors[i] * colorCount);
+        particles.colorIdx[idx] = m_colorMin + std::min(color, colorCount - 1);
+
+        particles.startSizeX[idx] = lerp(params.initSizeMin.x, params.initSizeMax.x, p_sizesX[i]) * m_spawnScale.x;
+        particles.startSizeY[idx] = lerp(params.initSizeMin.y, params.initSizeMax.y, p_sizesY[i]) * m_spawnScale.y;
+
+        particles.accelerationX[idx] = lerp(params.accelerationMin.x, params.accelerationMax.x, p_accelsX[i]);
+        particles.accelerationY[idx] = lerp(params.accelerationMin.y, params.accelerationMax.y, p_accelsY[i]);
+        particles.accelerationZ[idx] = lerp(params.accelerationMin.z, params.accelerationMax.z, p_accelsZ[i]);
+
+        glm::vec3 position = params.centerPosition + particles.positionOffset[idx] + m_spawnTranslation;
+
+        particles.positionX[idx] = position.x;
+        particles.positionY[idx] = position.y;
+        particles.positionZ[idx] = position.z;
+    }
+}
+
+void ParticleEmitter::_stepParticles(u32_t begin, u32_t end, f32_t deltaTime, std::vector<u32_t>& deadParticles)
+{
+    ParticleStreams& particles = m_particles;
+
+    // velocity is the spawn velocity plus the acceleration over the particle's age
+    const simd::f32v_t dt   = simd::set(deltaTime);
+    const simd::f32v_t zero = simd::set(0.0f);
+
+    u32_t i = begin;
+    for (; i + simd::k_width <= end; i += simd::k_width)
+    {
+        simd::f32v_t life = simd::sub(simd::load(&particles.curLifetime[i]), dt);
+        simd::store(&particles.curLifetime[i], life);
+
+        simd::f32v_t age = simd::sub(simd::load(&particles.startLifetime[i]), life);
+
+        simd::f32v_t velX
+            = simd::add(simd::load(&particles.velocityX[i]), simd::mul(simd::load(&particles.accelerationX[i]), age));
+        simd::f32v_t velY
+            = simd::add(simd::load(&particles.velocityY[i]), simd::mul(simd::load(&particles.accelerationY[i]), age));
+        simd::f32v_t velZ
+            = simd::add(simd::load(&particles.velocityZ[i]), simd::mul(simd::load(&particles.accelerationZ[i]), age));
+
+        simd::store(&particles.positionX[i], simd::add(simd::load(&particles.positionX[i]), simd::mul(velX, dt)));
+        simd::store(&particles.positionY[i], simd::add(simd::load(&particles.positionY[i]), simd::mul(velY, dt)));
+        simd::store(&particles.positionZ[i], simd::add(simd::load(&particles.positionZ[i]), simd::mul(velZ, dt)));
+
+        // usually none of them died, which is one test for the whole group
+        u32_t dead = simd::lessEqualMask(life, zero);
+        while (dead != 0)
+        {
+            deadParticles.push_back(i + std::countr_zero(dead));
+            dead &= dead - 1;
+        }
+    }
+
+    // what's left over is less than a group
+    for (; i < end; i++)
+    {
+        f32_t life               = particles.curLifetime[i] - deltaTime;
+        particles.curLifetime[i] = life;
+
+        f32_t age = particles.startLifetime[i] - life;
+
+        particles.positionX[i] += (particles.velocityX[i] + particles.accelerationX[i] * age) * deltaTime;
+        particles.positionY[i] += (particles.velocityY[i] + particles.accelerationY[i] * age) * deltaTime;
+        particles.positionZ[i] += (particles.velocityZ[i] + particles.accelerationZ[i] * age) * deltaTime;
+
+        if (life <= 0.0f)
+        {
+            deadParticles.push_back(i);
+        }
+    }
+}
+
+void ParticleEmitter::_writeInstances(particleInstanceData* p_dest, u32_t count)
+{
+    const ParticleStreams& particles  = m_particles;
+    u32_t                  colorCount = static_cast<u32_t>(m_colorTable.size() / 2);
+
+    // a particle's share of its life left and how much of its size it has
+    // left, the group's worth is computed at once then written per particle
+    f32_t lifeLeft[simd::k_width];
+    f32_t sizeLeft[simd::k_width];
+
+    auto write = [&](u32_t idx, f32_t life, f32_t size)
+    {
+        // colors removed since the particle spawned fall back to the last one
+        u32_t color = std::min(particles.colorIdx[idx], colorCount - 1) * 2;
+
+        particleInstanceData instance;
+        instance.position = glm::vec3(particles.positionX[idx], particles.positionY[idx], particles.positionZ[idx]);
+        instance.color    = m_colorTable[color] + m_colorTable[color + 1] * life;
+        instance.size     = glm::vec2(particles.startSizeX[idx], particles.startSizeY[idx]) * size;
+
+        p_dest[idx] = instance;
+    };
+
+    const simd::f32v_t zero = simd::set(0.0f);
+    const simd::f32v_t one  = simd::set(1.0f);
+
+    u32_t i = 0;
+    for (; i + simd::k_width <= count; i += simd::k_width)
+    {
+        simd::f32v_t life = simd::div(simd::load(&particles.curLifetime[i]), simd::load(&particles.startLifetime[i]));
+
+        // shrink at a slower rate initially then speed up as particle ages
+        simd::f32v_t size = m_parameters.shrink ? simd::sqrt(simd::max(life, zero)) : one;
+
+        simd::store(lifeLeft, life);
+        simd::store(sizeLeft, size);
+
+        for (u32_t lane = 0; lane < simd::k_width; lane++)
+        {
+            write(i + lane, lifeLeft[lane], sizeLeft[lane]);
+        }
+    }
+
+    for (; i < count; i++)
+    {
+        f32_t life = particles.curLifetime[i] / particles.startLifetime[i];
+        write(i, life, m_parameters.shrink ? std::sqrt(std::max(life, 0.0f)) : 1.0f);
+    }
+}
+
+f32_t ParticleEmitter::_getAnalyticLifetime(u32_t idx) const
+{
+    f32_t unit = _s_hashUnit(m_seed, idx, 0, k_streamLifetime);
+    return m_parameters.lifetimeMin_s + (m_parameters.lifetimeMax_s - m_parameters.lifetimeMin_s) * unit;
+}
+
+bool ParticleEmitter::_getAnalyticAge(u32_t idx, f32_t& lifetime, f32_t& age, u32_t& generation) const
+{
+    lifetime = _getAnalyticLifetime(idx);
+    if (lifetime <= 0.0f)
+    {
+        return false;
+    }
+
+    // a slot respawns as soon as it dies, so which spawn it's on and how
+    // old that is follow from the time
+    f64_t spawn = 0.0;
+    if (m_parameters.persist)
+    {
+        spawn = std::min(std::floor(m_time / lifetime), static_cast<f64_t>(k_noGeneration - 1));
+    }
+
+    age        = static_cast<f32_t>(m_time - spawn * lifetime);
+    generation = static_cast<u32_t>(spawn);
+
+    return age < lifetime;
+}
+
+void ParticleEmitter::_spawnAnalytic(u32_t idx, u32_t generation)
 {
-    p_attrib->resetLifetime(m_lifetimeDist(m_randGen));
+    ParticleStreams& particles = m_particles;
+
+    // the same ranges the distributions draw from
+    auto random = [&](u32_t stream, f32_t min, f32_t max)
+    { return min + (max - min) * _s_hashUnit(m_seed, idx, generation, stream); };
+
+    f32_t angleMin = m_parameters.ejectionBaseAngle_rad - m_parameters.ejectionSpreadAngle_rad / 2;
+    f32_t angleMax = m_parameters.ejectionBaseAngle_rad + m_parameters.ejectionSpreadAngle_rad / 2;
+    f32_t angle    = -random(k_streamAngle, angleMin, angleMax);
+    f32_t speed    = random(k_streamSpeed, m_parameters.initSpeedMin, m_parameters.initSpeedMax);
+
+    // before the spawn rotation, that's applied when evaluated
+    particles.velocityX[idx] = std::sin(angle) * speed;
+    particles.velocityY[idx] = std::cos(angle) * speed;
+    particles.velocityZ[idx] = 0.0f;
 
-    f32_t angle = -m_angleDist(m_randGen) - m_spawnRotation.z;
-    f32_t speed = m_speedDist(m_randGen);
+    u32_t colorCount = m_colorMax - m_colorMin + 1;
+    u32_t color      = static_cast<u32_t>(random(k_streamColor, 0.0f, static_cast<f32_t>(colorCount)));
 
-    p_attrib->velocity = glm::vec3(std::sin(angle) * speed, std::cos(angle) * speed, 0.0f);
+    particles.colorIdx[idx] = m_colorMin + std::min(color, colorCount - 1);
 
-    p_attrib->colorIdx = _getRandomColorIdx();
+    particles.startSizeX[idx] = random(k_streamSizeX, m_parameters.initSizeMin.x, m_parameters.initSizeMax.x);
+    particles.startSizeY[idx] = random(k_streamSizeY, m_parameters.initSizeMin.y, m_parameters.initSizeMax.y);
 
-    p_attrib->startSize.x = m_sizeDistX(m_randGen) * m_spawnScale.x;
-    p_attrib->startSize.y = m_sizeDistY(m_randGen) * m_spawnScale.y;
+    particles.accelerationX[idx]
+        = random(k_streamAccelX, m_parameters.accelerationMin.x, m_parameters.accelerationMax.x);
+    particles.accelerationY[idx]
+        = random(k_streamAccelY, m_parameters.accelerationMin.y, m_parameters.accelerationMax.y);
+    particles.accelerationZ[idx]
+        = random(k_streamAccelZ, m_parameters.accelerationMin.z, m_parameters.accelerationMax.z);
 
-    p_attrib->acceleration.x = m_accelDistX(m_randGen);
-    p_attrib->acceleration.y = m_accelDistY(m_randGen);
-    p_attrib->acceleration.z = m_accelDistZ(m_randGen);
+    particles.positionOffset[idx]
+        = _getPositionInVolume(random(k_streamVolumeU, -1.0f, 1.0f), random(k_streamVolumeV, -1.0f, 1.0f));
 
-    // reset the instance data
-    p_instDat->reset(m_parameters.centerPosition + p_attrib->positionOffset + m_spawnTranslation,
-                     p_attrib->startSize,
-                     m_parameters.colors[p_attrib->colorIdx].colorStart);
+    m_generations[idx] = generation;
 }
 
-u32_t ParticleEmitter::_getRandomColorIdx()
+u32_t ParticleEmitter::_writeAnalyticInstances(particleInstanceData* p_dest, u32_t maxCount)
 {
-    return m_colorIndexDist(m_randGen);
+    const ParticleStreams& particles  = m_particles;
+    u32_t                  colorCount = static_cast<u32_t>(m_colorTable.size() / 2);
+
+    // the spawn transform as it is now applies to every particle
+    glm::vec3 origin = m_parameters.centerPosition + m_spawnTranslation;
+    f32_t     sinRot = std::sin(m_spawnRotation.z);
+    f32_t     cosRot = std::cos(m_spawnRotation.z);
+
+    u32_t count = 0;
+    for (u32_t i = 0; i < m_numParticles && count < maxCount; i++)
+    {
+        f32_t lifetime;
+        f32_t age;
+        u32_t generation;
+        if (!_getAnalyticAge(i, lifetime, age, generation))
+        {
+            continue;
+        }
+
+        if (m_generations[i] != generation)
+        {
+            _spawnAnalytic(i, generation);
+        }
+
+        // same turn as the angle gets in _respawnParticles
+        glm::vec3 velocity(particles.velocityX[i] * cosRot - particles.velocityY[i] * sinRot,
+                           particles.velocityY[i] * cosRot + particles.velocityX[i] * sinRot,
+                           particles.velocityZ[i]);
+        glm::vec3 acceleration(particles.accelerationX[i], particles.accelerationY[i], particles.accelerationZ[i]);
+
+        f32_t life = 1.0f - age / lifetime;
+
+        // shrink at a slower rate initially then speed up as particle ages
+        f32_t sizeLeft = m_parameters.shrink ? std::sqrt(life) : 1.0f;
+        u32_t color    = std::min(particles.colorIdx[i], colorCount - 1) * 2;
+
+        glm::vec2 startSize(particles.startSizeX[i] * m_spawnScale.x, particles.startSizeY[i] * m_spawnScale.y);
+
+        // the stepped motion, velocity + acceleration * age, integrated over the age
+        particleInstanceData instance;
+        instance.position = origin + particles.positionOffset[i] + velocity * age + 0.5f * acceleration * age * age;
+        instance.color    = m_colorTable[color] + m_colorTable[color + 1] * life;
+        instance.size     = startSize * sizeLeft;
+
+        p_dest[count++] = instance;
+    }
+
+    return count;
 }
 
 glm::vec3 ParticleEmitter::_getRandomPositionInVolume()
 {
-    std::uniform_real_distribution<f32_t> dist(-1.0f, 1.0f);
+    f32_t u = m_random.range(-1.0f, 1.0f);
+    f32_t v = m_random.range(-1.0f, 1.0f);
+    return _getPositionInVolume(u, v);
+}
 
+glm::vec3 ParticleEmitter::_getPositionInVolume(f32_t u, f32_t v) const
+{
     switch (m_parameters.spawnVolumeType)
     {
         case SpawnVolumeType::point:
@@ -511,19 +854,19 @@ glm::vec3 ParticleEmitter::_getRandomPositionInVolume()
         }
         case SpawnVolumeType::circle:
         {
-            f32_t theta = 2 * 3.1415926f * dist(m_randGen);
-            f32_t r     = m_parameters.circleVolumeParams.radius * sqrt(dist(m_randGen));
+            f32_t theta = 2 * 3.1415926f * u;
+            f32_t r     = m_parameters.circleVolumeParams.radius * sqrt(v);
             return glm::vec3(r * cos(theta), r * sin(theta), 0.0f);
         }
         case SpawnVolumeType::rectangle:
         {
-            f32_t x = dist(m_randGen) * m_parameters.rectVolumeParams.width;
-            f32_t y = dist(m_randGen) * m_parameters.rectVolumeParams.height;
+            f32_t x = u * m_parameters.rectVolumeParams.width;
+            f32_t y = v * m_parameters.rectVolumeParams.height;
             return glm::vec3(x, y, 0.0f);
         }
         case SpawnVolumeType::line:
         {
-            f32_t x = dist(m_randGen) * m_parameters.lineVolumeParams.length;
+            f32_t x = u * m_parameters.lineVolumeParams.length;
             return glm::vec3(x, 0.0f, 0.0f);
         }
         default:
@@ -534,4 +877,23 @@ glm::vec3 ParticleEmitter::_getRandomPositionInVolume()
     }
 }
 
+f32_t ParticleEmitter::_s_hashUnit(u32_t seed, u32_t idx, u32_t generation, u32_t stream)
+{
+    // lowbias32 from Chris Wellons' hash prospector, each argument mixed in on its own
+    auto mix = [](u32_t x)
+    {
+        x ^= x >> 16;
+        x *= 0x7FEB352D;
+        x ^= x >> 15;
+        x *= 0x846CA68B;
+        x ^= x >> 16;
+        return x;
+    };
+
+    u32_t hash = mix(seed ^ mix(idx ^ mix(generation ^ mix(stream + 1))));
+
+    // the top 24 bits, as many as a float holds exactly
+    return static_cast<f32_t>(hash >> 8) * (1.0f / 16777216.0f);
+}
+
 }  // namespace nimbus
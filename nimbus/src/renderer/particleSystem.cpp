@@ -0,0 +1,283 @@
+#include "nimbus/core/nmpch.hpp"
+#include "nimbus/core/core.hpp"
+
+#include "nimbus/renderer/particleSystem.hpp"
+#include "nimbus/renderer/renderer.hpp"
+#include "nimbus/renderer/pipelineState.hpp"
+
+#include <algorithm>
+
+namespace nimbus
+{
+
+ParticleSystem::~ParticleSystem()
+{
+    // the jobs only point at the emitters
+    wait();
+}
+
+void ParticleSystem::add(const ref<ParticleEmitter>& p_emitter)
+{
+    NB_CORE_ASSERT(p_emitter != nullptr, "Adding a null particle emitter!");
+
+    m_emitters.push_back(p_emitter);
+}
+
+void ParticleSystem::remove(const ref<ParticleEmitter>& p_emitter)
+{
+    // keeps the order, it breaks priority ties
+    auto p_entry = std::find(m_emitters.begin(), m_emitters.end(), p_emitter);
+    if (p_entry == m_emitters.end())
+    {
+        return;
+    }
+
+    size_t idx = p_entry - m_emitters.begin();
+    if (idx < m_jobs.size())
+    {
+        JobSystem::s_wait(m_jobs[idx]);
+        m_jobs.erase(m_jobs.begin() + idx);
+    }
+
+    m_emitters.erase(p_entry);
+}
+
+void ParticleSystem::clear()
+{
+    wait();
+
+    m_emitters.clear();
+    m_drawItems.clear();
+}
+
+void ParticleSystem::update(f32_t deltaTime)
+{
+    NB_PROFILE_DETAIL();
+
+    wait();
+
+    // emitters don't share anything they change, so each is a job of its own
+    m_jobs.reserve(m_emitters.size());
+    for (const ref<ParticleEmitter>& p_emitter : m_emitters)
+    {
+        ParticleEmitter* p_raw = p_emitter.raw();
+        m_jobs.push_back(JobSystem::s_submit([p_raw, deltaTime]() { p_raw->update(deltaTime); }));
+    }
+}
+
+void ParticleSystem::wait()
+{
+    NB_PROFILE_DETAIL();
+
+    JobSystem::s_waitAll(m_jobs);
+    m_jobs.clear();
+}
+
+void ParticleSystem::draw()
+{
+    NB_PROFILE();
+
+    m_drawCount    = 0;
+    m_droppedCount = 0;
+
+    m_drawItems.clear();
+    for (size_t i = 0; i < m_emitters.size(); i++)
+    {
+        // the first emitters are read while the others may still be simulating
+        if (i < m_jobs.size())
+        {
+            JobSystem::s_wait(m_jobs[i]);
+        }
+
+        u32_t count = m_emitters[i]->getInstanceCount();
+        if (count == 0)
+        {
+            continue;
+        }
+
+        // scenes have few emitters, looking through the earlier ones is cheap enough
+        u32_t order = static_cast<u32_t>(m_drawItems.size());
+        u32_t group = order;
+        for (const DrawItem& item : m_drawItems)
+        {
+            if (_s_sameMaterial(*item.p_emitter, *m_emitters[i]))
+            {
+                group = item.group;
+                break;
+            }
+        }
+
+        m_drawItems.push_back({m_emitters[i].raw(), count, order, group});
+    }
+    m_jobs.clear();
+
+    if (m_drawItems.empty())
+    {
+        return;
+    }
+
+    if (mp_vao == nullptr)
+    {
+        _createQuad();
+    }
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Hand out the budget, highest priority first
+    ////////////////////////////////////////////////////////////////////////////
+    std::stable_sort(m_drawItems.begin(),
+                     m_drawItems.end(),
+                     [](const DrawItem& lhs, const DrawItem& rhs)
+                     { return lhs.p_emitter->getPriority() > rhs.p_emitter->getPriority(); });
+
+    u32_t remaining = m_budget;
+    for (DrawItem& item : m_drawItems)
+    {
+        u32_t granted = std::min(item.count, remaining);
+
+        m_droppedCount += item.count - granted;
+        remaining -= granted;
+        item.count = granted;
+    }
+
+    ////////////////////////////////////////////////////////////////////////////
+    // One instanced draw per material, in the order they were first seen
+    ////////////////////////////////////////////////////////////////////////////
+    std::sort(m_drawItems.begin(),
+              m_drawItems.end(),
+              [](const DrawItem& lhs, const DrawItem& rhs)
+              { return lhs.group != rhs.group ? lhs.group < rhs.group : lhs.order < rhs.order; });
+
+    m_drawGroups.clear();
+    u32_t itemCount = static_cast<u32_t>(m_drawItems.size());
+    for (u32_t begin = 0; begin < itemCount;)
+    {
+        u32_t end = begin + 1;
+        while (end < itemCount && m_drawItems[end].group == m_drawItems[begin].group)
+        {
+            end++;
+        }
+
+        m_drawGroups.push_back({begin, end, false});
+        begin = end;
+    }
+
+    // groups share nothing but the quad, so each records its own list and the lists' order puts them back in line
+    u32_t pass = Renderer::s_newCmdListPass();
+
+    for (u32_t g = 1; g < m_drawGroups.size(); g++)
+    {
+        m_drawJobs.push_back(JobSystem::s_submit(
+            [this, pass, g]()
+            {
+                Renderer::s_beginCmdList(pass, g);
+                _drawGroup(m_drawGroups[g]);
+                Renderer::s_endCmdList();
+            }));
+    }
+
+    Renderer::s_beginCmdList(pass, 0);
+    _drawGroup(m_drawGroups[0]);
+    Renderer::s_endCmdList();
+
+    JobSystem::s_waitAll(m_drawJobs);
+    m_drawJobs.clear();
+
+    Renderer::s_submitCmdLists(pass);
+
+    for (const DrawGroup& group : m_drawGroups)
+    {
+        m_drawCount += group.drawn;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Private Functions
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+void ParticleSystem::_createQuad()
+{
+    // clang-format off
+    const QuadVertex vertices[] =
+    {
+        // centered around (0, 0)
+        // pos                    // tex
+        {glm::vec2(-0.5f, -0.5f), glm::vec2(0.0f, 1.0f)},  // bottom left
+        {glm::vec2( 0.5f, -0.5f), glm::vec2(1.0f, 1.0f)},  // bottom right
+        {glm::vec2( 0.5f,  0.5f), glm::vec2(1.0f, 0.0f)},  // top right
+        {glm::vec2(-0.5f,  0.5f), glm::vec2(0.0f, 0.0f)}   // top left
+    };
+
+    u8_t indices[] = {
+        0, 1, 2,  // first triangle
+        2, 3, 0   // second triangle
+    };
+    // clang-format on
+
+    mp_vao = VertexArray::s_create();
+
+    ref<VertexBuffer> p_vertexVbo = VertexBuffer::s_create(vertices, sizeof(vertices));
+    p_vertexVbo->setFormat(k_quadVboFormat);
+
+    mp_vao->addVertexBuffer(p_vertexVbo);
+    mp_vao->setIndexBuffer(IndexBuffer::s_create(indices, sizeof(indices)));
+
+    // instance data is streamed each draw
+    m_instanceBinding = mp_vao->addVertexFormat(ParticleEmitter::k_instanceVboFormat);
+}
+
+void ParticleSystem::_drawGroup(DrawGroup& group)
+{
+    const ParticleEmitter& first = *m_drawItems[group.begin].p_emitter;
+
+    u32_t total = 0;
+    for (u32_t i = group.begin; i < group.end; i++)
+    {
+        total += m_drawItems[i].count;
+    }
+
+    if (total == 0)
+    {
+        return;
+    }
+
+    // if these aren't loaded, they're drawn once they are
+    if (!first.getTexture()->bind(0) || !first.getShader()->bind())
+    {
+        return;
+    }
+
+    first.getShader()->setInt("particleTexture", 0);
+
+    ref<StreamingBuffer>        p_stream = Renderer::s_getStreamingBuffer();
+    StreamingBuffer::Allocation allocation
+        = p_stream->allocate(total * sizeof(ParticleEmitter::particleInstanceData));
+
+    auto* p_instances = static_cast<ParticleEmitter::particleInstanceData*>(allocation.p_data);
+    u32_t written     = 0;
+    for (u32_t i = group.begin; i < group.end; i++)
+    {
+        written += m_drawItems[i].p_emitter->writeInstances(p_instances + written, m_drawItems[i].count);
+    }
+
+    if (written == 0)
+    {
+        return;
+    }
+
+    p_stream->bindVertexBuffer(mp_vao, m_instanceBinding, ParticleEmitter::k_instanceVboFormat.getStride(), allocation);
+
+    PipelineState pipeline;
+    pipeline.p_shader      = first.getShader();
+    pipeline.p_vertexArray = mp_vao;
+    pipeline.blendingMode  = first.getBlendMode();
+
+    Renderer::s_renderInstanced(pipeline, written);
+    group.drawn = true;
+}
+
+bool ParticleSystem::_s_sameMaterial(const ParticleEmitter& lhs, const ParticleEmitter& rhs)
+{
+    return lhs.getShader() == rhs.getShader() && lhs.getTexture() == rhs.getTexture()
+           && lhs.getBlendMode() == rhs.getBlendMode();
+}
+
+}  // namespace nimbus
@@ -2,40 +2,55 @@
 #include "nimbus/core/core.hpp"
 
 #include "nimbus/renderer/renderCmdQ.hpp"
+#include "nimbus/renderer/graphicsApi.hpp"
 
 namespace nimbus
 {
 
 RenderCmdQ::RenderCmdQ()
 {
-    mp_cmdBuf = static_cast<u8_t*>(calloc(k_cmdBufSize, sizeof(u8_t)));
-    NB_CORE_ASSERT(mp_cmdBuf, "Failed to allocate command queue!");
-    mp_cmdBufPtr = mp_cmdBuf;
+    mp_head = _s_acquireBlock(0);
+    mp_tail = mp_head;
 }
 
 RenderCmdQ::~RenderCmdQ()
 {
-    free(mp_cmdBuf);
+    _recycle();
+    _s_releaseBlock(mp_head);
 }
 
 void* RenderCmdQ::slot(renderCmdFn fn, u32_t size)
 {
-    *reinterpret_cast<renderCmdFn*>(mp_cmdBufPtr) = fn;
-    mp_cmdBufPtr += sizeof(renderCmdFn);
-    m_cmdBufUsedSz += sizeof(renderCmdFn);
+    u8_t* p_payload = static_cast<u8_t*>(packet(RenderCmdOp::callback, sizeof(fn) + size));
 
-    *reinterpret_cast<u32_t*>(mp_cmdBufPtr) = size;
-    mp_cmdBufPtr += sizeof(u32_t);
-    m_cmdBufUsedSz += sizeof(u32_t);
+    *reinterpret_cast<renderCmdFn*>(p_payload) = fn;
 
-    void* slot = mp_cmdBufPtr;
-    mp_cmdBufPtr += size;
-    m_cmdBufUsedSz += size;
+    return p_payload + sizeof(fn);
+}
+
+void* RenderCmdQ::packet(RenderCmdOp op, u32_t size)
+{
+    u32_t payloadSize = (size + k_cmdAlign - 1) & ~(k_cmdAlign - 1);
+    u32_t cmdSize     = sizeof(CmdHeader) + payloadSize;
+
+    if (mp_tail->capacity - mp_tail->used < cmdSize)
+    {
+        _grow(cmdSize);
+    }
+
+    u8_t*      p_cmd    = mp_tail->data() + mp_tail->used;
+    CmdHeader* p_header = reinterpret_cast<CmdHeader*>(p_cmd);
+    p_header->op        = op;
+    p_header->size      = payloadSize;
 
-    NB_CORE_ASSERT(m_cmdBufUsedSz < k_cmdBufSize, "Command Queue Overflow!");
+    mp_tail->used += cmdSize;
+    mp_tail->cmdCount++;
 
     m_cmdCount++;
-    return slot;
+    m_usedBytes += cmdSize;
+    m_highWaterBytes = std::max(m_highWaterBytes, m_usedBytes);
+
+    return p_cmd + sizeof(CmdHeader);
 }
 
 void RenderCmdQ::pump()
@@ -43,28 +58,121 @@ void RenderCmdQ::pump()
     // exit if there's nothing to process
     if (m_cmdCount > 0)
     {
-        u8_t* ptr = mp_cmdBuf;
-
-        for (u32_t i = 0; i < m_cmdCount; i++)
+        for (Block* p_block = mp_head; p_block != nullptr; p_block = p_block->p_next)
         {
-            // grab the function out
-            renderCmdFn fn = *reinterpret_cast<renderCmdFn*>(ptr);
-            ptr += sizeof(renderCmdFn);
+            u8_t* ptr = p_block->data();
+
+            for (u32_t i = 0; i < p_block->cmdCount; i++)
+            {
+                const CmdHeader* p_header = reinterpret_cast<const CmdHeader*>(ptr);
+                ptr += sizeof(CmdHeader);
+
+                switch (p_header->op)
+                {
+                    case (RenderCmdOp::callback):
+                    {
+                        // execute the function with the data
+                        renderCmdFn fn = *reinterpret_cast<renderCmdFn*>(ptr);
+                        fn(ptr + sizeof(renderCmdFn));
+
+                        // no telling what it did to the bindings the backend caches
+                        GraphicsApi::invalidateStateCache();
+                        break;
+                    }
+                    default:
+                        GraphicsApi::executeCmd(p_header->op, ptr);
+                        break;
+                }
+
+                ptr += p_header->size;
+            }
+        }
+
+        _recycle();
+    }
+}
+
+u32_t RenderCmdQ::s_getPoolBytes()
+{
+    return s_poolBytes.load(std::memory_order_relaxed);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Private Functions
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+void RenderCmdQ::_grow(u32_t minSize)
+{
+    Block* p_block  = _s_acquireBlock(minSize);
+    mp_tail->p_next = p_block;
+    mp_tail         = p_block;
+}
+
+void RenderCmdQ::_recycle()
+{
+    // keep the first block around, the rest go back to the pool
+    Block* p_block = mp_head->p_next;
+    while (p_block != nullptr)
+    {
+        Block* p_next = p_block->p_next;
+        _s_releaseBlock(p_block);
+        p_block = p_next;
+    }
+
+    mp_head->p_next   = nullptr;
+    mp_head->used     = 0;
+    mp_head->cmdCount = 0;
+    mp_tail           = mp_head;
+
+    m_cmdCount  = 0;
+    m_usedBytes = 0;
+}
 
-            // grab the size of the data
-            u32_t size = *reinterpret_cast<u32_t*>(ptr);
-            ptr += sizeof(u32_t);
+RenderCmdQ::Block* RenderCmdQ::_s_acquireBlock(u32_t minSize)
+{
+    const u32_t k_stdCapacity = k_blockSize - sizeof(Block);
 
-            // execute the function with the data
-            fn(ptr);
+    Block* p_block = nullptr;
 
-            ptr += size;
+    if (minSize <= k_stdCapacity)
+    {
+        std::lock_guard<std::mutex> lock(s_poolMtx);
+        if (sp_freeBlocks != nullptr)
+        {
+            p_block       = sp_freeBlocks;
+            sp_freeBlocks = p_block->p_next;
         }
+    }
 
-        mp_cmdBufPtr   = mp_cmdBuf;
-        m_cmdCount     = 0;
-        m_cmdBufUsedSz = 0;
+    if (p_block == nullptr)
+    {
+        // commands bigger than a block get a dedicated one that is freed rather than pooled
+        u32_t capacity = std::max(k_stdCapacity, minSize);
+
+        p_block = static_cast<Block*>(malloc(sizeof(Block) + capacity));
+        NB_CORE_ASSERT_STATIC(p_block, "Failed to allocate command queue block!");
+
+        p_block->capacity = capacity;
+        s_poolBytes.fetch_add(sizeof(Block) + capacity, std::memory_order_relaxed);
+    }
+
+    p_block->p_next   = nullptr;
+    p_block->used     = 0;
+    p_block->cmdCount = 0;
+    return p_block;
+}
+
+void RenderCmdQ::_s_releaseBlock(Block* p_block)
+{
+    if (p_block->capacity != k_blockSize - sizeof(Block))
+    {
+        s_poolBytes.fetch_sub(sizeof(Block) + p_block->capacity, std::memory_order_relaxed);
+        free(p_block);
+        return;
     }
+
+    std::lock_guard<std::mutex> lock(s_poolMtx);
+    p_block->p_next = sp_freeBlocks;
+    sp_freeBlocks   = p_block;
 }
 
-}  // namespace nimbus
\ No newline at end of file
+}  // namespace nimbus
@@ -12,53 +12,112 @@ namespace nimbus
 
 RenderThread::RenderThread()
 {
-    m_state  = State::dead;
-    m_active = false;
 }
 
 RenderThread::~RenderThread()
 {
 }
+
 void RenderThread::run(void (*fn)())
 {
     SDL_GL_MakeCurrent(static_cast<SDL_Window*>(Application::s_get().getWindow().getOsWindow()), nullptr);
-    m_active = true;
-    m_state  = State::busy;
+    m_active.store(true, std::memory_order_release);
     m_thread = std::thread(fn);
 }
 
-void RenderThread::waitForState(State state)
+void RenderThread::stop()
 {
-    std::unique_lock<std::mutex> lock(m_pendMtx);
-
-    // clang-format off
-    m_pendCond.wait(lock, [=]() { 
-        
-        if(m_state == state || !m_active)
-        {
-            return true;
-        }
-        else
-        {
-            return false;
-        }
-    
-    });
-    // clang-format on
+    m_active.store(false, std::memory_order_release);
+
+    // the render thread only wakes on a change of the counter so bump it, it sees it's no longer active before it
+    // would try to process anything
+    m_wake.fetch_add(1, std::memory_order_acq_rel);
+    m_wake.notify_all();
+    m_completed.notify_all();
+    m_gpuCompleted.notify_all();
+
+    m_thread.join();
 }
 
-void RenderThread::setState(State state)
+void RenderThread::submitFrame()
 {
-    std::lock_guard<std::mutex> lock(m_pendMtx);
-    m_state = state;
-    m_pendCond.notify_all();
+    m_submitted.fetch_add(1, std::memory_order_release);
+
+    m_wake.fetch_add(1, std::memory_order_release);
+    m_wake.notify_one();
 }
 
-void RenderThread::stop()
+void RenderThread::waitForFramesInFlight(u32_t framesInFlight)
 {
-    m_active = false;
-    setState(State::dead);
-    m_thread.join();
+    u64_t submitted = m_submitted.load(std::memory_order_relaxed);
+    u64_t completed = m_completed.load(std::memory_order_acquire);
+
+    while (submitted - completed >= framesInFlight && isActive())
+    {
+        m_completed.wait(completed, std::memory_order_acquire);
+        completed = m_completed.load(std::memory_order_acquire);
+    }
+}
+
+void RenderThread::waitForIdle()
+{
+    waitForFramesInFlight(1);
+}
+
+void RenderThread::waitForGpu(u64_t frames)
+{
+    u64_t completed = m_gpuCompleted.load(std::memory_order_acquire);
+    if (completed >= frames)
+    {
+        return;
+    }
+
+    // several threads can be waiting, the render thread waits for the furthest one
+    u64_t wanted = m_gpuWanted.load(std::memory_order_relaxed);
+    while (wanted < frames
+           && !m_gpuWanted.compare_exchange_weak(wanted, frames, std::memory_order_relaxed, std::memory_order_relaxed))
+    {
+    }
+
+    m_wake.fetch_add(1, std::memory_order_release);
+    m_wake.notify_one();
+
+    while (completed < frames && isActive())
+    {
+        m_gpuCompleted.wait(completed, std::memory_order_acquire);
+        completed = m_gpuCompleted.load(std::memory_order_acquire);
+    }
+}
+
+bool RenderThread::waitForWork()
+{
+    // the counter is read before what it guards, anything set after that changes it and the wait falls through
+    u32_t wake = m_wake.load(std::memory_order_acquire);
+
+    while (!hasFrame() && getGpuFramesWanted() <= getGpuCompletedFrames() && isActive())
+    {
+        m_wake.wait(wake, std::memory_order_acquire);
+        wake = m_wake.load(std::memory_order_acquire);
+    }
+
+    return isActive();
+}
+
+void RenderThread::completeFrame()
+{
+    m_completed.fetch_add(1, std::memory_order_release);
+    m_completed.notify_one();
+}
+
+void RenderThread::completeGpuFrames(u64_t frames)
+{
+    if (frames <= m_gpuCompleted.load(std::memory_order_relaxed))
+    {
+        return;
+    }
+
+    m_gpuCompleted.store(frames, std::memory_order_release);
+    m_gpuCompleted.notify_all();
 }
 
-}  // namespace nimbus
\ No newline at end of file
+}  // namespace nimbus
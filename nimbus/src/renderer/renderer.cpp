@@ -4,6 +4,7 @@
 #include "nimbus/renderer/renderer.hpp"
 
 #include "nimbus/core/application.hpp"
+#include "nimbus/core/jobSystem.hpp"
 #include "nimbus/renderer/renderCmdQ.hpp"
 #include "nimbus/renderer/renderThread.hpp"
 #include "nimbus/renderer/graphicsApi.hpp"
@@ -17,8 +18,21 @@
 namespace nimbus
 {
 
-inline static const i32_t k_numRenderCmdQ = 2;  // >= 2
-inline static const i32_t k_numObjectCmdQ = 2;  // >= 2
+// one queue per frame the render thread can be behind, plus the one being recorded
+inline static const u32_t k_maxCmdQ = Renderer::k_maxFramesInFlight + 1;
+
+inline static const u32_t k_streamingRegionInitSize = (1 << 20);
+
+struct RenderCmdList
+{
+    RenderCmdQ renderCmdQ;
+    RenderCmdQ objectCmdQ;
+    RenderCmdQ retireCmdQ;
+
+    u32_t pass     = 0;
+    u32_t order    = 0;
+    bool  consumed = false;  // render thread only
+};
 
 struct RendererInternalData
 {
@@ -30,27 +44,91 @@ struct RendererInternalData
     ///////////////////////////
     // Queues
     ///////////////////////////
-    RenderCmdQ* renderCmdQ[k_numRenderCmdQ];
-    RenderCmdQ* objectCmdQ[k_numObjectCmdQ];
+    // all paired by index, only the first numCmdQ are in use
+    RenderCmdQ* renderCmdQ[k_maxCmdQ];
+    RenderCmdQ* objectCmdQ[k_maxCmdQ];
+
+    // pumped after renderCmdQ
+    RenderCmdQ* retireCmdQ[k_maxCmdQ];
+
+    // for objects released on the render thread itself, pumped after the
+    // frame currently being processed
+    RenderCmdQ*     renderThreadRetireCmdQ;
+    std::thread::id renderThreadId;
+
+    // for objects released on any other thread (job workers), paired with
+    // renderCmdQ by index like retireCmdQ. The mutex also covers reading
+    // submitRenderCmdQIdx on those threads, swaps move it on holding it.
+    RenderCmdQ*     workerRetireCmdQ[k_maxCmdQ];
+    std::mutex      workerRetireMtx;
+    std::thread::id mainThreadId;
+
+    ///////////////////////////
+    // Command Lists
+    ///////////////////////////
+    // ended lists for each frame, sorted at swap
+    std::vector<RenderCmdList*> cmdLists[k_maxCmdQ];
+    std::vector<RenderCmdList*> freeCmdLists;
+    std::mutex                  cmdListMtx;
+    std::atomic<u32_t>          openCmdLists    = 0;
+    std::atomic<u32_t>          nextCmdListPass = 0;  // handed out by s_newCmdListPass, from 0 each frame
 
     ///////////////////////////
     // State
     ///////////////////////////
-    u32_t     submitRenderCmdQIdx;
-    u32_t     processRenderCmdQIdx;
-    u32_t     submitObjectCmdQIdx;
-    u32_t     processObjectCmdQIdx;
-    glm::mat4 vpMatrix = glm::mat4(1.0f);
+    u32_t     framesInFlight       = 1;
+    u32_t     numCmdQ              = 2;
+    u32_t     submitRenderCmdQIdx  = 0;  // main thread
+    u32_t     processRenderCmdQIdx = 0;  // render thread
+
+    // last frame uniforms written this frame, identical scenes don't need writing again
+    Renderer::FrameUniforms frameUniforms;
+    bool                    frameUniformsWritten = false;
+
+    // can be set from gui code, which runs on the render thread
+    std::atomic<u32_t> pendingFramesInFlight = 1;
+
+    ///////////////////////////
+    // Stats
+    ///////////////////////////
+    CmdQStats cmdQStats;
 
     ///////////////////////////
     // Assets
     ///////////////////////////
-    ref<Texture> p_whiteTexture;
-    ref<Texture> p_blackTexture;
+    ref<Texture>         p_whiteTexture;
+    ref<Texture>         p_blackTexture;
+    ref<StreamingBuffer> p_streamingBuffer;
 };
 
 RendererInternalData* Renderer::sp_data;
 
+// list this thread is recording into, if any, when it isn't running a job
+static thread_local RenderCmdList* tp_recordCmdList = nullptr;
+
+// A job's list goes with the job rather than its thread, a worker waiting on another job runs others on the same
+// thread and each has to keep recording into its own list
+static RenderCmdList* _s_getRecordCmdList()
+{
+    if (JobSystem::s_isInJob())
+    {
+        return static_cast<RenderCmdList*>(JobSystem::s_getJobLocal());
+    }
+
+    return tp_recordCmdList;
+}
+
+static void _s_setRecordCmdList(RenderCmdList* p_cmdList)
+{
+    if (JobSystem::s_isInJob())
+    {
+        JobSystem::s_setJobLocal(p_cmdList);
+        return;
+    }
+
+    tp_recordCmdList = p_cmdList;
+}
+
 void Renderer::s_init()
 {
     // clang-format off
@@ -66,24 +144,20 @@ void Renderer::s_init()
         ////////////////////////
         // Setup and start Thread
         ////////////////////////
-        for(int i = 0; i < k_numRenderCmdQ; i++)
+        for(u32_t i = 0; i < k_maxCmdQ; i++)
         {
             sp_data->renderCmdQ[i] = new RenderCmdQ();
-        }
-
-        sp_data->submitRenderCmdQIdx = 0;
-        sp_data->processRenderCmdQIdx = 1;
-
-        
-        for(int i = 0; i < k_numObjectCmdQ; i++)
-        {
             sp_data->objectCmdQ[i] = new RenderCmdQ();
+            sp_data->retireCmdQ[i] = new RenderCmdQ();
+            sp_data->workerRetireCmdQ[i] = new RenderCmdQ();
         }
 
-        sp_data->submitObjectCmdQIdx = 0;
-        sp_data->processObjectCmdQIdx = 1;
+        sp_data->mainThreadId = std::this_thread::get_id();
+
+        sp_data->renderThreadRetireCmdQ = new RenderCmdQ();
 
         sp_data->renderThread.run(Renderer::_s_renderThreadFn);
+        sp_data->renderThreadId = sp_data->renderThread.getId();
 
         ///////////////////////////
         // Make any common assets
@@ -104,6 +178,8 @@ void Renderer::s_init()
         u32_t blackData = 0xFF000000;
         sp_data->p_blackTexture->setData(&blackData, sizeof(blackData));
 
+        sp_data->p_streamingBuffer = StreamingBuffer::s_create(k_streamingRegionInitSize);
+
 
     });
     // clang-format on
@@ -111,8 +187,9 @@ void Renderer::s_init()
 
 void Renderer::s_destroy()
 {
-    sp_data->p_whiteTexture = nullptr;
-    sp_data->p_blackTexture = nullptr;
+    sp_data->p_whiteTexture    = nullptr;
+    sp_data->p_blackTexture    = nullptr;
+    sp_data->p_streamingBuffer = nullptr;
 
     // flush the queues, order matters here due to not wanting to use resources
     // that are being deleted, so we run all of the renders first before
@@ -120,41 +197,135 @@ void Renderer::s_destroy()
     // objects are processed first.
     // TODO think about: is this potentially a crash point on close if objects
     // are being used that technically haven't been created yet.
-    for (u32_t i = 0; i < k_numRenderCmdQ; i++)
+    for (u32_t i = 0; i < sp_data->numCmdQ; i++)
     {
         s_swapAndStart();
-        s_waitForRenderThread();
+        sp_data->renderThread.waitForIdle();
     }
 
     // render command queues should now be empty
-    for (u32_t i = 0; i < k_numObjectCmdQ; i++)
+    for (u32_t i = 0; i < sp_data->numCmdQ; i++)
     {
         _s_processObjectQueue();
         s_swapAndStart();
-        s_waitForRenderThread();
+        sp_data->renderThread.waitForIdle();
     }
 
     sp_data->renderThread.stop();
 
-    for (int i = 0; i < k_numRenderCmdQ; i++)
+    for (u32_t i = 0; i < k_maxCmdQ; i++)
     {
         if (sp_data->renderCmdQ[i]->getCmdCount() != 0)
         {
             Log::coreWarn("Unprocessed commands (%i) let on queue", sp_data->renderCmdQ[i]->getCmdCount());
         }
         delete sp_data->renderCmdQ[i];
+        delete sp_data->objectCmdQ[i];
+        delete sp_data->retireCmdQ[i];
+        delete sp_data->workerRetireCmdQ[i];
+    }
+
+    delete sp_data->renderThreadRetireCmdQ;
+
+    for (u32_t i = 0; i < k_maxCmdQ; i++)
+    {
+        _s_recycleCmdLists(i);
+    }
+
+    for (RenderCmdList* p_cmdList : sp_data->freeCmdLists)
+    {
+        delete p_cmdList;
     }
 
     delete sp_data;
 }
 
+void Renderer::s_beginCmdList(u32_t pass, u32_t order)
+{
+    NB_CORE_ASSERT_STATIC(!_s_getRecordCmdList(), "Already recording a command list on this thread or job!");
+
+    RenderCmdList* p_cmdList = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(sp_data->cmdListMtx);
+        if (!sp_data->freeCmdLists.empty())
+        {
+            p_cmdList = sp_data->freeCmdLists.back();
+            sp_data->freeCmdLists.pop_back();
+        }
+    }
+
+    if (p_cmdList == nullptr)
+    {
+        p_cmdList = new RenderCmdList();
+    }
+
+    p_cmdList->pass     = pass;
+    p_cmdList->order    = order;
+    p_cmdList->consumed = false;
+
+    sp_data->openCmdLists.fetch_add(1, std::memory_order_relaxed);
+    _s_setRecordCmdList(p_cmdList);
+}
+
+void Renderer::s_endCmdList()
+{
+    RenderCmdList* p_cmdList = _s_getRecordCmdList();
+    NB_CORE_ASSERT_STATIC(p_cmdList, "No command list being recorded on this thread or job!");
+
+    {
+        std::lock_guard<std::mutex> lock(sp_data->cmdListMtx);
+        sp_data->cmdLists[sp_data->submitRenderCmdQIdx].push_back(p_cmdList);
+    }
+
+    sp_data->openCmdLists.fetch_sub(1, std::memory_order_release);
+    _s_setRecordCmdList(nullptr);
+}
+
+void Renderer::s_submitCmdLists(u32_t pass)
+{
+    Renderer::s_submit([pass]() { _s_pumpCmdLists(pass); });
+}
+
+u32_t Renderer::s_newCmdListPass()
+{
+    return sp_data->nextCmdListPass.fetch_add(1, std::memory_order_relaxed);
+}
+
+void Renderer::s_setScene(const glm::mat4& view, const glm::mat4& projection)
+{
+    NB_PROFILE_TRACE();
+
+    FrameUniforms uniforms;
+    uniforms.view           = view;
+    uniforms.projection     = projection;
+    uniforms.viewProjection = projection * view;
+    uniforms.viewport       = glm::vec4(GraphicsApi::getViewport());
+    uniforms.time           = static_cast<f32_t>(Application::s_get().getGameTime());
+
+    if (sp_data->frameUniformsWritten && memcmp(&uniforms, &sp_data->frameUniforms, sizeof(FrameUniforms)) == 0)
+    {
+        return;
+    }
+
+    StreamingBuffer::Allocation allocation
+        = sp_data->p_streamingBuffer->allocate(sizeof(FrameUniforms), StreamingBuffer::k_uniformAlign);
+
+    memcpy(allocation.p_data, &uniforms, sizeof(FrameUniforms));
+    sp_data->p_streamingBuffer->bindUniformBuffer(k_frameUniformBinding, allocation);
+
+    sp_data->frameUniforms        = uniforms;
+    sp_data->frameUniformsWritten = true;
+}
+
 void Renderer::s_setScene(const glm::mat4& vpMatrix)
 {
-    sp_data->vpMatrix = vpMatrix;
+    s_setScene(glm::mat4(1.0f), vpMatrix);
 }
 
 void Renderer::s_startFrame()
 {
+    Texture::s_processLoads();
+
     _s_processObjectQueue();
 }
 
@@ -166,26 +337,56 @@ void Renderer::s_endFrame()
 void Renderer::s_swapAndStart()
 {
     _s_qSwap();
-    sp_data->renderThread.setState(RenderThread::State::ready);
+    sp_data->renderThread.submitFrame();
+
+    if (sp_data->pendingFramesInFlight.load(std::memory_order_relaxed) != sp_data->framesInFlight)
+    {
+        _s_applyFramesInFlight();
+    }
 }
 
 void Renderer::s_waitForRenderThread()
 {
-    sp_data->renderThread.waitForState(RenderThread::State::pend);
+    sp_data->renderThread.waitForFramesInFlight(sp_data->framesInFlight);
 }
 
-void Renderer::s_pumpCmds()
+void Renderer::s_waitForGpu(u64_t frames)
 {
-    u32_t queuesToPump = std::max({k_numRenderCmdQ, k_numObjectCmdQ});
+    sp_data->renderThread.waitForGpu(frames);
+}
 
-    for (u32_t i = 0; i < queuesToPump; i++)
+void Renderer::s_pumpCmds()
+{
+    for (u32_t i = 0; i < sp_data->numCmdQ; i++)
     {
         _s_processObjectQueue();
         s_swapAndStart();
-        s_waitForRenderThread();
+        sp_data->renderThread.waitForIdle();
     }
 }
 
+void Renderer::s_setFramesInFlight(u32_t framesInFlight)
+{
+    NB_CORE_ASSERT_STATIC(framesInFlight >= 1 && framesInFlight <= k_maxFramesInFlight,
+                          "Frames in flight (%i) must be between 1 and %i",
+                          framesInFlight,
+                          k_maxFramesInFlight);
+
+    // the frame being recorded is using the current queues, so this takes effect once it's swapped
+    sp_data->pendingFramesInFlight.store(framesInFlight, std::memory_order_relaxed);
+}
+
+u32_t Renderer::s_getFramesInFlight()
+{
+    return sp_data->pendingFramesInFlight.load(std::memory_order_relaxed);
+}
+
+Renderer::CmdQStats Renderer::s_getCmdQStats()
+{
+    sp_data->cmdQStats.poolBytes = RenderCmdQ::s_getPoolBytes();
+    return sp_data->cmdQStats;
+}
+
 ref<Texture> Renderer::getWhiteTexture()
 {
     return sp_data->p_whiteTexture;
@@ -196,28 +397,30 @@ ref<Texture> Renderer::getBlackTexture()
     return sp_data->p_blackTexture;
 }
 
-void Renderer::s_render(ref<Shader> p_shader, ref<VertexArray> p_vertexArray, i32_t vertexCount, bool setViewProjection)
+ref<StreamingBuffer> Renderer::s_getStreamingBuffer()
+{
+    return sp_data->p_streamingBuffer;
+}
+
+void Renderer::s_render(const PipelineState& state, i32_t vertexCount)
 {
     NB_PROFILE();
 
-    p_shader->bind();
+    GraphicsApi::setPipelineState(state);
 
-    if (setViewProjection)
-    {
-        p_shader->setMat4("u_viewProjection", sp_data->vpMatrix);
-    }
+    state.p_shader->bind();
 
     // do we have an index buffer?
-    if (p_vertexArray->getIndexBuffer())
+    if (state.p_vertexArray->getIndexBuffer())
     {
         // we do, so drawElements
         if (vertexCount == k_detectCountIfPossible)
         {
-            GraphicsApi::drawElements(p_vertexArray);
+            GraphicsApi::drawElements(state.p_vertexArray);
         }
         else
         {
-            GraphicsApi::drawElements(p_vertexArray, vertexCount);
+            GraphicsApi::drawElements(state.p_vertexArray, vertexCount);
         }
     }
     else
@@ -225,41 +428,34 @@ void Renderer::s_render(ref<Shader> p_shader, ref<VertexArray> p_vertexArray, i3
         // we don't so drawArrays
         if (vertexCount == k_detectCountIfPossible)
         {
-            GraphicsApi::drawArrays(p_vertexArray);
+            GraphicsApi::drawArrays(state.p_vertexArray);
         }
         else
         {
-            GraphicsApi::drawArrays(p_vertexArray, vertexCount);
+            GraphicsApi::drawArrays(state.p_vertexArray, vertexCount);
         }
     }
 }
 
-void Renderer::s_renderInstanced(const ref<Shader>&      p_shader,
-                                 const ref<VertexArray>& p_vertexArray,
-                                 i32_t                   instanceCount,
-                                 i32_t                   vertexCount,
-                                 bool                    setViewProjection)
+void Renderer::s_renderInstanced(const PipelineState& state, i32_t instanceCount, i32_t vertexCount)
 {
     NB_PROFILE();
 
-    p_shader->bind();
+    GraphicsApi::setPipelineState(state);
 
-    if (setViewProjection)
-    {
-        p_shader->setMat4("u_viewProjection", sp_data->vpMatrix);
-    }
+    state.p_shader->bind();
 
     // do we have an index buffer?
-    if (p_vertexArray->getIndexBuffer())
+    if (state.p_vertexArray->getIndexBuffer())
     {
         // we do, so drawElements
         if (vertexCount == k_detectCountIfPossible)
         {
-            GraphicsApi::drawElementsInstanced(p_vertexArray, instanceCount);
+            GraphicsApi::drawElementsInstanced(state.p_vertexArray, instanceCount);
         }
         else
         {
-            GraphicsApi::drawElementsInstanced(p_vertexArray, instanceCount, vertexCount);
+            GraphicsApi::drawElementsInstanced(state.p_vertexArray, instanceCount, vertexCount);
         }
     }
     else
@@ -267,11 +463,11 @@ void Renderer::s_renderInstanced(const ref<Shader>&      p_shader,
         // we don't so drawArrays
         if (vertexCount == k_detectCountIfPossible)
         {
-            GraphicsApi::drawArraysInstanced(p_vertexArray, instanceCount);
+            GraphicsApi::drawArraysInstanced(state.p_vertexArray, instanceCount);
         }
         else
         {
-            GraphicsApi::drawArraysInstanced(p_vertexArray, instanceCount, vertexCount);
+            GraphicsApi::drawArraysInstanced(state.p_vertexArray, instanceCount, vertexCount);
         }
     }
 }
@@ -281,6 +477,11 @@ void Renderer::s_renderInstanced(const ref<Shader>&      p_shader,
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 RenderCmdQ* Renderer::_s_getSubmitRenderCmdQ()
 {
+    if (RenderCmdList* p_cmdList = _s_getRecordCmdList())
+    {
+        return &p_cmdList->renderCmdQ;
+    }
+
     return sp_data->renderCmdQ[sp_data->submitRenderCmdQIdx];
 }
 RenderCmdQ* Renderer::_s_getProcessRenderCmdQ()
@@ -290,6 +491,11 @@ RenderCmdQ* Renderer::_s_getProcessRenderCmdQ()
 
 RenderCmdQ* Renderer::_s_getSubmitObjectCmdQ()
 {
+    if (RenderCmdList* p_cmdList = _s_getRecordCmdList())
+    {
+        return &p_cmdList->objectCmdQ;
+    }
+
     return sp_data->objectCmdQ[sp_data->submitRenderCmdQIdx];
 }
 RenderCmdQ* Renderer::_s_getProcessObjectCmdQ()
@@ -297,14 +503,95 @@ RenderCmdQ* Renderer::_s_getProcessObjectCmdQ()
     return sp_data->objectCmdQ[sp_data->processRenderCmdQIdx];
 }
 
+RenderCmdQ* Renderer::_s_getSubmitRetireCmdQ(std::unique_lock<std::mutex>& lock)
+{
+    std::thread::id threadId = std::this_thread::get_id();
+    if (threadId == sp_data->renderThreadId)
+    {
+        return sp_data->renderThreadRetireCmdQ;
+    }
+
+    if (RenderCmdList* p_cmdList = _s_getRecordCmdList())
+    {
+        return &p_cmdList->retireCmdQ;
+    }
+
+    if (threadId == sp_data->mainThreadId)
+    {
+        return sp_data->retireCmdQ[sp_data->submitRenderCmdQIdx];
+    }
+
+    lock = std::unique_lock<std::mutex>(sp_data->workerRetireMtx);
+    return sp_data->workerRetireCmdQ[sp_data->submitRenderCmdQIdx];
+}
+
+RenderCmdQ* Renderer::_s_getProcessRetireCmdQ()
+{
+    return sp_data->retireCmdQ[sp_data->processRenderCmdQIdx];
+}
+
 void Renderer::_s_qSwap()
-// Private Functions
 {
-    sp_data->submitRenderCmdQIdx  = (sp_data->submitRenderCmdQIdx + 1) % k_numRenderCmdQ;
-    sp_data->processRenderCmdQIdx = (sp_data->processRenderCmdQIdx + 1) % k_numRenderCmdQ;
+    NB_CORE_ASSERT_STATIC(sp_data->openCmdLists.load(std::memory_order_acquire) == 0,
+                          "Command lists must be ended before the frame is swapped!");
+
+    // lists end in whatever order their threads finish, put them in the order they were asked for
+    std::vector<RenderCmdList*>& cmdLists = sp_data->cmdLists[sp_data->submitRenderCmdQIdx];
+    std::sort(cmdLists.begin(),
+              cmdLists.end(),
+              [](const RenderCmdList* p_a, const RenderCmdList* p_b)
+              { return p_a->pass != p_b->pass ? p_a->pass < p_b->pass : p_a->order < p_b->order; });
+
+    CmdQStats& stats     = sp_data->cmdQStats;
+    stats.renderBytes    = sp_data->renderCmdQ[sp_data->submitRenderCmdQIdx]->getUsedBytes();
+    stats.objectBytes    = sp_data->objectCmdQ[sp_data->submitRenderCmdQIdx]->getUsedBytes();
+    stats.highWaterBytes = std::max({stats.highWaterBytes,
+                                     sp_data->renderCmdQ[sp_data->submitRenderCmdQIdx]->getHighWaterBytes(),
+                                     sp_data->objectCmdQ[sp_data->submitRenderCmdQIdx]->getHighWaterBytes()});
+    stats.cmdLists       = cmdLists.size();
+
+    for (RenderCmdList* p_cmdList : cmdLists)
+    {
+        stats.renderBytes += p_cmdList->renderCmdQ.getUsedBytes();
+        stats.objectBytes += p_cmdList->objectCmdQ.getUsedBytes();
+    }
+
+    // the render thread moves its own index on as it completes frames, workers retiring read it under the lock
+    {
+        std::lock_guard<std::mutex> lock(sp_data->workerRetireMtx);
+        sp_data->submitRenderCmdQIdx = (sp_data->submitRenderCmdQIdx + 1) % sp_data->numCmdQ;
+    }
+
+    StreamingBuffer::s_nextFrame();
+    sp_data->frameUniformsWritten = false;
+    sp_data->nextCmdListPass.store(0, std::memory_order_relaxed);
+
+    // having waited for frames in flight, the render thread is done with the frame we are about to record into
+    _s_recycleCmdLists(sp_data->submitRenderCmdQIdx);
+}
+
+void Renderer::_s_applyFramesInFlight()
+{
+    // queues can only be added or removed with none of them in use
+    sp_data->renderThread.waitForIdle();
+
+    for (u32_t i = 0; i < sp_data->numCmdQ; i++)
+    {
+        _s_recycleCmdLists(i);
+    }
+
+    std::lock_guard<std::mutex> lock(sp_data->workerRetireMtx);
+
+    // workers may have retired into the frame being recorded already, it becomes frame 0 with what they wrote. The
+    // queue it swaps with was processed by the wait above.
+    std::swap(sp_data->workerRetireCmdQ[0], sp_data->workerRetireCmdQ[sp_data->submitRenderCmdQIdx]);
+
+    sp_data->framesInFlight       = sp_data->pendingFramesInFlight.load(std::memory_order_relaxed);
+    sp_data->numCmdQ              = sp_data->framesInFlight + 1;
+    sp_data->submitRenderCmdQIdx  = 0;
+    sp_data->processRenderCmdQIdx = 0;
 
-    sp_data->submitObjectCmdQIdx  = (sp_data->submitObjectCmdQIdx + 1) % k_numObjectCmdQ;
-    sp_data->processObjectCmdQIdx = (sp_data->processObjectCmdQIdx + 1) % k_numObjectCmdQ;
+    Log::coreInfo("Renderer running with %i frames in flight", sp_data->framesInFlight);
 }
 
 void Renderer::_s_renderThreadFn()
@@ -312,22 +599,64 @@ void Renderer::_s_renderThreadFn()
     SDL_GL_MakeCurrent(static_cast<SDL_Window*>(Application::s_get().getWindow().getOsWindow()),
                        Application::s_get().getWindow().getContext());
 
-    auto pendSw = Application::s_get().getSwBank().newSw("RenderThread Pend");
+    auto bubbleSw = Application::s_get().getSwBank().newSw("RenderThread Bubble");
 
     auto processSw = Application::s_get().getSwBank().newSw("RenderThread Process");
 
-    while (sp_data->renderThread.isActive())
+    while (true)
     {
-        pendSw->split();
-        sp_data->renderThread.waitForState(RenderThread::State::ready);
-        pendSw->splitAndSave();
+        bubbleSw->split();
+        if (!sp_data->renderThread.waitForWork())
+        {
+            break;
+        }
+        bubbleSw->splitAndSave();
+
+        // another thread is about to reuse memory a frame still on the GPU may read, it's blocked until this returns
+        u64_t gpuFramesWanted = sp_data->renderThread.getGpuFramesWanted();
+        if (gpuFramesWanted > sp_data->renderThread.getGpuCompletedFrames())
+        {
+            sp_data->renderThread.completeGpuFrames(GraphicsApi::waitForGpuFrames(gpuFramesWanted));
+        }
+
+        if (!sp_data->renderThread.hasFrame())
+        {
+            continue;
+        }
 
         processSw->split();
 
-        sp_data->renderThread.setState(RenderThread::State::busy);
         // process all the commands in render queue
         _s_getProcessRenderCmdQ()->pump();
-        sp_data->renderThread.setState(RenderThread::State::pend);
+
+        // then any lists whose pass was never marked
+        std::vector<RenderCmdList*>& cmdLists = sp_data->cmdLists[sp_data->processRenderCmdQIdx];
+        for (RenderCmdList* p_cmdList : cmdLists)
+        {
+            if (!p_cmdList->consumed)
+            {
+                p_cmdList->objectCmdQ.pump();
+                p_cmdList->renderCmdQ.pump();
+            }
+        }
+
+        // now nothing recorded this frame can reference retired objects
+        _s_getProcessRetireCmdQ()->pump();
+        for (RenderCmdList* p_cmdList : cmdLists)
+        {
+            p_cmdList->retireCmdQ.pump();
+        }
+
+        // workers can't be writing to this one anymore, swapping past it waited for their lock
+        sp_data->workerRetireCmdQ[sp_data->processRenderCmdQIdx]->pump();
+
+        sp_data->renderThreadRetireCmdQ->pump();
+
+        u64_t gpuFrames = GraphicsApi::fenceFrame();
+
+        sp_data->processRenderCmdQIdx = (sp_data->processRenderCmdQIdx + 1) % sp_data->numCmdQ;
+        sp_data->renderThread.completeFrame();
+        sp_data->renderThread.completeGpuFrames(gpuFrames);
         processSw->splitAndSave();
     }
 }
@@ -336,25 +665,60 @@ void Renderer::_s_processObjectQueue()
 {
     // typically we call this before starting a frame, so that all
     // object commands get procesed before render commands
-    Renderer::s_submit([]() { _s_getProcessObjectCmdQ()->pump(); });
+    Renderer::s_submit(
+        []()
+        {
+            _s_getProcessObjectCmdQ()->pump();
+
+            for (RenderCmdList* p_cmdList : sp_data->cmdLists[sp_data->processRenderCmdQIdx])
+            {
+                p_cmdList->objectCmdQ.pump();
+            }
+        });
+}
+
+void Renderer::_s_pumpCmdLists(u32_t pass)
+{
+    // lists are sorted by pass so this could be a binary search, but there are only ever a handful
+    for (RenderCmdList* p_cmdList : sp_data->cmdLists[sp_data->processRenderCmdQIdx])
+    {
+        if (p_cmdList->pass == pass && !p_cmdList->consumed)
+        {
+            // normally already done by the object queue pump
+            p_cmdList->objectCmdQ.pump();
+            p_cmdList->renderCmdQ.pump();
+            p_cmdList->consumed = true;
+        }
+    }
+}
+
+void Renderer::_s_recycleCmdLists(u32_t frameIdx)
+{
+    std::lock_guard<std::mutex> lock(sp_data->cmdListMtx);
+
+    for (RenderCmdList* p_cmdList : sp_data->cmdLists[frameIdx])
+    {
+        if (p_cmdList->renderCmdQ.getCmdCount() != 0 || p_cmdList->retireCmdQ.getCmdCount() != 0)
+        {
+            Log::coreWarn("Unprocessed commands (%i) left on command list",
+                          p_cmdList->renderCmdQ.getCmdCount() + p_cmdList->retireCmdQ.getCmdCount());
+        }
+        sp_data->freeCmdLists.push_back(p_cmdList);
+    }
+
+    sp_data->cmdLists[frameIdx].clear();
 }
 
 void Renderer::_s_submit(const ref<Shader>&      p_shader,
                          const ref<VertexArray>& p_vertexArray,
                          const glm::mat4&        model,
-                         i32_t                   vertexCount,
-                         bool                    setViewProjection)
+                         i32_t                   vertexCount)
 {
     NB_PROFILE();
 
     p_shader->bind();
     p_shader->setMat4("u_model", model);
 
-    if (setViewProjection)
-    {
-        p_shader->setMat4("u_viewProjection", sp_data->vpMatrix);
-    }
-
     // do we have an index buffer?
     if (p_vertexArray->getIndexBuffer())
     {
@@ -386,19 +750,13 @@ void Renderer::_s_submitInstanced(const ref<Shader>&      p_shader,
                                   const ref<VertexArray>& p_vertexArray,
                                   i32_t                   instanceCount,
                                   const glm::mat4&        model,
-                                  i32_t                   vertexCount,
-                                  bool                    setViewProjection)
+                                  i32_t                   vertexCount)
 {
     NB_PROFILE();
 
     p_shader->bind();
     p_shader->setMat4("u_model", model);
 
-    if (setViewProjection)
-    {
-        p_shader->setMat4("u_viewProjection", sp_data->vpMatrix);
-    }
-
     // do we have an index buffer?
     if (p_vertexArray->getIndexBuffer())
     {
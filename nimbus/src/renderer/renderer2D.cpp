@@ -7,17 +7,52 @@
 #include "nimbus/renderer/fontData.hpp"
 #include "nimbus/renderer/renderer.hpp"
 #include "nimbus/renderer/renderer2D.hpp"
+#include "nimbus/renderer/staticQuadBatch.hpp"
 #include "nimbus/core/resourceManager.hpp"
 #include "nimbus/core/application.hpp"
 
+#include "gtc/packing.hpp"
+
 namespace nimbus
 {
 
 bool                  Renderer2D::s_inScene = false;
 Renderer2D::QuadData* Renderer2D::s_quadData;
 Renderer2D::TextData* Renderer2D::s_textData;
+Renderer2D::DrawList* Renderer2D::s_drawList;
 Renderer2D::Stats     Renderer2D::s_stats;
 
+// marks a texture key as a page index rather than a texture uid, the key is 20 bits
+static const u32_t k_pageKeyBit = (1 << 19);
+
+static bool s_hasAlpha(const ref<Texture>& p_texture)
+{
+    if (p_texture == nullptr)
+    {
+        return false;
+    }
+
+    switch (p_texture->getSpec().formatInternal)
+    {
+        case (Texture::FormatInternal::rgba8):
+        case (Texture::FormatInternal::rgba16f):
+        case (Texture::FormatInternal::rgba32f):
+            return true;
+        default:
+            return false;
+    }
+}
+
+// top 24 bits of a float, flipped so they compare as unsigned integers in the same order as the floats
+static u32_t s_sortableDepth(f32_t depth)
+{
+    u32_t bits;
+    memcpy(&bits, &depth, sizeof(bits));
+
+    bits = (bits & 0x80000000) ? ~bits : (bits | 0x80000000);
+    return bits >> 8;
+}
+
 void Renderer2D::s_init()
 {
     //clang-format off
@@ -27,6 +62,7 @@ void Renderer2D::s_init()
     {
         s_quadData = new QuadData;
         s_textData = new TextData;
+        s_drawList = new DrawList;
 
         ///////////////////////////
         // General data init
@@ -41,10 +77,14 @@ void Renderer2D::s_init()
         ///////////////////////////
         s_quadData->p_shader = Application::s_get().getResourceManager().loadShader(
             "../resources/shaders/quad.v.glsl", "../resources/shaders/quad.f.glsl");
+        s_quadData->p_compactShader = Application::s_get().getResourceManager().loadShader(
+            "../resources/shaders/quadCompact.v.glsl", "../resources/shaders/quad.f.glsl");
 
-        s_quadData->textures.reserve(Texture::s_getMaxTextures());
+        s_quadData->textures.reserve(k_quadTextureSlots);
+        s_quadData->batchPages.reserve(k_quadPageSlots);
 
         s_quadData->textures.push_back(Renderer::getWhiteTexture());
+        s_quadData->textureSlots.emplace(Renderer::getWhiteTexture().raw(), 0);
 
         _s_createQuadBuffers();
 
@@ -54,8 +94,6 @@ void Renderer2D::s_init()
         s_textData->p_shader = Application::s_get().getResourceManager().loadShader(
             "../resources/shaders/text.v.glsl", "../resources/shaders/text.f.glsl");
 
-        s_textData->atlases.reserve(Texture::s_getMaxTextures());
-
         _s_createTextBuffers();
     });
     //clang-format on
@@ -65,9 +103,10 @@ void Renderer2D::s_destroy()
 {
     delete s_quadData;
     delete s_textData;
+    delete s_drawList;
 }
 
-void Renderer2D::s_begin(const glm::mat4& vpMatrix)
+void Renderer2D::s_begin(const glm::mat4& view, const glm::mat4& projection)
 {
     NB_PROFILE_TRACE();
 
@@ -77,8 +116,16 @@ void Renderer2D::s_begin(const glm::mat4& vpMatrix)
         return;
     }
 
-    Renderer::s_setScene(vpMatrix);
+    Renderer::s_setScene(view, projection);
     s_inScene = true;
+
+    s_drawList->layer    = 0;
+    s_drawList->sequence = 0;
+}
+
+void Renderer2D::s_begin(const glm::mat4& vpMatrix)
+{
+    s_begin(glm::mat4(1.0f), vpMatrix);
 }
 
 void Renderer2D::s_end()
@@ -90,20 +137,36 @@ void Renderer2D::s_end()
         Log::coreError("Renderer2D::end called before Renderer2D::begin!");
         return;
     }
-    _s_submit();
 
-    s_inScene = false;
+    // glyphs generated since the last frame can be drawn in this one
+    s_textData->glyphs.update();
 
-    // resize buffers if required
-    if (s_quadData->needsResize)
-    {
-        _s_createQuadBuffers();
-    }
+    _s_flushDrawList();
 
-    if (s_textData->needsResize)
-    {
-        _s_createTextBuffers();
-    }
+    _s_evictPackedTextures();
+
+    // counted here as stats are read from gui code on the render thread
+    s_stats.textLayouts = s_textData->layouts.getLayoutCount();
+    s_stats.textLayoutsBuilt += s_textData->layouts.getMissCount();
+    s_textData->layouts.nextFrame();
+
+    s_stats.glyphsCached  = s_textData->glyphs.getGlyphCount();
+    s_stats.glyphsPending = s_textData->glyphs.getPendingCount();
+    s_stats.glyphsGenerated += s_textData->glyphs.getGeneratedCount();
+    s_stats.glyphsFromCache += s_textData->glyphs.getFromCacheCount();
+    s_stats.glyphsEvicted += s_textData->glyphs.getEvictedCount();
+
+    s_stats.packedTextures = s_quadData->packedTextures.size();
+    s_stats.texturePages   = std::count_if(s_quadData->pages.begin(),
+                                         s_quadData->pages.end(),
+                                         [](const TexturePage& page) { return page.p_array != nullptr; });
+
+    s_inScene = false;
+}
+
+void Renderer2D::s_setLayer(u8_t layer)
+{
+    s_drawList->layer = layer;
 }
 
 void Renderer2D::s_drawQuad(const glm::mat4&    transform,
@@ -112,54 +175,37 @@ void Renderer2D::s_drawQuad(const glm::mat4&    transform,
                             f32_t               texTilingFactor,
                             u32_t               entityId)
 {
-    // first make sure we can fit this quad:
-    //  verify we have room left for this character
-    if (s_quadData->quadCount + 1 > s_quadData->instVertices.size())
+    // still decoding/uploading, bind() would fail anyway
+    if (p_texture != nullptr && !p_texture->isLoaded())
     {
-        // We're full, We need to submit data to render.
-        _s_submit();
-        // this will resize the buffers if possible on begin()
-        s_quadData->needsResize = true;
+        return;
     }
 
-    int texIdx = 0;
-    if (p_texture != nullptr)
-    {
-        for (size_t i = 1; i < s_quadData->textures.size(); i++)
-        {
-            if (*(s_quadData->textures[i]) == *p_texture)
-            {
-                // this fellow is the same, so reuse it
-                texIdx = static_cast<int>(i);
-                break;
-            }
-        }
-        // we didn't find it, so it's a new texture
-        if (texIdx == 0)
-        {
-            if (s_quadData->textures.size() == s_quadData->textures.capacity())
-            {
-                // we've used all texture slots, send it;
-                _s_submit();
-            }
+    QuadItem item;
+    item.transform       = transform;
+    item.color           = color;
+    item.p_texture       = p_texture;
+    item.texTilingFactor = texTilingFactor;
+    item.entityId        = entityId;
 
-            // grab the location and store it
-            texIdx = s_quadData->textures.size();
-            s_quadData->textures.push_back(p_texture);
-        }
-    }
-    else
+    bool compact = _s_encodeCompactQuad(transform, color, texTilingFactor, entityId, item.compactVertex);
+
+    // quads on the same page bind the same thing, so they group by page rather than by texture
+    u32_t textureKey = 0;  // white texture
+    if (p_texture != nullptr)
     {
-        texIdx = 0;  // white texture
+        item.p_packed = _s_findPackedTexture(p_texture);
+        textureKey    = item.p_packed != nullptr ? (k_pageKeyBit | item.p_packed->page)
+                                                 : (p_texture->getUid() & (k_pageKeyBit - 1));
     }
 
-    s_quadData->instVertices[s_quadData->quadCount].transform       = transform;
-    s_quadData->instVertices[s_quadData->quadCount].color           = color;
-    s_quadData->instVertices[s_quadData->quadCount].texIndex        = texIdx;
-    s_quadData->instVertices[s_quadData->quadCount].texTilingFactor = texTilingFactor;
-    s_quadData->instVertices[s_quadData->quadCount].entityId        = entityId;
+    // without depth testing only the order decides what ends up on top, so everything is drawn as if translucent
+    bool translucent = !GraphicsApi::getDepthTest() || color.a < 1.0f || s_hasAlpha(p_texture);
 
-    s_quadData->quadCount++;
+    DrawKind kind  = compact ? DrawKind::compactQuad : DrawKind::quad;
+    u32_t    index = static_cast<u32_t>(s_drawList->quads.size());
+    s_drawList->items.push_back({_s_makeSortKey(kind, textureKey, transform[3].z, translucent), index, kind});
+    s_drawList->quads.push_back(std::move(item));
 }
 
 void Renderer2D::s_drawQuad(const glm::mat4& transform, const glm::vec4& color, u32_t entityId)
@@ -168,6 +214,47 @@ void Renderer2D::s_drawQuad(const glm::mat4& transform, const glm::vec4& color,
     s_drawQuad(transform, nullptr, color, 1.0f, entityId);
 }
 
+void Renderer2D::s_uploadStaticBatch(const ref<StaticQuadBatch>& p_batch)
+{
+    NB_PROFILE();
+
+    s_stats.staticQuadsUploaded += p_batch->_upload();
+}
+
+void Renderer2D::s_drawStaticBatch(const ref<StaticQuadBatch>& p_batch, u32_t first, u32_t count, f32_t depth)
+{
+    NB_PROFILE_TRACE();
+
+    if (!s_inScene)
+    {
+        Log::coreError("Renderer2D::s_drawStaticBatch called outside of Renderer2D::begin/end!");
+        return;
+    }
+
+    NB_CORE_ASSERT(first + count <= p_batch->getSlotCount(), "Drawing slots the batch doesn't have");
+
+    if (count == 0 || p_batch->mp_buffer == nullptr)
+    {
+        return;
+    }
+
+    // a run can hold any of the batch's textures, there's no one texture to key it on
+    u32_t index = static_cast<u32_t>(s_drawList->statics.size());
+    s_drawList->items.push_back(
+        {_s_makeSortKey(DrawKind::staticBatch, 0, depth, true), index, DrawKind::staticBatch});
+    s_drawList->statics.push_back({p_batch, first, count});
+}
+
+void Renderer2D::s_drawStaticBatch(const ref<StaticQuadBatch>& p_batch)
+{
+    s_uploadStaticBatch(p_batch);
+
+    for (const StaticQuadBatch::Run& run : p_batch->getRuns())
+    {
+        s_drawStaticBatch(p_batch, run.first, run.count, run.depth);
+    }
+}
+
 void Renderer2D::s_drawText(const std::string&  text,
                             const Font::Format& fontFormat,
                             const glm::vec3&    position,
@@ -201,206 +288,399 @@ void Renderer2D::s_drawText(const std::string&  text,
         return;
     }
 
-    const auto& fontData     = fontFormat.p_font->getFontData();
-    const auto& fontGeometry = fontData->fontGeometry;
-    const auto& fontMetrics  = fontGeometry.getMetrics();
-    const f32_t spaceAdvance = fontGeometry.getGlyph(' ')->getAdvance();
+    const TextLayoutCache::Layout& layout = s_textData->layouts.get(text, fontFormat);
+    if (layout.glyphs.empty())
+    {
+        return;
+    }
+
+    TextItem item;
+    item.p_font    = fontFormat.p_font;
+    item.p_layout  = &layout;
+    item.transform = transform;
+    item.fgColor   = fontFormat.fgColor;
+    item.bgColor   = fontFormat.bgColor;
+    item.unitRange = s_textData->glyphs.getUnitRange();
+    item.entityId  = entityId;
+
+    // glyph edges are blended, text is always translucent. All text samples the same pages, no texture to key on.
+    u32_t index = static_cast<u32_t>(s_drawList->texts.size());
+    s_drawList->items.push_back({_s_makeSortKey(DrawKind::text, 0, transform[3].z, true), index, DrawKind::text});
+    s_drawList->texts.push_back(std::move(item));
+}
+
+Renderer2D::Stats Renderer2D::s_getStats()
+{
+    Renderer::CmdQStats cmdQStats = Renderer::s_getCmdQStats();
+
+    Stats stats                  = s_stats;
+    stats.cmdQueueBytes          = cmdQStats.renderBytes + cmdQStats.objectBytes;
+    stats.cmdQueueHighWaterBytes = cmdQStats.highWaterBytes;
+    stats.cmdQueuePoolBytes      = cmdQStats.poolBytes;
+    stats.cmdLists               = cmdQStats.cmdLists;
+    stats.streamedBytes          = StreamingBuffer::s_getBytesStreamed();
+
+    GraphicsApi::StateStats stateStats = GraphicsApi::getStateStats();
+    stats.stateChangesIssued           = stateStats.issued;
+    stats.stateChangesSkipped          = stateStats.skipped;
+    return stats;
+}
+
+bool Renderer2D::s_getTextBounds(const std::string&  text,
+                                 const Font::Format& fontFormat,
+                                 glm::vec2&          min,
+                                 glm::vec2&          max)
+{
+    if (fontFormat.p_font == nullptr || !fontFormat.p_font->isLoaded())
+    {
+        return false;
+    }
+
+    // the layout s_drawText is about to draw, laid out now if it isn't cached yet
+    const TextLayoutCache::Layout& layout = s_textData->layouts.get(text, fontFormat);
+
+    // Plane bounds are only known once a glyph is generated, a margin of half the ascender to descender height covers
+    // glyphs overhanging their advance, like italics and accents
+    const f32_t k_margin = 0.5f;
+
+    min = layout.min - k_margin;
+    max = layout.max + k_margin;
+    return true;
+}
+
+void Renderer2D::s_addCullStats(u32_t quads, u32_t culledQuads, u32_t texts, u32_t culledTexts)
+{
+    s_stats.submittedQuads += quads - culledQuads;
+    s_stats.culledQuads += culledQuads;
+    s_stats.submittedTexts += texts - culledTexts;
+    s_stats.culledTexts += culledTexts;
+}
 
-    auto p_atlas = fontFormat.p_font->getAtlasTex();
+void Renderer2D::s_resetStats()
+{
+    s_stats = Stats();
+}
 
-    // calc data we need
-    f32_t     atlasWidth  = p_atlas->getWidth();
-    f32_t     atlasHeight = p_atlas->getHeight();
-    glm::vec2 unitRange   = glm::vec2(fontData->pixelRange) / glm::vec2(atlasWidth, atlasHeight);
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Private functions
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+u64_t Renderer2D::_s_makeSortKey(DrawKind kind, u32_t textureKey, f32_t depth, bool translucent)
+{
+    u64_t key      = static_cast<u64_t>(s_drawList->layer) << 56;
+    u32_t sequence = s_drawList->sequence++;
 
-    f64_t incX        = 0.0;  // incremental x position
-    f64_t incY        = 0.0;  // incremental y positioncp
-    f64_t scale       = 1.0 / (fontMetrics.ascenderY - fontMetrics.descenderY);
-    f32_t texelWidth  = 1.0f / atlasWidth;
-    f32_t texelHeight = 1.0f / atlasHeight;
+    if (translucent)
+    {
+        // higher z is closer to the camera, so ascending depth is back to front
+        key |= u64_t(1) << 55;
+        key |= static_cast<u64_t>(s_sortableDepth(depth)) << 31;
+        key |= sequence & 0x7FFFFFFF;
 
-    int texIdx = -1;
-    for (size_t i = 0; i < s_textData->atlases.size(); i++)
+        s_stats.translucentDraws++;
+    }
+    else
     {
-        if (*(s_textData->atlases[i]) == *p_atlas)
-        {
-            // this fellow is the same, so reuse it
-            texIdx = static_cast<int>(i);
-            break;
-        }
+        // front to back within a texture, so the depth test rejects what's hidden before it's shaded
+        key |= static_cast<u64_t>(kind) << 52;
+        key |= static_cast<u64_t>(textureKey & 0xFFFFF) << 32;
+        key |= static_cast<u64_t>(~s_sortableDepth(depth) & 0xFFFFFF) << 8;
+
+        s_stats.opaqueDraws++;
     }
-    // we didn't find it, so it's a new texture
-    if (texIdx == -1)
+
+    return key;
+}
+
+void Renderer2D::_s_sortDrawList()
+{
+    NB_PROFILE_DETAIL();
+
+    std::vector<DrawItem>& items   = s_drawList->items;
+    std::vector<DrawItem>& scratch = s_drawList->sortScratch;
+    scratch.resize(items.size());
+
+    // Least significant byte first. Every pass is stable, so items with the same byte keep the order the previous
+    // passes gave them, and equal keys keep the order they were submitted in.
+    for (u32_t shift = 0; shift < 64; shift += 8)
     {
-        if (s_textData->atlases.size() == s_textData->atlases.capacity())
+        u32_t counts[256] = {};
+        for (const DrawItem& item : items)
         {
-            // we've used all texture slots, send it;
-            _s_submit();
+            counts[(item.key >> shift) & 0xFF]++;
+        }
+
+        // all keys share this byte (layers mostly do), the pass wouldn't move anything
+        if (counts[(items[0].key >> shift) & 0xFF] == items.size())
+        {
+            continue;
+        }
+
+        u32_t offset = 0;
+        for (u32_t& count : counts)
+        {
+            u32_t bucketSize = count;
+            count            = offset;
+            offset += bucketSize;
+        }
+
+        for (const DrawItem& item : items)
+        {
+            scratch[counts[(item.key >> shift) & 0xFF]++] = item;
         }
 
-        // grab the location and store it
-        texIdx = s_textData->atlases.size();
-        s_textData->atlases.push_back(p_atlas);
+        items.swap(scratch);
     }
+}
+
+void Renderer2D::_s_flushDrawList()
+{
+    NB_PROFILE();
 
-    for (u32_t i = 0; i < text.size(); i++)
+    if (s_drawList->items.empty())
     {
-        char character = text[i];
+        return;
+    }
+
+    _s_sortDrawList();
+
+    // runs of a batch that follow each other in the buffer and in the sorted list are drawn with one call
+    StaticItem pending = {nullptr, 0, 0};
 
-        // some characters we don't need to render, we just need to
-        // adjust where the character after that will be (like spaces)
-        if (character == '\x20')
+    for (const DrawItem& item : s_drawList->items)
+    {
+        if (item.kind == DrawKind::staticBatch)
         {
-            // if this isn't the last character
-            if (i < text.size() - 1)
+            const StaticItem& run = s_drawList->statics[item.index];
+            if (pending.p_batch == run.p_batch && pending.first + pending.count == run.first)
             {
-                f64_t advance;
-                if (!fontGeometry.getAdvance(advance, character, text[i + 1]))
-                {
-                    // we couldn't get a specific advance for this character
-                    // combination, so just use the one for this character
-                    advance = spaceAdvance;
-                }
-
-                // kerning doesn't apply to spaces
-                incX += scale * static_cast<f32_t>(advance);
+                pending.count += run.count;
                 continue;
             }
         }
-        else if (character == '\n')
+
+        if (pending.p_batch != nullptr)
         {
-            // newlines just reset us back to zero x, and move y down.
-            incX = 0.0f;
-            incY -= scale * fontMetrics.lineHeight + fontFormat.leading;
-            continue;
+            _s_drawStatic(pending);
+            pending.p_batch = nullptr;
         }
-        else if (character == '\t')
+
+        if (item.kind == DrawKind::staticBatch)
         {
-            // a tab is 4 space characters, specific character pair advance
-            // doesn't matter for tabs either
-            incX += scale * (spaceAdvance * 4.0);
-            continue;
+            pending = s_drawList->statics[item.index];
         }
-        else if (character == '\r')
+        else if (item.kind == DrawKind::text)
         {
-            // we don't need to do anything with this
-            continue;
+            _s_batchText(s_drawList->texts[item.index]);
         }
+        else
+        {
+            _s_batchQuad(s_drawList->quads[item.index], item.kind == DrawKind::compactQuad);
+        }
+    }
+
+    if (pending.p_batch != nullptr)
+    {
+        _s_drawStatic(pending);
+    }
+
+    _s_submit();
+
+    s_drawList->items.clear();
+    s_drawList->quads.clear();
+    s_drawList->texts.clear();
+    s_drawList->statics.clear();
+}
+
+void Renderer2D::_s_batchQuad(const QuadItem& item, bool compact)
+{
+    // a batch only holds one kind of instance
+    if ((s_quadData->quadCount > 0 && compact != s_quadData->compactBatch) || s_textData->glyphCount > 0)
+    {
+        _s_submit();
+        s_stats.batchBreaksPipeline++;
+    }
+    s_quadData->compactBatch = compact;
 
-        // verify we have room left for this character
-        if (s_textData->vertexIdx + 4 > s_textData->vertices.size())
+    // first make sure we can fit this quad
+    if (s_quadData->quadCount + 1 > s_quadData->instVertices.size())
+    {
+        if (s_quadData->instVertices.size() < k_quadMaxCount)
+        {
+            // the streaming buffer grows with us, so no need to flush
+            u32_t newSize = std::min(static_cast<u32_t>(s_quadData->instVertices.size()) * 2, k_quadMaxCount);
+            s_quadData->instVertices.resize(newSize);
+            s_quadData->compactInstVertices.resize(newSize);
+        }
+        else
         {
-            // We need to submit data to render.
+            // the batch can't get any bigger, send it
             _s_submit();
-            // this will resize the buffers if possible on begin()
-            s_textData->needsResize = true;
+            s_stats.batchBreaksCapacity++;
+        }
+    }
+
+    i32_t texIdx   = 0;  // white texture
+    i32_t texLayer = k_noLayer;
+    if (item.p_packed != nullptr)
+    {
+        TexturePage& page = s_quadData->pages[item.p_packed->page];
+        if (page.batchSlot == k_noSlot)
+        {
+            if (s_quadData->batchPages.size() == k_quadPageSlots)
+            {
+                // we've used all page slots, send it
+                _s_submit();
+                s_stats.batchBreaksTextures++;
+            }
+
+            page.batchSlot = s_quadData->batchPages.size();
+            s_quadData->batchPages.push_back(item.p_packed->page);
+        }
+
+        texIdx   = page.batchSlot;
+        texLayer = item.p_packed->layer;
+    }
+    else if (item.p_texture != nullptr)
+    {
+        auto p_slot = s_quadData->textureSlots.find(item.p_texture.raw());
+        if (p_slot != s_quadData->textureSlots.end())
+        {
+            texIdx = p_slot->second;
+        }
+        else
+        {
+            if (s_quadData->textures.size() == k_quadTextureSlots)
+            {
+                // we've used all texture slots, send it
+                _s_submit();
+                s_stats.batchBreaksTextures++;
+            }
+
+            // grab the location and store it
+            texIdx = s_quadData->textures.size();
+            s_quadData->textures.push_back(item.p_texture);
+            s_quadData->textureSlots.emplace(item.p_texture.raw(), texIdx);
         }
+    }
+
+    if (compact)
+    {
+        QuadCompactInstVertex& vertex = s_quadData->compactInstVertices[s_quadData->quadCount];
+
+        vertex = item.compactVertex;
+        vertex.texture |= (static_cast<u32_t>(texIdx) & 0xF) | ((static_cast<u32_t>(texLayer + 1) & 0xFFF) << 4);
+    }
+    else
+    {
+        QuadInstVertex& vertex = s_quadData->instVertices[s_quadData->quadCount];
+
+        vertex.transform       = item.transform;
+        vertex.color           = item.color;
+        vertex.texIndex        = texIdx;
+        vertex.texTilingFactor = item.texTilingFactor;
+        vertex.entityId        = item.entityId;
+        vertex.texLayer        = texLayer;
+    }
+
+    s_quadData->quadCount++;
+}
+
+void Renderer2D::_s_batchText(const TextItem& item)
+{
+    if (s_quadData->quadCount > 0)
+    {
+        _s_submit();
+        s_stats.batchBreaksPipeline++;
+    }
+
+    TextStyle style;
+    style.transform = item.transform;
+    style.fgColor   = item.fgColor;
+    style.bgColor   = item.bgColor;
+    style.unitRange = item.unitRange;
+    style.entityId  = item.entityId;
 
-        // we need to find the character in the atlas
-        auto glyph = fontGeometry.getGlyph(character);
+    u32_t styleIdx = static_cast<u32_t>(s_textData->styles.size());
+    s_textData->styles.push_back(style);
 
-        if (!glyph)
+    GlyphAtlas& atlas = s_textData->glyphs;
+    f32_t       scale = item.p_layout->scale;
+
+    for (const TextLayoutCache::Glyph& glyph : item.p_layout->glyphs)
+    {
+        // not generated yet, the rest of the text draws without it until it is
+        const GlyphAtlas::Glyph* p_glyph = atlas.use(glyph.handle, item.p_font);
+        if (p_glyph == nullptr)
         {
-            // we didn't find it so use a ? if it's there
-            glyph = fontGeometry.getGlyph('?');
-            Log::coreWarn("Glyph %c not found in font %s", character, fontFormat.p_font->getPath().c_str());
+            continue;
         }
-        // whats the deal with this font?
-        NB_CORE_ASSERT_STATIC(glyph,
-                              "Glyph %c not found in font %s (nor was ? for that matter)",
-                              character,
-                              fontFormat.p_font->getPath().c_str());
-
-        // figure out the bounds of the quad needed for glyph
-        f64_t quadLeft;
-        f64_t quadBottom;
-        f64_t quadRight;
-        f64_t quadTop;
-        glyph->getQuadPlaneBounds(quadLeft, quadBottom, quadRight, quadTop);
-        quadLeft   = (quadLeft * scale) + incX;
-        quadBottom = (quadBottom * scale) + incY;
-        quadRight  = (quadRight * scale) + incX;
-        quadTop    = (quadTop * scale) + incY;
-
-        // figure out the location in the atlas
-        f64_t texLeft;
-        f64_t texBottom;
-        f64_t texRight;
-        f64_t texTop;
-        glyph->getQuadAtlasBounds(texLeft, texBottom, texRight, texTop);
-        glm::vec2 texCoordMin((f32_t)texLeft, (f32_t)texBottom);
-        glm::vec2 texCoordMax((f32_t)texRight, (f32_t)texTop);
-
-        texLeft *= texelWidth;
-        texBottom *= texelHeight;
-        texRight *= texelWidth;
-        texTop *= texelHeight;
-
-        s_textData->vertices[s_textData->vertexIdx].position  = transform * glm::vec4(quadLeft, quadBottom, 0.0f, 1.0f);
-        s_textData->vertices[s_textData->vertexIdx].texCoord  = glm::vec2(texLeft, texBottom);
-        s_textData->vertices[s_textData->vertexIdx].fgColor   = fontFormat.fgColor;
-        s_textData->vertices[s_textData->vertexIdx].bgColor   = fontFormat.bgColor;
-        s_textData->vertices[s_textData->vertexIdx].unitRange = unitRange;
-        s_textData->vertices[s_textData->vertexIdx].texIndex  = texIdx;
-        s_textData->vertices[s_textData->vertexIdx].entityId  = entityId;
-
-        s_textData->vertexIdx++;
-
-        s_textData->vertices[s_textData->vertexIdx].position  = transform * glm::vec4(quadLeft, quadTop, 0.0f, 1.0f);
-        s_textData->vertices[s_textData->vertexIdx].texCoord  = glm::vec2(texLeft, texTop);
-        s_textData->vertices[s_textData->vertexIdx].fgColor   = fontFormat.fgColor;
-        s_textData->vertices[s_textData->vertexIdx].bgColor   = fontFormat.bgColor;
-        s_textData->vertices[s_textData->vertexIdx].unitRange = unitRange;
-        s_textData->vertices[s_textData->vertexIdx].texIndex  = texIdx;
-        s_textData->vertices[s_textData->vertexIdx].entityId  = entityId;
-
-        s_textData->vertexIdx++;
-
-        s_textData->vertices[s_textData->vertexIdx].position  = transform * glm::vec4(quadRight, quadTop, 0.0f, 1.0f);
-        s_textData->vertices[s_textData->vertexIdx].texCoord  = glm::vec2(texRight, texTop);
-        s_textData->vertices[s_textData->vertexIdx].fgColor   = fontFormat.fgColor;
-        s_textData->vertices[s_textData->vertexIdx].bgColor   = fontFormat.bgColor;
-        s_textData->vertices[s_textData->vertexIdx].unitRange = unitRange;
-        s_textData->vertices[s_textData->vertexIdx].texIndex  = texIdx;
-        s_textData->vertices[s_textData->vertexIdx].entityId  = entityId;
-
-        s_textData->vertexIdx++;
-
-        s_textData->vertices[s_textData->vertexIdx].position = transform * glm::vec4(quadRight, quadBottom, 0.0f, 1.0f);
-        s_textData->vertices[s_textData->vertexIdx].texCoord = glm::vec2(texRight, texBottom);
-        s_textData->vertices[s_textData->vertexIdx].fgColor  = fontFormat.fgColor;
-        s_textData->vertices[s_textData->vertexIdx].bgColor  = fontFormat.bgColor;
-        s_textData->vertices[s_textData->vertexIdx].unitRange = unitRange;
-        s_textData->vertices[s_textData->vertexIdx].texIndex  = texIdx;
-        s_textData->vertices[s_textData->vertexIdx].entityId  = entityId;
-
-        s_textData->vertexIdx++;
-
-        s_textData->charCount++;
-
-        if (i < text.size() - 1)
+
+        // verify we have room left for this glyph
+        if (s_textData->glyphCount + 1 > s_textData->instVertices.size())
         {
-            f64_t advance;
-            if (!fontGeometry.getAdvance(advance, character, text[i + 1]))
+            if (s_textData->instVertices.size() < k_glyphMaxCount)
             {
-                // we couldn't get a specific advance for this character
-                // combination, so just use the one for this character
-                advance = glyph->getAdvance();
+                u32_t newSize = std::min(static_cast<u32_t>(s_textData->instVertices.size()) * 2, k_glyphMaxCount);
+                s_textData->instVertices.resize(newSize);
             }
+            else
+            {
+                _s_submit();
+                s_stats.batchBreaksCapacity++;
 
-            incX += scale * static_cast<f32_t>(advance) + fontFormat.kerning;
+                // the submit let go of the styles, the rest of the text still needs its own
+                styleIdx = 0;
+                s_textData->styles.push_back(style);
+            }
         }
+
+        glm::vec4 origin(glyph.origin, glyph.origin);
+        glm::vec4 plane = p_glyph->plane * scale + origin;
+
+        s_textData->instVertices[s_textData->glyphCount] = {plane, p_glyph->atlas, styleIdx, p_glyph->page};
+        s_textData->glyphCount++;
     }
 }
 
-void Renderer2D::s_resetStats()
+void Renderer2D::_s_drawStatic(const StaticItem& item)
 {
-    s_stats = Stats();
+    // the batch brings its own textures and instances, whatever was batched before it has to go first
+    _s_submit();
+
+    const ref<StaticQuadBatch>& p_batch = item.p_batch;
+
+    for (size_t i = 0; i < p_batch->m_textures.size(); i++)
+    {
+        if (p_batch->m_textures[i].users > 0)
+        {
+            p_batch->m_textures[i].p_texture->bind(i);
+        }
+    }
+
+    for (size_t i = 0; i < p_batch->m_pages.size(); i++)
+    {
+        const StaticQuadBatch::PageSlot& slot = p_batch->m_pages[i];
+        if (slot.users > 0)
+        {
+            s_quadData->pages[slot.page].p_array->bind(k_quadTextureSlots + i);
+        }
+    }
+
+    u32_t stride = k_quadInstVertexFormat.getStride();
+    s_quadData->p_vao->bindVertexBuffer(s_quadData->instBinding, p_batch->mp_buffer, stride, item.first * stride);
+
+    PipelineState pipeline;
+    pipeline.p_shader      = s_quadData->p_shader;
+    pipeline.p_vertexArray = s_quadData->p_vao;
+    pipeline.blendingMode  = GraphicsApi::BlendingMode::alphaBlend;
+
+    // removed slots inside a run are degenerate, cheaper to let them through than to compact the buffer every time
+    Renderer::s_renderInstanced(pipeline, item.count);
+
+    s_stats.drawCalls++;
+    s_stats.staticQuads += item.count;
 }
 
-////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-// Private functions
-////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 void Renderer2D::_s_submit()
 {
     NB_PROFILE();
@@ -410,18 +690,42 @@ void Renderer2D::_s_submit()
     ///////////////////////////
     if (s_quadData->quadCount > 0)
     {
-        s_quadData->p_vbo->setData(&s_quadData->instVertices[0], sizeof(QuadInstVertex) * s_quadData->quadCount);
+        bool             compact     = s_quadData->compactBatch;
+        ref<VertexArray> p_vao       = compact ? s_quadData->p_compactVao : s_quadData->p_vao;
+        u32_t            binding     = compact ? s_quadData->compactInstBinding : s_quadData->instBinding;
+        const void*      p_instances = compact ? static_cast<const void*>(s_quadData->compactInstVertices.data())
+                                               : static_cast<const void*>(s_quadData->instVertices.data());
+
+        u32_t stride = compact ? k_quadCompactInstVertexFormat.getStride() : k_quadInstVertexFormat.getStride();
+
+        u32_t                       size       = stride * s_quadData->quadCount;
+        ref<StreamingBuffer>        p_stream   = Renderer::s_getStreamingBuffer();
+        StreamingBuffer::Allocation allocation = p_stream->allocate(size);
+
+        memcpy(allocation.p_data, p_instances, size);
+        p_stream->bindVertexBuffer(p_vao, binding, stride, allocation);
 
         for (size_t i = 0; i < s_quadData->textures.size(); i++)
         {
             s_quadData->textures[i]->bind(i);
         }
 
-        Renderer::s_renderInstanced(s_quadData->p_shader, s_quadData->p_vao, s_quadData->quadCount);
+        for (size_t i = 0; i < s_quadData->batchPages.size(); i++)
+        {
+            s_quadData->pages[s_quadData->batchPages[i]].p_array->bind(k_quadTextureSlots + i);
+        }
+
+        PipelineState pipeline;
+        pipeline.p_shader      = compact ? s_quadData->p_compactShader : s_quadData->p_shader;
+        pipeline.p_vertexArray = p_vao;
+        pipeline.blendingMode  = GraphicsApi::BlendingMode::alphaBlend;
+
+        Renderer::s_renderInstanced(pipeline, s_quadData->quadCount);
 
         // collect stats
         s_stats.drawCalls++;
         s_stats.quads += s_quadData->quadCount;
+        s_stats.compactQuads += compact ? s_quadData->quadCount : 0;
         s_stats.quadVertices += s_quadData->quadCount * 4;
         s_stats.totalVertices += s_quadData->quadCount * 4;
         s_stats.quadVertsAvail = (s_quadData->instVertices.size() * 4) - s_stats.quadVertices;
@@ -430,40 +734,222 @@ void Renderer2D::_s_submit()
         s_quadData->quadCount = 0;
 
         // remove all but the first texture (the white one)
+        for (size_t i = 1; i < s_quadData->textures.size(); i++)
+        {
+            s_quadData->textureSlots.erase(s_quadData->textures[i].raw());
+        }
         s_quadData->textures.erase(s_quadData->textures.begin() + 1, s_quadData->textures.end());
+
+        for (u32_t pageIdx : s_quadData->batchPages)
+        {
+            s_quadData->pages[pageIdx].batchSlot = k_noSlot;
+        }
+        s_quadData->batchPages.clear();
     }
 
     ///////////////////////////
     // Text Rendering
     ///////////////////////////
-    if (s_textData->charCount > 0)
+    if (s_textData->glyphCount > 0)
     {
-        s_textData->p_vbo->setData(&s_textData->vertices[0], sizeof(TextVertex) * s_textData->vertexIdx);
+        u32_t                       stride     = k_glyphInstVertexFormat.getStride();
+        u32_t                       size       = stride * s_textData->glyphCount;
+        ref<StreamingBuffer>        p_stream   = Renderer::s_getStreamingBuffer();
+        StreamingBuffer::Allocation allocation = p_stream->allocate(size);
 
-        for (size_t i = 0; i < s_textData->atlases.size(); i++)
-        {
-            s_textData->atlases[i]->bind(i);
-        }
+        memcpy(allocation.p_data, s_textData->instVertices.data(), size);
+        p_stream->bindVertexBuffer(s_textData->p_vao, s_textData->instBinding, stride, allocation);
 
-        Renderer::s_render(  // 6 vertex per quad
-            s_textData->p_shader,
-            s_textData->p_vao,
-            s_textData->charCount * 6,
-            true);
+        u32_t                       stylesSize       = sizeof(TextStyle) * s_textData->styles.size();
+        StreamingBuffer::Allocation stylesAllocation = p_stream->allocate(stylesSize, StreamingBuffer::k_uniformAlign);
+
+        memcpy(stylesAllocation.p_data, s_textData->styles.data(), stylesSize);
+        p_stream->bindStorageBuffer(k_textStyleBinding, stylesAllocation);
+
+        s_textData->glyphs.getPages()->bind(0);
+
+        PipelineState pipeline;
+        pipeline.p_shader      = s_textData->p_shader;
+        pipeline.p_vertexArray = s_textData->p_vao;
+        pipeline.blendingMode  = GraphicsApi::BlendingMode::alphaBlend;
+
+        Renderer::s_renderInstanced(pipeline, s_textData->glyphCount);
 
         // collect stats
         s_stats.drawCalls++;
-        s_stats.characters += s_textData->charCount;
-        s_stats.textVertices += s_textData->charCount * 4;
-        s_stats.totalVertices += s_textData->charCount * 4;
-        s_stats.textVertsAvail = s_textData->vertices.size() - s_stats.textVertices;
+        s_stats.characters += s_textData->glyphCount;
+        s_stats.textVertices += s_textData->glyphCount * 4;
+        s_stats.totalVertices += s_textData->glyphCount * 4;
+        s_stats.textVertsAvail = (s_textData->instVertices.size() * 4) - s_stats.textVertices;
 
         // reset
-        s_textData->vertexIdx = 0;
-        s_textData->charCount = 0;
+        s_textData->glyphCount = 0;
+
+        s_textData->styles.clear();
+    }
+}
+
+bool Renderer2D::_s_packTexture(const ref<Texture>& p_texture)
+{
+    NB_PROFILE_DETAIL();
+
+    // only textures loaded from files, anything else (render targets, ...) can change after it has been copied
+    const Texture::Spec& spec = p_texture->getSpec();
+    if (p_texture->getPath().empty() || spec.samples > 1 || spec.width > k_pageMaxTextureSize
+        || spec.height > k_pageMaxTextureSize)
+    {
+        return false;
+    }
+
+    u32_t bytesPerPixel = 0;
+    switch (spec.formatInternal)
+    {
+        case (Texture::FormatInternal::rgba8):
+        case (Texture::FormatInternal::rgb8):  // padded to 4 by most drivers
+            bytesPerPixel = 4;
+            break;
+        case (Texture::FormatInternal::r8):
+            bytesPerPixel = 1;
+            break;
+        default:
+            return false;
+    }
+
+    // a third on top for the mips
+    u32_t layerBytes = spec.width * spec.height * bytesPerPixel * 4 / 3;
+    u32_t maxLayers  = std::min(k_pageBudgetBytes / layerBytes, k_pageMaxLayers);
+    if (maxLayers < 2)
+    {
+        // no point in a page that can only ever hold one texture
+        return false;
+    }
+
+    u32_t pageIdx = k_noSlot;
+    u32_t growIdx = k_noSlot;
+    u32_t freeIdx = k_noSlot;
+    for (u32_t i = 0; i < s_quadData->pages.size(); i++)
+    {
+        const TexturePage& page = s_quadData->pages[i];
+        if (page.p_array == nullptr)
+        {
+            freeIdx = i;
+        }
+        else if (page.p_array->getWidth() == spec.width && page.p_array->getHeight() == spec.height
+                 && page.p_array->getFormat() == spec.formatInternal)
+        {
+            if (!page.freeLayers.empty())
+            {
+                pageIdx = i;
+                break;
+            }
 
-        s_textData->atlases.clear();
+            if (growIdx == k_noSlot && page.p_array->getLayerCount() < maxLayers)
+            {
+                growIdx = i;
+            }
+        }
+    }
+
+    if (pageIdx == k_noSlot && growIdx != k_noSlot)
+    {
+        pageIdx = growIdx;
+        _s_growPage(pageIdx, maxLayers);
+    }
+    else if (pageIdx == k_noSlot)
+    {
+        // sized to what's in it, it grows as more textures are packed
+        TexturePage page;
+        page.p_array = TextureArray::s_create(spec.width, spec.height, spec.formatInternal, 1);
+        page.freeLayers.push_back(0);
+
+        if (freeIdx != k_noSlot)
+        {
+            pageIdx                    = freeIdx;
+            s_quadData->pages[pageIdx] = std::move(page);
+        }
+        else
+        {
+            pageIdx = s_quadData->pages.size();
+            s_quadData->pages.push_back(std::move(page));
+        }
+    }
+
+    TexturePage& page  = s_quadData->pages[pageIdx];
+    u32_t        layer = page.freeLayers.back();
+    page.freeLayers.pop_back();
+
+    page.p_array->copyLayer(p_texture, layer);
+
+    // the page has its pixels now, drawing it anywhere else samples the layer too
+    p_texture->viewLayer(page.p_array, layer);
+
+    s_quadData->packedTextures.emplace(p_texture.raw(), PackedTexture{p_texture, pageIdx, layer});
+
+    return true;
+}
+
+void Renderer2D::_s_growPage(u32_t pageIdx, u32_t maxLayers)
+{
+    NB_PROFILE_DETAIL();
+
+    TexturePage&      page      = s_quadData->pages[pageIdx];
+    ref<TextureArray> p_old     = page.p_array;
+    u32_t             oldLayers = p_old->getLayerCount();
+    u32_t             layers    = std::min(oldLayers * 2, maxLayers);
+
+    page.p_array = TextureArray::s_create(p_old->getWidth(), p_old->getHeight(), p_old->getFormat(), layers);
+    page.p_array->copyLayers(p_old);
+
+    // handed out from the back, lowest layer first
+    for (u32_t layer = layers; layer > oldLayers; layer--)
+    {
+        page.freeLayers.push_back(layer - 1);
+    }
+
+    // views of the old array would keep its memory alive
+    for (const auto& [p_raw, packed] : s_quadData->packedTextures)
+    {
+        if (packed.page == pageIdx)
+        {
+            packed.p_texture->viewLayer(page.p_array, packed.layer);
+        }
+    }
+}
+
+const Renderer2D::PackedTexture* Renderer2D::_s_findPackedTexture(const ref<Texture>& p_texture)
+{
+    auto p_packed = s_quadData->packedTextures.find(p_texture.raw());
+    if (p_packed == s_quadData->packedTextures.end() && _s_packTexture(p_texture))
+    {
+        p_packed = s_quadData->packedTextures.find(p_texture.raw());
     }
+
+    return p_packed != s_quadData->packedTextures.end() ? &p_packed->second : nullptr;
+}
+
+void Renderer2D::_s_evictPackedTextures()
+{
+    // textures only we still reference are gone as far as everyone else is concerned, give their layers back
+    std::erase_if(s_quadData->packedTextures,
+                  [](const auto& pair)
+                  {
+                      const PackedTexture& packed = pair.second;
+                      if (packed.p_texture->getRefCount() > 1)
+                      {
+                          return false;
+                      }
+
+                      TexturePage& page = s_quadData->pages[packed.page];
+                      page.freeLayers.push_back(packed.layer);
+
+                      if (page.freeLayers.size() == page.p_array->getLayerCount())
+                      {
+                          page.p_array = nullptr;
+                          page.freeLayers.clear();
+                      }
+
+                      return true;
+                  });
 }
 
 template <typename IndexType>
@@ -491,33 +977,10 @@ void Renderer2D::_s_createQuadBuffers()
 {
     NB_PROFILE_DETAIL();
 
-    ///////////////////////////
-    // Determine size
-    ///////////////////////////
-    u32_t newSize;
-    if (s_quadData->p_vao)
-    {
-        // this is a resize
-        newSize = s_quadData->instVertices.size() + k_quadGrowCount;
-
-        if (newSize >= k_quadMaxCount)
-        {
-            Log::coreWarn("Quad buffer size limit (%i) reached.", k_quadMaxCount);
-            return;
-        }
-    }
-    else
-    {
-        newSize = k_quadInitCount;
-    }
-
-    ///////////////////////////
-    // (Re)make VAO
-    ///////////////////////////
     s_quadData->p_vao = VertexArray::s_create();
 
     ///////////////////////////
-    // (Re)make Shared VBO
+    // Shared VBO
     ///////////////////////////
     // shared, doesn't change after creation so no need to save handle to it
     auto sharedVbo = VertexBuffer::s_create(
@@ -527,89 +990,122 @@ void Renderer2D::_s_createQuadBuffers()
     s_quadData->p_vao->addVertexBuffer(sharedVbo);
 
     ///////////////////////////
-    // (Re)make IBO for shared
+    // IBO for shared
     ///////////////////////////
     s_generateIndicesAndSetBuffer<u8_t>(1, s_quadData->p_vao);
 
     ///////////////////////////
-    // (Re)make Instance VBO
+    // Instance data
     ///////////////////////////
-    s_quadData->instVertices = std::vector<QuadInstVertex>(newSize);
+    // streamed in each batch
+    s_quadData->instBinding = s_quadData->p_vao->addVertexFormat(k_quadInstVertexFormat);
 
-    s_quadData->p_vbo = VertexBuffer::s_create(&s_quadData->instVertices[0],
-                                               s_quadData->instVertices.size() * sizeof(QuadInstVertex),
-                                               VertexBuffer::Type::streamDraw);
+    s_quadData->instVertices = std::vector<QuadInstVertex>(k_quadInitCount);
+    s_quadData->quadCount    = 0;
 
-    s_quadData->p_vbo->setFormat(k_quadInstVertexFormat);
-    s_quadData->p_vao->addVertexBuffer(s_quadData->p_vbo);
-
-    s_quadData->quadCount   = 0;
-    s_quadData->needsResize = false;
+    ///////////////////////////
+    // Compact instance VAO
+    ///////////////////////////
+    // same quad, instances in the compact format
+    s_quadData->p_compactVao = VertexArray::s_create();
+    s_quadData->p_compactVao->addVertexBuffer(sharedVbo);
+    s_generateIndicesAndSetBuffer<u8_t>(1, s_quadData->p_compactVao);
 
-    Log::coreInfo("Quad buffer sized to %i", newSize);
+    s_quadData->compactInstBinding  = s_quadData->p_compactVao->addVertexFormat(k_quadCompactInstVertexFormat);
+    s_quadData->compactInstVertices = std::vector<QuadCompactInstVertex>(k_quadInitCount);
 }
 
-void Renderer2D::_s_createTextBuffers()
+bool Renderer2D::_s_encodeCompactQuad(const glm::mat4&       transform,
+                                      const glm::vec4&       color,
+                                      f32_t                  texTilingFactor,
+                                      u32_t                  entityId,
+                                      QuadCompactInstVertex& vertex)
 {
-    NB_PROFILE_DETAIL();
+    // smallest and biggest normal halves
+    const f32_t k_halfMin = 6.104e-5f;
+    const f32_t k_halfMax = 65504.0f;
 
-    ///////////////////////////
-    // Determine size
-    ///////////////////////////
-    u32_t newSize;
-    if (s_textData->p_vao)
+    const glm::vec4& axisX = transform[0];
+    const glm::vec4& axisY = transform[1];
+
+    // Anything tilted out of the plane or with a projection needs the full matrix. The quad is flat, so the z axis
+    // column never affects it.
+    if (axisX.z != 0.0f || axisX.w != 0.0f || axisY.z != 0.0f || axisY.w != 0.0f || transform[3].w != 1.0f)
     {
-        // this is a resize
-        s_textData->p_vao->unbind();
+        return false;
+    }
 
-        newSize = s_textData->vertices.size() + k_textVerticesGrowCount;
+    // colors get stored as 8 bits, keep anything over bright as it is
+    if (glm::any(glm::lessThan(color, glm::vec4(0.0f))) || glm::any(glm::greaterThan(color, glm::vec4(1.0f))))
+    {
+        return false;
+    }
 
-        if (newSize >= k_textVerticesMaxCount)
-        {
-            Log::coreWarn("Text vertex buffer size limit (%i) reached.", k_textVerticesMaxCount);
-            return;
-        }
+    glm::vec2 scale(glm::length(glm::vec2(axisX)), glm::length(glm::vec2(axisY)));
+    if (scale.x < k_halfMin || scale.y < k_halfMin || scale.x > k_halfMax || scale.y > k_halfMax
+        || std::abs(texTilingFactor) > k_halfMax)
+    {
+        return false;
     }
-    else
+
+    // axes have to be at right angles, no shear
+    if (std::abs(glm::dot(glm::vec2(axisX), glm::vec2(axisY))) > 1e-4f * scale.x * scale.y)
     {
-        newSize = k_textVerticesInitCount;
+        return false;
     }
 
-    ///////////////////////////
-    // (Re)make VAO
-    ///////////////////////////
+    // depth orders sprites, so it has to survive being a half exactly
+    f32_t    depth     = transform[3].z;
+    u16_t    depthBits = glm::packHalf1x16(depth);
+    if (glm::unpackHalf1x16(depthBits) != depth)
+    {
+        return false;
+    }
+
+    // a mirrored transform has its y axis clockwise from the x axis
+    if (axisX.x * axisY.y - axisX.y * axisY.x < 0.0f)
+    {
+        scale.y = -scale.y;
+    }
+
+    f32_t turns    = std::atan2(axisX.y, axisX.x) / glm::two_pi<f32_t>();
+    u32_t rotation = static_cast<u32_t>(std::lround((turns - std::floor(turns)) * 65536.0f)) & 0xFFFF;
+
+    vertex.translation   = glm::vec2(transform[3]);
+    vertex.depthRotation = static_cast<u32_t>(depthBits) | (rotation << 16);
+    vertex.scale         = glm::packHalf2x16(scale);
+    vertex.color         = glm::packUnorm4x8(color);
+    vertex.texture       = static_cast<u32_t>(glm::packHalf1x16(texTilingFactor)) << 16;
+    vertex.entityId      = entityId;
+    return true;
+}
+
+void Renderer2D::_s_createTextBuffers()
+{
+    NB_PROFILE_DETAIL();
+
     s_textData->p_vao = VertexArray::s_create();
 
     ///////////////////////////
-    // (Re)make VBO
+    // Shared VBO
     ///////////////////////////
-    s_textData->vertices = std::vector<TextVertex>(newSize);
+    // the same quad as the sprites, each glyph stretches it over its rect
+    auto sharedVbo = VertexBuffer::s_create(
+        &s_quadData->vertices[0], s_quadData->vertices.size() * sizeof(QuadVertex), VertexBuffer::Type::staticDraw);
 
-    s_textData->p_vbo = VertexBuffer::s_create(
-        &s_textData->vertices[0], s_textData->vertices.size() * sizeof(TextVertex), VertexBuffer::Type::dynamicDraw);
+    sharedVbo->setFormat(k_quadVertexFormat);
+    s_textData->p_vao->addVertexBuffer(sharedVbo);
 
-    s_textData->p_vbo->setFormat(k_TextVertexFormat);
-    s_textData->p_vao->addVertexBuffer(s_textData->p_vbo);
+    s_generateIndicesAndSetBuffer<u8_t>(1, s_textData->p_vao);
 
     ///////////////////////////
-    // (Re)make IBO
+    // Instance data
     ///////////////////////////
-    u32_t maxIndexVal = 6 * newSize - 1;
-
-    if (maxIndexVal < 65536)
-    {
-        s_generateIndicesAndSetBuffer<u16_t>(newSize / 4, s_textData->p_vao);
-    }
-    else
-    {
-        s_generateIndicesAndSetBuffer<u32_t>(newSize / 4, s_textData->p_vao);
-    }
-
-    s_textData->charCount   = 0;
-    s_textData->vertexIdx   = 0;
-    s_textData->needsResize = false;
+    // streamed in each batch
+    s_textData->instBinding = s_textData->p_vao->addVertexFormat(k_glyphInstVertexFormat);
 
-    Log::coreInfo("Text buffer sized to %i", newSize / 4);
+    s_textData->instVertices = std::vector<GlyphInstVertex>(k_glyphInitCount);
+    s_textData->glyphCount   = 0;
 }
 
-}  // namespace nimbus
\ No newline at end of file
+}  // namespace nimbus
@@ -0,0 +1,379 @@
+#include "nimbus/core/nmpch.hpp"
+#include "nimbus/core/core.hpp"
+
+#include "nimbus/renderer/staticQuadBatch.hpp"
+#include "nimbus/renderer/renderer.hpp"
+
+#include <algorithm>
+#include <limits>
+
+namespace nimbus
+{
+
+StaticQuadBatch::StaticQuadBatch()
+{
+    m_instances.resize(k_initCapacity, _s_hiddenInstance());
+
+    m_textures.resize(Renderer2D::k_quadTextureSlots);
+    m_pages.resize(Renderer2D::k_quadPageSlots);
+
+    // slot 0 is always the white texture, for quads without one
+    m_textures[0].p_texture = Renderer::getWhiteTexture();
+}
+
+u32_t StaticQuadBatch::add(const glm::mat4&    transform,
+                           const ref<Texture>& p_texture,
+                           const glm::vec4&    color,
+                           f32_t               texTilingFactor,
+                           u32_t               entityId)
+{
+    i32_t texIndex = 0;
+    i32_t texLayer = Renderer2D::k_noLayer;
+    if (!_acquireTexture(p_texture, texIndex, texLayer))
+    {
+        return k_noSlot;
+    }
+
+    if (m_slotCount == m_instances.size())
+    {
+        // the GPU buffer can't grow in place, it's recreated with everything on the next upload
+        m_instances.resize(m_instances.size() * 2, _s_hiddenInstance());
+        m_bufferIsStale = true;
+    }
+
+    u32_t     slot     = m_slotCount++;
+    Instance& instance = m_instances[slot];
+
+    instance.transform       = transform;
+    instance.color           = color;
+    instance.texIndex        = texIndex;
+    instance.texTilingFactor = texTilingFactor;
+    instance.entityId        = entityId;
+    instance.texLayer        = texLayer;
+
+    m_dirtySlots.push_back(slot);
+    return slot;
+}
+
+bool StaticQuadBatch::set(u32_t               slot,
+                          const glm::mat4&    transform,
+                          const ref<Texture>& p_texture,
+                          const glm::vec4&    color,
+                          f32_t               texTilingFactor,
+                          u32_t               entityId)
+{
+    NB_CORE_ASSERT(slot < m_slotCount, "Slot %i was never added to the batch", slot);
+
+    // take the new texture before letting go of the old one, so a slot keeping its texture can't lose its place
+    i32_t texIndex = 0;
+    i32_t texLayer = Renderer2D::k_noLayer;
+    if (!_acquireTexture(p_texture, texIndex, texLayer))
+    {
+        return false;
+    }
+
+    Instance& instance = m_instances[slot];
+    _releaseTexture(instance);
+
+    instance.transform       = transform;
+    instance.color           = color;
+    instance.texIndex        = texIndex;
+    instance.texTilingFactor = texTilingFactor;
+    instance.entityId        = entityId;
+    instance.texLayer        = texLayer;
+
+    m_dirtySlots.push_back(slot);
+    return true;
+}
+
+void StaticQuadBatch::remove(u32_t slot)
+{
+    NB_CORE_ASSERT(slot < m_slotCount, "Slot %i was never added to the batch", slot);
+
+    _releaseTexture(m_instances[slot]);
+    m_instances[slot] = _s_hiddenInstance();
+
+    m_removedCount++;
+    m_dirtySlots.push_back(slot);
+}
+
+void StaticQuadBatch::clear()
+{
+    std::fill(m_instances.begin(), m_instances.begin() + m_slotCount, _s_hiddenInstance());
+    m_slotCount    = 0;
+    m_removedCount = 0;
+
+    for (u32_t i = 1; i < m_textures.size(); i++)
+    {
+        m_textures[i] = TextureSlot();
+    }
+    m_textures[0].users = 0;
+
+    std::fill(m_pages.begin(), m_pages.end(), PageSlot());
+
+    m_dirtySlots.clear();
+    m_chunkRuns.clear();
+    m_runs.clear();
+    m_bufferIsStale = true;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Private Functions
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+bool StaticQuadBatch::_acquireTexture(const ref<Texture>& p_texture, i32_t& texIndex, i32_t& texLayer)
+{
+    if (p_texture == nullptr)
+    {
+        texIndex = 0;
+        texLayer = Renderer2D::k_noLayer;
+        m_textures[0].users++;
+        return true;
+    }
+
+    if (!p_texture->isLoaded())
+    {
+        return false;
+    }
+
+    const Renderer2D::PackedTexture* p_packed = Renderer2D::_s_findPackedTexture(p_texture);
+    if (p_packed != nullptr)
+    {
+        u32_t freeIdx = k_noSlot;
+        for (u32_t i = 0; i < m_pages.size(); i++)
+        {
+            if (m_pages[i].users > 0 && m_pages[i].page == p_packed->page)
+            {
+                freeIdx = i;
+                break;
+            }
+            else if (m_pages[i].users == 0 && freeIdx == k_noSlot)
+            {
+                freeIdx = i;
+            }
+        }
+
+        if (freeIdx == k_noSlot)
+        {
+            return false;
+        }
+
+        m_pages[freeIdx].page = p_packed->page;
+        m_pages[freeIdx].users++;
+
+        texIndex = freeIdx;
+        texLayer = p_packed->layer;
+        return true;
+    }
+
+    u32_t freeIdx = k_noSlot;
+    for (u32_t i = 1; i < m_textures.size(); i++)
+    {
+        if (m_textures[i].users > 0 && m_textures[i].p_texture == p_texture)
+        {
+            freeIdx = i;
+            break;
+        }
+        else if (m_textures[i].users == 0 && freeIdx == k_noSlot)
+        {
+            freeIdx = i;
+        }
+    }
+
+    if (freeIdx == k_noSlot)
+    {
+        return false;
+    }
+
+    m_textures[freeIdx].p_texture = p_texture;
+    m_textures[freeIdx].users++;
+
+    texIndex = freeIdx;
+    texLayer = Renderer2D::k_noLayer;
+    return true;
+}
+
+void StaticQuadBatch::_releaseTexture(const Instance& instance)
+{
+    if (instance.texLayer != Renderer2D::k_noLayer)
+    {
+        m_pages[instance.texIndex].users--;
+        return;
+    }
+
+    TextureSlot& slot = m_textures[instance.texIndex];
+    slot.users--;
+
+    // keep the white texture, let go of anything else nobody uses anymore
+    if (slot.users == 0 && instance.texIndex != 0)
+    {
+        slot.p_texture = nullptr;
+    }
+}
+
+StaticQuadBatch::Instance StaticQuadBatch::_s_hiddenInstance()
+{
+    Instance instance;
+    instance.transform       = glm::mat4(0.0f);
+    instance.color           = glm::vec4(0.0f);
+    instance.texIndex        = 0;
+    instance.texTilingFactor = 1.0f;
+    instance.entityId        = 0;
+    instance.texLayer        = Renderer2D::k_noLayer;
+    return instance;
+}
+
+u32_t StaticQuadBatch::_upload()
+{
+    NB_PROFILE_DETAIL();
+
+    const u32_t k_stride = sizeof(Instance);
+
+    if (!m_bufferIsStale && !m_dirtySlots.empty())
+    {
+        std::sort(m_dirtySlots.begin(), m_dirtySlots.end());
+        m_dirtySlots.erase(std::unique(m_dirtySlots.begin(), m_dirtySlots.end()), m_dirtySlots.end());
+
+        // most of the batch changed, recreating it beats streaming that much
+        if (m_dirtySlots.size() * k_stride > k_streamedUploadMaxBytes)
+        {
+            m_bufferIsStale = true;
+        }
+    }
+
+    _updateRuns();
+
+    if (m_bufferIsStale)
+    {
+        mp_buffer = VertexBuffer::s_create(
+            m_instances.data(), m_instances.size() * k_stride, VertexBuffer::Type::staticDraw);
+
+        m_bufferIsStale = false;
+        m_dirtySlots.clear();
+        return m_slotCount;
+    }
+
+    if (m_dirtySlots.empty())
+    {
+        return 0;
+    }
+
+    // merge dirty slots into ranges, a few clean slots in between are cheaper than another copy
+    struct Range
+    {
+        u32_t begin;
+        u32_t end;
+    };
+    std::vector<Range> ranges;
+
+    u32_t uploaded = 0;
+    for (u32_t slot : m_dirtySlots)
+    {
+        if (!ranges.empty() && slot <= ranges.back().end + k_rangeMergeGap)
+        {
+            uploaded += slot + 1 - ranges.back().end;
+            ranges.back().end = slot + 1;
+        }
+        else
+        {
+            uploaded++;
+            ranges.push_back({slot, slot + 1});
+        }
+    }
+
+    ref<StreamingBuffer>        p_stream   = Renderer::s_getStreamingBuffer();
+    StreamingBuffer::Allocation allocation = p_stream->allocate(uploaded * k_stride);
+
+    u32_t offset = 0;
+    for (const Range& range : ranges)
+    {
+        u32_t size = (range.end - range.begin) * k_stride;
+
+        memcpy(static_cast<u8_t*>(allocation.p_data) + offset, &m_instances[range.begin], size);
+        p_stream->copyToBuffer(allocation, offset, size, mp_buffer, range.begin * k_stride);
+
+        offset += size;
+    }
+
+    m_dirtySlots.clear();
+    return uploaded;
+}
+
+void StaticQuadBatch::_updateRuns()
+{
+    if (!m_bufferIsStale && m_dirtySlots.empty())
+    {
+        return;
+    }
+
+    u32_t chunkCount = (m_slotCount + k_runMaxSlots - 1) / k_runMaxSlots;
+    m_chunkRuns.resize(chunkCount);
+
+    if (m_bufferIsStale)
+    {
+        for (u32_t chunk = 0; chunk < chunkCount; chunk++)
+        {
+            _findRuns(chunk);
+        }
+    }
+    else
+    {
+        // dirty slots are sorted by now, each chunk comes up once
+        u32_t lastChunk = k_noSlot;
+        for (u32_t slot : m_dirtySlots)
+        {
+            u32_t chunk = slot / k_runMaxSlots;
+            if (chunk != lastChunk)
+            {
+                _findRuns(chunk);
+                lastChunk = chunk;
+            }
+        }
+    }
+
+    m_runs.clear();
+    for (const std::vector<Run>& runs : m_chunkRuns)
+    {
+        m_runs.insert(m_runs.end(), runs.begin(), runs.end());
+    }
+}
+
+void StaticQuadBatch::_findRuns(u32_t chunk)
+{
+    std::vector<Run>& runs = m_chunkRuns[chunk];
+    runs.clear();
+
+    u32_t begin = chunk * k_runMaxSlots;
+    u32_t end   = std::min(begin + k_runMaxSlots, m_slotCount);
+
+    for (u32_t slot = begin; slot < end; slot++)
+    {
+        const glm::mat4& transform = m_instances[slot].transform;
+
+        // only hidden slots have a zero transform, any quad's has a 1 in the corner
+        if (transform[3][3] == 0.0f)
+        {
+            continue;
+        }
+
+        f32_t depth = transform[3].z;
+        if (runs.empty() || runs.back().depth != depth)
+        {
+            runs.push_back({slot,
+                            0,
+                            depth,
+                            glm::vec3(std::numeric_limits<f32_t>::max()),
+                            glm::vec3(std::numeric_limits<f32_t>::lowest())});
+        }
+
+        // the unit quad's corners are half of the transform's x and y axes away from its center
+        glm::vec3 center = glm::vec3(transform[3]);
+        glm::vec3 extent = (glm::abs(glm::vec3(transform[0])) + glm::abs(glm::vec3(transform[1]))) * 0.5f;
+
+        Run& run  = runs.back();
+        run.count = slot + 1 - run.first;
+        run.min   = glm::min(run.min, center - extent);
+        run.max   = glm::max(run.max, center + extent);
+    }
+}
+
+}  // namespace nimbus
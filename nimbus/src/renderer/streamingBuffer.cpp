@@ -0,0 +1,26 @@
+#include "nimbus/core/nmpch.hpp"
+#include "nimbus/core/core.hpp"
+
+#include "nimbus/renderer/streamingBuffer.hpp"
+#include "nimbus/renderer/renderer.hpp"
+
+#include "nimbus/platform/gl/glStreamingBuffer.hpp"
+
+namespace nimbus
+{
+
+static_assert(StreamingBuffer::k_regionCount == Renderer::k_maxFramesInFlight + 1,
+              "Streaming buffers need a region for every frame that can be in flight");
+
+ref<StreamingBuffer> StreamingBuffer::s_create(u32_t regionSize)
+{
+    return ref<GlStreamingBuffer>::gen(regionSize);
+}
+
+void StreamingBuffer::s_nextFrame()
+{
+    s_bytesLastFrame.store(s_bytesThisFrame.exchange(0, std::memory_order_relaxed), std::memory_order_relaxed);
+    s_frame.fetch_add(1, std::memory_order_release);
+}
+
+}  // namespace nimbus
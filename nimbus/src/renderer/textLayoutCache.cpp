@@ -0,0 +1,171 @@
+#include "nimbus/core/nmpch.hpp"
+#include "nimbus/core/core.hpp"
+
+#include "nimbus/renderer/textLayoutCache.hpp"
+#include "nimbus/renderer/fontData.hpp"
+#include "nimbus/core/utility.hpp"
+
+namespace nimbus
+{
+
+TextLayoutCache::TextLayoutCache(GlyphAtlas& atlas) : mp_atlas(&atlas)
+{
+}
+
+const TextLayoutCache::Layout& TextLayoutCache::get(const std::string& text, const Font::Format& fontFormat)
+{
+    NB_CORE_ASSERT(fontFormat.p_font != nullptr && fontFormat.p_font->isLoaded(), "Laying out text with no font!");
+
+    KeyView view{text, fontFormat.p_font.raw(), fontFormat.kerning, fontFormat.leading};
+
+    auto p_entry = m_layouts.find(view);
+    if (p_entry == m_layouts.end())
+    {
+        Layout layout;
+        _layOut(text, fontFormat, layout);
+
+        Key key{text, fontFormat.p_font, fontFormat.kerning, fontFormat.leading};
+        p_entry = m_layouts.emplace(std::move(key), std::move(layout)).first;
+
+        m_misses++;
+    }
+
+    p_entry->second.lastUsedFrame = m_frame;
+    return p_entry->second;
+}
+
+void TextLayoutCache::nextFrame()
+{
+    std::erase_if(m_layouts,
+                  [this](const auto& pair) { return m_frame - pair.second.lastUsedFrame > k_maxUnusedFrames; });
+
+    m_frame++;
+    m_misses = 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Private Functions
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+size_t TextLayoutCache::KeyHash::operator()(const KeyView& key) const
+{
+    size_t hash = std::hash<std::string_view>()(key.text);
+
+    // boost's hash_combine
+    auto combine = [&hash](size_t value) { hash ^= value + 0x9e3779b9 + (hash << 6) + (hash >> 2); };
+    combine(std::hash<const Font*>()(key.p_font));
+    combine(std::hash<f32_t>()(key.kerning));
+    combine(std::hash<f32_t>()(key.leading));
+
+    return hash;
+}
+
+size_t TextLayoutCache::KeyHash::operator()(const Key& key) const
+{
+    return (*this)(_s_view(key));
+}
+
+bool TextLayoutCache::KeyEqual::operator()(const KeyView& lhs, const KeyView& rhs) const
+{
+    return lhs.p_font == rhs.p_font && lhs.kerning == rhs.kerning && lhs.leading == rhs.leading
+           && lhs.text == rhs.text;
+}
+
+bool TextLayoutCache::KeyEqual::operator()(const Key& lhs, const KeyView& rhs) const
+{
+    return (*this)(_s_view(lhs), rhs);
+}
+
+bool TextLayoutCache::KeyEqual::operator()(const KeyView& lhs, const Key& rhs) const
+{
+    return (*this)(lhs, _s_view(rhs));
+}
+
+bool TextLayoutCache::KeyEqual::operator()(const Key& lhs, const Key& rhs) const
+{
+    return (*this)(_s_view(lhs), _s_view(rhs));
+}
+
+TextLayoutCache::KeyView TextLayoutCache::_s_view(const Key& key)
+{
+    return KeyView{key.text, key.p_font.raw(), key.kerning, key.leading};
+}
+
+void TextLayoutCache::_layOut(const std::string& text, const Font::Format& fontFormat, Layout& layout)
+{
+    NB_PROFILE_DETAIL();
+
+    const ref<Font>& p_font     = fontFormat.p_font;
+    const FontData*  p_fontData = p_font->getFontData();
+
+    // whats the deal with this font?
+    NB_CORE_ASSERT(p_fontData->glyphTable['?'].present, "Glyph ? not found in font %s", p_font->getPath().c_str());
+
+    f32_t scale = 1.0f / (p_fontData->ascenderY - p_fontData->descenderY);
+    f32_t incX  = 0.0f;  // incremental x position
+    f32_t incY  = 0.0f;  // incremental y position
+
+    layout.scale = scale;
+    layout.glyphs.reserve(text.size());
+
+    glm::vec2 min(std::numeric_limits<f32_t>::max());
+    glm::vec2 max(std::numeric_limits<f32_t>::lowest());
+
+    size_t pos       = 0;
+    u32_t  codepoint = text.empty() ? 0 : util::decodeUtf8(text, pos);
+
+    while (codepoint != 0)
+    {
+        u32_t next = pos < text.size() ? util::decodeUtf8(text, pos) : 0;
+
+        if (codepoint == '\n')
+        {
+            // newlines just reset us back to zero x, and move y down.
+            incX = 0.0f;
+            incY -= scale * p_fontData->lineHeight + fontFormat.leading;
+        }
+        else if (codepoint == '\t')
+        {
+            // a tab is 4 space characters, specific character pair advance doesn't matter for tabs either
+            incX += scale * p_fontData->glyphTable[' '].advance * 4.0f;
+        }
+        else if (codepoint != '\r')  // we don't need to do anything with \r
+        {
+            f32_t advance = 0.0f;
+            if (!p_font->getAdvance(codepoint, next, advance))
+            {
+                // only laid out once, so this doesn't repeat every frame
+                Log::coreWarn("Glyph U+%04X not found in font %s", codepoint, p_font->getPath().c_str());
+
+                codepoint = '?';
+                p_font->getAdvance(codepoint, next, advance);
+            }
+
+            // spaces only move where the character after them goes
+            if (codepoint != ' ')
+            {
+                layout.glyphs.push_back({glm::vec2(incX, incY), mp_atlas->getHandle(p_font, codepoint)});
+
+                // a pair's advance can be negative
+                f32_t endX = incX + scale * advance;
+                min        = glm::min(min, glm::vec2(std::min(incX, endX), incY + scale * p_fontData->descenderY));
+                max        = glm::max(max, glm::vec2(std::max(incX, endX), incY + scale * p_fontData->ascenderY));
+            }
+
+            if (next != 0)
+            {
+                // kerning doesn't apply to spaces
+                incX += scale * advance + (codepoint != ' ' ? fontFormat.kerning : 0.0f);
+            }
+        }
+
+        codepoint = next;
+    }
+
+    if (!layout.glyphs.empty())
+    {
+        layout.min = min;
+        layout.max = max;
+    }
+}
+
+}  // namespace nimbus
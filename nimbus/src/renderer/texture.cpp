@@ -27,6 +27,16 @@ u32_t Texture::s_getMaxTextures()
     return s_maxTextures;
 }
 
+void Texture::s_processLoads()
+{
+    GlTexture::s_processLoads();
+}
+
+void Texture::s_cancelLoads()
+{
+    GlTexture::s_cancelLoads();
+}
+
 u32_t Texture::s_format(Format format)
 {
     return GlTexture::s_format(format);
@@ -0,0 +1,22 @@
+#include "nimbus/core/nmpch.hpp"
+#include "nimbus/core/core.hpp"
+
+#include "nimbus/renderer/textureArray.hpp"
+
+#include "nimbus/platform/gl/glTextureArray.hpp"
+
+namespace nimbus
+{
+
+ref<TextureArray> TextureArray::s_create(
+    u32_t width, u32_t height, Texture::FormatInternal format, u32_t layers, bool mipmapped)
+{
+    return ref<GlTextureArray>::gen(width, height, format, layers, mipmapped);
+}
+
+u32_t TextureArray::s_levelCount(u32_t width, u32_t height)
+{
+    return 1 + static_cast<u32_t>(std::floor(std::log2(std::max(width, height))));
+}
+
+}  // namespace nimbus
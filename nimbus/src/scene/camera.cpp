@@ -133,7 +133,8 @@ glm::mat4& Camera::getView()
             m_view = glm::inverse(transform);
         }
 
-        m_staleView = false;
+        m_staleView     = false;
+        m_staleViewProj = true;
     }
 
     return m_view;
@@ -160,6 +161,7 @@ glm::mat4& Camera::getProjection()
         }
 
         m_staleProjection = false;
+        m_staleViewProj   = true;
     }
 
     return m_projection;
@@ -169,10 +171,12 @@ glm::mat4& Camera::getViewProjection()
 {
     NB_PROFILE_DETAIL();
 
-    if (m_staleView || m_staleProjection)
+    // getView/getProjection clear their own flags, so they can't tell us whether the product is stale
+    if (m_staleView || m_staleProjection || m_staleViewProj)
     {
         m_viewProjection = getProjection() * getView();
 
+        m_staleViewProj    = false;
         m_staleWorldBounds = true;
     }
     return m_viewProjection;
@@ -15,59 +15,70 @@ namespace nimbus
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Static functions
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-static void _s_updateWorldTransform(TransformCmp& tc, AncestryCmp& ac)
+// appends entity to parent's children
+static void _s_linkAncestry(entt::registry& registry, entt::entity entity, entt::entity parent)
 {
-    // if this guy has a parent, update his world transform
-    if (ac.parent && ac.parent.hasComponent<TransformCmp>())
+    AncestryCmp& ac       = registry.get<AncestryCmp>(entity);
+    AncestryCmp& parentAc = registry.get<AncestryCmp>(parent);
+
+    ac.parent      = parent;
+    ac.nextSibling = entt::null;
+
+    if (parentAc.firstChild == entt::null)
     {
-        tc.world.setTransform(ac.parent.getComponent<TransformCmp>().world.getTransform() * tc.local.getTransform());
+        // an only child is its own last sibling
+        parentAc.firstChild = entity;
+        ac.prevSibling      = entity;
     }
     else
     {
-        tc.world = tc.local;
-    }
+        AncestryCmp& firstAc = registry.get<AncestryCmp>(parentAc.firstChild);
 
-    // update his children's transforms, if any
-    for (auto& child : ac.children)
-    {
-        if (child.hasComponent<TransformCmp>())
-        {
-            _s_updateWorldTransform(child.getComponent<TransformCmp>(), child.getComponent<AncestryCmp>());
-        }
+        registry.get<AncestryCmp>(firstAc.prevSibling).nextSibling = entity;
+        ac.prevSibling                                             = firstAc.prevSibling;
+        firstAc.prevSibling                                        = entity;
     }
+
+    parentAc.childCount++;
 }
 
-// same as above, but accounts for physics behavior changes
-static void _s_updateWorldTransformRuntime(TransformCmp& tc, AncestryCmp& ac, bool hasFixture)
+static void _s_unlinkAncestry(entt::registry& registry, entt::entity entity)
 {
-    // if this guy has no fixture and a parent, update his world transform
-    if (!hasFixture && ac.parent && ac.parent.hasComponent<TransformCmp>())
+    AncestryCmp& ac = registry.get<AncestryCmp>(entity);
+    if (ac.parent == entt::null)
     {
-        tc.world.setTransform(ac.parent.getComponent<TransformCmp>().world.getTransform() * tc.local.getTransform());
+        return;
     }
-    else
+
+    AncestryCmp& parentAc = registry.get<AncestryCmp>(ac.parent);
+
+    if (parentAc.firstChild == entity)
     {
-        tc.world = tc.local;
+        // the next one becomes first, and takes over knowing the last
+        parentAc.firstChild = ac.nextSibling;
+        if (ac.nextSibling != entt::null)
+        {
+            registry.get<AncestryCmp>(ac.nextSibling).prevSibling = ac.prevSibling;
+        }
     }
-
-    // update his children's transforms, if any
-    for (auto& child : ac.children)
+    else
     {
-        if (child.hasComponent<TransformCmp>())
+        registry.get<AncestryCmp>(ac.prevSibling).nextSibling = ac.nextSibling;
+        if (ac.nextSibling != entt::null)
         {
-            bool hasFixture = false;
-            if (child.hasComponent<RigidBody2DCmp>())
-            {
-                if (child.getComponent<RigidBody2DCmp>().fixSpec.shape != nullptr)
-                {
-                    hasFixture = true;
-                }
-            }
-            _s_updateWorldTransformRuntime(child.getComponent<TransformCmp>(),
-                                           child.getComponent<AncestryCmp>(),
-                                           hasFixture);
+            registry.get<AncestryCmp>(ac.nextSibling).prevSibling = ac.prevSibling;
+        }
+        else
+        {
+            registry.get<AncestryCmp>(parentAc.firstChild).prevSibling = ac.prevSibling;
         }
     }
+
+    parentAc.childCount--;
+
+    ac.parent      = entt::null;
+    ac.nextSibling = entt::null;
+    ac.prevSibling = entt::null;
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -75,6 +86,25 @@ static void _s_updateWorldTransformRuntime(TransformCmp& tc, AncestryCmp& ac, bo
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 Scene::Scene(const std::string& name) : m_name(name)
 {
+    // transform components are handles into the pool, these hand out and track their slots
+    m_registry.on_construct<TransformCmp>().connect<&Scene::_onTransformAdded>(this);
+    m_registry.on_destroy<TransformCmp>().connect<&Scene::_onTransformRemoved>(this);
+
+    // and the pool mirrors the hierarchy, for propagating world transforms
+    m_registry.on_construct<AncestryCmp>().connect<&Scene::_onAncestryChanged>(this);
+    m_registry.on_update<AncestryCmp>().connect<&Scene::_onAncestryChanged>(this);
+    m_registry.on_destroy<AncestryCmp>().connect<&Scene::_onAncestryRemoved>(this);
+
+    // anything that changes how or where a sprite is drawn
+    m_registry.on_construct<SpriteCmp>().connect<&Scene::_onSpriteChanged>(this);
+    m_registry.on_update<SpriteCmp>().connect<&Scene::_onSpriteChanged>(this);
+    m_registry.on_destroy<SpriteCmp>().connect<&Scene::_onSpriteChanged>(this);
+    m_registry.on_construct<TransformCmp>().connect<&Scene::_onSpriteChanged>(this);
+    m_registry.on_update<TransformCmp>().connect<&Scene::_onSpriteChanged>(this);
+    m_registry.on_destroy<TransformCmp>().connect<&Scene::_onSpriteChanged>(this);
+
+    // emitters of entities removed while running stop being updated and drawn
+    m_registry.on_destroy<ParticleEmitterCmp>().connect<&Scene::_onParticleEmitterRemoved>(this);
 }
 
 Scene::~Scene()
@@ -100,56 +130,76 @@ Entity Scene::addChildEntity(Entity parentEntity, const std::string& name)
 {
     Entity child = addEntity(name);
 
-    auto& childAc = child.getComponent<AncestryCmp>();
-
-    childAc.parent = parentEntity;
-
-    auto& parentAc = parentEntity.getComponent<AncestryCmp>();
-    parentAc.children.push_back(child);
+    setParent(child, parentEntity);
 
     return child;
 }
 
 void Scene::removeEntity(Entity entity, bool removeChildren)
 {
-    auto& ac = entity.getComponent<AncestryCmp>();
+    entt::entity id = entity.getId();
 
-    if (!removeChildren)
+    // the children either go with it, or are promoted to top level nodes. Removing
+    // one can move this one's component in its pool, so it's looked up every time
+    entt::entity child;
+    while ((child = m_registry.get<AncestryCmp>(id).firstChild) != entt::null)
     {
-        // we want to remove this as the parent of all it's direct children
-        // essentially promoting all the direct children to top level nodes
-        for (auto child : ac.children)
+        if (removeChildren)
         {
-            child.getComponent<AncestryCmp>().parent = Entity();
+            removeEntity({child, this}, true);
         }
-    }
-    else
-    {
-        // otherwise we nuke the children recursively xD
-        for (u32_t i = 0; i < ac.children.size(); i++)
+        else
         {
-            removeEntity(ac.children[i], true);
+            setParent({child, this});
         }
     }
 
-    if (ac.parent)
-    {
-        auto& parentAc = ac.parent.getComponent<AncestryCmp>();
+    _s_unlinkAncestry(m_registry, id);
 
-        auto it = std::find(parentAc.children.begin(), parentAc.children.end(), entity);
+    m_registry.destroy(id);
+}
 
-        if (it != parentAc.children.end())
+void Scene::setParent(Entity entity, Entity parent)
+{
+    entt::entity id       = entity.getId();
+    entt::entity parentId = parent ? parent.getId() : entt::null;
+
+    if (m_registry.get<AncestryCmp>(id).parent == parentId)
+    {
+        return;
+    }
+
+    entt::entity ancestor = parentId;
+    while (ancestor != entt::null)
+    {
+        if (ancestor == id)
         {
-            parentAc.children.erase(it);
+            Log::coreWarn("%s can't be parented to its own descendant %s",
+                          entity.getComponent<NameCmp>().name.c_str(),
+                          parent.getComponent<NameCmp>().name.c_str());
+            return;
         }
+
+        ancestor = m_registry.get<AncestryCmp>(ancestor).parent;
+    }
+
+    _s_unlinkAncestry(m_registry, id);
+
+    if (parentId != entt::null)
+    {
+        _s_linkAncestry(m_registry, id, parentId);
     }
 
-    m_registry.destroy(entity.getId());
+    // for the transform pool's copy of the hierarchy
+    entity.markChanged<AncestryCmp>();
 }
 
 void Scene::sortEntities()
 {
     m_registry.sort<GuidCmp>([&](const auto lhs, const auto rhs) { return lhs.sequenceIndex < rhs.sequenceIndex; });
+
+    // the batch draws in the order sprites were added to it
+    m_rebuildSpriteBatch = true;
 }
 
 bool Scene::setScriptAssemblyPath(const std::filesystem::path& scriptAssemblyPath, bool load)
@@ -279,6 +329,7 @@ void Scene::onStartRuntime()
         {
             NB_UNUSED(entity);
             pec.p_emitter = ref<ParticleEmitter>::gen(pec.numParticles, pec.parameters, pec.p_texture, nullptr, false);
+            m_particleSystem.add(pec.p_emitter);
         });
 
     //////////////////////////////////////////////////////
@@ -291,23 +342,26 @@ void Scene::onStartRuntime()
         {
             NB_UNUSED(entity);
 
+            util::Transform world = tc.getWorldTransform();
+
             // update the spec with transform information
-            rbc.spec.position.x = tc.world.getTranslation().x;
-            rbc.spec.position.y = tc.world.getTranslation().y;
-            rbc.spec.angle      = tc.world.getRotation().z;
+            rbc.spec.position.x = world.getTranslation().x;
+            rbc.spec.position.y = world.getTranslation().y;
+            rbc.spec.angle      = world.getRotation().z;
 
             // save off transform pre-sim to restore after
-            rbc.preSimTransform = tc.local;
+            rbc.preSimTransform = tc.getLocalTransform();
 
             // other parameters are configured in place and are accessable by the SHP
             rbc.p_body             = mp_world2D->addRigidBody(rbc.spec);
             rbc.p_body->name       = nc.name;
             rbc.p_body->p_userData = (void*)entity;
 
-            // add fixture if so inclined
+            // add fixture if so inclined, the body moves it from then on rather than its parent
             if (rbc.fixSpec.shape != nullptr)
             {
-                rbc.p_body->addFixture(rbc.fixSpec, tc.world);
+                rbc.p_body->addFixture(rbc.fixSpec, world);
+                m_transforms.setFollowsParent(tc.slot, false);
             }
         });
 
@@ -351,6 +405,7 @@ void Scene::onStopRuntime()
             NB_UNUSED(entity);
             pec.p_emitter = nullptr;
         });
+    m_particleSystem.clear();
 
 
     //////////////////////////////////////////////////////
@@ -373,7 +428,8 @@ void Scene::onStopRuntime()
             NB_UNUSED(entity);
             rbc.p_body = nullptr;
 
-            tc.local = rbc.preSimTransform;
+            tc.setLocalTransform(rbc.preSimTransform);
+            m_transforms.setFollowsParent(tc.slot, true);
         });
 
     // remove world
@@ -394,9 +450,9 @@ void Scene::onUpdateRuntime(f32_t deltaTime)
 
             // we only want to update the XY translation and z rotation when using 2D physics
             util::Transform& transform = rbc.p_body->getTransform();
-            tc.local.setTranslationX(transform.getTranslation().x);
-            tc.local.setTranslationY(transform.getTranslation().y);
-            tc.local.setRotationZ(transform.getRotation().z);
+            tc.setTranslationX(transform.getTranslation().x);
+            tc.setTranslationY(transform.getTranslation().y);
+            tc.setRotationZ(transform.getRotation().z);
         });
 
 
@@ -430,27 +486,21 @@ void Scene::onUpdateRuntime(f32_t deltaTime)
             });
     }
 
-    // for all entities that have a transform, we want to update any
-    // all child transforms accordingly
-    auto tcView = m_registry.view<TransformCmp, AncestryCmp>();
+    _updateWorldTransforms();
 
-    for (auto [entity, tc, ac] : tcView.each())
-    {
-        // only update top level here
-        if (!ac.parent)
-        {  // this parameter only matters for children
-            _s_updateWorldTransformRuntime(tc, ac, false);
-        }
-    }
+    // the emitters may still be simulating the last update if it wasn't drawn
+    m_particleSystem.wait();
 
     auto peView = m_registry.view<GuidCmp, TransformCmp, ParticleEmitterCmp>();
 
     for (auto [entity, gc, tc, pec] : peView.each())
     {
-        pec.p_emitter->updateSpawnTransform(tc.world.getTranslation(), tc.world.getRotation(), tc.world.getScale());
-        pec.p_emitter->update(deltaTime);
+        util::Transform world = tc.getWorldTransform();
+        pec.p_emitter->updateSpawnTransform(world.getTranslation(), world.getRotation(), world.getScale());
     }
 
+    m_particleSystem.update(deltaTime);
+
     for (auto&& fn : m_postUpdateWorkQueue)
     {
         fn();
@@ -507,76 +557,473 @@ void Scene::onResize(u32_t width, u32_t height)
 
 void Scene::_render(Camera* p_camera)
 {
+    _updateSpriteBatch();
+
+    // the runs have to be up to date before they're culled
+    Renderer2D::s_uploadStaticBatch(mp_spriteBatch);
+    const std::vector<StaticQuadBatch::Run>& runs = mp_spriteBatch->getRuns();
+
+    auto textView = m_registry.view<GuidCmp, TransformCmp, TextCmp>();
+
+    // order based on GuidCmp which should be sorted based on sequenceIndex
+    // we want to render these by the order they were created, so newest
+    // objects are on top (assuming = Z due to 2D)
+    textView.use<GuidCmp>();
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Cull
+    ////////////////////////////////////////////////////////////////////////////
+    // Batch runs, unbatched sprites then text go into the culler, the n-th
+    // run, unbatched sprite and text is the n-th box of its kind.
+    m_culler.begin(p_camera->getViewProjection());
+
+    for (const StaticQuadBatch::Run& run : runs)
+    {
+        m_culler.addBox(run.min, run.max);
+    }
+
+    for (entt::entity entity : m_unbatchedSprites)
+    {
+        m_culler.add(m_registry.get<TransformCmp>(entity).getWorld());
+    }
+
+    u32_t firstTextBox = m_culler.getCount();
+
+    for (auto [entity, gc, tc, txc] : textView.each())
+    {
+        // text that can't be drawn yet gets an empty box, s_drawText skips it anyway
+        glm::vec2 min(0.0f);
+        glm::vec2 max(0.0f);
+        Renderer2D::s_getTextBounds(txc.text, txc.format, min, max);
+        m_culler.add(tc.getWorld(), min, max);
+    }
+
+    m_culler.cull();
+
     ////////////////////////////////////////////////////////////////////////////
     // Render
     ////////////////////////////////////////////////////////////////////////////
-    Renderer2D::s_begin(p_camera->getViewProjection());
+    Renderer2D::s_begin(p_camera->getView(), p_camera->getProjection());
+
+    u32_t quadCount   = static_cast<u32_t>(m_unbatchedSprites.size());
+    u32_t culledQuads = 0;
+    u32_t culledTexts = 0;
 
     //////////////////////////////////////////////////////
     // Sprites
     //////////////////////////////////////////////////////
-    auto spriteView = m_registry.view<GuidCmp, TransformCmp, SpriteCmp>();
+    // Batch slots and unbatched sprites are both in creation order, merging
+    // them by sequence index submits every sprite in the order it was made,
+    // same as drawing them one by one. Renderer2D then only reorders them by
+    // layer and depth. A run is split where unbatched sprites go in between.
+    const u32_t k_firstUnbatchedBox = static_cast<u32_t>(runs.size());
+    u32_t       nextUnbatched       = 0;
+
+    // draws the unbatched sprites made before sequence
+    auto drawUnbatched = [&](u32_t sequence)
+    {
+        while (nextUnbatched < m_unbatchedSprites.size())
+        {
+            entt::entity entity = m_unbatchedSprites[nextUnbatched];
+            if (m_registry.get<GuidCmp>(entity).sequenceIndex >= sequence)
+            {
+                break;
+            }
 
-    // order based on GuidCmp which should be sorted based on sequenceIndex
-    // we want to render these by the order they were created, so newest
-    // objects are on top (assuming = Z due to 2D)
-    spriteView.use<GuidCmp>();
+            if (!m_culler.isVisible(k_firstUnbatchedBox + nextUnbatched++))
+            {
+                culledQuads++;
+                continue;
+            }
 
-    for (auto [entity, gc, tc, sc] : spriteView.each())
+            auto [tc, sc] = m_registry.get<TransformCmp, SpriteCmp>(entity);
+            Renderer2D::s_drawQuad(tc.getWorld(),
+                                   sc.p_texture,
+                                   sc.color,
+                                   sc.tilingFactor,
+                                   static_cast<int>(entity));
+        }
+    };
+
+    for (u32_t runIdx = 0; runIdx < runs.size(); runIdx++)
     {
-        Renderer2D::s_drawQuad(tc.world.getTransform(),
-                               sc.p_texture,
-                               sc.color,
-                               sc.tilingFactor,
-                               static_cast<int>(entity));
+        const StaticQuadBatch::Run& run     = runs[runIdx];
+        bool                        visible = m_culler.isVisible(runIdx);
+
+        u32_t first = run.first;
+        u32_t end   = run.first + run.count;
+        while (first < end)
+        {
+            drawUnbatched(m_slotSequences[first]);
+
+            // up to the slot the next unbatched sprite goes before
+            u32_t last = end;
+            if (nextUnbatched < m_unbatchedSprites.size())
+            {
+                u32_t sequence = m_registry.get<GuidCmp>(m_unbatchedSprites[nextUnbatched]).sequenceIndex;
+                last           = static_cast<u32_t>(
+                    std::upper_bound(m_slotSequences.begin() + first, m_slotSequences.begin() + end, sequence)
+                    - m_slotSequences.begin());
+            }
+
+            if (visible)
+            {
+                Renderer2D::s_drawStaticBatch(mp_spriteBatch, first, last - first, run.depth);
+            }
+
+            first = last;
+        }
+
+        quadCount += run.count;
+        culledQuads += visible ? 0 : run.count;
     }
 
+    drawUnbatched(std::numeric_limits<u32_t>::max());
+
     //////////////////////////////////////////////////////
     // Text
     //////////////////////////////////////////////////////
-    auto textView = m_registry.view<GuidCmp, TransformCmp, TextCmp>();
-
-    // same as for sprites, but we also assume we want to draw text after
-    // sprites
-    textView.use<GuidCmp>();
-
+    // Renderer2D sorts text in with the sprites by depth, at the same depth
+    // whatever is submitted later goes on top, so text ends up over sprites
+    u32_t boxIdx = firstTextBox;
     for (auto [entity, gc, tc, txc] : textView.each())
     {
-        Renderer2D::s_drawText(txc.text, txc.format, tc.world.getTransform(), static_cast<int>(entity));
+        if (!m_culler.isVisible(boxIdx++))
+        {
+            culledTexts++;
+            continue;
+        }
+
+        Renderer2D::s_drawText(txc.text, txc.format, tc.getWorld(), static_cast<int>(entity));
     }
 
+    Renderer2D::s_addCullStats(quadCount, culledQuads, boxIdx - firstTextBox, culledTexts);
+
     Renderer2D::s_end();
 }
 
-void Scene::_renderSceneSpecific(Camera* p_camera)
+void Scene::_updateWorldTransforms()
 {
-    Renderer::s_setScene(p_camera->getViewProjection());
-    //////////////////////////////////////////////////////
-    // Particle Emitter
-    //////////////////////////////////////////////////////
-    auto peView = m_registry.view<GuidCmp, TransformCmp, ParticleEmitterCmp>();
+    NB_PROFILE_DETAIL();
 
-    for (auto [entity, gc, tc, pec] : peView.each())
+    m_movedTransforms.clear();
+    m_transforms.updateWorlds(m_movedTransforms);
+
+    // let listeners (the static sprite batch) know about world transforms that actually moved
+    for (entt::entity entity : m_movedTransforms)
     {
-        pec.p_emitter->draw();
+        m_registry.patch<TransformCmp>(entity);
     }
 }
 
-void Scene::_onUpdateEditor(f32_t deltaTime)
+void Scene::_onTransformAdded(entt::registry& registry, entt::entity entity)
 {
-    NB_UNUSED(deltaTime);
-    // for all entities that have a transform, we want to update any
-    // all child transforms accordingly
-    auto tcView = m_registry.view<TransformCmp, AncestryCmp>();
+    TransformCmp& tc = registry.get<TransformCmp>(entity);
+    tc.p_pool        = &m_transforms;
+    tc.slot          = m_transforms.add(entity);
+
+    // the editor adds transforms to entities that may already have family
+    _linkTransform(entity);
+
+    if (const AncestryCmp* p_ac = registry.try_get<AncestryCmp>(entity))
+    {
+        entt::entity child = p_ac->firstChild;
+        while (child != entt::null)
+        {
+            _linkTransform(child);
+            child = registry.get<AncestryCmp>(child).nextSibling;
+        }
+    }
+}
+
+void Scene::_onTransformRemoved(entt::registry& registry, entt::entity entity)
+{
+    // the last transform takes the freed slot, its children are left as roots
+    entt::entity moved = m_transforms.remove(registry.get<TransformCmp>(entity).slot);
+    if (moved != entt::null)
+    {
+        registry.get<TransformCmp>(moved).slot = registry.get<TransformCmp>(entity).slot;
+    }
+}
 
-    for (auto [entity, tc, ac] : tcView.each())
+void Scene::_onAncestryChanged(entt::registry& registry, entt::entity entity)
+{
+    NB_UNUSED(registry);
+    _linkTransform(entity);
+}
+
+void Scene::_onAncestryRemoved(entt::registry& registry, entt::entity entity)
+{
+    if (const TransformCmp* p_tc = registry.try_get<TransformCmp>(entity))
+    {
+        m_transforms.setParent(p_tc->slot, TransformPool::k_noSlot);
+    }
+}
+
+void Scene::_linkTransform(entt::entity entity)
+{
+    const TransformCmp* p_tc = m_registry.valid(entity) ? m_registry.try_get<TransformCmp>(entity) : nullptr;
+    if (p_tc == nullptr)
     {
-        // only update top level here
-        if (!ac.parent)
+        return;
+    }
+
+    // a parent without a transform leaves it a root
+    u32_t              parentSlot = TransformPool::k_noSlot;
+    const AncestryCmp* p_ac       = m_registry.try_get<AncestryCmp>(entity);
+    if (p_ac != nullptr && p_ac->parent != entt::null)
+    {
+        if (const TransformCmp* p_parentTc = m_registry.try_get<TransformCmp>(p_ac->parent))
         {
-            _s_updateWorldTransform(tc, ac);
+            parentSlot = p_parentTc->slot;
         }
     }
+
+    m_transforms.setParent(p_tc->slot, parentSlot);
+}
+
+void Scene::_onSpriteChanged(entt::registry& registry, entt::entity entity)
+{
+    // transforms of everything else are of no interest
+    if (!registry.all_of<SpriteCmp>(entity))
+    {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(m_changedSpritesMtx);
+    m_changedSprites.push_back(entity);
+}
+
+void Scene::_onParticleEmitterRemoved(entt::registry& registry, entt::entity entity)
+{
+    // outside runtime there's no emitter to remove
+    const ParticleEmitterCmp& pec = registry.get<ParticleEmitterCmp>(entity);
+    if (pec.p_emitter != nullptr)
+    {
+        m_particleSystem.remove(pec.p_emitter);
+    }
+}
+
+void Scene::_updateSpriteBatch()
+{
+    NB_PROFILE_DETAIL();
+
+    // past this many removed slots, and a quarter of the batch, it gets rebuilt without them
+    const u32_t k_maxRemovedSlots = 1024;
+
+    // past this many sprites left out of the batch for being out of order, it gets rebuilt with them
+    const u32_t k_maxMisplacedSprites = 64;
+
+    std::vector<entt::entity> changed;
+    {
+        std::lock_guard<std::mutex> lock(m_changedSpritesMtx);
+        changed.swap(m_changedSprites);
+    }
+
+    if (mp_spriteBatch != nullptr && mp_spriteBatch->getRemovedCount() > k_maxRemovedSlots
+        && mp_spriteBatch->getRemovedCount() > mp_spriteBatch->getSlotCount() / 4)
+    {
+        m_rebuildSpriteBatch = true;
+    }
+
+    if (m_misplacedSprites > k_maxMisplacedSprites)
+    {
+        m_rebuildSpriteBatch = true;
+    }
+
+    if (m_rebuildSpriteBatch)
+    {
+        _rebuildSpriteBatch();
+        return;
+    }
+
+    std::vector<entt::entity> added;
+    std::vector<entt::entity> refused;
+    for (entt::entity entity : changed)
+    {
+        bool isSprite = m_registry.valid(entity) && m_registry.all_of<GuidCmp, TransformCmp, SpriteCmp>(entity);
+
+        auto p_slot = m_spriteSlots.find(entity);
+        if (p_slot == m_spriteSlots.end())
+        {
+            bool waiting = std::find(m_loadingSprites.begin(), m_loadingSprites.end(), entity) != m_loadingSprites.end()
+                           || std::find(m_unbatchedSprites.begin(), m_unbatchedSprites.end(), entity)
+                                  != m_unbatchedSprites.end();
+
+            // unbatched and loading ones pick up the change by themselves and keep their place
+            if (!isSprite)
+            {
+                std::erase(m_unbatchedSprites, entity);
+                std::erase(m_loadingSprites, entity);
+            }
+            else if (!waiting)
+            {
+                added.push_back(entity);
+            }
+            continue;
+        }
+
+        if (isSprite)
+        {
+            auto [tc, sc] = m_registry.get<TransformCmp, SpriteCmp>(entity);
+            if (mp_spriteBatch->set(p_slot->second,
+                                    tc.getWorld(),
+                                    sc.p_texture,
+                                    sc.color,
+                                    sc.tilingFactor,
+                                    static_cast<u32_t>(entity)))
+            {
+                continue;
+            }
+
+            // its new texture doesn't fit in the batch, it's drawn unbatched in its place instead
+            refused.push_back(entity);
+        }
+
+        mp_spriteBatch->remove(p_slot->second);
+        m_spriteSlots.erase(p_slot);
+    }
+
+    // unbatched sprites are looked up to keep them in order, so only once every destroyed one is gone
+    for (entt::entity entity : refused)
+    {
+        _addUnbatchedSprite(entity);
+    }
+
+    // sprites waiting on their texture are new ones as far as the batch is concerned once it has loaded
+    std::erase_if(m_loadingSprites,
+                  [&](entt::entity entity)
+                  {
+                      const SpriteCmp* p_sc = m_registry.try_get<SpriteCmp>(entity);
+                      if (p_sc != nullptr && p_sc->p_texture != nullptr && !p_sc->p_texture->isLoaded())
+                      {
+                          return false;
+                      }
+
+                      added.push_back(entity);
+                      return true;
+                  });
+
+    if (added.empty())
+    {
+        return;
+    }
+
+    // newest go last, same as a rebuild would have them
+    std::sort(added.begin(),
+              added.end(),
+              [this](entt::entity lhs, entt::entity rhs)
+              {
+                  return m_registry.get<GuidCmp>(lhs).sequenceIndex < m_registry.get<GuidCmp>(rhs).sequenceIndex;
+              });
+    added.erase(std::unique(added.begin(), added.end()), added.end());
+
+    for (entt::entity entity : added)
+    {
+        auto [gc, tc, sc] = m_registry.get<GuidCmp, TransformCmp, SpriteCmp>(entity);
+
+        if (sc.p_texture != nullptr && !sc.p_texture->isLoaded())
+        {
+            m_loadingSprites.push_back(entity);
+            continue;
+        }
+
+        // only sprites newer than every slot can go on the end of the batch and keep it in creation order
+        if (!m_slotSequences.empty() && gc.sequenceIndex < m_slotSequences.back())
+        {
+            _addUnbatchedSprite(entity);
+            m_misplacedSprites++;
+            continue;
+        }
+
+        u32_t slot = mp_spriteBatch->add(
+            tc.getWorld(), sc.p_texture, sc.color, sc.tilingFactor, static_cast<u32_t>(entity));
+
+        if (slot == StaticQuadBatch::k_noSlot)
+        {
+            _addUnbatchedSprite(entity);
+        }
+        else
+        {
+            m_spriteSlots.emplace(entity, slot);
+            m_slotSequences.push_back(gc.sequenceIndex);
+        }
+    }
+}
+
+void Scene::_rebuildSpriteBatch()
+{
+    NB_PROFILE_DETAIL();
+
+    if (mp_spriteBatch == nullptr)
+    {
+        mp_spriteBatch = ref<StaticQuadBatch>::gen();
+    }
+    else
+    {
+        mp_spriteBatch->clear();
+    }
+
+    m_spriteSlots.clear();
+    m_slotSequences.clear();
+    m_unbatchedSprites.clear();
+    m_loadingSprites.clear();
+    m_misplacedSprites = 0;
+
+    auto spriteView = m_registry.view<GuidCmp, TransformCmp, SpriteCmp>();
+    spriteView.use<GuidCmp>();
+
+    for (auto [entity, gc, tc, sc] : spriteView.each())
+    {
+        if (sc.p_texture != nullptr && !sc.p_texture->isLoaded())
+        {
+            m_loadingSprites.push_back(entity);
+            continue;
+        }
+
+        u32_t slot = mp_spriteBatch->add(
+            tc.getWorld(), sc.p_texture, sc.color, sc.tilingFactor, static_cast<u32_t>(entity));
+
+        if (slot == StaticQuadBatch::k_noSlot)
+        {
+            m_unbatchedSprites.push_back(entity);
+        }
+        else
+        {
+            m_spriteSlots.emplace(entity, slot);
+            m_slotSequences.push_back(gc.sequenceIndex);
+        }
+    }
+
+    m_rebuildSpriteBatch = false;
+}
+
+void Scene::_addUnbatchedSprite(entt::entity entity)
+{
+    u32_t sequence = m_registry.get<GuidCmp>(entity).sequenceIndex;
+
+    auto p_pos = std::upper_bound(m_unbatchedSprites.begin(),
+                                  m_unbatchedSprites.end(),
+                                  sequence,
+                                  [this](u32_t lhs, entt::entity rhs)
+                                  { return lhs < m_registry.get<GuidCmp>(rhs).sequenceIndex; });
+
+    m_unbatchedSprites.insert(p_pos, entity);
+}
+
+void Scene::_renderSceneSpecific(Camera* p_camera)
+{
+    Renderer::s_setScene(p_camera->getView(), p_camera->getProjection());
+    //////////////////////////////////////////////////////
+    // Particle Emitters
+    //////////////////////////////////////////////////////
+    m_particleSystem.draw();
+}
+
+void Scene::_onUpdateEditor(f32_t deltaTime)
+{
+    NB_UNUSED(deltaTime);
+    _updateWorldTransforms();
 }
 
 void Scene::_onDrawEditor(Camera* p_editorCamera)
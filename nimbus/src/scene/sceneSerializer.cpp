@@ -20,7 +20,7 @@
 namespace nimbus
 {
 
-static void s_serializeEntity(toml::table& entitiesTbl, Entity entity, GuidCmp& guidCmp)
+static void s_serializeEntity(toml::table& entitiesTbl, Scene* p_scene, Entity entity, GuidCmp& guidCmp)
 {
     toml::table entityTbl;
     entityTbl.insert("sequenceIndex", guidCmp.sequenceIndex);
@@ -40,15 +40,18 @@ static void s_serializeEntity(toml::table& entitiesTbl, Entity entity, GuidCmp&
         toml::table  ancestryTbl;
         AncestryCmp& ac = entity.getComponent<AncestryCmp>();
 
-        if (ac.parent)
+        if (ac.parent != entt::null)
         {
-            ancestryTbl.insert("parent", ac.parent.getComponent<GuidCmp>().guid.toString());
+            ancestryTbl.insert("parent", Entity(ac.parent, p_scene).getComponent<GuidCmp>().guid.toString());
         }
 
+        // only the parent is read back, children are listed for whoever reads the file
         toml::array childGuids;
-        for (auto& child : ac.children)
+        Entity      child(ac.firstChild, p_scene);
+        while (child)
         {
             childGuids.push_back(child.getComponent<GuidCmp>().guid.toString());
+            child = Entity(child.getComponent<AncestryCmp>().nextSibling, p_scene);
         }
 
         ancestryTbl.insert("children", childGuids);
@@ -64,16 +67,16 @@ static void s_serializeEntity(toml::table& entitiesTbl, Entity entity, GuidCmp&
         toml::table   transformTbl;
         TransformCmp& tc = entity.getComponent<TransformCmp>();
 
-        auto& translation = tc.local.getTranslation();
-        auto& rotation    = tc.local.getRotation();
-        auto& scale       = tc.local.getScale();
+        glm::vec3 translation = tc.getTranslation();
+        glm::vec3 rotation    = tc.getRotation();
+        glm::vec3 scale       = tc.getScale();
 
         transformTbl.insert("translation", toml::array{translation.x, translation.y, translation.z});
 
         transformTbl.insert("rotation", toml::array{rotation.x, rotation.y, rotation.z});
 
         transformTbl.insert("scale", toml::array{scale.x, scale.y, scale.z});
-        transformTbl.insert("scaleLocked", tc.local.isScaleLocked());
+        transformTbl.insert("scaleLocked", tc.isScaleLocked());
 
         entityTbl.insert("TransformCmp", transformTbl);
     }
@@ -214,7 +217,11 @@ static void s_serializeEntity(toml::table& entitiesTbl, Entity entity, GuidCmp&
 
         paramTbl.insert("persist", pe.parameters.persist);
         paramTbl.insert("shrink", pe.parameters.shrink);
+        paramTbl.insert("analytic", pe.parameters.analytic);
+        paramTbl.insert("seed", static_cast<i64_t>(pe.parameters.seed));
+        paramTbl.insert("prewarm_s", pe.parameters.prewarm_s);
         paramTbl.insert("blendingMode", static_cast<int>(pe.parameters.blendingMode));
+        paramTbl.insert("priority", pe.parameters.priority);
 
         peTbl.insert("parameters", paramTbl);
         entityTbl.insert("ParticleEmitterCmp", peTbl);
@@ -319,7 +326,7 @@ void SceneSerializer::serialize(const std::string& filepath)
             return;
         }
 
-        s_serializeEntity(entitiesTbl, entity, guid);
+        s_serializeEntity(entitiesTbl, mp_scene.raw(), entity, guid);
     }
 
     sceneTbl.insert("Entities", entitiesTbl);
@@ -347,14 +354,14 @@ static void _s_deserializeComponent(Entity entity, const std::string& cmpType, t
         auto& rotation    = *cmpTbl["rotation"].as_array();
         auto& scale       = *cmpTbl["scale"].as_array();
 
-        tc.local.setTranslation(
+        tc.setTranslation(
             {translation[0].ref<f64_t>(), translation[1].ref<f64_t>(), translation[2].ref<f64_t>()});
 
-        tc.local.setRotation({rotation[0].ref<f64_t>(), rotation[1].ref<f64_t>(), rotation[2].ref<f64_t>()});
+        tc.setRotation({rotation[0].ref<f64_t>(), rotation[1].ref<f64_t>(), rotation[2].ref<f64_t>()});
 
-        tc.local.setScale({scale[0].ref<f64_t>(), scale[1].ref<f64_t>(), scale[2].ref<f64_t>()});
+        tc.setScale({scale[0].ref<f64_t>(), scale[1].ref<f64_t>(), scale[2].ref<f64_t>()});
 
-        tc.local.setScaleLocked(cmpTbl["scaleLocked"].ref<bool>());
+        tc.setScaleLocked(cmpTbl["scaleLocked"].ref<bool>());
     }
 
     ///////////////////////////
@@ -502,6 +509,12 @@ static void _s_deserializeComponent(Entity entity, const std::string& cmpType, t
         params.persist                   = paramTbl["persist"].as_boolean();
         params.shrink                    = paramTbl["shrink"].as_boolean();
 
+        // older scenes don't have these
+        params.analytic  = paramTbl["analytic"].value_or(false);
+        params.seed      = static_cast<u32_t>(paramTbl["seed"].value_or(i64_t(0)));
+        params.prewarm_s = paramTbl["prewarm_s"].value_or(0.0f);
+        params.priority  = paramTbl["priority"].value_or(0);
+
         params.blendingMode = static_cast<GraphicsApi::BlendingMode>(paramTbl["blendingMode"].ref<i64_t>());
 
         pe.parameters = params;
@@ -633,22 +646,13 @@ void SceneSerializer::_assembleFamilyTree(void* entityTbl, const std::string gui
                 ///////////////////////////
                 if (cmpType == "AncestryCmp")
                 {
-                    auto& ac = entity.addComponent<AncestryCmp>();
+                    entity.addComponent<AncestryCmp>();
 
+                    // linked once every entity has its AncestryCmp, children are found through their parent
                     std::optional<std::string> parentGuidStr = cmpTbl["parent"].value<std::string>();
-
                     if (parentGuidStr)
                     {
-                        ac.parent = m_entityMap[parentGuidStr.value()];
-                    }
-
-                    auto childrenGuidStrs = cmpTbl["children"].as_array();
-                    if (childrenGuidStrs)
-                    {
-                        for (auto& childGuidStr : *childrenGuidStrs)
-                        {
-                            ac.children.push_back(m_entityMap[childGuidStr.ref<std::string>()]);
-                        }
+                        m_parentLinks.push_back({entity, m_entityMap[parentGuidStr.value()]});
                     }
                 }
             }
@@ -724,6 +728,23 @@ bool SceneSerializer::deserialize(const std::string& filepath)
             }
         });
 
+    // children in the order they were created, which is the order they were added in
+    std::sort(m_parentLinks.begin(),
+              m_parentLinks.end(),
+              [](const std::pair<Entity, Entity>& lhs, const std::pair<Entity, Entity>& rhs)
+              {
+                  Entity lhsChild = lhs.first;
+                  Entity rhsChild = rhs.first;
+                  return lhsChild.getComponent<GuidCmp>().sequenceIndex
+                         < rhsChild.getComponent<GuidCmp>().sequenceIndex;
+              });
+
+    for (auto& [child, parent] : m_parentLinks)
+    {
+        mp_scene->setParent(child, parent);
+    }
+    m_parentLinks.clear();
+
     mp_scene->sortEntities();
     return true;
 }
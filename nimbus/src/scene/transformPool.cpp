@@ -0,0 +1,620 @@
+#include "nimbus/core/nmpch.hpp"
+#include "nimbus/core/core.hpp"
+
+#include "nimbus/scene/transformPool.hpp"
+#include "nimbus/core/jobSystem.hpp"
+#include "nimbus/core/simd.hpp"
+
+#include "gtx/quaternion.hpp"
+#include "gtx/matrix_decompose.hpp"
+
+namespace nimbus
+{
+
+u32_t TransformPool::add(entt::entity entity)
+{
+    u32_t slot = m_count;
+    _resize(m_count + 1);
+
+    m_translationX[slot] = 0.0f;
+    m_translationY[slot] = 0.0f;
+    m_translationZ[slot] = 0.0f;
+    m_quatX[slot]        = 0.0f;
+    m_quatY[slot]        = 0.0f;
+    m_quatZ[slot]        = 0.0f;
+    m_quatW[slot]        = 1.0f;
+    m_scaleX[slot]       = 1.0f;
+    m_scaleY[slot]       = 1.0f;
+    m_scaleZ[slot]       = 1.0f;
+    m_stale[slot]        = 0;
+    m_locals[slot]       = glm::mat4(1.0f);
+    m_worlds[slot]       = glm::mat4(1.0f);
+    m_rotations[slot]    = glm::vec3(0.0f);
+    m_scaleLocked[slot]  = 0;
+    m_entities[slot]     = entity;
+
+    m_worldStale[slot]    = 0;
+    m_parents[slot]       = k_noSlot;
+    m_firstChildren[slot] = k_noSlot;
+    m_nextSiblings[slot]  = k_noSlot;
+    m_prevSiblings[slot]  = k_noSlot;
+    m_depths[slot]        = 0;
+    m_followsParent[slot] = 1;
+
+    return slot;
+}
+
+entt::entity TransformPool::remove(u32_t slot)
+{
+    NB_CORE_ASSERT(slot < m_count, "Transform slot %i out of range (%i transforms)", slot, m_count);
+
+    // its children become roots
+    while (m_firstChildren[slot] != k_noSlot)
+    {
+        setParent(m_firstChildren[slot], k_noSlot);
+    }
+
+    _unlink(slot);
+
+    u32_t        last  = m_count - 1;
+    entt::entity moved = entt::null;
+
+    if (slot != last)
+    {
+        _relocate(last, slot);
+        moved = m_entities[slot];
+
+        // m_dirty still lists it under last
+        if (m_worldStale[slot])
+        {
+            m_dirty.push_back(slot);
+        }
+    }
+
+    // padding is never stale
+    m_stale[last]      = 0;
+    m_worldStale[last] = 0;
+    _resize(last);
+
+    return moved;
+}
+
+void TransformPool::clear()
+{
+    _resize(0);
+    m_dirty.clear();
+    m_anyStale = false;
+}
+
+glm::vec3 TransformPool::getTranslation(u32_t slot) const
+{
+    return glm::vec3(m_translationX[slot], m_translationY[slot], m_translationZ[slot]);
+}
+
+void TransformPool::setTranslation(u32_t slot, const glm::vec3& translation)
+{
+    m_translationX[slot] = translation.x;
+    m_translationY[slot] = translation.y;
+    m_translationZ[slot] = translation.z;
+    _markStale(slot);
+}
+
+void TransformPool::setRotation(u32_t slot, const glm::vec3& rotation)
+{
+    glm::quat orientation(rotation);
+
+    m_rotations[slot] = rotation;
+    m_quatX[slot]     = orientation.x;
+    m_quatY[slot]     = orientation.y;
+    m_quatZ[slot]     = orientation.z;
+    m_quatW[slot]     = orientation.w;
+    _markStale(slot);
+}
+
+glm::vec3 TransformPool::getScale(u32_t slot) const
+{
+    return glm::vec3(m_scaleX[slot], m_scaleY[slot], m_scaleZ[slot]);
+}
+
+void TransformPool::setScale(u32_t slot, const glm::vec3& scale)
+{
+    _setScale(slot, scale);
+    m_scaleLocked[slot] = 0;
+}
+
+void TransformPool::setScaleAxis(u32_t slot, u32_t axis, f32_t value)
+{
+    NB_CORE_ASSERT(axis < 3, "Scale axis %i out of range", axis);
+
+    glm::vec3 scale = getScale(slot);
+
+    if (m_scaleLocked[slot])
+    {
+        // keep the proportions between the axes, a zero axis has none to keep
+        if (scale[axis] == 0.0f || value == 0.0f)
+        {
+            return;
+        }
+
+        scale *= value / scale[axis];
+    }
+
+    scale[axis] = value;
+    _setScale(slot, scale);
+}
+
+const glm::mat4& TransformPool::getLocal(u32_t slot) const
+{
+    if (m_stale[slot])
+    {
+        _composeLocal(slot);
+        m_stale[slot] = 0;
+    }
+
+    return m_locals[slot];
+}
+
+void TransformPool::setLocal(u32_t slot, const glm::mat4& local)
+{
+    glm::vec3 translation;
+    glm::quat orientation;
+    glm::vec3 scale;
+    glm::vec3 skew;
+    glm::vec4 perspective;
+
+    glm::decompose(local, scale, orientation, translation, skew, perspective);
+
+    m_translationX[slot] = translation.x;
+    m_translationY[slot] = translation.y;
+    m_translationZ[slot] = translation.z;
+    m_quatX[slot]        = orientation.x;
+    m_quatY[slot]        = orientation.y;
+    m_quatZ[slot]        = orientation.z;
+    m_quatW[slot]        = orientation.w;
+    m_scaleX[slot]       = scale.x;
+    m_scaleY[slot]       = scale.y;
+    m_scaleZ[slot]       = scale.z;
+    m_rotations[slot]    = glm::eulerAngles(orientation);
+
+    m_locals[slot] = local;
+    m_stale[slot]  = 0;
+    _markWorldStale(slot);
+}
+
+void TransformPool::setParent(u32_t slot, u32_t parentSlot)
+{
+    NB_CORE_ASSERT(slot < m_count, "Transform slot %i out of range (%i transforms)", slot, m_count);
+
+    if (m_parents[slot] == parentSlot)
+    {
+        return;
+    }
+
+    for (u32_t ancestor = parentSlot; ancestor != k_noSlot; ancestor = m_parents[ancestor])
+    {
+        if (ancestor == slot)
+        {
+            Log::coreWarn("Transform %i can't be parented to its own descendant %i", slot, parentSlot);
+            return;
+        }
+    }
+
+    _unlink(slot);
+    _link(slot, parentSlot);
+    _setDepth(slot, parentSlot == k_noSlot ? 0 : m_depths[parentSlot] + 1);
+    _markWorldStale(slot);
+}
+
+void TransformPool::setFollowsParent(u32_t slot, bool follows)
+{
+    if (static_cast<bool>(m_followsParent[slot]) != follows)
+    {
+        m_followsParent[slot] = follows;
+        _markWorldStale(slot);
+    }
+}
+
+void TransformPool::updateLocals()
+{
+    NB_PROFILE_DETAIL();
+
+    static_assert(k_laneCount % simd::k_width == 0, "Transform arrays aren't padded to whole simd groups");
+
+    if (!m_anyStale)
+    {
+        return;
+    }
+
+    const simd::f32v_t one = simd::set(1.0f);
+    const simd::f32v_t two = simd::set(2.0f);
+
+    // rotation times scale, [column][row][lane]
+    f32_t axes[3][3][simd::k_width];
+
+    // padding is never stale so the last group can be partial
+    for (u32_t first = 0; first < m_count; first += simd::k_width)
+    {
+        bool anyStale = false;
+        for (u32_t lane = 0; lane < simd::k_width; lane++)
+        {
+            anyStale |= m_stale[first + lane] != 0;
+        }
+
+        if (!anyStale)
+        {
+            continue;
+        }
+
+        // local = translate * rotate * scale, with the rotation from its quaternion. Each vector holds one value of
+        // k_width transforms, they are written out as a matrix per transform at the end.
+        simd::f32v_t qx = simd::load(&m_quatX[first]);
+        simd::f32v_t qy = simd::load(&m_quatY[first]);
+        simd::f32v_t qz = simd::load(&m_quatZ[first]);
+        simd::f32v_t qw = simd::load(&m_quatW[first]);
+        simd::f32v_t sx = simd::load(&m_scaleX[first]);
+        simd::f32v_t sy = simd::load(&m_scaleY[first]);
+        simd::f32v_t sz = simd::load(&m_scaleZ[first]);
+
+        simd::f32v_t xx = simd::mul(qx, qx);
+        simd::f32v_t yy = simd::mul(qy, qy);
+        simd::f32v_t zz = simd::mul(qz, qz);
+        simd::f32v_t xy = simd::mul(qx, qy);
+        simd::f32v_t xz = simd::mul(qx, qz);
+        simd::f32v_t yz = simd::mul(qy, qz);
+        simd::f32v_t wx = simd::mul(qw, qx);
+        simd::f32v_t wy = simd::mul(qw, qy);
+        simd::f32v_t wz = simd::mul(qw, qz);
+
+        simd::store(axes[0][0], simd::mul(simd::sub(one, simd::mul(two, simd::add(yy, zz))), sx));
+        simd::store(axes[0][1], simd::mul(simd::mul(two, simd::add(xy, wz)), sx));
+        simd::store(axes[0][2], simd::mul(simd::mul(two, simd::sub(xz, wy)), sx));
+
+        simd::store(axes[1][0], simd::mul(simd::mul(two, simd::sub(xy, wz)), sy));
+        simd::store(axes[1][1], simd::mul(simd::sub(one, simd::mul(two, simd::add(xx, zz))), sy));
+        simd::store(axes[1][2], simd::mul(simd::mul(two, simd::add(yz, wx)), sy));
+
+        simd::store(axes[2][0], simd::mul(simd::mul(two, simd::add(xz, wy)), sz));
+        simd::store(axes[2][1], simd::mul(simd::mul(two, simd::sub(yz, wx)), sz));
+        simd::store(axes[2][2], simd::mul(simd::sub(one, simd::mul(two, simd::add(xx, yy))), sz));
+
+        // only the stale ones, the others may have been set as a matrix that isn't exactly its decomposition
+        for (u32_t lane = 0; lane < simd::k_width; lane++)
+        {
+            u32_t slot = first + lane;
+            if (!m_stale[slot])
+            {
+                continue;
+            }
+
+            glm::mat4& local = m_locals[slot];
+            for (u32_t column = 0; column < 3; column++)
+            {
+                local[column] = glm::vec4(axes[column][0][lane], axes[column][1][lane], axes[column][2][lane], 0.0f);
+            }
+            local[3] = glm::vec4(m_translationX[slot], m_translationY[slot], m_translationZ[slot], 1.0f);
+
+            m_stale[slot] = 0;
+        }
+    }
+
+    m_anyStale = false;
+}
+
+void TransformPool::updateWorlds(std::vector<entt::entity>& moved)
+{
+    NB_PROFILE_DETAIL();
+
+    updateLocals();
+
+    if (m_dirty.empty())
+    {
+        return;
+    }
+
+    // Shallowest first, so every parent is up to date by the time its dirty children come up. Slots can be listed
+    // twice, removing transforms moves the last one's entry and a freed slot can be handed out and marked again.
+    std::erase_if(m_dirty, [this](u32_t slot) { return slot >= m_count || !m_worldStale[slot]; });
+    std::sort(m_dirty.begin(),
+              m_dirty.end(),
+              [this](u32_t lhs, u32_t rhs)
+              { return m_depths[lhs] != m_depths[rhs] ? m_depths[lhs] < m_depths[rhs] : lhs < rhs; });
+    m_dirty.erase(std::unique(m_dirty.begin(), m_dirty.end()), m_dirty.end());
+
+    u32_t      count = static_cast<u32_t>(m_dirty.size());
+    std::mutex movedMtx;
+
+    for (u32_t first = 0; first < count;)
+    {
+        u32_t depth = m_depths[m_dirty[first]];
+        u32_t end   = first + 1;
+        while (end < count && m_depths[m_dirty[end]] == depth)
+        {
+            end++;
+        }
+
+        if (end - first >= k_minParallelRoots)
+        {
+            // none of them is below another, and everything above them is done
+            auto propagateChunk = [this, first, &moved, &movedMtx](u32_t chunkBegin, u32_t chunkEnd)
+            {
+                std::vector<entt::entity> chunkMoved;
+                _propagate(first + chunkBegin, first + chunkEnd, chunkMoved);
+
+                std::lock_guard<std::mutex> lock(movedMtx);
+                moved.insert(moved.end(), chunkMoved.begin(), chunkMoved.end());
+            };
+
+            JobSystem::s_wait(JobSystem::s_parallelFor(end - first, 0, propagateChunk));
+        }
+        else
+        {
+            _propagate(first, end, moved);
+        }
+
+        first = end;
+    }
+
+    m_dirty.clear();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Private Functions
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+void TransformPool::_resize(u32_t count)
+{
+    // rounded up to whole groups
+    u32_t size = (count + k_laneCount - 1) / k_laneCount * k_laneCount;
+
+    m_translationX.resize(size, 0.0f);
+    m_translationY.resize(size, 0.0f);
+    m_translationZ.resize(size, 0.0f);
+    m_quatX.resize(size, 0.0f);
+    m_quatY.resize(size, 0.0f);
+    m_quatZ.resize(size, 0.0f);
+    m_quatW.resize(size, 1.0f);
+    m_scaleX.resize(size, 1.0f);
+    m_scaleY.resize(size, 1.0f);
+    m_scaleZ.resize(size, 1.0f);
+    m_stale.resize(size, 0);
+    m_locals.resize(size, glm::mat4(1.0f));
+    m_worlds.resize(size, glm::mat4(1.0f));
+    m_rotations.resize(size, glm::vec3(0.0f));
+    m_scaleLocked.resize(size, 0);
+    m_entities.resize(size, entt::null);
+    m_worldStale.resize(size, 0);
+    m_parents.resize(size, k_noSlot);
+    m_firstChildren.resize(size, k_noSlot);
+    m_nextSiblings.resize(size, k_noSlot);
+    m_prevSiblings.resize(size, k_noSlot);
+    m_depths.resize(size, 0);
+    m_followsParent.resize(size, 1);
+
+    m_count = count;
+}
+
+void TransformPool::_markStale(u32_t slot)
+{
+    m_stale[slot] = 1;
+    m_anyStale    = true;
+    _markWorldStale(slot);
+}
+
+void TransformPool::_markWorldStale(u32_t slot)
+{
+    if (!m_worldStale[slot])
+    {
+        m_worldStale[slot] = 1;
+        m_dirty.push_back(slot);
+    }
+}
+
+void TransformPool::_setScale(u32_t slot, const glm::vec3& scale)
+{
+    m_scaleX[slot] = scale.x;
+    m_scaleY[slot] = scale.y;
+    m_scaleZ[slot] = scale.z;
+    _markStale(slot);
+}
+
+void TransformPool::_composeLocal(u32_t slot) const
+{
+    glm::quat orientation(m_quatW[slot], m_quatX[slot], m_quatY[slot], m_quatZ[slot]);
+
+    glm::mat4 local = glm::toMat4(orientation);
+    local[0] *= m_scaleX[slot];
+    local[1] *= m_scaleY[slot];
+    local[2] *= m_scaleZ[slot];
+    local[3] = glm::vec4(m_translationX[slot], m_translationY[slot], m_translationZ[slot], 1.0f);
+
+    m_locals[slot] = local;
+}
+
+void TransformPool::_link(u32_t slot, u32_t parentSlot)
+{
+    m_parents[slot]      = parentSlot;
+    m_prevSiblings[slot] = k_noSlot;
+    m_nextSiblings[slot] = k_noSlot;
+
+    if (parentSlot == k_noSlot)
+    {
+        return;
+    }
+
+    u32_t first = m_firstChildren[parentSlot];
+    if (first == k_noSlot)
+    {
+        // an only child is its own last sibling
+        m_firstChildren[parentSlot] = slot;
+        m_prevSiblings[slot]        = slot;
+    }
+    else
+    {
+        u32_t last = m_prevSiblings[first];
+
+        m_nextSiblings[last]  = slot;
+        m_prevSiblings[slot]  = last;
+        m_prevSiblings[first] = slot;
+    }
+}
+
+void TransformPool::_unlink(u32_t slot)
+{
+    u32_t parent = m_parents[slot];
+    u32_t prev   = m_prevSiblings[slot];
+    u32_t next   = m_nextSiblings[slot];
+
+    if (parent == k_noSlot)
+    {
+        return;
+    }
+
+    if (m_firstChildren[parent] == slot)
+    {
+        // the next one becomes first, and takes over knowing the last
+        m_firstChildren[parent] = next;
+        if (next != k_noSlot)
+        {
+            m_prevSiblings[next] = prev;
+        }
+    }
+    else
+    {
+        m_nextSiblings[prev] = next;
+        if (next != k_noSlot)
+        {
+            m_prevSiblings[next] = prev;
+        }
+        else
+        {
+            m_prevSiblings[m_firstChildren[parent]] = prev;
+        }
+    }
+
+    m_parents[slot]      = k_noSlot;
+    m_prevSiblings[slot] = k_noSlot;
+    m_nextSiblings[slot] = k_noSlot;
+}
+
+void TransformPool::_setDepth(u32_t slot, u32_t depth)
+{
+    if (m_depths[slot] == depth)
+    {
+        return;
+    }
+
+    // parents are set before their children, so a child's new depth is one past its parent's
+    std::vector<u32_t> pending{slot};
+    while (!pending.empty())
+    {
+        u32_t current = pending.back();
+        pending.pop_back();
+
+        m_depths[current] = current == slot ? depth : m_depths[m_parents[current]] + 1;
+
+        for (u32_t child = m_firstChildren[current]; child != k_noSlot; child = m_nextSiblings[child])
+        {
+            pending.push_back(child);
+        }
+    }
+}
+
+void TransformPool::_relocate(u32_t from, u32_t to)
+{
+    m_translationX[to]  = m_translationX[from];
+    m_translationY[to]  = m_translationY[from];
+    m_translationZ[to]  = m_translationZ[from];
+    m_quatX[to]         = m_quatX[from];
+    m_quatY[to]         = m_quatY[from];
+    m_quatZ[to]         = m_quatZ[from];
+    m_quatW[to]         = m_quatW[from];
+    m_scaleX[to]        = m_scaleX[from];
+    m_scaleY[to]        = m_scaleY[from];
+    m_scaleZ[to]        = m_scaleZ[from];
+    m_stale[to]         = m_stale[from];
+    m_locals[to]        = m_locals[from];
+    m_worlds[to]        = m_worlds[from];
+    m_worldStale[to]    = m_worldStale[from];
+    m_parents[to]       = m_parents[from];
+    m_firstChildren[to] = m_firstChildren[from];
+    m_nextSiblings[to]  = m_nextSiblings[from];
+    m_prevSiblings[to]  = m_prevSiblings[from];
+    m_depths[to]        = m_depths[from];
+    m_followsParent[to] = m_followsParent[from];
+    m_rotations[to]     = m_rotations[from];
+    m_scaleLocked[to]   = m_scaleLocked[from];
+    m_entities[to]      = m_entities[from];
+
+    // point whatever referred to from at to, an only child refers to itself as its last sibling
+    u32_t parent = m_parents[to];
+    if (parent != k_noSlot)
+    {
+        if (m_firstChildren[parent] == from)
+        {
+            m_firstChildren[parent] = to;
+        }
+        else
+        {
+            m_nextSiblings[m_prevSiblings[to]] = to;
+        }
+
+        if (m_nextSiblings[to] != k_noSlot)
+        {
+            m_prevSiblings[m_nextSiblings[to]] = to;
+        }
+        else
+        {
+            m_prevSiblings[m_firstChildren[parent]] = to;
+        }
+    }
+
+    for (u32_t child = m_firstChildren[to]; child != k_noSlot; child = m_nextSiblings[child])
+    {
+        m_parents[child] = to;
+    }
+}
+
+void TransformPool::_propagate(u32_t begin, u32_t end, std::vector<entt::entity>& moved)
+{
+    std::vector<u32_t> pending;
+
+    for (u32_t i = begin; i < end; i++)
+    {
+        // already done on the way down from an ancestor that moved
+        if (!m_worldStale[m_dirty[i]])
+        {
+            continue;
+        }
+
+        pending.push_back(m_dirty[i]);
+        while (!pending.empty())
+        {
+            u32_t slot = pending.back();
+            pending.pop_back();
+
+            u32_t parent   = m_parents[slot];
+            bool  inherits = parent != k_noSlot && m_followsParent[slot];
+
+            m_worldStale[slot] = 0;
+
+            glm::mat4 world = inherits ? m_worlds[parent] * m_locals[slot] : m_locals[slot];
+            if (world == m_worlds[slot])
+            {
+                // nothing new for its children, the dirty ones among them are listed themselves
+                continue;
+            }
+
+            m_worlds[slot] = world;
+            moved.push_back(m_entities[slot]);
+
+            for (u32_t child = m_firstChildren[slot]; child != k_noSlot; child = m_nextSiblings[child])
+            {
+                if (m_followsParent[child])
+                {
+                    pending.push_back(child);
+                }
+            }
+        }
+    }
+}
+
+}  // namespace nimbus
@@ -27,6 +27,7 @@ static Window*                                                gp_appWinRef = nul
 static std::unordered_map<ip_t, std::function<bool(Entity&)>> s_hasComponentFuncs;
 static std::unordered_map<ip_t, std::function<void(Entity&)>> s_addComponentFuncs;
 static std::unordered_map<ip_t, std::function<void(Entity&)>> s_removeComponentFuncs;
+static Random                                                 s_random(0);  // seeded by internalCallsInit
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Helpers
@@ -91,6 +92,9 @@ void internalCallsInit()
     gp_appRef    = &Application::s_get();
     gp_appWinRef = &gp_appRef->getWindow();
 
+    // from the sequence as it is now, after the application had the chance to seed it
+    s_random = Random();
+
     registerComponentType<GuidCmp>();
     registerComponentType<NameCmp>();
     registerComponentType<AncestryCmp>();
@@ -229,28 +233,28 @@ INTERNAL_CALL glm::mat4 ic_getWorldTransform(u32_t entityId)
 {
     auto& tc = getEntity(entityId).getComponent<TransformCmp>();
 
-    return tc.world.getTransform();
+    return tc.getWorld();
 }
 
 INTERNAL_CALL glm::vec3 ic_getWorldTranslation(u32_t entityId)
 {
     auto& tc = getEntity(entityId).getComponent<TransformCmp>();
 
-    return tc.world.getTranslation();
+    return glm::vec3(tc.getWorld()[3]);
 }
 
 INTERNAL_CALL glm::vec3 ic_getWorldRotation(u32_t entityId)
 {
     auto& tc = getEntity(entityId).getComponent<TransformCmp>();
 
-    return tc.world.getRotation();
+    return tc.getWorldTransform().getRotation();
 }
 
 INTERNAL_CALL glm::vec3 ic_getWorldScale(u32_t entityId)
 {
     auto& tc = getEntity(entityId).getComponent<TransformCmp>();
 
-    return tc.world.getScale();
+    return tc.getWorldTransform().getScale();
 }
 
 // no point to set world transform from script, it's calculated from local
@@ -265,28 +269,28 @@ INTERNAL_CALL glm::mat4 ic_getLocalTransform(u32_t entityId)
 {
     auto& tc = getEntity(entityId).getComponent<TransformCmp>();
 
-    return tc.local.getTransform();
+    return tc.getLocal();
 }
 
 INTERNAL_CALL glm::vec3 ic_getLocalTranslation(u32_t entityId)
 {
     auto& tc = getEntity(entityId).getComponent<TransformCmp>();
 
-    return tc.local.getTranslation();
+    return tc.getTranslation();
 }
 
 INTERNAL_CALL glm::vec3 ic_getLocalRotation(u32_t entityId)
 {
     auto& tc = getEntity(entityId).getComponent<TransformCmp>();
 
-    return tc.local.getRotation();
+    return tc.getRotation();
 }
 
 INTERNAL_CALL glm::vec3 ic_getLocalScale(u32_t entityId)
 {
     auto& tc = getEntity(entityId).getComponent<TransformCmp>();
 
-    return tc.local.getScale();
+    return tc.getScale();
 }
 
 ///////////////////////////
@@ -296,28 +300,54 @@ INTERNAL_CALL void ic_setLocalTransform(u32_t entityId, glm::mat4* p_transform)
 {
     auto& tc = getEntity(entityId).getComponent<TransformCmp>();
 
-    tc.local.setTransform(*p_transform);
+    tc.setLocal(*p_transform);
 }
 
 INTERNAL_CALL void ic_setLocalTranslation(u32_t entityId, glm::vec3* p_translation)
 {
     auto& tc = getEntity(entityId).getComponent<TransformCmp>();
 
-    tc.local.setTranslation(*p_translation);
+    tc.setTranslation(*p_translation);
 }
 
 INTERNAL_CALL void ic_setLocalRotation(u32_t entityId, glm::vec3* p_rotation)
 {
     auto& tc = getEntity(entityId).getComponent<TransformCmp>();
 
-    tc.local.setRotation(*p_rotation);
+    tc.setRotation(*p_rotation);
 }
 
 INTERNAL_CALL void ic_setLocalScale(u32_t entityId, glm::vec3* p_scale)
 {
     auto& tc = getEntity(entityId).getComponent<TransformCmp>();
 
-    tc.local.setScale(*p_scale);
+    tc.setScale(*p_scale);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Random
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+INTERNAL_CALL void ic_seedRandom(u64_t seed)
+{
+    s_random.seed(seed);
+}
+
+INTERNAL_CALL f32_t ic_randomFloat(f32_t min, f32_t max)
+{
+    return s_random.range(min, max);
+}
+
+INTERNAL_CALL i32_t ic_randomInt(i32_t min, i32_t max)
+{
+    if (min > max)
+    {
+        Log::coreError("Random int range %i - %i is empty", min, max);
+        return min;
+    }
+
+    // offset into unsigned and back, so negative ranges work too
+    u32_t offset = static_cast<u32_t>(max) - static_cast<u32_t>(min);
+    return static_cast<i32_t>(static_cast<u32_t>(min) + s_random.rangeU32(0, offset));
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -120,6 +120,23 @@ public unsafe partial class InternalCalls
         public static partial void SetLocalScale(uint entityId, ref Vec3 scale);
     }
 
+    public unsafe partial class Random
+    {
+        ////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+        // Random
+        ////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+        [LibraryImport("nimbus", EntryPoint = "ic_seedRandom")]
+        public static partial void Seed(ulong seed);
+
+        // in [min, max)
+        [LibraryImport("nimbus", EntryPoint = "ic_randomFloat")]
+        public static partial float Float(float min, float max);
+
+        // in [min, max]
+        [LibraryImport("nimbus", EntryPoint = "ic_randomInt")]
+        public static partial int Int(int min, int max);
+    }
+
     public unsafe partial class Input
     {
         ////////////////////////////////////////////////////////////////////////////////////////////////////////////////
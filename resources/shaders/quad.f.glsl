@@ -4,8 +4,11 @@ layout(location = 1)      in vec4  v_color;
 layout(location = 2) flat in int   v_texIndex;
 layout(location = 3)      in float v_texTilingFactor;
 layout(location = 4) flat in uint  v_entityId;
+layout(location = 5) flat in int   v_texLayer;
 
-layout(binding = 0) uniform sampler2D u_textures[32];
+// see Renderer2D::k_quadTextureSlots and k_quadPageSlots
+layout(binding = 0) uniform sampler2D      u_textures[8];
+layout(binding = 8) uniform sampler2DArray u_pages[8];
 
 layout(location = 0) out vec4 o_fragColor;
 layout(location = 1) out uint o_entityId;
@@ -15,9 +18,13 @@ void main()
 
     o_entityId = v_entityId;
 
-    o_fragColor = v_color
-                  * texture(u_textures[v_texIndex],
-                            v_texCoord * v_texTilingFactor);
+    vec2 texCoord = v_texCoord * v_texTilingFactor;
+
+    // a layer of -1 is a standalone texture, anything else a layer of a page
+    if (v_texLayer < 0)
+        o_fragColor = v_color * texture(u_textures[v_texIndex], texCoord);
+    else
+        o_fragColor = v_color * texture(u_pages[v_texIndex], vec3(texCoord, v_texLayer));
     
     if (o_fragColor.a == 0.0f)
         discard;
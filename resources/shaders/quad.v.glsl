@@ -9,14 +9,23 @@ layout(location = 6) in vec4  a_color;
 layout(location = 7) in int   a_texIndex;
 layout(location = 8) in float a_texTilingFactor;
 layout(location = 9) in uint  a_entityId;
+layout(location = 10) in int  a_texLayer;
 
 layout(location = 0)      out vec2  v_texCoord;
 layout(location = 1)      out vec4  v_color;
 layout(location = 2) flat out int   v_texIndex;
 layout(location = 3)      out float v_texTilingFactor;
 layout(location = 4) flat out uint  v_entityId;
+layout(location = 5) flat out int   v_texLayer;
 
-uniform mat4 u_viewProjection;
+layout(std140, binding = 0) uniform FrameData
+{
+    mat4  u_view;
+    mat4  u_projection;
+    mat4  u_viewProjection;
+    vec4  u_viewport;
+    float u_time;
+};
 
 void main()
 {
@@ -28,6 +37,7 @@ void main()
     v_texIndex        = a_texIndex;
     v_texTilingFactor = a_texTilingFactor;
     v_entityId        = a_entityId;
+    v_texLayer        = a_texLayer;
 
     gl_Position = u_viewProjection * transform * a_position;
 }
\ No newline at end of file
@@ -0,0 +1,47 @@
+#version 460 core
+layout(location = 0) in vec4  a_position;
+layout(location = 1) in vec2  a_texCoord;
+layout(location = 2) in vec2  a_translation;
+layout(location = 3) in uint  a_depthRotation;
+layout(location = 4) in uint  a_scale;
+layout(location = 5) in uint  a_color;
+layout(location = 6) in uint  a_texture;
+layout(location = 7) in uint  a_entityId;
+
+layout(location = 0)      out vec2  v_texCoord;
+layout(location = 1)      out vec4  v_color;
+layout(location = 2) flat out int   v_texIndex;
+layout(location = 3)      out float v_texTilingFactor;
+layout(location = 4) flat out uint  v_entityId;
+layout(location = 5) flat out int   v_texLayer;
+
+layout(std140, binding = 0) uniform FrameData
+{
+    mat4  u_view;
+    mat4  u_projection;
+    mat4  u_viewProjection;
+    vec4  u_viewport;
+    float u_time;
+};
+
+// see Renderer2D::QuadCompactInstVertex for the packing
+void main()
+{
+    float depth    = unpackHalf2x16(a_depthRotation).x;
+    float rotation = float(a_depthRotation >> 16) * (6.28318530718 / 65536.0);
+    vec2  scale    = unpackHalf2x16(a_scale);
+
+    vec2 local = a_position.xy * scale;
+    vec2 world = vec2(cos(rotation) * local.x - sin(rotation) * local.y,
+                      sin(rotation) * local.x + cos(rotation) * local.y)
+                 + a_translation;
+
+    v_texCoord        = a_texCoord;
+    v_color           = unpackUnorm4x8(a_color);
+    v_texIndex        = int(a_texture & 0xFu);
+    v_texTilingFactor = unpackHalf2x16(a_texture >> 16).x;
+    v_entityId        = a_entityId;
+    v_texLayer        = int((a_texture >> 4) & 0xFFFu) - 1;
+
+    gl_Position = u_viewProjection * vec4(world, depth, 1.0);
+}
@@ -4,10 +4,11 @@ layout(location = 0)      in vec2  v_texCoord;
 layout(location = 1)      in vec4  v_fgColor;
 layout(location = 2)      in vec4  v_bgColor;
 layout(location = 3)      in vec2  v_unitRange;
-layout(location = 4) flat in int   v_texIndex;
+layout(location = 4) flat in uint  v_page;
 layout(location = 5) flat in uint  v_entityId;
 
-layout(binding = 0) uniform sampler2D u_atlases[32];
+// pages of Renderer2D's glyph atlas, shared by every font
+layout(binding = 0) uniform sampler2DArray u_glyphPages;
 
 layout(location = 0) out vec4 o_fragColor;
 layout(location = 1) out uint o_entityId;
@@ -27,7 +28,7 @@ void main()
 {
     o_entityId = v_entityId;
 
-    vec3  msd = texture(u_atlases[v_texIndex], v_texCoord).rgb;
+    vec3  msd = texture(u_glyphPages, vec3(v_texCoord, v_page)).rgb;
     float sd  = median(msd.r, msd.g, msd.b);
     float screenPxDistance = screenPxRange() * (sd - 0.5f);
     float opacity          = clamp(screenPxDistance + 0.5f, 0.0f, 1.0f);
@@ -1,29 +1,56 @@
 #version 460 core
 layout(location = 0) in vec4  a_position;
 layout(location = 1) in vec2  a_texCoord;
-layout(location = 2) in vec4  a_fgColor;
-layout(location = 3) in vec4  a_bgColor;
-layout(location = 4) in vec2  a_unitRange;
-layout(location = 5) in int   a_texIndex;
-layout(location = 6) in uint  a_entityId;
+layout(location = 2) in vec4  a_plane;
+layout(location = 3) in vec4  a_atlas;
+layout(location = 4) in uint  a_style;
+layout(location = 5) in uint  a_page;
 
 layout(location = 0)      out vec2 v_texCoord;
 layout(location = 1)      out vec4 v_fgColor;
 layout(location = 2)      out vec4 v_bgColor;
 layout(location = 3)      out vec2 v_unitRange;
-layout(location = 4) flat out int  v_texIndex;
+layout(location = 4) flat out uint v_page;
 layout(location = 5) flat out uint v_entityId;
 
-uniform mat4 u_viewProjection;
+layout(std140, binding = 0) uniform FrameData
+{
+    mat4  u_view;
+    mat4  u_projection;
+    mat4  u_viewProjection;
+    vec4  u_viewport;
+    float u_time;
+};
+
+// see Renderer2D::TextStyle
+struct TextStyle
+{
+    mat4 transform;
+    vec4 fgColor;
+    vec4 bgColor;
+    vec2 unitRange;
+    uint entityId;
+    uint padding;
+};
+
+layout(std430, binding = 1) readonly buffer TextStyles
+{
+    TextStyle u_styles[];
+};
 
 void main()
 {
-    v_texCoord  = a_texCoord;
-    v_fgColor   = a_fgColor;
-    v_bgColor   = a_bgColor;
-    v_unitRange = a_unitRange;
-    v_texIndex  = a_texIndex;
-    v_entityId  = a_entityId;
-
-    gl_Position = u_viewProjection * a_position;
-}
\ No newline at end of file
+    TextStyle style = u_styles[a_style];
+
+    // the shared quad's corners are at -0.5 and 0.5, as a blend from one edge of the glyph to the other
+    vec2 corner = a_position.xy + 0.5f;
+
+    v_texCoord  = mix(a_atlas.xy, a_atlas.zw, corner);
+    v_fgColor   = style.fgColor;
+    v_bgColor   = style.bgColor;
+    v_unitRange = style.unitRange;
+    v_page      = a_page;
+    v_entityId  = style.entityId;
+
+    gl_Position = u_viewProjection * style.transform * vec4(mix(a_plane.xy, a_plane.zw, corner), 0.0f, 1.0f);
+}